@@ -118,9 +118,7 @@ namespace ecs {
         Entity entity;
         entity.id = nextId_++;
         entity.name = name;
-        auto [it, _] = entities_.emplace(entity.id, entity);
-        entityOrder_.push_back(entity.id);
-        return it->second;
+        return *entities_.tryEmplace(entity.id, std::move(entity)).first;
     }
 
     void ComponentStorage::destroyEntity(EntityId id) {
@@ -131,7 +129,6 @@ namespace ecs {
         materials_.erase(id);
         scripts_.erase(id);
         animations_.erase(id);
-        entityOrder_.erase(std::remove(entityOrder_.begin(), entityOrder_.end(), id), entityOrder_.end());
     }
 
     void ComponentStorage::clear() {
@@ -142,52 +139,50 @@ namespace ecs {
         materials_.clear();
         scripts_.clear();
         animations_.clear();
-        entityOrder_.clear();
         nextId_ = 0;
     }
 
     Entity* ComponentStorage::getEntity(EntityId id) {
-        auto it = entities_.find(id);
-        return (it != entities_.end()) ? &it->second : nullptr;
+        return entities_.find(id);
     }
 
     const Entity* ComponentStorage::getEntity(EntityId id) const {
-        auto it = entities_.find(id);
-        return (it != entities_.end()) ? &it->second : nullptr;
+        return entities_.find(id);
     }
 
     std::vector<std::reference_wrapper<const Entity>> ComponentStorage::entities() const {
         std::vector<std::reference_wrapper<const Entity>> list;
-        list.reserve(entityOrder_.size());
-        for (auto id : entityOrder_) {
-            list.emplace_back(entities_.at(id));
+        list.reserve(entities_.size());
+        for (size_t i = 0; i < entities_.size(); ++i) {
+            list.emplace_back(entities_.at(i));
         }
         return list;
     }
 
     std::optional<std::reference_wrapper<Entity>> ComponentStorage::selectedEntity() {
-        for (auto id : entityOrder_) {
-            auto it = entities_.find(id);
-            if (it != entities_.end() && it->second.selected) {
-                return it->second;
+        for (size_t i = 0; i < entities_.size(); ++i) {
+            Entity& entity = entities_.at(i);
+            if (entity.selected) {
+                return entity;
             }
         }
         return std::nullopt;
     }
 
     std::optional<std::reference_wrapper<const Entity>> ComponentStorage::selectedEntity() const {
-        for (auto id : entityOrder_) {
-            auto it = entities_.find(id);
-            if (it != entities_.end() && it->second.selected) {
-                return std::cref(it->second);
+        for (size_t i = 0; i < entities_.size(); ++i) {
+            const Entity& entity = entities_.at(i);
+            if (entity.selected) {
+                return std::cref(entity);
             }
         }
         return std::nullopt;
     }
 
     void ComponentStorage::setSelected(EntityId id, bool value) {
-        for (auto& [eid, entity] : entities_) {
-            if (eid == id) {
+        for (size_t i = 0; i < entities_.size(); ++i) {
+            Entity& entity = entities_.at(i);
+            if (entity.id == id) {
                 entity.selected = value;
             }
             else if (value) {
@@ -197,15 +192,19 @@ namespace ecs {
     }
 
     void ComponentStorage::update(float dt) {
-        for (auto& [id, script] : scripts_) {
+        // По индексу: колбэки могут добавлять компоненты, страницы при этом не двигаются
+        for (size_t i = 0; i < scripts_.size(); ++i) {
+            const Script& script = scripts_.at(i);
             if (script.onUpdate) {
-                script.onUpdate(id, dt);
+                script.onUpdate(scripts_.idAt(i), dt);
             }
         }
 
         std::vector<EntityId> toRemove;
 
-        for (auto& [id, anim] : animations_) {
+        for (size_t i = 0; i < animations_.size(); ++i) {
+            const EntityId id = animations_.idAt(i);
+            Animation& anim = animations_.at(i);
             anim.elapsed += dt;
 
             if (anim.isFinished()) {
@@ -1,9 +1,10 @@
 #pragma once
+#include <functional>
 #include <optional>
-#include <unordered_map>
 #include <vector>
 
 #include "Entity.h"
+#include "SparseSet.h"
 #include "Transform.h"
 #include "Mesh.h"
 #include "Collider.h"
@@ -24,46 +25,64 @@ namespace ecs {
 
         std::vector<std::reference_wrapper<const Entity>> entities() const;
 
+        size_t entityCount() const { return entities_.size(); }
+
         template<typename Component, typename... Args>
         Component& emplace(EntityId id, Args&&... args) {
-            auto& map = mapFor<Component>();
-            auto [it, inserted] = map.try_emplace(id, std::forward<Args>(args)...);
-            if (!inserted) {
-                it->second = Component{ std::forward<Args>(args)... };
+            auto& pool = poolFor<Component>();
+            if (Component* existing = pool.find(id)) {
+                *existing = Component{ std::forward<Args>(args)... };
+                return *existing;
             }
-            return it->second;
+            return *pool.tryEmplace(id, std::forward<Args>(args)...).first;
         }
 
         template<typename Component>
         Component* get(EntityId id) {
-            auto& map = mapFor<Component>();
-            auto it = map.find(id);
-            return (it != map.end()) ? &it->second : nullptr;
+            return poolFor<Component>().find(id);
         }
 
         template<typename Component>
         const Component* get(EntityId id) const {
-            const auto& map = mapFor<Component>();
-            auto it = map.find(id);
-            return (it != map.end()) ? &it->second : nullptr;
+            return poolFor<Component>().find(id);
         }
 
+        // Walks the smallest of the requested pools and probes the others by
+        // index; order follows that pool, not creation order.
         template<typename... Components, typename Func>
         void each(Func&& fn) {
-            for (const auto& id : entityOrder_) {
-                Entity& entity = entities_.at(id);
-                if ((hasComponent<Components>(id) && ...)) {
-                    fn(entity, *get<Components>(id)...);
+            if constexpr (sizeof...(Components) == 0) {
+                for (size_t i = 0; i < entities_.size(); ++i) {
+                    fn(entities_.at(i));
+                }
+            }
+            else {
+                const std::vector<EntityId>& ids = smallestPoolIds<Components...>();
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    const EntityId id = ids[i];
+                    Entity* entity = entities_.find(id);
+                    if (entity && (hasComponent<Components>(id) && ...)) {
+                        fn(*entity, *get<Components>(id)...);
+                    }
                 }
             }
         }
 
         template<typename... Components, typename Func>
         void each(Func&& fn) const {
-            for (const auto& id : entityOrder_) {
-                const Entity& entity = entities_.at(id);
-                if ((hasComponent<Components>(id) && ...)) {
-                    fn(entity, *get<Components>(id)...);
+            if constexpr (sizeof...(Components) == 0) {
+                for (size_t i = 0; i < entities_.size(); ++i) {
+                    fn(entities_.at(i));
+                }
+            }
+            else {
+                const std::vector<EntityId>& ids = smallestPoolIds<Components...>();
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    const EntityId id = ids[i];
+                    const Entity* entity = entities_.find(id);
+                    if (entity && (hasComponent<Components>(id) && ...)) {
+                        fn(*entity, *get<Components>(id)...);
+                    }
                 }
             }
         }
@@ -76,63 +95,68 @@ namespace ecs {
 
     private:
         template<typename Component>
-        std::unordered_map<EntityId, Component>& mapFor();
+        SparseSet<Component>& poolFor();
 
         template<typename Component>
-        const std::unordered_map<EntityId, Component>& mapFor() const;
+        const SparseSet<Component>& poolFor() const;
 
         template<typename Component>
         bool hasComponent(EntityId id) const {
-            const auto& map = mapFor<Component>();
-            return map.find(id) != map.end();
+            return poolFor<Component>().contains(id);
+        }
+
+        template<typename First, typename... Rest>
+        const std::vector<EntityId>& smallestPoolIds() const {
+            const std::vector<EntityId>* ids = &poolFor<First>().ids();
+            ((ids = poolFor<Rest>().size() < ids->size() ? &poolFor<Rest>().ids() : ids), ...);
+            return *ids;
         }
 
         EntityId nextId_ = 0;
-        std::unordered_map<EntityId, Entity> entities_;
-        std::vector<EntityId> entityOrder_;
-        std::unordered_map<EntityId, Transform> transforms_;
-        std::unordered_map<EntityId, Mesh> meshes_;
-        std::unordered_map<EntityId, Collider> colliders_;
-        std::unordered_map<EntityId, Material> materials_;
-        std::unordered_map<EntityId, Script> scripts_;
-        std::unordered_map<EntityId, Animation> animations_;
+        SparseSet<Entity> entities_;
+        SparseSet<Transform> transforms_;
+        SparseSet<Mesh> meshes_;
+        SparseSet<Collider> colliders_;
+        SparseSet<Material> materials_;
+        SparseSet<Script> scripts_;
+        SparseSet<Animation> animations_;
     };
 
-    // Template specializations to fetch component maps.
+    // Template specializations to fetch component pools.
     template<>
-    inline std::unordered_map<EntityId, Transform>& ComponentStorage::mapFor<Transform>() { return transforms_; }
+    inline SparseSet<Transform>& ComponentStorage::poolFor<Transform>() { return transforms_; }
 
     template<>
-    inline std::unordered_map<EntityId, Mesh>& ComponentStorage::mapFor<Mesh>() { return meshes_; }
+    inline SparseSet<Mesh>& ComponentStorage::poolFor<Mesh>() { return meshes_; }
 
     template<>
-    inline std::unordered_map<EntityId, Collider>& ComponentStorage::mapFor<Collider>() { return colliders_; }
+    inline SparseSet<Collider>& ComponentStorage::poolFor<Collider>() { return colliders_; }
 
     template<>
-    inline std::unordered_map<EntityId, Material>& ComponentStorage::mapFor<Material>() { return materials_; }
+    inline SparseSet<Material>& ComponentStorage::poolFor<Material>() { return materials_; }
 
     template<>
-    inline std::unordered_map<EntityId, Script>& ComponentStorage::mapFor<Script>() { return scripts_; }
+    inline SparseSet<Script>& ComponentStorage::poolFor<Script>() { return scripts_; }
 
     template<>
-    inline std::unordered_map<EntityId, Animation>& ComponentStorage::mapFor<Animation>() { return animations_; }
+    inline SparseSet<Animation>& ComponentStorage::poolFor<Animation>() { return animations_; }
 
     // Const overloads.
     template<>
-    inline const std::unordered_map<EntityId, Transform>& ComponentStorage::mapFor<Transform>() const { return transforms_; }
+    inline const SparseSet<Transform>& ComponentStorage::poolFor<Transform>() const { return transforms_; }
 
     template<>
-    inline const std::unordered_map<EntityId, Mesh>& ComponentStorage::mapFor<Mesh>() const { return meshes_; }
+    inline const SparseSet<Mesh>& ComponentStorage::poolFor<Mesh>() const { return meshes_; }
 
     template<>
-    inline const std::unordered_map<EntityId, Collider>& ComponentStorage::mapFor<Collider>() const { return colliders_; }
+    inline const SparseSet<Collider>& ComponentStorage::poolFor<Collider>() const { return colliders_; }
 
     template<>
-    inline const std::unordered_map<EntityId, Material>& ComponentStorage::mapFor<Material>() const { return materials_; }
+    inline const SparseSet<Material>& ComponentStorage::poolFor<Material>() const { return materials_; }
 
     template<>
-    inline const std::unordered_map<EntityId, Script>& ComponentStorage::mapFor<Script>() const { return scripts_; }
+    inline const SparseSet<Script>& ComponentStorage::poolFor<Script>() const { return scripts_; }
 
     template<>
-    inline const std::unordered_map<EntityId, Animation>& ComponentStorage::mapFor<Animation>() const { return animations_; }
+    inline const SparseSet<Animation>& ComponentStorage::poolFor<Animation>() const { return animations_; }
 } // namespace ecs
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Entity.h"
+
+namespace ecs {
+
+    // Sparse set: sparse_[id] -> index in the dense arrays.
+    // Values live in fixed-capacity pages, so inserting never moves existing
+    // elements and references survive tryEmplace. erase is a swap-remove:
+    // unlike unordered_map, it invalidates references to the erased value and
+    // to the last one, which is moved into the freed slot.
+    template<typename T, size_t PageSize = 256>
+    class SparseSet {
+    public:
+        static constexpr uint32_t npos = ~uint32_t(0);
+
+        size_t size() const { return ids_.size(); }
+        bool empty() const { return ids_.empty(); }
+        bool contains(EntityId id) const { return indexOf(id) != npos; }
+
+        // Dense order: ids()[i] owns at(i)
+        const std::vector<EntityId>& ids() const { return ids_; }
+        EntityId idAt(size_t i) const { return ids_[i]; }
+        T& at(size_t i) { return pages_[i / PageSize][i % PageSize]; }
+        const T& at(size_t i) const { return pages_[i / PageSize][i % PageSize]; }
+
+        T* find(EntityId id) {
+            const uint32_t i = indexOf(id);
+            return i != npos ? &at(i) : nullptr;
+        }
+
+        const T* find(EntityId id) const {
+            const uint32_t i = indexOf(id);
+            return i != npos ? &at(i) : nullptr;
+        }
+
+        template<typename... Args>
+        std::pair<T*, bool> tryEmplace(EntityId id, Args&&... args) {
+            if (T* existing = find(id)) {
+                return { existing, false };
+            }
+            if (static_cast<size_t>(id) >= sparse_.size()) {
+                sparse_.resize(static_cast<size_t>(id) + 1, npos);
+            }
+            if (pages_.empty() || pages_.back().size() == PageSize) {
+                pages_.emplace_back().reserve(PageSize);
+            }
+            pages_.back().emplace_back(std::forward<Args>(args)...);
+            sparse_[static_cast<size_t>(id)] = static_cast<uint32_t>(ids_.size());
+            ids_.push_back(id);
+            return { &pages_.back().back(), true };
+        }
+
+        // The last element moves into the erased slot: pointers and references
+        // to it (and dense indices of it) are invalid afterwards, others stay
+        bool erase(EntityId id) {
+            const uint32_t i = indexOf(id);
+            if (i == npos) {
+                return false;
+            }
+            const uint32_t last = static_cast<uint32_t>(ids_.size() - 1);
+            if (i != last) {
+                at(i) = std::move(at(last));
+                ids_[i] = ids_[last];
+                sparse_[static_cast<size_t>(ids_[i])] = i;
+            }
+            sparse_[static_cast<size_t>(id)] = npos;
+            ids_.pop_back();
+            pages_.back().pop_back();
+            if (pages_.back().empty()) {
+                pages_.pop_back();
+            }
+            return true;
+        }
+
+        void clear() {
+            sparse_.clear();
+            ids_.clear();
+            pages_.clear();
+        }
+
+    private:
+        uint32_t indexOf(EntityId id) const {
+            if (id < 0 || static_cast<size_t>(id) >= sparse_.size()) {
+                return npos;
+            }
+            return sparse_[static_cast<size_t>(id)];
+        }
+
+        std::vector<uint32_t> sparse_;
+        std::vector<EntityId> ids_;
+        std::vector<std::vector<T>> pages_;
+    };
+
+} // namespace ecs
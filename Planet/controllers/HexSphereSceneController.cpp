@@ -8,6 +8,7 @@
 
 // �?обавляем н�?жн�?е include
 #include "generation/MeshGenerators/WireMeshGenerator.h"
+#include "model/TopologyCache.h"
 #include "generation/MeshGenerators/SelectionOutlineGenerator.h"
 #include <QVector3D>
 #include <QElapsedTimer>
@@ -69,8 +70,8 @@ void HexSphereSceneController::setOutlineBias(float value) {
 }
 
 void HexSphereSceneController::rebuildTopology() {
-    ico_ = icoBuilder_.build(L_);
-    model_.rebuildFromIcosphere(ico_);
+    model_.rebuildFromTopology(TopologyCache::acquire(L_));
+    ++topologyRevision_;
 }
 
 void HexSphereSceneController::rebuildModel() {
@@ -108,20 +109,33 @@ void HexSphereSceneController::rebuildDerivedGeometry() {
     generateTreePlacements();
 }
 
+void HexSphereSceneController::rebuildDerivedGeometryForCells(const std::vector<int>& dirtyCells) {
+    if (isContributorMode()) {
+        rebuildContributorScene();
+        return;
+    }
+
+    updateTerrainMeshForCells(dirtyCells);
+    generateTreePlacements();
+}
+
 void HexSphereSceneController::clearForShutdown() {
     selectedCells_.clear();
     selectionOutlineVertices_.clear();
     selectionOutlineDirty_ = true;
     treePlacements_.clear();
+    ++treePlacementsRevision_;
     treeOccupiedCells_.clear();
-    triangleCache_.clear();
+    terrainClusters_.clear();
     cacheValid_ = false;
     velocity_ = QVector3D();
     cameraPos_ = QVector3D();
     lastCameraPos_ = QVector3D();
     terrainCPU_ = TerrainMesh{};
+    terrainPatch_ = TerrainMeshPatch{};
     model_ = HexSphereModel{};
-    ico_ = IcoMesh{};
+    ++topologyRevision_;
+    ++terrainRevision_;
     generator_.reset();
 }
 
@@ -153,6 +167,7 @@ void HexSphereSceneController::setSelectionOutlineVertices(std::vector<float> ve
 
 void HexSphereSceneController::setTreePlacements(std::vector<TreePlacement> placements) {
     treePlacements_ = std::move(placements);
+    ++treePlacementsRevision_;
     updateTreeOccupiedCells();
 }
 
@@ -196,7 +211,7 @@ WaterGeometryData HexSphereSceneController::buildWaterGeometry() const {
     if (isContributorMode()) {
         return {};
     }
-    return WaterMeshGenerator::buildWaterGeometry(model_);
+    return WaterMeshGenerator::buildWaterGeometry(model_, waterMeshOptions_);
 }
 
 TerrainSnapshot HexSphereSceneController::captureTerrainSnapshot() const {
@@ -228,19 +243,35 @@ void HexSphereSceneController::applyTerrainSnapshot(const TerrainSnapshot& snaps
         return;
     }
 
+    // Та же топология и уже построенная сетка: перестраиваем только изменённые клетки
+    const bool sameTopology = !topologyDirty_ &&
+        L_ == snapshot.subdivisionLevel &&
+        model_.cells().size() == snapshot.cells.size() &&
+        !terrainCPU_.cellRanges.empty();
+
     generatorIndex_ = normalizeTerrainGeneratorIndex(snapshot.generatorIndex);
     generator_ = createTerrainGeneratorByIndex(generatorIndex_);
     genParams_ = snapshot.params;
     L_ = snapshot.subdivisionLevel;
     topologyDirty_ = false;
 
-    rebuildTopology();
+    if (!sameTopology) {
+        rebuildTopology();
+    }
 
     auto& cells = model_.cells();
     const size_t count = std::min(cells.size(), snapshot.cells.size());
+    std::vector<int> dirtyCells;
     for (size_t i = 0; i < count; ++i) {
         const auto& source = snapshot.cells[i];
         auto& target = cells[i];
+        if (target.height != source.height ||
+            target.biome != source.biome ||
+            target.oreType != source.oreType ||
+            target.oreDensity != source.oreDensity ||
+            target.oreNoiseOffset != source.oreNoiseOffset) {
+            dirtyCells.push_back(static_cast<int>(i));
+        }
         target.height = source.height;
         target.biome = source.biome;
         target.temperature = source.temperature;
@@ -255,7 +286,13 @@ void HexSphereSceneController::applyTerrainSnapshot(const TerrainSnapshot& snaps
     selectedCells_.clear();
     selectionOutlineVertices_.clear();
     selectionOutlineDirty_ = true;
-    updateTerrainMesh();
+    // Новый сид меняет почти всё - тогда дешевле полная перестройка
+    if (sameTopology && dirtyCells.size() * 4 < cells.size()) {
+        updateTerrainMeshForCells(dirtyCells);
+    }
+    else {
+        updateTerrainMesh();
+    }
     generateTreePlacements();
 }
 
@@ -265,15 +302,7 @@ float HexSphereSceneController::autoHeightStep() const {
     return baseStep / (1.0f + L_ * reductionFactor);
 }
 
-void HexSphereSceneController::updateTerrainMesh() {
-    if (isContributorMode()) {
-        terrainCPU_ = TerrainMesh{};
-        cacheValid_ = false;
-        triangleCache_.clear();
-        return;
-    }
-
-    heightStep_ = autoHeightStep();
+TerrainMeshOptions HexSphereSceneController::terrainMeshOptions() const {
     TerrainMeshOptions options;
     options.heightStep = heightStep_;
     options.inset = stripInset_;
@@ -283,10 +312,43 @@ void HexSphereSceneController::updateTerrainMesh() {
     options.doBlades = true;
     options.doCornerTris = true;
     options.doEdgeCliffs = true;
+    return options;
+}
+
+void HexSphereSceneController::updateTerrainMesh() {
+    terrainPatch_ = TerrainMeshPatch{};
+    terrainPatch_.fullRebuild = true;
+    ++terrainRevision_;
 
-    terrainCPU_ = TerrainMeshGenerator::buildTerrainMesh(model_, options);
+    if (isContributorMode()) {
+        terrainCPU_ = TerrainMesh{};
+        cacheValid_ = false;
+        terrainClusters_.clear();
+        return;
+    }
+
+    heightStep_ = autoHeightStep();
+    terrainCPU_ = TerrainMeshGenerator::buildTerrainMesh(model_, terrainMeshOptions());
+    terrainPatch_.cellsRetessellated = static_cast<size_t>(model_.cellCount());
     cacheValid_ = false;
-    triangleCache_.clear();
+    terrainClusters_.clear();
+    selectionOutlineDirty_ = true;
+}
+
+void HexSphereSceneController::updateTerrainMeshForCells(const std::vector<int>& dirtyCells) {
+    if (isContributorMode() || terrainCPU_.idx.empty() || heightStep_ != autoHeightStep()) {
+        updateTerrainMesh();
+        return;
+    }
+
+    terrainPatch_ = TerrainMeshGenerator::updateTerrainMesh(model_, terrainMeshOptions(), dirtyCells, terrainCPU_);
+    ++terrainRevision_;
+    // Keep the cluster order (and the uploaded IBO) unless the edit cannot be refitted into it
+    if (terrainPatch_.fullRebuild || !cacheValid_ ||
+        !terrainClusters_.refit(terrainCPU_, terrainPatch_.slotIndexBytes, clusterEdits_)) {
+        cacheValid_ = false;
+        terrainClusters_.clear();
+    }
     selectionOutlineDirty_ = true;
 }
 
@@ -313,6 +375,7 @@ void HexSphereSceneController::updateTreeOccupiedCells() {
 
 void HexSphereSceneController::generateTreePlacements() {
     treePlacements_.clear();
+    ++treePlacementsRevision_;
 
     if (isContributorMode()) {
         TreePlacement placement;
@@ -329,7 +392,9 @@ void HexSphereSceneController::generateTreePlacements() {
         return;
     }
 
-    const auto& cells = model_.cells();
+    // Колонки: проход по всей планете читает только биом, степень и влажность
+    const auto& columns = std::as_const(model_).columns();
+    const auto& topology = model_.topology();
 
     const uint32_t deterministicSeed =
         genParams_.seed ^
@@ -370,13 +435,13 @@ void HexSphereSceneController::generateTreePlacements() {
     int firCount = 0;
     int autumnCount = 0;
 
-    for (size_t i = 0; i < cells.size(); ++i) {
-        const auto& cell = cells[i];
+    for (size_t i = 0; i < topology.cellCount(); ++i) {
+        const Biome biome = columns.biome[i];
 
         bool shouldPlaceTree = false;
         TreeType treeTypeToPlace = TreeType::Oak;
 
-        if (cell.biome == Biome::Grass) {
+        if (biome == Biome::Grass) {
             shouldPlaceTree = distTreePresence(gen) < 0.28f;
             if (shouldPlaceTree) {
                 // 70% обычные деревья, 30% ёлочки
@@ -389,17 +454,17 @@ void HexSphereSceneController::generateTreePlacements() {
                 }
             }
         }
-        else if (cell.biome == Biome::Savanna) {
+        else if (biome == Biome::Savanna) {
             shouldPlaceTree = distTreePresence(gen) < 0.16f;
             treeTypeToPlace = TreeType::Oak;
         }
-        else if (cell.biome == Biome::Snow) {
+        else if (biome == Biome::Snow) {
             if (distTreePresence(gen) < 0.12f) {
                 shouldPlaceTree = true;
                 treeTypeToPlace = TreeType::Fir;
             }
         }
-        else if (cell.biome == Biome::Tundra) {
+        else if (biome == Biome::Tundra) {
             if (distTreePresence(gen) < 0.08f) {
                 shouldPlaceTree = true;
                 treeTypeToPlace = TreeType::Fir;
@@ -412,8 +477,9 @@ void HexSphereSceneController::generateTreePlacements() {
         placement.cellId = static_cast<int>(i);
         placement.treeType = treeTypeToPlace;
 
-        if (!cell.poly.empty()) {
-            std::uniform_int_distribution<int> distTri(0, static_cast<int>(cell.poly.size()) - 1);
+        const int degree = topology.degree(static_cast<int>(i));
+        if (degree > 0) {
+            std::uniform_int_distribution<int> distTri(0, degree - 1);
             placement.triangleIdx = distTri(gen);
         }
 
@@ -427,7 +493,7 @@ void HexSphereSceneController::generateTreePlacements() {
         placement.baryV = v;
         placement.baryW = 1.0f - u - v;
 
-        if (cell.biome == Biome::Savanna) {
+        if (biome == Biome::Savanna) {
             // Осенние деревья
             placement.colorType = TreePlacement::TreeColorType::Autumn;
             placement.isYellowCellTree = true;
@@ -485,10 +551,10 @@ void HexSphereSceneController::generateTreePlacements() {
                 distTrunkB(gen)
             );
 
-            if (cell.humidity > 0.7f) {
+            if (columns.humidity[i] > 0.7f) {
                 placement.scale = distScale(gen) * 1.2f;
             }
-            else if (cell.humidity < 0.3f) {
+            else if (columns.humidity[i] < 0.3f) {
                 placement.scale = distScale(gen) * 0.7f;
             }
             else {
@@ -515,53 +581,45 @@ void HexSphereSceneController::rebuildContributorScene() {
     selectedCells_.clear();
     heightStep_ = autoHeightStep();
 
-    Cell contributorCell;
-    contributorCell.id = 0;
-    contributorCell.height = -35;
-    contributorCell.biome = Biome::Grass;
+    CellShape contributorCell;
     contributorCell.centroid = QVector3D(0.0f, 1.0f, 0.0f);
-    contributorCell.temperature = 0.5f;
-    contributorCell.humidity = 0.5f;
-    contributorCell.pressure = 0.5f;
 
     model_ = HexSphereModel{};
     model_.debug_setCellsAndDual({ contributorCell }, {});
+    model_.setHeight(0, -35);
+    model_.setBiome(0, Biome::Grass);
     terrainCPU_ = TerrainMesh{};
-    triangleCache_.clear();
+    ++topologyRevision_;
+    ++terrainRevision_;
+    terrainClusters_.clear();
     cacheValid_ = false;
     generateTreePlacements();
 }
 
-static std::vector<QVector3D> convertToQVector3D(const std::vector<float>& positions) {
-    std::vector<QVector3D> result;
-    result.reserve(positions.size() / 3);
-    for (size_t i = 0; i < positions.size(); i += 3) {
-        result.emplace_back(positions[i], positions[i + 1], positions[i + 2]);
-    }
-    return result;
-}
-
 std::vector<uint32_t> HexSphereSceneController::getVisibleIndices(const QVector3D& cameraPos) const {
     validateCache();
 
-    QVector3D planetCenter(0, 0, 0);
-    QVector3D toCam = (cameraPos - planetCenter).normalized();
-
     std::vector<uint32_t> visibleIndices;
-    visibleIndices.reserve(terrainCPU_.idx.size() / 2);
-
-    for (const auto& tri : triangleCache_) {
-        QVector3D normal = tri.center.normalized();
-        if (QVector3D::dotProduct(normal, toCam) > 0.0f) {
-            visibleIndices.push_back(tri.i0);
-            visibleIndices.push_back(tri.i1);
-            visibleIndices.push_back(tri.i2);
-        }
-    }
-
+    visibleIndices.reserve(terrainClusters_.indices().size() / 2);
+    terrainClusters_.gatherVisible(cameraPos, 0.0f, visibleIndices);
     return visibleIndices;
 }
 
+size_t HexSphereSceneController::appendVisibleIndices(const QVector3D& cameraPos, std::vector<uint32_t>& out) const {
+    validateCache();
+    return terrainClusters_.gatherVisible(cameraPos, 0.0f, out);
+}
+
+const std::vector<uint32_t>& HexSphereSceneController::clusteredTerrainIndices() const {
+    validateCache();
+    return terrainClusters_.indices();
+}
+
+size_t HexSphereSceneController::getVisibleRanges(const QVector3D& cameraPos, std::vector<TerrainDrawRange>& ranges, uint32_t mergeGap) const {
+    validateCache();
+    return terrainClusters_.gatherVisibleRanges(cameraPos, 0.0f, ranges, mergeGap);
+}
+
 TerrainMesh HexSphereSceneController::getVisibleTerrainMesh() const {
     TerrainMesh visibleMesh = terrainCPU_;
     visibleMesh.idx = getVisibleIndices(cameraPos_);
@@ -580,32 +638,23 @@ std::pair<size_t, size_t> HexSphereSceneController::getVisibilityStats() const {
 
 void HexSphereSceneController::rebuildCache() const {
     if (terrainCPU_.idx.empty() || terrainCPU_.pos.empty()) {
-        triangleCache_.clear();
+        terrainClusters_.clear();
         cacheValid_ = false;
         return;
     }
 
-    std::vector<QVector3D> positions = convertToQVector3D(terrainCPU_.pos);
-    triangleCache_.clear();
-    triangleCache_.reserve(terrainCPU_.idx.size() / 3);
-
     QElapsedTimer timer;
     timer.start();
+    terrainClusters_.build(terrainCPU_);
+    clusterEdits_.clear();
+    ++clusterRevision_;
 
-    for (size_t i = 0; i + 2 < terrainCPU_.idx.size(); i += 3) {
-        uint32_t i0 = terrainCPU_.idx[i];
-        uint32_t i1 = terrainCPU_.idx[i + 1];
-        uint32_t i2 = terrainCPU_.idx[i + 2];
-        QVector3D center = (positions[i0] + positions[i1] + positions[i2]) * (1.0f / 3.0f);
-        triangleCache_.push_back({ center, i0, i1, i2, 0.0f });
-    }
-
-    qDebug() << "Cache rebuilt:" << triangleCache_.size() << "triangles in" << timer.elapsed() << "ms";
+    qDebug() << "Cache rebuilt:" << terrainClusters_.clusterCount() << "clusters in" << timer.elapsed() << "ms";
     cacheValid_ = true;
 }
 
 void HexSphereSceneController::validateCache() const {
-    if (!cacheValid_ || triangleCache_.size() != terrainCPU_.idx.size() / 3) {
+    if (!cacheValid_ || terrainClusters_.sourceTriangleCount() != terrainCPU_.idx.size() / 3) {
         rebuildCache();
     }
 }
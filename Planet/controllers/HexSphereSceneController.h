@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "core/AppViewConfig.h"
+#include "culling/TerrainClusters.h"
 #include "dag/TerrainBackendTypes.h"
 #include "controllers/PathBuilder.h"
 #include "generation/MeshGenerators/TerrainMeshGenerator.h"
@@ -18,12 +19,6 @@
 #include "generation/TerrainGenerator.h"
 #include "model/HexSphereModel.h"
 
-struct CachedTriangle {
-    QVector3D center;      // Центр треугольника в world-space
-    uint32_t i0, i1, i2;   // Индексы вершин
-    float cachedDot;        // Кэшированное значение dot product (опционально)
-};
-
 struct VisibilityConfig {
     float baseThreshold = 0.1f;        // Базовый порог движения
     float farDistance = 5.0f;           // Расстояние, с которого начинается "далеко"
@@ -64,6 +59,8 @@ public:
     void rebuildModel();
     void regenerateTerrain();
     void rebuildDerivedGeometry();
+    // Как rebuildDerivedGeometry, но сетка перестраивается только вокруг dirtyCells
+    void rebuildDerivedGeometryForCells(const std::vector<int>& dirtyCells);
     void clearForShutdown();
 
     void clearSelection();
@@ -77,12 +74,20 @@ public:
     std::vector<float> buildSelectionOutlineVertices() const;
     std::vector<float> buildOutlineVerticesForCells(const QSet<int>& cells) const;
     WaterGeometryData buildWaterGeometry() const;
+    // Water quality / LOD settings used by buildWaterGeometry
+    void setWaterMeshOptions(const WaterMeshOptions& options) { waterMeshOptions_ = options; }
+    const WaterMeshOptions& waterMeshOptions() const { return waterMeshOptions_; }
     TerrainSnapshot captureTerrainSnapshot() const;
     void applyTerrainSnapshot(const TerrainSnapshot& snapshot);
 
     const HexSphereModel& model() const { return model_; }
     HexSphereModel& modelMutable() { return model_; }
     const TerrainMesh& terrain() const { return terrainCPU_; }
+    // Изменённые диапазоны terrain() с последнего обновления (для частичной загрузки)
+    const TerrainMeshPatch& lastTerrainPatch() const { return terrainPatch_; }
+    // Счётчики смены model().pickTris() и terrain() - для кэшей вроде BVH пикинга
+    uint64_t topologyRevision() const { return topologyRevision_; }
+    uint64_t terrainRevision() const { return terrainRevision_; }
     const QSet<int>& selectedCells() const { return selectedCells_; }
 
     int subdivisionLevel() const { return L_; }
@@ -96,6 +101,8 @@ public:
     float cellSize() const;
     bool isCellOccupiedByTree(int cellId) const;
     const std::vector<TreePlacement>& getTreePlacements() const { return treePlacements_; }
+    // Bumped on every change of the placements (and so of their surface heights)
+    uint64_t treePlacementsRevision() const { return treePlacementsRevision_; }
     void generateTreePlacements();
     SceneViewMode sceneViewMode() const { return viewMode_; }
     bool isContributorMode() const { return viewMode_ == SceneViewMode::Contributor; }
@@ -131,6 +138,16 @@ public:
     }
     void updateLastCameraPosition() { lastCameraPos_ = cameraPos_; }
     std::vector<uint32_t> getVisibleIndices(const QVector3D& cameraPos) const;
+    size_t appendVisibleIndices(const QVector3D& cameraPos, std::vector<uint32_t>& out) const;
+    // Terrain indices in cluster order and visibility as ranges into them:
+    // the renderer uploads the first once per revision and multi-draws the second.
+    // Edits refit the clusters in place: the revision stays and the rewritten
+    // ranges of clusteredTerrainIndices() collect in terrainClusterEdits() until
+    // the next rebuild.
+    const std::vector<uint32_t>& clusteredTerrainIndices() const;
+    uint64_t terrainClusterRevision() const { validateCache(); return clusterRevision_; }
+    const std::vector<TerrainDrawRange>& terrainClusterEdits() const { validateCache(); return clusterEdits_; }
+    size_t getVisibleRanges(const QVector3D& cameraPos, std::vector<TerrainDrawRange>& ranges, uint32_t mergeGap = 0) const;
     TerrainMesh getVisibleTerrainMesh() const;
     void updateVisibility(const QVector3D& cameraPos);
     std::pair<size_t, size_t> getVisibilityStats() const;
@@ -191,17 +208,20 @@ public:
 private:
     float autoHeightStep() const;
     void rebuildTopology();
+    TerrainMeshOptions terrainMeshOptions() const;
     void updateTerrainMesh();
+    void updateTerrainMeshForCells(const std::vector<int>& dirtyCells);
     void rebuildContributorScene();
 
     void updateTreeOccupiedCells();
 
     SceneViewMode viewMode_ = SceneViewMode::Planet;
 
-    IcosphereBuilder icoBuilder_;
-    IcoMesh ico_;
     HexSphereModel model_;
     TerrainMesh terrainCPU_;
+    TerrainMeshPatch terrainPatch_;
+    uint64_t topologyRevision_ = 0;
+    uint64_t terrainRevision_ = 0;
 
     std::unique_ptr<ITerrainGenerator> generator_;
     TerrainParams genParams_{};
@@ -214,17 +234,21 @@ private:
     float outlineBias_ = 0.004f;
     float stripInset_ = 0.25f;
     float pathBias_ = 0.01f;
+    WaterMeshOptions waterMeshOptions_;
 
     QSet<int> selectedCells_;
 
     std::vector<TreePlacement> treePlacements_;
+    uint64_t treePlacementsRevision_ = 0;
     QSet<int> treeOccupiedCells_;
     std::vector<float> selectionOutlineVertices_;
     bool selectionOutlineDirty_ = true;
 
     QVector3D cameraPos_{ 0, 0, 5 };      // Текущая позиция камеры (начальное значение)
     QVector3D lastCameraPos_{ 0, 0, 5 };  // Позиция на прошлом кадре для детекта движения
-    mutable std::vector<CachedTriangle> triangleCache_;
+    mutable TerrainClusters terrainClusters_;
+    mutable uint64_t clusterRevision_ = 0;
+    mutable std::vector<TerrainDrawRange> clusterEdits_; // refit since clusterRevision_ was bumped
     mutable bool cacheValid_ = false;
     mutable QVector3D lastCacheCameraPos_;
 
@@ -15,6 +15,7 @@
 
 #include "controllers/CameraController.h"
 #include "controllers/PathBuilder.h"
+#include "culling/TriangleBVH.h"
 #include "dag/EngineFacade.h"
 #include "ECS/Transform.h"
 #include "model/SurfacePlacement.h"
@@ -41,32 +42,6 @@ namespace {
         }
     }
 
-    bool rayTriangleMT(const QVector3D& o, const QVector3D& d,
-        const QVector3D& v0, const QVector3D& v1, const QVector3D& v2,
-        float& tOut) {
-        const float eps = 1e-6f;
-        const QVector3D e1 = v1 - v0;
-        const QVector3D e2 = v2 - v0;
-        const QVector3D p = QVector3D::crossProduct(d, e2);
-        const float det = QVector3D::dotProduct(e1, p);
-        if (std::fabs(det) < eps) return false;
-
-        const float invDet = 1.0f / det;
-        const QVector3D t = o - v0;
-        const float u = QVector3D::dotProduct(t, p) * invDet;
-        if (u < -eps || u > 1.0f + eps) return false;
-
-        const QVector3D q = QVector3D::crossProduct(t, e1);
-        const float v = QVector3D::dotProduct(d, q) * invDet;
-        if (v < -eps || u + v > 1.0f + eps) return false;
-
-        const float tt = QVector3D::dotProduct(e2, q) * invDet;
-        if (tt <= eps) return false;
-
-        tOut = tt;
-        return true;
-    }
-
     void printGlInfo(QOpenGLFunctions_3_3_Core* gl) {
         const GLubyte* vendor = gl->glGetString(GL_VENDOR);
         const GLubyte* renderer = gl->glGetString(GL_RENDERER);
@@ -356,17 +331,21 @@ InputController::Response InputController::executeCommand(SceneCommand command)
     };
 
     auto applyToSelectedCells = [&](auto fn) {
+        std::vector<int> edited;
+        edited.reserve(static_cast<size_t>(scene_.selectedCells().size()));
         for (int cid : scene_.selectedCells()) {
             fn(cid);
+            edited.push_back(cid);
         }
+        return edited;
     };
 
     auto setSelectedBiome = [&](Biome biome, const QString& name) {
         if (!requireSelectedCells()) {
             return;
         }
-        applyToSelectedCells([&](int cid) { scene_.modelMutable().setBiome(cid, biome); });
-        rebuildDerivedGeometry(response);
+        const auto edited = applyToSelectedCells([&](int cid) { scene_.modelMutable().setBiome(cid, biome); });
+        rebuildDerivedGeometry(response, edited);
         response.hudMessage = QString("Biome: %1").arg(name);
     };
 
@@ -463,16 +442,16 @@ InputController::Response InputController::executeCommand(SceneCommand command)
         if (!requireSelectedCells()) {
             return response;
         }
-        applyToSelectedCells([&](int cid) { scene_.modelMutable().addHeight(cid, +1); });
-        rebuildDerivedGeometry(response);
+        rebuildDerivedGeometry(response,
+            applyToSelectedCells([&](int cid) { scene_.modelMutable().addHeight(cid, +1); }));
         response.hudMessage = QString("Height +1");
         return response;
     case SceneCommand::DecreaseHeight:
         if (!requireSelectedCells()) {
             return response;
         }
-        applyToSelectedCells([&](int cid) { scene_.modelMutable().addHeight(cid, -1); });
-        rebuildDerivedGeometry(response);
+        rebuildDerivedGeometry(response,
+            applyToSelectedCells([&](int cid) { scene_.modelMutable().addHeight(cid, -1); }));
         response.hudMessage = QString("Height -1");
         return response;
     case SceneCommand::SetBiomeSea:
@@ -657,6 +636,15 @@ void InputController::rebuildDerivedGeometry(Response& response) {
     response.requestUpdate = true;
 }
 
+void InputController::rebuildDerivedGeometry(Response& response, const std::vector<int>& dirtyCells) {
+    scene_.rebuildDerivedGeometryForCells(dirtyCells);
+    refreshEntityTransformsForTerrain();
+    syncPathBackendFromScene();
+    uploadBuffers();
+    refreshBuildPreview();
+    response.requestUpdate = true;
+}
+
 void InputController::uploadSelection() {
     refreshSceneDagOutputs();
     if (renderer_) {
@@ -821,52 +809,38 @@ std::optional<int> InputController::pickCellAt(int sx, int sy) const {
     const QVector3D ro = camera_.rayOrigin();
     const QVector3D rd = camera_.rayDirectionFromScreen(sx, sy, owner_->width(), owner_->height(), owner_->devicePixelRatioF());
     const auto& tris = scene_.model().pickTris();
-    float bestT = std::numeric_limits<float>::infinity();
-    int bestId = -1;
-    for (const auto& pt : tris) {
-        float t;
-        if (rayTriangleMT(ro, rd, pt.v0, pt.v1, pt.v2, t) && t < bestT) {
-            bestT = t;
-            bestId = pt.cellId;
-        }
+    if (pickBvhRevision_ != scene_.topologyRevision()) {
+        pickBvh_.build(TriangleBVH::trianglesOf(tris));
+        pickBvhRevision_ = scene_.topologyRevision();
+    }
+    if (const auto hit = pickBvh_.intersectFirst(ro, rd)) {
+        const int cellId = tris[size_t(hit->triangle)].cellId;
+        if (cellId >= 0) return cellId;
     }
-    if (bestId >= 0) return bestId;
     return std::nullopt;
 }
 
 std::optional<InputController::PickHit> InputController::pickTerrainAt(int sx, int sy) const {
-    if (scene_.terrain().triOwner.empty()) return std::nullopt;
+    const TerrainMesh& terrain = scene_.terrain();
+    if (terrain.triOwner.empty()) return std::nullopt;
     const QVector3D ro = camera_.rayOrigin();
     const QVector3D rd = camera_.rayDirectionFromScreen(sx, sy, owner_->width(), owner_->height(), owner_->devicePixelRatioF());
 
-    float bestT = std::numeric_limits<float>::infinity();
-    int bestOwner = -1;
-    QVector3D bestPos;
-
-    const auto& P = scene_.terrain().pos;
-    const auto& I = scene_.terrain().idx;
-    const auto& O = scene_.terrain().triOwner;
-
-    const size_t triCount = O.size();
-    for (size_t t = 0; t < triCount; ++t) {
-        const uint32_t i0 = I[3 * t + 0];
-        const uint32_t i1 = I[3 * t + 1];
-        const uint32_t i2 = I[3 * t + 2];
-        const QVector3D v0(P[3 * i0], P[3 * i0 + 1], P[3 * i0 + 2]);
-        const QVector3D v1(P[3 * i1], P[3 * i1 + 1], P[3 * i1 + 2]);
-        const QVector3D v2(P[3 * i2], P[3 * i2 + 1], P[3 * i2 + 2]);
-        float tt;
-        if (rayTriangleMT(ro, rd, v0, v1, v2, tt) && tt < bestT) {
-            bestT = tt;
-            bestOwner = O[t];
-            bestPos = ro + rd * tt;
+    if (terrainBvhRevision_ != scene_.terrainRevision()) {
+        // Правка высот без смены раскладки - достаточно refit, иначе перестраиваем дерево
+        auto triangles = TriangleBVH::trianglesOf(terrain);
+        const bool canRefit = !terrainBvh_.empty() && !scene_.lastTerrainPatch().fullRebuild;
+        if (!canRefit || !terrainBvh_.refit(triangles)) {
+            terrainBvh_.build(std::move(triangles));
         }
+        terrainBvhRevision_ = scene_.terrainRevision();
     }
 
-    if (bestOwner >= 0) {
-        return PickHit{ bestOwner, -1, bestPos, bestT, false };
-    }
-    return std::nullopt;
+    const auto hit = terrainBvh_.intersectFirst(ro, rd);
+    if (!hit) return std::nullopt;
+    const int owner = terrain.triOwner[size_t(hit->triangle)];
+    if (owner < 0) return std::nullopt;
+    return PickHit{ owner, -1, ro + rd * hit->t, hit->t, false };
 }
 
 std::optional<InputController::PickHit> InputController::pickEntityAt(int sx, int sy) const {
@@ -10,6 +10,7 @@
 
 #include "core/AppViewConfig.h"
 #include "controllers/HexSphereSceneController.h"
+#include "culling/TriangleBVH.h"
 #include "dag/TerrainBackendContract.h"
 #include "renderers/HexSphereRenderer.h"
 #include "ui/PerformanceStats.h"
@@ -122,6 +123,7 @@ private:
 
     void rebuildModel(Response& response);
     void rebuildDerivedGeometry(Response& response);
+    void rebuildDerivedGeometry(Response& response, const std::vector<int>& dirtyCells);
     void uploadSelection();
     void uploadBuffers();
     void refreshSceneDagOutputs();
@@ -160,6 +162,11 @@ private:
 
     HexSphereSceneController scene_;
     ecs::ComponentStorage ecs_{};
+    // BVH пикинга строятся лениво по ревизиям сцены
+    mutable TriangleBVH pickBvh_;
+    mutable TriangleBVH terrainBvh_;
+    mutable uint64_t pickBvhRevision_ = ~uint64_t(0);
+    mutable uint64_t terrainBvhRevision_ = ~uint64_t(0);
     PerformanceStats stats_{};
 
     HexSphereRenderer::UploadOptions uploadOptions_{};
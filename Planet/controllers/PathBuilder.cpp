@@ -1,7 +1,9 @@
 ﻿#include "controllers/PathBuilder.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <queue>
 
 namespace {
 
@@ -19,19 +21,39 @@ int PathBuilder::effectiveMaxClimbDelta(int smoothMaxDelta) {
 }
 
 void PathBuilder::build(PathBuilder::WeightFn w) const {
-    const auto& cells = model_.cells();
-    const int n = static_cast<int>(cells.size());
+    const auto& topology = model_.topology();
+    const int n = static_cast<int>(topology.cellCount());
     g_.assign(n, {});
+    clearLandmarks();
+
+    if (w) {
+        const auto& cells = model_.cells();
+        for (int u = 0; u < n; ++u) {
+            for (int v : topology.neighborsOf(u)) {
+                if (v < 0) {
+                    continue;
+                }
+
+                const float weight = w(cells[static_cast<size_t>(u)], cells[static_cast<size_t>(v)]);
+                if (std::isfinite(weight)) {
+                    g_[u].push_back({ v, weight });
+                }
+            }
+        }
+        return;
+    }
 
+    // Default weights read only the height/biome columns and centroids
+    const auto& columns = model_.columns();
     for (int u = 0; u < n; ++u) {
-        const auto& from = cells[static_cast<size_t>(u)];
-        for (int v : from.neighbors) {
+        for (int v : topology.neighborsOf(u)) {
             if (v < 0) {
                 continue;
             }
 
-            const auto& to = cells[static_cast<size_t>(v)];
-            const float weight = w ? w(from, to) : traversalCost(from, to);
+            const float weight = traversalCost(
+                columns.height[u], columns.biome[u], topology.centroids[u],
+                columns.height[v], columns.biome[v], topology.centroids[v]);
             if (std::isfinite(weight)) {
                 g_[u].push_back({ v, weight });
             }
@@ -40,17 +62,24 @@ void PathBuilder::build(PathBuilder::WeightFn w) const {
 }
 
 bool PathBuilder::isTraversable(const Cell& from, const Cell& to) const {
-    if (to.biome == Biome::Sea) {
+    return isTraversable(to.height - from.height, to.biome);
+}
+
+bool PathBuilder::isTraversable(int climbDelta, Biome toBiome) const {
+    if (toBiome == Biome::Sea) {
         return false;
     }
 
-    const int climbDelta = to.height - from.height;
     return std::abs(climbDelta) <= smoothMaxDelta_;
 }
 
 float PathBuilder::edgeAngularDistance(const Cell& from, const Cell& to) {
+    return edgeAngularDistance(from.centroid, to.centroid);
+}
+
+float PathBuilder::edgeAngularDistance(const QVector3D& from, const QVector3D& to) {
     const float dot = std::clamp(
-        QVector3D::dotProduct(from.centroid.normalized(), to.centroid.normalized()),
+        QVector3D::dotProduct(from.normalized(), to.normalized()),
         -1.0f,
         1.0f);
     return std::acos(dot);
@@ -71,84 +100,318 @@ float PathBuilder::biomeTraversalFactor(Biome biome) {
 }
 
 float PathBuilder::traversalCost(const Cell& from, const Cell& to) const {
-    if (!isTraversable(from, to)) {
+    return traversalCost(from.height, from.biome, from.centroid, to.height, to.biome, to.centroid);
+}
+
+float PathBuilder::traversalCost(int fromHeight, Biome fromBiome, const QVector3D& fromCentroid,
+    int toHeight, Biome toBiome, const QVector3D& toCentroid) const {
+    const int climbDelta = toHeight - fromHeight;
+    if (!isTraversable(climbDelta, toBiome)) {
         return std::numeric_limits<float>::infinity();
     }
 
-    const float distance = edgeAngularDistance(from, to);
+    const float distance = edgeAngularDistance(fromCentroid, toCentroid);
     const float terrainFactor =
-        0.5f * (biomeTraversalFactor(from.biome) + biomeTraversalFactor(to.biome));
-    const int climbDelta = to.height - from.height;
+        0.5f * (biomeTraversalFactor(fromBiome) + biomeTraversalFactor(toBiome));
     return distance * terrainFactor * slopePenalty(climbDelta);
 }
 
-std::vector<int> PathBuilder::astar(int startId, int goalId) const {
-    const int n = static_cast<int>(g_.size());
-    if (startId < 0 || goalId < 0 || startId >= n || goalId >= n) {
-        return {};
+// ── SearchWorkspace ─────────────────────────────────────────────────────────
+void PathBuilder::SearchWorkspace::prepare(size_t nodeCount) {
+    if (stamp_.size() != nodeCount) {
+        g.assign(nodeCount, 0.0f);
+        parent.assign(nodeCount, -1);
+        closed.assign(nodeCount, 0);
+        f_.assign(nodeCount, 0.0f);
+        heapPos_.assign(nodeCount, -1);
+        stamp_.assign(nodeCount, 0);
+        generation_ = 0;
     }
 
-    auto heuristic = [&](int a, int b) {
-        return edgeAngularDistance(model_.cells()[static_cast<size_t>(a)],
-            model_.cells()[static_cast<size_t>(b)]);
-        };
+    if (++generation_ == 0) {
+        std::fill(stamp_.begin(), stamp_.end(), 0u);
+        generation_ = 1;
+    }
+    heap_.clear();
+}
+
+void PathBuilder::SearchWorkspace::touch(int v) {
+    const size_t i = static_cast<size_t>(v);
+    stamp_[i] = generation_;
+    g[i] = std::numeric_limits<float>::infinity();
+    parent[i] = -1;
+    closed[i] = 0;
+    heapPos_[i] = -1;
+}
+
+void PathBuilder::SearchWorkspace::heapPushOrDecrease(int v, float f) {
+    const size_t i = static_cast<size_t>(v);
+    if (heapPos_[i] < 0) {
+        f_[i] = f;
+        heap_.push_back(v);
+        heapPos_[i] = static_cast<int>(heap_.size() - 1);
+        siftUp(heap_.size() - 1);
+    }
+    else if (f < f_[i]) {
+        f_[i] = f;
+        siftUp(static_cast<size_t>(heapPos_[i]));
+    }
+}
+
+int PathBuilder::SearchWorkspace::heapPop() {
+    const int top = heap_.front();
+    heapPos_[static_cast<size_t>(top)] = -1;
+    const int last = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) {
+        heap_[0] = last;
+        heapPos_[static_cast<size_t>(last)] = 0;
+        siftDown(0);
+    }
+    return top;
+}
+
+void PathBuilder::SearchWorkspace::siftUp(size_t i) {
+    const int v = heap_[i];
+    const float f = f_[static_cast<size_t>(v)];
+    while (i > 0) {
+        const size_t up = (i - 1) / 2;
+        const int u = heap_[up];
+        if (!(f < f_[static_cast<size_t>(u)])) {
+            break;
+        }
+        heap_[i] = u;
+        heapPos_[static_cast<size_t>(u)] = static_cast<int>(i);
+        i = up;
+    }
+    heap_[i] = v;
+    heapPos_[static_cast<size_t>(v)] = static_cast<int>(i);
+}
+
+void PathBuilder::SearchWorkspace::siftDown(size_t i) {
+    const int v = heap_[i];
+    const float f = f_[static_cast<size_t>(v)];
+    const size_t n = heap_.size();
+    while (true) {
+        size_t child = 2 * i + 1;
+        if (child >= n) {
+            break;
+        }
+        if (child + 1 < n && f_[static_cast<size_t>(heap_[child + 1])] < f_[static_cast<size_t>(heap_[child])]) {
+            ++child;
+        }
+        const int c = heap_[child];
+        if (!(f_[static_cast<size_t>(c)] < f)) {
+            break;
+        }
+        heap_[i] = c;
+        heapPos_[static_cast<size_t>(c)] = static_cast<int>(i);
+        i = child;
+    }
+    heap_[i] = v;
+    heapPos_[static_cast<size_t>(v)] = static_cast<int>(i);
+}
 
+// ── Landmarks (ALT) ─────────────────────────────────────────────────────────
+void PathBuilder::dijkstra(const std::vector<std::vector<Adj>>& graph, int source, std::vector<float>& dist) {
     constexpr float INF = std::numeric_limits<float>::infinity();
-    std::vector<float> g(n, INF);
-    std::vector<float> f(n, INF);
-    std::vector<int> parent(n, -1);
-    std::vector<char> closed(n, 0);
-
-    struct Node {
-        float f;
-        int id;
-    };
-    struct Compare {
-        bool operator()(const Node& a, const Node& b) const { return a.f > b.f; }
-    };
-
-    std::priority_queue<Node, std::vector<Node>, Compare> pq;
-    g[startId] = 0.0f;
-    f[startId] = heuristic(startId, goalId);
-    pq.push({ f[startId], startId });
+    dist.assign(graph.size(), INF);
 
+    using Entry = std::pair<float, int>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> pq;
+    dist[static_cast<size_t>(source)] = 0.0f;
+    pq.push({ 0.0f, source });
     while (!pq.empty()) {
-        const int u = pq.top().id;
+        const auto [d, u] = pq.top();
         pq.pop();
-
-        if (closed[u]) {
+        if (d > dist[static_cast<size_t>(u)]) {
             continue;
         }
-        closed[u] = 1;
-        if (u == goalId) {
-            break;
+        for (const auto& edge : graph[static_cast<size_t>(u)]) {
+            const float candidate = d + edge.w;
+            if (candidate < dist[static_cast<size_t>(edge.to)]) {
+                dist[static_cast<size_t>(edge.to)] = candidate;
+                pq.push({ candidate, edge.to });
+            }
         }
+    }
+}
+
+void PathBuilder::clearLandmarks() const {
+    landmarks_.clear();
+    fromLandmark_.clear();
+    toLandmark_.clear();
+}
+
+void PathBuilder::buildLandmarks(int landmarkCount) const {
+    clearLandmarks();
+    const size_t n = g_.size();
+    if (n == 0 || landmarkCount <= 0) {
+        return;
+    }
 
+    // Costs are direction-dependent (slope, sea), so "to landmark" distances
+    // come from a Dijkstra over the reversed graph
+    std::vector<std::vector<Adj>> reversed(n);
+    for (size_t u = 0; u < n; ++u) {
         for (const auto& edge : g_[u]) {
-            const int v = edge.to;
-            if (closed[v]) {
-                continue;
+            reversed[static_cast<size_t>(edge.to)].push_back({ static_cast<int>(u), edge.w });
+        }
+    }
+
+    // Farthest-point sampling: next landmark maximises the distance to the
+    // nearest chosen one; only nodes reachable from a landmark are candidates
+    std::vector<float> from;
+    std::vector<float> to;
+    std::vector<float> nearest(n, std::numeric_limits<float>::infinity());
+    std::vector<std::vector<float>> fromTables;
+    std::vector<std::vector<float>> toTables;
+
+    dijkstra(g_, 0, from);
+    int next = 0;
+    for (size_t v = 0; v < n; ++v) {
+        if (std::isfinite(from[v]) && from[v] > from[static_cast<size_t>(next)]) {
+            next = static_cast<int>(v);
+        }
+    }
+
+    while (static_cast<int>(landmarks_.size()) < landmarkCount) {
+        landmarks_.push_back(next);
+        dijkstra(g_, next, from);
+        dijkstra(reversed, next, to);
+
+        int best = -1;
+        float bestDistance = 0.0f;
+        for (size_t v = 0; v < n; ++v) {
+            if (std::isfinite(from[v])) {
+                nearest[v] = std::isfinite(nearest[v]) ? std::min(nearest[v], from[v]) : from[v];
+            }
+            if (std::isfinite(nearest[v]) && nearest[v] > bestDistance) {
+                bestDistance = nearest[v];
+                best = static_cast<int>(v);
             }
+        }
+        fromTables.push_back(std::move(from));
+        toTables.push_back(std::move(to));
+        if (best < 0) {
+            break;
+        }
+        next = best;
+    }
+
+    const size_t count = landmarks_.size();
+    fromLandmark_.resize(n * count);
+    toLandmark_.resize(n * count);
+    for (size_t v = 0; v < n; ++v) {
+        for (size_t l = 0; l < count; ++l) {
+            fromLandmark_[v * count + l] = fromTables[l][v];
+            toLandmark_[v * count + l] = toTables[l][v];
+        }
+    }
+}
+
+float PathBuilder::heuristic(int v, int goal) const {
+    const auto& centroids = model_.topology().centroids;
+    float h = edgeAngularDistance(centroids[static_cast<size_t>(v)], centroids[static_cast<size_t>(goal)]);
+
+    const size_t count = landmarks_.size();
+    if (count == 0) {
+        return h;
+    }
 
-            const float candidate = g[u] + edge.w;
-            if (candidate < g[v]) {
-                g[v] = candidate;
-                f[v] = candidate + heuristic(v, goalId);
-                parent[v] = u;
-                pq.push({ f[v], v });
+    const float* fromV = &fromLandmark_[static_cast<size_t>(v) * count];
+    const float* fromGoal = &fromLandmark_[static_cast<size_t>(goal) * count];
+    const float* toV = &toLandmark_[static_cast<size_t>(v) * count];
+    const float* toGoal = &toLandmark_[static_cast<size_t>(goal) * count];
+    for (size_t l = 0; l < count; ++l) {
+        // d(L,v) + d(v,goal) >= d(L,goal); L reaches v but not goal => v cannot either
+        if (std::isfinite(fromV[l])) {
+            if (!std::isfinite(fromGoal[l])) {
+                return std::numeric_limits<float>::infinity();
             }
+            h = std::max(h, fromGoal[l] - fromV[l]);
+        }
+        // d(v,goal) + d(goal,L) >= d(v,L)
+        if (std::isfinite(toV[l]) && std::isfinite(toGoal[l])) {
+            h = std::max(h, toV[l] - toGoal[l]);
         }
     }
+    return h;
+}
 
-    if (parent[goalId] == -1 && startId != goalId) {
+// ── A* ──────────────────────────────────────────────────────────────────────
+std::vector<int> PathBuilder::astar(int startId, int goalId) const {
+    return astar(startId, goalId, workspace_);
+}
+
+std::vector<int> PathBuilder::astar(int startId, int goalId, SearchWorkspace& ws) const {
+    const int n = static_cast<int>(g_.size());
+    if (startId < 0 || goalId < 0 || startId >= n || goalId >= n) {
         return {};
     }
 
+    const auto startTime = std::chrono::steady_clock::now();
+    SearchStats stats;
+    stats.queries = 1;
+
+    ws.prepare(static_cast<size_t>(n));
+    ws.touch(startId);
+    ws.g[static_cast<size_t>(startId)] = 0.0f;
+
+    bool found = false;
+    const float startH = heuristic(startId, goalId);
+    if (std::isfinite(startH)) {
+        ws.heapPushOrDecrease(startId, startH);
+        ++stats.heapPushes;
+    }
+
+    while (!ws.heapEmpty()) {
+        const int u = ws.heapPop();
+        ws.closed[static_cast<size_t>(u)] = 1;
+        ++stats.expandedNodes;
+        if (u == goalId) {
+            found = true;
+            break;
+        }
+
+        const float gu = ws.g[static_cast<size_t>(u)];
+        for (const auto& edge : g_[static_cast<size_t>(u)]) {
+            const int v = edge.to;
+            if (!ws.seen(v)) {
+                ws.touch(v);
+            }
+            else if (ws.closed[static_cast<size_t>(v)]) {
+                continue;
+            }
+
+            const float candidate = gu + edge.w;
+            if (candidate < ws.g[static_cast<size_t>(v)]) {
+                const float h = heuristic(v, goalId);
+                if (!std::isfinite(h)) {
+                    continue;
+                }
+                ws.g[static_cast<size_t>(v)] = candidate;
+                ws.parent[static_cast<size_t>(v)] = u;
+                ws.heapPushOrDecrease(v, candidate + h);
+                ++stats.heapPushes;
+            }
+        }
+    }
+
     std::vector<int> path;
-    for (int cur = goalId; cur != -1; cur = parent[cur]) {
-        path.push_back(cur);
+    if (found) {
+        for (int cur = goalId; cur != -1; cur = ws.parent[static_cast<size_t>(cur)]) {
+            path.push_back(cur);
+        }
+        std::reverse(path.begin(), path.end());
     }
-    std::reverse(path.begin(), path.end());
+
+    stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+    ws.last = stats;
+    ws.total.queries += stats.queries;
+    ws.total.expandedNodes += stats.expandedNodes;
+    ws.total.heapPushes += stats.heapPushes;
+    ws.total.elapsedMs += stats.elapsedMs;
     return path;
 }
 
@@ -1,8 +1,8 @@
 ﻿#pragma once
 
+#include <cstdint>
 #include <functional>
 #include <limits>
-#include <queue>
 #include <vector>
 
 #include <QVector3D>
@@ -19,12 +19,65 @@ public:
     using WeightFn = std::function<float(const Cell&, const Cell&)>;
     static constexpr int kMaxClimbDelta = 2;
 
+    // Per-query counters; elapsedMs is wall time of the search itself
+    struct SearchStats {
+        uint64_t queries = 0;
+        uint64_t expandedNodes = 0;
+        uint64_t heapPushes = 0;
+        double elapsedMs = 0.0;
+    };
+
+    // Reusable search state. Arrays are stamped with a generation instead of
+    // being cleared, so a query touches only the nodes it reaches. One
+    // workspace per thread; the builder keeps its own for astar(start, goal).
+    class SearchWorkspace {
+    public:
+        SearchStats last;
+        SearchStats total;
+
+        void prepare(size_t nodeCount);
+        bool seen(int v) const { return stamp_[size_t(v)] == generation_; }
+        void touch(int v);
+
+        std::vector<float> g;
+        std::vector<int> parent;
+        std::vector<char> closed;
+
+        // Indexed binary min-heap on f with decrease-key
+        bool heapEmpty() const { return heap_.empty(); }
+        void heapPushOrDecrease(int v, float f);
+        int heapPop();
+
+    private:
+        void siftUp(size_t i);
+        void siftDown(size_t i);
+
+        uint32_t generation_ = 0;
+        std::vector<uint32_t> stamp_;
+        std::vector<float> f_;
+        std::vector<int> heapPos_; // -1 => not in heap
+        std::vector<int> heap_;
+    };
+
     explicit PathBuilder(const HexSphereModel& model, int smoothMaxDelta = 1)
         : model_(model)
         , smoothMaxDelta_(effectiveMaxClimbDelta(smoothMaxDelta)) {}
 
+    // Rebuilding the graph drops landmark tables built for the previous one
     void build(WeightFn w = nullptr) const;
     std::vector<int> astar(int startId, int goalId) const;
+    std::vector<int> astar(int startId, int goalId, SearchWorkspace& workspace) const;
+
+    // ALT heuristic: exact forward/backward distances from landmarks picked by
+    // farthest-point sampling on the built graph. Combined with the
+    // great-circle bound, so it is never looser than the default heuristic.
+    void buildLandmarks(int landmarkCount = 8) const;
+    void clearLandmarks() const;
+    int landmarkCount() const { return static_cast<int>(landmarks_.size()); }
+
+    // Counters of the builder's own workspace
+    const SearchStats& lastSearchStats() const { return workspace_.last; }
+    const SearchStats& totalSearchStats() const { return workspace_.total; }
 
     std::vector<QVector3D> polylineOnSphere(const std::vector<int>& path,
         int segmentsPerEdge,
@@ -39,8 +92,23 @@ public:
     float traversalCost(const Cell& from, const Cell& to) const;
 
 private:
+    bool isTraversable(int climbDelta, Biome toBiome) const;
+    static float edgeAngularDistance(const QVector3D& from, const QVector3D& to);
+    float traversalCost(int fromHeight, Biome fromBiome, const QVector3D& fromCentroid,
+        int toHeight, Biome toBiome, const QVector3D& toCentroid) const;
+
+    float heuristic(int v, int goal) const;
+    static void dijkstra(const std::vector<std::vector<Adj>>& graph, int source, std::vector<float>& dist);
+
     const HexSphereModel& model_;
     const int smoothMaxDelta_;
     mutable std::vector<std::vector<Adj>> g_;
+
+    // Landmark tables, node-major: [v * L + l]
+    mutable std::vector<int> landmarks_;
+    mutable std::vector<float> fromLandmark_; // d(landmark, v)
+    mutable std::vector<float> toLandmark_;   // d(v, landmark)
+
+    mutable SearchWorkspace workspace_;
 };
 
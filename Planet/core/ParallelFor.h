@@ -0,0 +1,35 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Раздаёт задачи [0, count) рабочим потокам; при threads <= 1 - в текущем потоке.
+// fn(taskIndex, workerIndex); workerIndex < min(threads, count).
+template <typename Fn>
+void parallelFor(size_t count, int threads, Fn&& fn) {
+    const size_t workerCount = std::min<size_t>(size_t(std::max(threads, 1)), count);
+    if (workerCount <= 1) {
+        for (size_t i = 0; i < count; ++i) fn(i, 0);
+        return;
+    }
+
+    std::atomic<size_t> next{ 0 };
+    auto worker = [&](size_t workerIdx) {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+            fn(i, workerIdx);
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(workerCount - 1);
+    for (size_t w = 1; w < workerCount; ++w) pool.emplace_back(worker, w);
+    worker(0);
+    for (auto& t : pool) t.join();
+}
+
+// threadCount > 0 - как есть, иначе по числу аппаратных потоков
+inline int resolveThreadCount(int threadCount) {
+    if (threadCount > 0) return threadCount;
+    return std::max(1, int(std::thread::hardware_concurrency()));
+}
@@ -0,0 +1,61 @@
+#include "core/ProcessMemory.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#if defined(_MSC_VER)
+#pragma comment(lib, "psapi.lib")
+#endif
+#elif defined(__linux__)
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+#if defined(__linux__)
+namespace {
+    // Строки вида "VmRSS:     12345 kB"
+    size_t readStatusKb(const char* key) {
+        FILE* file = std::fopen("/proc/self/status", "r");
+        if (!file) return 0;
+        const size_t keyLen = std::strlen(key);
+        char line[256];
+        size_t kb = 0;
+        while (std::fgets(line, sizeof(line), file)) {
+            if (std::strncmp(line, key, keyLen) == 0 && line[keyLen] == ':') {
+                kb = static_cast<size_t>(std::strtoull(line + keyLen + 1, nullptr, 10));
+                break;
+            }
+        }
+        std::fclose(file);
+        return kb;
+    }
+}
+#endif
+
+ProcessMemorySample sampleProcessMemory() {
+    ProcessMemorySample sample;
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS info;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info))) {
+        sample.rssBytes = static_cast<size_t>(info.WorkingSetSize);
+        sample.peakRssBytes = static_cast<size_t>(info.PeakWorkingSetSize);
+    }
+#elif defined(__linux__)
+    sample.rssBytes = readStatusKb("VmRSS") * 1024;
+    sample.peakRssBytes = readStatusKb("VmHWM") * 1024;
+#endif
+    return sample;
+}
+
+bool resetPeakRss() {
+#if defined(__linux__)
+    FILE* file = std::fopen("/proc/self/clear_refs", "w");
+    if (!file) return false;
+    const bool ok = std::fputs("5", file) >= 0;
+    return std::fclose(file) == 0 && ok;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+
+// Resident set size of the current process. Linux reads /proc/self/status
+// (VmRSS / VmHWM), Windows uses psapi; other platforms report zeros.
+struct ProcessMemorySample {
+    size_t rssBytes = 0;
+    size_t peakRssBytes = 0;
+};
+
+ProcessMemorySample sampleProcessMemory();
+
+// Restart the peak counter so the next sample covers only what follows.
+// Linux: /proc/self/clear_refs; returns false where the OS cannot do it.
+bool resetPeakRss();
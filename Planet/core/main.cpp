@@ -1,11 +1,13 @@
 #include <QApplication>
 #include <QCoreApplication>
 #include <QDir>
+#include <QStandardPaths>
 #include <QSurfaceFormat>
 #include <windows.h>
 
 #include "core/AppViewConfig.h"
 #include "dag/DagBackendBenchmark.h"
+#include "model/TopologyCache.h"
 #include "ui/MainWindow.h"
 
 extern "C" {
@@ -39,6 +41,9 @@ int main(int argc, char** argv) {
     }
 
     QApplication app(argc, argv);
+    // Бенчмарк выше строит топологию с нуля; приложение берёт готовую с диска
+    TopologyCache::setDiskDirectory(
+        QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/topology");
     const AppViewConfig viewConfig = defaultAppViewConfig();
     MainWindow w(viewConfig);
 
@@ -0,0 +1,385 @@
+#include "TerrainClusters.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "renderers/TerrainTessellator.h"
+
+namespace {
+    constexpr float kPi = 3.14159265358979f;
+    constexpr int kNormalCells = 4;
+
+    // 10 бит на ось -> 30-битный код Мортона
+    uint32_t spreadBits(uint32_t v) {
+        v &= 0x3FFu;
+        v = (v | (v << 16)) & 0x030000FFu;
+        v = (v | (v << 8)) & 0x0300F00Fu;
+        v = (v | (v << 4)) & 0x030C30C3u;
+        v = (v | (v << 2)) & 0x09249249u;
+        return v;
+    }
+
+    uint32_t mortonCode(const QVector3D& p, const QVector3D& lo, const QVector3D& extent) {
+        auto quantize = [](float v, float lo, float extent) {
+            const float t = extent > 0.0f ? (v - lo) / extent : 0.0f;
+            return uint32_t(std::clamp(t, 0.0f, 1.0f) * 1023.0f);
+        };
+        return (spreadBits(quantize(p.x(), lo.x(), extent.x())) << 2) |
+            (spreadBits(quantize(p.y(), lo.y(), extent.y())) << 1) |
+            spreadBits(quantize(p.z(), lo.z(), extent.z()));
+    }
+
+    QVector3D minOf(const QVector3D& a, const QVector3D& b) {
+        return QVector3D(std::min(a.x(), b.x()), std::min(a.y(), b.y()), std::min(a.z(), b.z()));
+    }
+
+    QVector3D maxOf(const QVector3D& a, const QVector3D& b) {
+        return QVector3D(std::max(a.x(), b.x()), std::max(a.y(), b.y()), std::max(a.z(), b.z()));
+    }
+
+    // Ячейка кубической карты направления нормали (kNormalCells x kNormalCells на грань).
+    // Стенки и склоны в одном кластере с крышами дают конус шире 60° - такой не отсекается
+    uint32_t normalBucket(const QVector3D& n) {
+        const float ax = std::fabs(n.x()), ay = std::fabs(n.y()), az = std::fabs(n.z());
+        int face;
+        float u, v, m;
+        if (ax >= ay && ax >= az) {
+            face = n.x() > 0.0f ? 0 : 1;
+            u = n.y(); v = n.z(); m = ax;
+        } else if (ay >= az) {
+            face = n.y() > 0.0f ? 2 : 3;
+            u = n.x(); v = n.z(); m = ay;
+        } else {
+            face = n.z() > 0.0f ? 4 : 5;
+            u = n.x(); v = n.y(); m = az;
+        }
+        const int iu = std::min(kNormalCells - 1, int((u / m * 0.5f + 0.5f) * kNormalCells));
+        const int iv = std::min(kNormalCells - 1, int((v / m * 0.5f + 0.5f) * kNormalCells));
+        return uint32_t((face * kNormalCells + iu) * kNormalCells + iv);
+    }
+
+    void setConeAngle(TerrainCluster& bounds, float angle) {
+        if (angle >= kPi) {
+            bounds.coneCos = -1.0f;
+            bounds.coneSin = 0.0f;
+            return;
+        }
+        bounds.coneCos = std::cos(angle);
+        bounds.coneSin = std::sin(angle);
+    }
+}
+
+void TerrainClusters::clear() {
+    indices_.clear();
+    owners_.clear();
+    clusters_.clear();
+    groups_.clear();
+    positions_.clear();
+    sourceTriangles_ = 0;
+}
+
+void TerrainClusters::build(const TerrainMesh& mesh, uint32_t clusterTriangles) {
+    clear();
+    sourceTriangles_ = mesh.idx.size() / 3;
+    if (sourceTriangles_ == 0) return;
+    clusterTriangles_ = std::max(clusterTriangles, 1u);
+
+    const auto& P = mesh.pos;
+    const auto& I = mesh.idx;
+    auto vertex = [&](uint32_t i) { return QVector3D(P[3 * size_t(i)], P[3 * size_t(i) + 1], P[3 * size_t(i) + 2]); };
+
+    // Вырожденные треугольники (пустые хвосты слотов) ничего не рисуют - в кластеры не попадают
+    std::vector<uint32_t> live;
+    std::vector<QVector3D> centroids(sourceTriangles_);
+    std::vector<QVector3D> normals(sourceTriangles_);
+    live.reserve(sourceTriangles_);
+    QVector3D lo(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+    QVector3D hi = -lo;
+    for (uint32_t t = 0; t < sourceTriangles_; ++t) {
+        const QVector3D v0 = vertex(I[3 * size_t(t)]);
+        const QVector3D v1 = vertex(I[3 * size_t(t) + 1]);
+        const QVector3D v2 = vertex(I[3 * size_t(t) + 2]);
+        const QVector3D n = QVector3D::crossProduct(v1 - v0, v2 - v0);
+        if (n.lengthSquared() <= 0.0f) continue;
+        normals[t] = n.normalized();
+        centroids[t] = (v0 + v1 + v2) * (1.0f / 3.0f);
+        lo = minOf(lo, centroids[t]);
+        hi = maxOf(hi, centroids[t]);
+        live.push_back(t);
+    }
+    positions_.assign(sourceTriangles_, kNoPosition);
+    if (live.empty()) return;
+
+    // Ключ: направление нормали, внутри него - кривая Мортона по центроидам
+    std::vector<uint64_t> codes(sourceTriangles_);
+    for (uint32_t t : live) codes[t] = (uint64_t(normalBucket(normals[t])) << 32) | mortonCode(centroids[t], lo, hi - lo);
+    std::stable_sort(live.begin(), live.end(), [&](uint32_t a, uint32_t b) { return codes[a] < codes[b]; });
+
+    const bool hasOwners = mesh.triOwner.size() == sourceTriangles_;
+    indices_.reserve(live.size() * 3);
+    if (hasOwners) owners_.reserve(live.size());
+    for (uint32_t t : live) {
+        positions_[t] = uint32_t(indices_.size() / 3);
+        indices_.insert(indices_.end(), I.begin() + 3 * size_t(t), I.begin() + 3 * size_t(t) + 3);
+        if (hasOwners) owners_.push_back(mesh.triOwner[t]);
+    }
+
+    clusters_.resize((live.size() + clusterTriangles_ - 1) / clusterTriangles_);
+    for (size_t c = 0; c < clusters_.size(); ++c) {
+        const size_t begin = c * clusterTriangles_;
+        const size_t end = std::min(live.size(), begin + clusterTriangles_);
+        clusters_[c].firstIndex = uint32_t(begin * 3);
+        clusters_[c].indexCount = uint32_t((end - begin) * 3);
+        fitCluster(c, mesh);
+    }
+    groups_.resize((clusters_.size() + kGroupSize - 1) / kGroupSize);
+    for (size_t g = 0; g < groups_.size(); ++g) fitGroup(g);
+}
+
+bool TerrainClusters::refit(const TerrainMesh& mesh, const std::vector<TerrainMeshByteRange>& slotIndexBytes,
+    std::vector<TerrainDrawRange>& changed)
+{
+    constexpr size_t kTriIndexBytes = 3 * sizeof(uint32_t);
+    const size_t triangles = mesh.idx.size() / 3;
+    const bool hasOwners = !owners_.empty();
+    if (clusters_.empty() || triangles < sourceTriangles_) return false;
+    if (hasOwners && mesh.triOwner.size() != triangles) return false;
+
+    const auto& P = mesh.pos;
+    const auto& I = mesh.idx;
+    auto vertex = [&](uint32_t i) { return QVector3D(P[3 * size_t(i)], P[3 * size_t(i) + 1], P[3 * size_t(i) + 2]); };
+    auto isLive = [&](size_t t) {
+        const QVector3D v0 = vertex(I[3 * t]);
+        return QVector3D::crossProduct(vertex(I[3 * t + 1]) - v0, vertex(I[3 * t + 2]) - v0).lengthSquared() > 0.0f;
+    };
+    auto positionOf = [&](size_t t) { return t < positions_.size() ? positions_[t] : kNoPosition; };
+
+    // Сначала проверка, потом правка: новому живому треугольнику в текущем порядке места нет
+    for (const TerrainMeshByteRange& range : slotIndexBytes) {
+        const size_t end = (range.offset + range.size) / kTriIndexBytes;
+        if (end > triangles) return false;
+        for (size_t t = range.offset / kTriIndexBytes; t < end; ++t)
+            if (positionOf(t) == kNoPosition && isLive(t)) return false;
+    }
+
+    positions_.resize(triangles, kNoPosition);
+    sourceTriangles_ = triangles;
+    std::vector<size_t> dirty;
+    for (const TerrainMeshByteRange& range : slotIndexBytes) {
+        for (size_t t = range.offset / kTriIndexBytes; t < (range.offset + range.size) / kTriIndexBytes; ++t) {
+            const uint32_t position = positions_[t];
+            if (position == kNoPosition) continue;
+            // Умерший треугольник остаётся на своём месте вырожденным
+            const size_t at = size_t(position) * 3;
+            if (!std::equal(I.begin() + 3 * t, I.begin() + 3 * t + 3, indices_.begin() + at)) {
+                std::copy(I.begin() + 3 * t, I.begin() + 3 * t + 3, indices_.begin() + at);
+                changed.push_back({ uint32_t(at), 3u });
+            }
+            if (hasOwners) owners_[position] = mesh.triOwner[t];
+            dirty.push_back(position / clusterTriangles_);
+        }
+    }
+
+    std::sort(dirty.begin(), dirty.end());
+    dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+    size_t lastGroup = std::numeric_limits<size_t>::max();
+    for (size_t c : dirty) {
+        fitCluster(c, mesh);
+        if (c / kGroupSize != lastGroup) {
+            if (lastGroup != std::numeric_limits<size_t>::max()) fitGroup(lastGroup);
+            lastGroup = c / kGroupSize;
+        }
+    }
+    if (lastGroup != std::numeric_limits<size_t>::max()) fitGroup(lastGroup);
+
+    // changed держим отсортированным и склеенным: его накапливают между перестройками
+    std::sort(changed.begin(), changed.end(), [](const TerrainDrawRange& a, const TerrainDrawRange& b) {
+        return a.firstIndex < b.firstIndex;
+    });
+    size_t out = 0;
+    for (size_t i = 0; i < changed.size(); ++i) {
+        if (out > 0 && changed[out - 1].firstIndex + changed[out - 1].indexCount >= changed[i].firstIndex) {
+            const uint32_t end = std::max(changed[out - 1].firstIndex + changed[out - 1].indexCount,
+                changed[i].firstIndex + changed[i].indexCount);
+            changed[out - 1].indexCount = end - changed[out - 1].firstIndex;
+        }
+        else {
+            changed[out++] = changed[i];
+        }
+    }
+    changed.resize(out);
+    return true;
+}
+
+// ── кластеры: сфера по вершинам, конус по нормалям граней ──────────────────
+// Вырожденные записи (треугольник умер после refit) границ не задают
+void TerrainClusters::fitCluster(size_t c, const TerrainMesh& mesh) {
+    const auto& P = mesh.pos;
+    auto vertex = [&](uint32_t i) { return QVector3D(P[3 * size_t(i)], P[3 * size_t(i) + 1], P[3 * size_t(i) + 2]); };
+    auto normalOf = [&](size_t k) {
+        const QVector3D v0 = vertex(indices_[k * 3]);
+        return QVector3D::crossProduct(vertex(indices_[k * 3 + 1]) - v0, vertex(indices_[k * 3 + 2]) - v0);
+    };
+
+    TerrainCluster& cluster = clusters_[c];
+    const size_t begin = cluster.firstIndex / 3;
+    const size_t end = begin + cluster.indexCount / 3;
+    QVector3D boxLo(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+    QVector3D boxHi = -boxLo;
+    QVector3D axis;
+    for (size_t k = begin; k < end; ++k) {
+        const QVector3D n = normalOf(k);
+        if (n.lengthSquared() <= 0.0f) continue;
+        axis += n.normalized();
+        for (size_t v = 0; v < 3; ++v) {
+            boxLo = minOf(boxLo, vertex(indices_[k * 3 + v]));
+            boxHi = maxOf(boxHi, vertex(indices_[k * 3 + v]));
+        }
+    }
+
+    cluster.coneAxis = QVector3D();
+    setConeAngle(cluster, kPi);
+    // Одни вырожденные: прежняя сфера остаётся верной, отсекать по конусу нечем
+    if (boxLo.x() > boxHi.x()) return;
+
+    cluster.center = (boxLo + boxHi) * 0.5f;
+    cluster.radius = 0.0f;
+    for (size_t k = begin; k < end; ++k) {
+        if (normalOf(k).lengthSquared() <= 0.0f) continue;
+        for (size_t v = 0; v < 3; ++v)
+            cluster.radius = std::max(cluster.radius, (vertex(indices_[k * 3 + v]) - cluster.center).length());
+    }
+
+    if (axis.length() > 1e-4f) {
+        cluster.coneAxis = axis.normalized();
+        float minDot = 1.0f;
+        for (size_t k = begin; k < end; ++k) {
+            const QVector3D n = normalOf(k);
+            if (n.lengthSquared() > 0.0f) minDot = std::min(minDot, QVector3D::dotProduct(cluster.coneAxis, n.normalized()));
+        }
+        setConeAngle(cluster, std::acos(std::clamp(minDot, -1.0f, 1.0f)));
+    }
+}
+
+// ── группы: подряд идущие кластеры одного участка кривой Мортона ───────────
+void TerrainClusters::fitGroup(size_t g) {
+    const size_t begin = g * kGroupSize;
+    const size_t end = std::min(clusters_.size(), size_t(begin + kGroupSize));
+    TerrainCluster group;
+    group.firstIndex = clusters_[begin].firstIndex;
+    group.indexCount = clusters_[end - 1].firstIndex + clusters_[end - 1].indexCount - group.firstIndex;
+
+    QVector3D boxLo = clusters_[begin].center;
+    QVector3D boxHi = boxLo;
+    QVector3D axis;
+    bool coneValid = true;
+    for (size_t c = begin; c < end; ++c) {
+        const TerrainCluster& cluster = clusters_[c];
+        const QVector3D r(cluster.radius, cluster.radius, cluster.radius);
+        boxLo = minOf(boxLo, cluster.center - r);
+        boxHi = maxOf(boxHi, cluster.center + r);
+        axis += cluster.coneAxis * float(cluster.indexCount);
+        coneValid = coneValid && cluster.coneCos > -1.0f;
+    }
+    group.center = (boxLo + boxHi) * 0.5f;
+    for (size_t c = begin; c < end; ++c)
+        group.radius = std::max(group.radius, (clusters_[c].center - group.center).length() + clusters_[c].radius);
+
+    if (coneValid && axis.length() > 1e-4f) {
+        group.coneAxis = axis.normalized();
+        float angle = 0.0f;
+        for (size_t c = begin; c < end; ++c) {
+            const float toChild = std::acos(std::clamp(QVector3D::dotProduct(group.coneAxis, clusters_[c].coneAxis), -1.0f, 1.0f));
+            angle = std::max(angle, toChild + std::acos(std::clamp(clusters_[c].coneCos, -1.0f, 1.0f)));
+        }
+        setConeAngle(group, angle);
+    }
+    groups_[g] = group;
+}
+
+// ── запросы ─────────────────────────────────────────────────────────────────
+// Для нормали n из конуса (ось a, полуугол θ) и точки p из сферы (c, r) при
+// v = c - eye, d = |v|, φ = угол(a, v):
+//   dot(n, p - eye) >= d*cos(φ + θ) - r   -> все грани отвёрнуты, если это > 0
+//   dot(n, p - eye) <= d*cos(max(φ - θ, 0)) + r -> все грани к камере, если < 0
+TerrainClusters::Visibility TerrainClusters::classify(const TerrainCluster& bounds, const QVector3D& eye, float eps) {
+    if (bounds.coneCos <= -1.0f) return Visibility::Partial;
+    const QVector3D v = bounds.center - eye;
+    const float d = v.length();
+    if (d <= bounds.radius) return Visibility::Partial;
+
+    const float cosPhi = QVector3D::dotProduct(bounds.coneAxis, v) / d;
+    const float sinPhi = QVector3D::crossProduct(bounds.coneAxis, v).length() / d;
+    const float rd = bounds.radius / d;
+
+    // φ + θ > π: в конусе есть нормаль, смотрящая прямо на камеру
+    const float minDot = bounds.coneCos < -cosPhi ? -1.0f : cosPhi * bounds.coneCos - sinPhi * bounds.coneSin;
+    if (minDot - rd > -eps) return Visibility::Culled;
+    const float maxDot = cosPhi > bounds.coneCos ? 1.0f : cosPhi * bounds.coneCos + sinPhi * bounds.coneSin;
+    if (maxDot + rd < std::min(-eps, 0.0f)) return Visibility::Visible;
+    return Visibility::Partial;
+}
+
+template <class Emit>
+void TerrainClusters::forEachVisible(const QVector3D& eye, float eps, Emit&& emit) const {
+    for (size_t g = 0; g < groups_.size(); ++g) {
+        const Visibility groupVisibility = classify(groups_[g], eye, eps);
+        if (groupVisibility == Visibility::Culled) continue;
+        if (groupVisibility == Visibility::Visible) {
+            emit(groups_[g]);
+            continue;
+        }
+        const size_t end = std::min(clusters_.size(), (g + 1) * kGroupSize);
+        for (size_t c = g * kGroupSize; c < end; ++c) {
+            if (classify(clusters_[c], eye, eps) != Visibility::Culled) emit(clusters_[c]);
+        }
+    }
+}
+
+size_t TerrainClusters::gatherVisibleRanges(const QVector3D& eye, float eps,
+    std::vector<TerrainDrawRange>& ranges, uint32_t mergeGap) const
+{
+    const size_t before = ranges.size();
+    size_t indexCount = 0;
+    // Кластеры приходят по возрастанию firstIndex: соседние (и через короткий разрыв) склеиваются
+    forEachVisible(eye, eps, [&](const TerrainCluster& range) {
+        if (ranges.size() > before) {
+            TerrainDrawRange& last = ranges.back();
+            const uint32_t lastEnd = last.firstIndex + last.indexCount;
+            if (range.firstIndex - lastEnd <= mergeGap) {
+                indexCount += range.firstIndex + range.indexCount - lastEnd;
+                last.indexCount = range.firstIndex + range.indexCount - last.firstIndex;
+                return;
+            }
+        }
+        ranges.push_back({ range.firstIndex, range.indexCount });
+        indexCount += range.indexCount;
+    });
+    return indexCount / 3;
+}
+
+size_t TerrainClusters::gatherVisible(const QVector3D& eye, float eps,
+    std::vector<uint32_t>& indices, std::vector<int>* owners) const
+{
+    const size_t before = indices.size();
+    const bool withOwners = owners && !owners_.empty();
+
+    // Соседние видимые кластеры лежат подряд в indices_ - копируем их одним куском
+    uint32_t runFirst = 0;
+    uint32_t runEnd = 0;
+    auto flush = [&]() {
+        if (runEnd == runFirst) return;
+        indices.insert(indices.end(), indices_.begin() + runFirst, indices_.begin() + runEnd);
+        if (withOwners) owners->insert(owners->end(), owners_.begin() + runFirst / 3, owners_.begin() + runEnd / 3);
+    };
+    forEachVisible(eye, eps, [&](const TerrainCluster& range) {
+        if (range.firstIndex != runEnd) {
+            flush();
+            runFirst = range.firstIndex;
+        }
+        runEnd = range.firstIndex + range.indexCount;
+    });
+    flush();
+    return (indices.size() - before) / 3;
+}
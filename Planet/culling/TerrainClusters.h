@@ -0,0 +1,101 @@
+#pragma once
+
+#include <QVector3D>
+
+#include <cstdint>
+#include <vector>
+
+struct TerrainMesh;
+struct TerrainMeshByteRange;
+
+// Bounds of a run of triangles in TerrainClusters::indices(): a sphere around
+// the vertices and a cone around the face normals (coneCos = cos of the
+// half-angle; -1 when the normals do not fit a cone).
+struct TerrainCluster {
+    QVector3D center;
+    float radius = 0.0f;
+    QVector3D coneAxis;
+    float coneCos = -1.0f;
+    float coneSin = 0.0f;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+};
+
+// Contiguous run of TerrainClusters::indices(), in indices (not bytes)
+struct TerrainDrawRange {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+};
+
+// Terrain split into fixed-size spatial clusters for backface culling on the
+// CPU. Triangles are bucketed by normal direction (cube-map cells), sorted
+// along a Morton curve of their centroids inside a bucket and cut into
+// clusters of clusterTriangles; every kGroupSize consecutive clusters form a
+// group with merged bounds. A visibility query tests the groups, then
+// the clusters of partially visible groups, and copies the index ranges of
+// the survivors - the cost follows the cluster count, not the triangle count.
+// The result is conservative: every triangle facing the eye is kept.
+//
+// After an in-place edit of the mesh (TerrainTessellator::retessellateCells)
+// refit() keeps the cluster order: rewritten triangles are copied to their
+// positions and only the clusters and groups holding them get new bounds.
+// Triangles that died stay in their clusters as degenerate entries.
+class TerrainClusters {
+public:
+    static constexpr uint32_t kDefaultClusterTriangles = 64;
+    static constexpr uint32_t kGroupSize = 16;
+    static constexpr uint32_t kNoPosition = 0xFFFFFFFFu;
+
+    void build(const TerrainMesh& mesh, uint32_t clusterTriangles = kDefaultClusterTriangles);
+    void clear();
+    // slotIndexBytes: TerrainMeshPatch::slotIndexBytes of the edit. Appends the
+    // rewritten ranges of indices() to changed. Returns false, leaving the
+    // clusters untouched, when a live triangle has no position in the current
+    // order (a slot moved to the tail of the mesh) - build() again then.
+    bool refit(const TerrainMesh& mesh, const std::vector<TerrainMeshByteRange>& slotIndexBytes,
+        std::vector<TerrainDrawRange>& changed);
+
+    bool empty() const { return clusters_.empty(); }
+    size_t clusterCount() const { return clusters_.size(); }
+    size_t groupCount() const { return groups_.size(); }
+    // Triangles of the source mesh, degenerate ones included
+    size_t sourceTriangleCount() const { return sourceTriangles_; }
+
+    // Live triangles of the source mesh in cluster order; owners follow
+    // TerrainMesh::triOwner (empty when the mesh has none)
+    const std::vector<uint32_t>& indices() const { return indices_; }
+    const std::vector<int>& owners() const { return owners_; }
+    const std::vector<TerrainCluster>& clusters() const { return clusters_; }
+    const std::vector<TerrainCluster>& groups() const { return groups_; }
+
+    // Appends the indices (and owners) of the clusters that may face the eye;
+    // returns the number of triangles appended. eps > 0 also drops clusters
+    // seen at grazing angles: a cluster is culled when every face has
+    // dot(normal, dirFromEye) > -eps.
+    size_t gatherVisible(const QVector3D& eye, float eps,
+        std::vector<uint32_t>& indices, std::vector<int>* owners = nullptr) const;
+
+    // Same test, but the result is a list of ranges into indices() for a
+    // multi-draw over an index buffer that holds indices() as is. Ranges
+    // separated by at most mergeGap indices are joined, trading a few culled
+    // triangles for fewer draws. Returns the number of triangles covered.
+    size_t gatherVisibleRanges(const QVector3D& eye, float eps,
+        std::vector<TerrainDrawRange>& ranges, uint32_t mergeGap = 0) const;
+
+private:
+    enum class Visibility { Culled, Partial, Visible };
+    static Visibility classify(const TerrainCluster& bounds, const QVector3D& eye, float eps);
+    void fitCluster(size_t c, const TerrainMesh& mesh);
+    void fitGroup(size_t g);
+    // Surviving groups and clusters, in increasing firstIndex order
+    template <class Emit>
+    void forEachVisible(const QVector3D& eye, float eps, Emit&& emit) const;
+
+    std::vector<uint32_t> indices_;
+    std::vector<int> owners_;
+    std::vector<TerrainCluster> clusters_;
+    std::vector<TerrainCluster> groups_;
+    std::vector<uint32_t> positions_; // source triangle -> triangle of indices(), kNoPosition if dropped
+    uint32_t clusterTriangles_ = kDefaultClusterTriangles;
+    size_t sourceTriangles_ = 0;
+};
@@ -6,6 +6,7 @@
 #include <memory>
 #include <unordered_map>
 
+#include "culling/TerrainClusters.h"
 #include "renderers/TerrainTessellator.h" 
 
 struct CulledMesh {
@@ -18,7 +19,7 @@ struct CulledMesh {
 
 class TerrainCulling {
 public:
-    //        
+    //        
     void setFullMesh(const TerrainMesh& mesh);
 
     //        
@@ -34,23 +35,11 @@ public:
     size_t getTotalTriangleCount() const { return totalTriangles_; }
 
 private:
-    void buildTriangleCenters();
     void filterIndices(const QVector3D& cameraPos, const QVector3D& planetCenter, float eps);
 
-    TerrainMesh fullMesh_;              //  
     TerrainMesh culledMesh_;             //    
-
-    std::vector<QVector3D> triangleCenters_; //   
-    std::vector<int> triangleCellOwners_;     //  
+    TerrainClusters clusters_;           //      
 
     size_t totalTriangles_ = 0;
     size_t visibleTriangles_ = 0;
-
-    //       
-    struct VertexRef {
-        const std::vector<float>& pos;
-        QVector3D operator()(uint32_t idx) const {
-            return QVector3D(pos[idx * 3], pos[idx * 3 + 1], pos[idx * 3 + 2]);
-        }
-    };
 };
\ No newline at end of file
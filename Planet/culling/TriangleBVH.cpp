@@ -0,0 +1,318 @@
+#include "TriangleBVH.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "model/HexSphereModel.h"
+#include "renderers/TerrainTessellator.h"
+
+namespace {
+    constexpr uint32_t kLeafSize = 4;
+    constexpr int kBins = 12;
+    // Глубже SAH не пускаем: дальше только медиана, так что глубина < kStackSize
+    constexpr int kMaxSahDepth = 64;
+    constexpr int kStackSize = 128;
+
+    float axisOf(const QVector3D& v, int axis) {
+        return axis == 0 ? v.x() : (axis == 1 ? v.y() : v.z());
+    }
+}
+
+std::vector<BVHTriangle> TriangleBVH::trianglesOf(const std::vector<PickTri>& tris) {
+    std::vector<BVHTriangle> out;
+    out.reserve(tris.size());
+    for (const auto& pt : tris) out.push_back({ pt.v0, pt.v1, pt.v2 });
+    return out;
+}
+
+std::vector<BVHTriangle> TriangleBVH::trianglesOf(const TerrainMesh& mesh) {
+    const auto& P = mesh.pos;
+    const auto& I = mesh.idx;
+    auto vertex = [&](uint32_t i) { return QVector3D(P[3 * i], P[3 * i + 1], P[3 * i + 2]); };
+
+    std::vector<BVHTriangle> out;
+    out.reserve(I.size() / 3);
+    for (size_t t = 0; t + 2 < I.size(); t += 3)
+        out.push_back({ vertex(I[t]), vertex(I[t + 1]), vertex(I[t + 2]) });
+    return out;
+}
+
+bool TriangleBVH::rayTriangle(const QVector3D& o, const QVector3D& d,
+    const QVector3D& v0, const QVector3D& v1, const QVector3D& v2, float& tOut)
+{
+    const float eps = 1e-6f;
+    const QVector3D e1 = v1 - v0;
+    const QVector3D e2 = v2 - v0;
+    const QVector3D p = QVector3D::crossProduct(d, e2);
+    const float det = QVector3D::dotProduct(e1, p);
+    if (std::fabs(det) < eps) return false;
+
+    const float invDet = 1.0f / det;
+    const QVector3D t = o - v0;
+    const float u = QVector3D::dotProduct(t, p) * invDet;
+    if (u < -eps || u > 1.0f + eps) return false;
+
+    const QVector3D q = QVector3D::crossProduct(t, e1);
+    const float v = QVector3D::dotProduct(d, q) * invDet;
+    if (v < -eps || u + v > 1.0f + eps) return false;
+
+    const float tt = QVector3D::dotProduct(e2, q) * invDet;
+    if (tt <= eps) return false;
+
+    tOut = tt;
+    return true;
+}
+
+// ── построение ──────────────────────────────────────────────────────────────
+void TriangleBVH::clear() {
+    triangles_.clear();
+    order_.clear();
+    nodes_.clear();
+}
+
+void TriangleBVH::build(std::vector<BVHTriangle> triangles) {
+    clear();
+    triangles_ = std::move(triangles);
+    if (triangles_.empty()) return;
+
+    const size_t n = triangles_.size();
+    std::vector<Bounds> triBox(n);
+    std::vector<QVector3D> centers(n);
+    for (size_t i = 0; i < n; ++i) {
+        const BVHTriangle& tri = triangles_[i];
+        for (int a = 0; a < 3; ++a) {
+            const float x = axisOf(tri.v0, a), y = axisOf(tri.v1, a), z = axisOf(tri.v2, a);
+            triBox[i].lo[a] = std::min({ x, y, z });
+            triBox[i].hi[a] = std::max({ x, y, z });
+        }
+        centers[i] = (tri.v0 + tri.v1 + tri.v2) / 3.0f;
+    }
+
+    order_.resize(n);
+    for (size_t i = 0; i < n; ++i) order_[i] = uint32_t(i);
+    nodes_.reserve(2 * n / kLeafSize + 1);
+    buildNode(0, uint32_t(n), 0, triBox, centers);
+}
+
+uint32_t TriangleBVH::buildNode(uint32_t begin, uint32_t end, int depth,
+    std::vector<Bounds>& triBox, std::vector<QVector3D>& centers)
+{
+    const uint32_t index = uint32_t(nodes_.size());
+    nodes_.emplace_back();
+
+    Bounds box;
+    Bounds centerBox;
+    for (int a = 0; a < 3; ++a) {
+        box.lo[a] = centerBox.lo[a] = std::numeric_limits<float>::infinity();
+        box.hi[a] = centerBox.hi[a] = -std::numeric_limits<float>::infinity();
+    }
+    for (uint32_t i = begin; i < end; ++i) {
+        const uint32_t t = order_[i];
+        for (int a = 0; a < 3; ++a) {
+            box.lo[a] = std::min(box.lo[a], triBox[t].lo[a]);
+            box.hi[a] = std::max(box.hi[a], triBox[t].hi[a]);
+            const float c = axisOf(centers[t], a);
+            centerBox.lo[a] = std::min(centerBox.lo[a], c);
+            centerBox.hi[a] = std::max(centerBox.hi[a], c);
+        }
+    }
+    nodes_[index].box = box;
+
+    const uint32_t count = end - begin;
+    auto makeLeaf = [&]() {
+        nodes_[index].first = begin;
+        nodes_[index].count = count;
+        return index;
+    };
+    if (count <= kLeafSize) return makeLeaf();
+
+    // Бинированный SAH по оси с наибольшим разбросом центров
+    int axis = 0;
+    for (int a = 1; a < 3; ++a)
+        if (centerBox.hi[a] - centerBox.lo[a] > centerBox.hi[axis] - centerBox.lo[axis]) axis = a;
+    const float extent = centerBox.hi[axis] - centerBox.lo[axis];
+    if (extent <= 0.0f) return makeLeaf();
+
+    struct Bin {
+        Bounds box;
+        uint32_t count = 0;
+    };
+    auto area = [](const Bounds& b) {
+        const float dx = b.hi[0] - b.lo[0], dy = b.hi[1] - b.lo[1], dz = b.hi[2] - b.lo[2];
+        return dx * dy + dy * dz + dz * dx;
+    };
+    auto grow = [](Bounds& dst, const Bounds& src, bool first) {
+        for (int a = 0; a < 3; ++a) {
+            dst.lo[a] = first ? src.lo[a] : std::min(dst.lo[a], src.lo[a]);
+            dst.hi[a] = first ? src.hi[a] : std::max(dst.hi[a], src.hi[a]);
+        }
+    };
+    auto binOf = [&](uint32_t t) {
+        const int b = int(float(kBins) * (axisOf(centers[t], axis) - centerBox.lo[axis]) / extent);
+        return std::clamp(b, 0, kBins - 1);
+    };
+
+    Bin bins[kBins];
+    for (uint32_t i = begin; i < end; ++i) {
+        const uint32_t t = order_[i];
+        Bin& bin = bins[binOf(t)];
+        grow(bin.box, triBox[t], bin.count == 0);
+        ++bin.count;
+    }
+
+    // Стоимость разреза после бина s: площадь * число слева + справа
+    float leftCost[kBins - 1];
+    Bounds acc;
+    uint32_t accCount = 0;
+    for (int s = 0; s < kBins - 1; ++s) {
+        if (bins[s].count) { grow(acc, bins[s].box, accCount == 0); accCount += bins[s].count; }
+        leftCost[s] = accCount ? area(acc) * float(accCount) : 0.0f;
+    }
+    int bestSplit = -1;
+    float bestCost = depth < kMaxSahDepth ? area(box) * float(count) : -1.0f;
+    acc = Bounds{};
+    accCount = 0;
+    for (int s = kBins - 1; s > 0; --s) {
+        if (bins[s].count) { grow(acc, bins[s].box, accCount == 0); accCount += bins[s].count; }
+        const float cost = leftCost[s - 1] + (accCount ? area(acc) * float(accCount) : 0.0f);
+        if (accCount > 0 && accCount < count && cost < bestCost) {
+            bestCost = cost;
+            bestSplit = s - 1;
+        }
+    }
+
+    uint32_t mid;
+    if (bestSplit >= 0) {
+        mid = uint32_t(std::partition(order_.begin() + begin, order_.begin() + end,
+            [&](uint32_t t) { return binOf(t) <= bestSplit; }) - order_.begin());
+    }
+    else {
+        // SAH не нашёл выгодного разреза, но лист слишком большой - делим по медиане
+        mid = begin + count / 2;
+        std::nth_element(order_.begin() + begin, order_.begin() + mid, order_.begin() + end,
+            [&](uint32_t a, uint32_t b) { return axisOf(centers[a], axis) < axisOf(centers[b], axis); });
+    }
+    if (mid == begin || mid == end) return makeLeaf();
+
+    buildNode(begin, mid, depth + 1, triBox, centers);
+    const uint32_t right = buildNode(mid, end, depth + 1, triBox, centers);
+    nodes_[index].first = right;
+    nodes_[index].count = 0;
+    return index;
+}
+
+bool TriangleBVH::refit(const std::vector<BVHTriangle>& triangles) {
+    if (triangles.size() != triangles_.size() || nodes_.empty()) return false;
+    triangles_ = triangles;
+
+    // Дети всегда правее родителя, поэтому обратный проход идёт снизу вверх
+    for (size_t i = nodes_.size(); i-- > 0;) {
+        Node& node = nodes_[i];
+        Bounds box;
+        for (int a = 0; a < 3; ++a) {
+            box.lo[a] = std::numeric_limits<float>::infinity();
+            box.hi[a] = -std::numeric_limits<float>::infinity();
+        }
+        auto include = [&](const Bounds& b) {
+            for (int a = 0; a < 3; ++a) {
+                box.lo[a] = std::min(box.lo[a], b.lo[a]);
+                box.hi[a] = std::max(box.hi[a], b.hi[a]);
+            }
+        };
+        if (node.count > 0) {
+            for (uint32_t k = node.first; k < node.first + node.count; ++k) {
+                const BVHTriangle& tri = triangles_[order_[k]];
+                for (const QVector3D* v : { &tri.v0, &tri.v1, &tri.v2 }) {
+                    Bounds p;
+                    for (int a = 0; a < 3; ++a) p.lo[a] = p.hi[a] = axisOf(*v, a);
+                    include(p);
+                }
+            }
+        }
+        else {
+            include(nodes_[i + 1].box);
+            include(nodes_[node.first].box);
+        }
+        node.box = box;
+    }
+    return true;
+}
+
+// ── запросы ─────────────────────────────────────────────────────────────────
+bool TriangleBVH::slab(const Bounds& box, const QVector3D& origin, const float invDir[3],
+    float tMax, float& tNear) const
+{
+    float t0 = 0.0f, t1 = tMax;
+    for (int a = 0; a < 3; ++a) {
+        const float o = axisOf(origin, a);
+        float lo = (box.lo[a] - o) * invDir[a];
+        float hi = (box.hi[a] - o) * invDir[a];
+        if (lo > hi) std::swap(lo, hi);
+        // NaN (0 * inf для луча в плоскости грани) не сужает интервал
+        t0 = lo > t0 ? lo : t0;
+        t1 = hi < t1 ? hi : t1;
+        if (t0 > t1) return false;
+    }
+    tNear = t0;
+    return true;
+}
+
+template <bool AnyHit>
+bool TriangleBVH::traverse(const QVector3D& origin, const QVector3D& dir, float tMax, BVHRayHit& hit) const {
+    if (nodes_.empty()) return false;
+
+    const float invDir[3] = { 1.0f / dir.x(), 1.0f / dir.y(), 1.0f / dir.z() };
+    float best = tMax;
+    bool found = false;
+
+    uint32_t stack[kStackSize];
+    int top = 0;
+    float tNear;
+    if (!slab(nodes_[0].box, origin, invDir, best, tNear)) return false;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Node& node = nodes_[stack[--top]];
+        if (node.count > 0) {
+            for (uint32_t k = node.first; k < node.first + node.count; ++k) {
+                const uint32_t id = order_[k];
+                const BVHTriangle& tri = triangles_[id];
+                float t;
+                if (rayTriangle(origin, dir, tri.v0, tri.v1, tri.v2, t) && t < best) {
+                    best = t;
+                    hit.triangle = int(id);
+                    hit.t = t;
+                    found = true;
+                    if constexpr (AnyHit) return true;
+                }
+            }
+            continue;
+        }
+
+        // Ближний ребёнок кладётся последним, чтобы обойти его первым
+        const uint32_t left = uint32_t(&node - nodes_.data()) + 1;
+        const uint32_t right = node.first;
+        float tLeft, tRight;
+        const bool hitLeft = slab(nodes_[left].box, origin, invDir, best, tLeft);
+        const bool hitRight = slab(nodes_[right].box, origin, invDir, best, tRight);
+        if (hitLeft && hitRight) {
+            const bool leftFirst = tLeft <= tRight;
+            stack[top++] = leftFirst ? right : left;
+            stack[top++] = leftFirst ? left : right;
+        }
+        else if (hitLeft) stack[top++] = left;
+        else if (hitRight) stack[top++] = right;
+    }
+    return found;
+}
+
+std::optional<BVHRayHit> TriangleBVH::intersectFirst(const QVector3D& origin, const QVector3D& dir, float tMax) const {
+    BVHRayHit hit;
+    if (traverse<false>(origin, dir, tMax, hit)) return hit;
+    return std::nullopt;
+}
+
+bool TriangleBVH::intersectAny(const QVector3D& origin, const QVector3D& dir, float tMax) const {
+    BVHRayHit hit;
+    return traverse<true>(origin, dir, tMax, hit);
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QVector3D>
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+struct PickTri;
+struct TerrainMesh;
+
+struct BVHTriangle {
+    QVector3D v0, v1, v2;
+};
+
+struct BVHRayHit {
+    int triangle = -1; // index in the source triangle list
+    float t = 0.0f;
+};
+
+// Binned-SAH bounding volume hierarchy over a static triangle list for ray
+// picking. Triangle ids stay those of the source list, so callers map hits
+// back to PickTri::cellId or TerrainMesh::triOwner directly.
+class TriangleBVH {
+public:
+    static std::vector<BVHTriangle> trianglesOf(const std::vector<PickTri>& tris);
+    static std::vector<BVHTriangle> trianglesOf(const TerrainMesh& mesh);
+
+    void build(std::vector<BVHTriangle> triangles);
+    // Same triangle count, moved vertices: recompute bounds, keep the tree.
+    // Returns false (tree untouched) when the count differs - rebuild instead.
+    bool refit(const std::vector<BVHTriangle>& triangles);
+    void clear();
+
+    bool empty() const { return nodes_.empty(); }
+    size_t triangleCount() const { return triangles_.size(); }
+    size_t nodeCount() const { return nodes_.size(); }
+
+    // Closest hit with t in (0, tMax)
+    std::optional<BVHRayHit> intersectFirst(const QVector3D& origin, const QVector3D& dir,
+        float tMax = std::numeric_limits<float>::infinity()) const;
+    // Any hit with t in (0, tMax); stops at the first one found
+    bool intersectAny(const QVector3D& origin, const QVector3D& dir,
+        float tMax = std::numeric_limits<float>::infinity()) const;
+
+    // Same test the brute-force pickers used
+    static bool rayTriangle(const QVector3D& o, const QVector3D& d,
+        const QVector3D& v0, const QVector3D& v1, const QVector3D& v2, float& tOut);
+
+private:
+    struct Bounds {
+        float lo[3] = { 0.0f, 0.0f, 0.0f };
+        float hi[3] = { 0.0f, 0.0f, 0.0f };
+    };
+    struct Node {
+        Bounds box;
+        uint32_t first = 0; // leaf: first entry in order_; inner: right child
+        uint32_t count = 0; // 0 => inner node, left child is this + 1
+    };
+
+    uint32_t buildNode(uint32_t begin, uint32_t end, int depth,
+        std::vector<Bounds>& triBox, std::vector<QVector3D>& centers);
+    bool slab(const Bounds& box, const QVector3D& origin, const float invDir[3], float tMax, float& tNear) const;
+    template <bool AnyHit>
+    bool traverse(const QVector3D& origin, const QVector3D& dir, float tMax, BVHRayHit& hit) const;
+
+    std::vector<BVHTriangle> triangles_;
+    std::vector<uint32_t> order_; // leaf entries -> triangle ids
+    std::vector<Node> nodes_;
+};
@@ -5,14 +5,27 @@
 #include <QTextStream>
 
 #include <algorithm>
+#include <charconv>
+#include <cstdint>
 #include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+#include "DagPathBackend.h"
 #include "DagSceneBackend.h"
 #include "DagTerrainBackend.h"
 #include "LegacyTerrainBackend.h"
+#include "SnapshotModelRegistry.h"
 #include "TerrainBackendContract.h"
+#include "TerrainSerialization.h"
 #include "controllers/HexSphereSceneController.h"
+#include "controllers/PathBuilder.h"
+#include "generation/TerrainGenerator.h"
+#include "model/HexSphereModel.h"
+
+#include <proc/ProcessDag.h>
 
 namespace {
 
@@ -193,6 +206,615 @@ void appendTerrainRows(
     }
 }
 
+DagBenchmarkRow makeSteadyStateRow(
+    const TerrainScenario& scenario,
+    const QString& operation,
+    int iteration,
+    double elapsedMs,
+    const DagTerrainBackend& backend) {
+    DagBenchmarkRow row;
+    row.category = "terrain-steady-state";
+    row.scenario = scenario.name;
+    row.operation = operation;
+    row.backend = "DAG terrain";
+    row.iteration = iteration;
+    row.elapsedMs = elapsedMs;
+    row.cellCount = backend.currentTerrainSnapshot()
+        ? static_cast<int>(backend.currentTerrainSnapshot()->cells.size())
+        : 0;
+    row.compatible = backend.currentTerrainSnapshot() != nullptr;
+    return row;
+}
+
+// Cold: a fresh backend (engine, schema, planner) per regeneration.
+// Tweak: one long-lived backend where only the seed changes between runs.
+// Unchanged: the same backend regenerated again with identical inputs.
+void appendSteadyStateRows(
+    DagBenchmarkReport& report,
+    const TerrainScenario& scenario,
+    int iterations) {
+    BenchmarkTerrainBridge bridge;
+
+    for (int i = 0; i < iterations; ++i) {
+        TerrainScenario tweaked = scenario;
+        tweaked.params.seed += static_cast<uint32_t>(i + 1);
+
+        QElapsedTimer coldTimer;
+        coldTimer.start();
+        DagTerrainBackend coldBackend;
+        coldBackend.attachTerrainBridge(&bridge);
+        runTerrainOnce(coldBackend, tweaked);
+        const double coldMs = static_cast<double>(coldTimer.nsecsElapsed()) / 1000000.0;
+        report.rows.push_back(makeSteadyStateRow(scenario, "cold_regenerate", i, coldMs, coldBackend));
+    }
+
+    DagTerrainBackend warmBackend;
+    warmBackend.attachTerrainBridge(&bridge);
+    runTerrainOnce(warmBackend, scenario);
+
+    for (int i = 0; i < iterations; ++i) {
+        TerrainScenario tweaked = scenario;
+        tweaked.params.seed += static_cast<uint32_t>(i + 1);
+
+        const double tweakMs = runTerrainOnce(warmBackend, tweaked);
+        report.rows.push_back(makeSteadyStateRow(scenario, "param_tweak", i, tweakMs, warmBackend));
+
+        const double unchangedMs = runTerrainOnce(warmBackend, tweaked);
+        report.rows.push_back(makeSteadyStateRow(scenario, "unchanged_regenerate", i, unchangedMs, warmBackend));
+
+        const bool ok = warmBackend.currentTerrainSnapshot() != nullptr;
+        report.ok = report.ok && ok;
+    }
+}
+
+// Path queries on one terrain: model and graph rebuilt for every query (the
+// old DagPathBackend) vs DagPathBackend on the shared SnapshotModelRegistry.
+void appendModelRegistryRows(DagBenchmarkReport& report, int iterations) {
+    constexpr int kQueriesPerBatch = 20;
+
+    for (int level : { 4, 5 }) {
+        BenchmarkTerrainBridge bridge;
+        bridge.stageGeneratorByIndex(3);
+        bridge.stageTerrainParams(TerrainParams{ 12345u, 3, 3.0f });
+        bridge.stageSubdivisionLevel(level);
+        bridge.rebuildTerrainFromInputs();
+        const TerrainSnapshot snapshot = bridge.captureTerrainSnapshot();
+        const std::string encoded = encodeTerrainSnapshot(snapshot);
+        const QString scenario = QString("model registry L%1").arg(level);
+        const int cellCount = static_cast<int>(snapshot.cells.size());
+
+        DagPathBackend pathBackend;
+        pathBackend.setSmoothMaxDelta(PathBuilder::kMaxClimbDelta);
+        pathBackend.setTerrainSnapshot(snapshot);
+
+        std::mt19937 rng(0x7e57u + static_cast<uint32_t>(level));
+        std::uniform_int_distribution<int> pickCell(0, cellCount - 1);
+        for (int i = 0; i < iterations; ++i) {
+            std::vector<std::pair<int, int>> queries(kQueriesPerBatch);
+            for (auto& query : queries) {
+                query = { pickCell(rng), pickCell(rng) };
+            }
+
+            std::vector<std::vector<int>> rebuiltPaths;
+            QElapsedTimer timer;
+            timer.start();
+            for (const auto& [start, goal] : queries) {
+                const auto view = TerrainSnapshotView::fromBytes(encoded);
+                const HexSphereModel model = buildModelFromSnapshot(*view);
+                PathBuilder builder(model, PathBuilder::kMaxClimbDelta);
+                builder.build();
+                rebuiltPaths.push_back(builder.astar(start, goal));
+            }
+            const double rebuildMs = static_cast<double>(timer.nsecsElapsed()) / 1000000.0;
+
+            const SnapshotModelStats before = SnapshotModelRegistry::shared().stats();
+            bool compatible = true;
+            timer.restart();
+            for (size_t q = 0; q < queries.size(); ++q) {
+                const PathResult result = pathBackend.findPath(queries[q].first, queries[q].second);
+                compatible = compatible && result.cellIds == rebuiltPaths[q];
+            }
+            const double sharedMs = static_cast<double>(timer.nsecsElapsed()) / 1000000.0;
+            const SnapshotModelStats after = SnapshotModelRegistry::shared().stats();
+
+            for (const bool shared : { false, true }) {
+                DagBenchmarkRow row;
+                row.category = "model-registry";
+                row.scenario = scenario;
+                row.operation = QString("find_path x%1").arg(kQueriesPerBatch);
+                row.backend = shared ? "Shared snapshot model" : "Rebuild per query";
+                row.iteration = i;
+                row.elapsedMs = shared ? sharedMs : rebuildMs;
+                row.cellCount = cellCount;
+                row.compatible = shared ? compatible : true;
+                if (shared) {
+                    row.cacheHits = static_cast<int>(after.graphReuses - before.graphReuses);
+                    row.cacheMisses = static_cast<int>(after.graphBuilds - before.graphBuilds);
+                }
+                else {
+                    row.cacheMisses = kQueriesPerBatch;
+                }
+                report.rows.push_back(row);
+            }
+            report.ok = report.ok && compatible;
+        }
+    }
+}
+
+// Read/write throughput of DAG field storage: name-keyed layers with every
+// value formatted to and parsed from a string (the old path, kept as the
+// compatibility layer) vs slot-indexed dense layers with typed scalars.
+void appendDagStorageRows(DagBenchmarkReport& report, int iterations) {
+    using NamedState = proc::LayeredState<2>;
+    using SlotState = proc::LayeredState<2, proc::DefaultMemoryPolicy, proc::DenseBaseStore, proc::DenseOverlayStore>;
+    constexpr int kRounds = 2000;
+
+    auto elapsedSince = [](const QElapsedTimer& timer) {
+        return static_cast<double>(timer.nsecsElapsed()) / 1000000.0;
+    };
+
+    for (int fieldCount : { 8, 64 }) {
+        std::vector<proc::Field> names;
+        for (int f = 0; f < fieldCount; ++f) {
+            names.push_back("param" + std::to_string(f));
+        }
+        const QString scenario = QString("dag storage %1 fields").arg(fieldCount);
+
+        for (int i = 0; i < iterations; ++i) {
+            NamedState named;
+            SlotState slots;
+
+            // Запись: каждый раунд меняет все поля и продвигает D -> V
+            QElapsedTimer timer;
+            timer.start();
+            for (int round = 0; round < kRounds; ++round) {
+                for (int f = 0; f < fieldCount; ++f) {
+                    named.set_D(names[f], proc::make_value(std::to_string(round * fieldCount + f)));
+                }
+                named.promote_D_to_V_apply();
+            }
+            const double namedWriteMs = elapsedSince(timer);
+            timer.restart();
+            for (int round = 0; round < kRounds; ++round) {
+                for (int f = 0; f < fieldCount; ++f) {
+                    slots.set_D(static_cast<proc::v2::FieldSlot>(f), proc::make_scalar(round * fieldCount + f));
+                }
+                slots.promote_D_to_V_apply();
+            }
+            const double slotWriteMs = elapsedSince(timer);
+
+            // Чтение: поиск поля и получение int
+            timer.restart();
+            int64_t namedSum = 0;
+            for (int round = 0; round < kRounds; ++round) {
+                for (int f = 0; f < fieldCount; ++f) {
+                    const auto bytes = proc::Commit::debug_view(named.get(names[f]));
+                    int value = 0;
+                    std::from_chars(bytes.data(), bytes.data() + bytes.size(), value);
+                    namedSum += value;
+                }
+            }
+            const double namedReadMs = elapsedSince(timer);
+            timer.restart();
+            int64_t slotSum = 0;
+            for (int round = 0; round < kRounds; ++round) {
+                for (int f = 0; f < fieldCount; ++f) {
+                    slotSum += proc::value_as<int>(slots.get(static_cast<proc::v2::FieldSlot>(f))).value_or(0);
+                }
+            }
+            const double slotReadMs = elapsedSince(timer);
+
+            const bool compatible = namedSum == slotSum &&
+                *proc::value_as<int>(named.get(names.back())) == (kRounds - 1) * fieldCount + fieldCount - 1;
+            auto addRows = [&](const QString& operation, double namedMs, double slotMs) {
+                for (const bool typed : { false, true }) {
+                    DagBenchmarkRow row;
+                    row.category = "dag-storage";
+                    row.scenario = scenario;
+                    row.operation = operation;
+                    row.backend = typed ? "Typed slots" : "String fields";
+                    row.iteration = i;
+                    row.elapsedMs = typed ? slotMs : namedMs;
+                    row.modelCount = fieldCount;
+                    row.compatible = typed ? compatible : true;
+                    report.rows.push_back(row);
+                }
+            };
+            addRows(QString("write x%1").arg(kRounds), namedWriteMs, slotWriteMs);
+            addRows(QString("read x%1").arg(kRounds), namedReadMs, slotReadMs);
+            report.ok = report.ok && compatible;
+        }
+    }
+}
+
+// Веер независимых узлов: seed -> branch0..N-1 -> Join. Узлы веток - один уровень волны.
+proc::DefaultDagEngine buildFanOutEngine(int branchCount, int workRounds) {
+    proc::GraphSchema::StorageLayout roles;
+    roles.inputs.insert("seed");
+    roles.outputs.insert("total");
+
+    std::vector<proc::GraphSchemaBuilder::FieldDef> fields = { {"seed", "scalar"}, {"total", "scalar"} };
+    std::vector<proc::GraphSchemaBuilder::NodeDef> nodes;
+    std::vector<proc::Field> branchOutputs;
+    for (int b = 0; b < branchCount; ++b) {
+        const proc::Field output = "branch" + std::to_string(b);
+        fields.push_back({ output, "scalar" });
+        nodes.push_back({ "Branch" + std::to_string(b), "fanout_branch", { "seed" }, { output }, std::nullopt });
+        branchOutputs.push_back(output);
+    }
+    nodes.push_back({ "Join", "fanout_join", branchOutputs, { "total" }, std::nullopt });
+
+    proc::OperationRegistry operations = proc::make_builtin_operation_registry();
+    operations.register_op("fanout_branch", proc::v2::OpId{ 400 });
+    operations.register_op("fanout_join", proc::v2::OpId{ 401 });
+    proc::GraphSchema schema = proc::GraphSchemaBuilder::compile(
+        roles, fields, nodes, operations, proc::make_builtin_algebra_registry());
+
+    proc::RuntimeOperationRegistry runtime(proc::make_builtin_operation_registry());
+    runtime.register_op("fanout_branch", proc::v2::OpId{ 400 });
+    runtime.register_op("fanout_join", proc::v2::OpId{ 401 });
+    const proc::v2::FieldSlot seedSlot = *schema.find_field("seed");
+    std::vector<proc::v2::FieldSlot> branchSlots;
+    for (int b = 0; b < branchCount; ++b) {
+        const auto node = *schema.find_node("Branch" + std::to_string(b));
+        const auto output = *schema.find_field(branchOutputs[static_cast<size_t>(b)]);
+        branchSlots.push_back(output);
+        runtime.bind_executor(
+            schema.op_of(node),
+            node,
+            [seedSlot, output, salt = static_cast<uint64_t>(b), workRounds](
+                const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
+                const proc::RuntimeOperationRegistry::FieldNameFn&,
+                const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
+                uint64_t state = proc::value_as<uint64_t>(readHandle(seedSlot)).value_or(0) ^ (salt * 0x9e3779b97f4a7c15ull);
+                for (int round = 0; round < workRounds; ++round) {
+                    state += 0x9e3779b97f4a7c15ull;
+                    uint64_t z = state;
+                    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+                    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+                    state ^= z ^ (z >> 31);
+                }
+                proc::Commit commit;
+                commit.set_scalar(output, state);
+                return commit;
+            });
+    }
+
+    const auto joinNode = *schema.find_node("Join");
+    runtime.bind_executor(
+        schema.op_of(joinNode),
+        joinNode,
+        [branchSlots, totalSlot = *schema.find_field("total")](
+            const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
+            const proc::RuntimeOperationRegistry::FieldNameFn&,
+            const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
+            uint64_t total = 0;
+            for (const proc::v2::FieldSlot slot : branchSlots) {
+                total += proc::value_as<uint64_t>(readHandle(slot)).value_or(0);
+            }
+            proc::Commit commit;
+            commit.set_scalar(totalSlot, total);
+            return commit;
+        });
+
+    proc::DefaultDagEngine engine(std::move(schema), std::move(runtime), proc::make_builtin_guard_registry());
+    proc::ValueStore init;
+    init["seed"] = proc::make_scalar(uint64_t(0));
+    engine.init(init);
+    return engine;
+}
+
+void appendDagWavefrontRows(DagBenchmarkReport& report, int iterations) {
+    constexpr int kFlushes = 20;
+    constexpr int kWorkRounds = 20000;
+    const std::vector<proc::Field> outputs = { "total" };
+
+    for (int branchCount : { 3, 8 }) {
+        proc::DefaultDagEngine serial = buildFanOutEngine(branchCount, kWorkRounds);
+        proc::DefaultDagEngine wavefront = buildFanOutEngine(branchCount, kWorkRounds);
+        serial.set_execution_options(proc::ExecutionOptions{ proc::ExecutionMode::Serial, 0, true });
+        wavefront.set_execution_options(proc::ExecutionOptions{ proc::ExecutionMode::Wavefront, 0, true });
+        const int threadCount = static_cast<int>(proc::WorkerPool::resolve_size(0, static_cast<size_t>(branchCount + 1)));
+        const QString scenario = QString("fan-out %1 branches").arg(branchCount);
+
+        for (int i = 0; i < iterations; ++i) {
+            uint64_t serialChecksum = 0;
+            uint64_t wavefrontChecksum = 0;
+            double serialMs = 0.0;
+            double wavefrontMs = 0.0;
+            double serialNodeMs = 0.0;
+            double wavefrontNodeMs = 0.0;
+            int executedNodes = 0;
+
+            auto flushAll = [&](proc::DefaultDagEngine& engine, uint64_t& checksum, double& elapsedMs, double& nodeMs) {
+                for (int flush = 0; flush < kFlushes; ++flush) {
+                    proc::Commit input;
+                    input.set_handle("seed", proc::make_scalar(uint64_t(i * kFlushes + flush + 1)));
+                    QElapsedTimer timer;
+                    timer.start();
+                    engine.push_input(input);
+                    engine.flush_prepare(outputs);
+                    elapsedMs += static_cast<double>(timer.nsecsElapsed()) / 1000000.0;
+                    checksum += proc::get_value_as<uint64_t>(engine.prepared_output_store(), "total").value_or(0);
+                    engine.ack_outputs();
+
+                    executedNodes = 0;
+                    for (const proc::NodeTiming& timing : engine.last_node_timings()) {
+                        nodeMs += static_cast<double>(timing.execute.count()) / 1000000.0;
+                        executedNodes += timing.skipped_guard ? 0 : 1;
+                    }
+                }
+            };
+            flushAll(serial, serialChecksum, serialMs, serialNodeMs);
+            flushAll(wavefront, wavefrontChecksum, wavefrontMs, wavefrontNodeMs);
+
+            const bool compatible = serialChecksum == wavefrontChecksum && executedNodes == branchCount + 1;
+            auto addRows = [&](const QString& operation, double serialValue, double wavefrontValue) {
+                for (const bool parallel : { false, true }) {
+                    DagBenchmarkRow row;
+                    row.category = "dag-wavefront";
+                    row.scenario = scenario;
+                    row.operation = operation;
+                    row.backend = parallel ? "Wavefront" : "Serial";
+                    row.iteration = i;
+                    row.elapsedMs = parallel ? wavefrontValue : serialValue;
+                    row.executedNodes = executedNodes;
+                    row.threadCount = parallel ? threadCount : 1;
+                    row.compatible = parallel ? compatible : true;
+                    report.rows.push_back(row);
+                }
+            };
+            addRows(QString("flush x%1").arg(kFlushes), serialMs, wavefrontMs);
+            // Сумма времён узлов: работа та же, выигрыш волны только во времени flush
+            addRows(QString("node time x%1").arg(kFlushes), serialNodeMs, wavefrontNodeMs);
+            report.ok = report.ok && compatible;
+        }
+    }
+}
+
+// Суммирует высоты снапшота. По патчу (value_diff_from) пересчитывает только изменённые клетки.
+struct HeightSumState {
+    proc::ValueRef seen;
+    int64_t sum = 0;
+};
+
+proc::DefaultDagEngine buildHeightSumEngine(const std::string& initialSnapshot, const std::shared_ptr<HeightSumState>& state) {
+    proc::GraphSchema::StorageLayout roles;
+    roles.inputs.insert("terrain");
+    roles.outputs.insert("heightSum");
+
+    proc::OperationRegistry operations = proc::make_builtin_operation_registry();
+    operations.register_op("height_sum", proc::v2::OpId{ 402 });
+    proc::AlgebraRegistry algebras = proc::make_builtin_algebra_registry();
+    algebras.register_type("terrainSnapshot", proc::v2::AlgebraId{ 100 });
+    proc::GraphSchema schema = proc::GraphSchemaBuilder::compile(
+        roles,
+        { {"terrain", "terrainSnapshot"}, {"heightSum", "scalar"} },
+        { proc::GraphSchemaBuilder::NodeDef{ "SumHeights", "height_sum", { "terrain" }, { "heightSum" }, std::nullopt } },
+        operations,
+        algebras);
+
+    proc::RuntimeOperationRegistry runtime(proc::make_builtin_operation_registry());
+    runtime.register_op("height_sum", proc::v2::OpId{ 402 });
+    const auto node = *schema.find_node("SumHeights");
+    const proc::v2::FieldSlot terrainSlot = *schema.find_field("terrain");
+    runtime.bind_executor(
+        schema.op_of(node),
+        node,
+        [state, terrainSlot, sumSlot = *schema.find_field("heightSum")](
+            const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
+            const proc::RuntimeOperationRegistry::FieldNameFn&,
+            const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
+            const auto value = readHandle(terrainSlot);
+            const auto next = TerrainSnapshotView::fromBytes(value->bytes());
+            const auto diff = proc::value_diff_from(value, state->seen);
+            const auto ranges = diff ? terrainSnapshotPatchRanges(diff->bytes()) : std::nullopt;
+            const auto previous = state->seen ? TerrainSnapshotView::fromBytes(state->seen->bytes()) : std::nullopt;
+            if (next && ranges && previous) {
+                for (const TerrainCellRange& range : *ranges) {
+                    for (size_t c = range.first; c < size_t(range.first) + range.count; ++c) {
+                        state->sum += next->height(c) - previous->height(c);
+                    }
+                }
+            }
+            else {
+                state->sum = 0;
+                for (size_t c = 0; next && c < next->cellCount(); ++c) {
+                    state->sum += next->height(c);
+                }
+            }
+            state->seen = value;
+
+            proc::Commit commit;
+            commit.set_scalar(sumSlot, state->sum);
+            return commit;
+        });
+
+    proc::DefaultDagEngine engine(std::move(schema), std::move(runtime), proc::make_builtin_guard_registry());
+    proc::ValueStore init;
+    init["terrain"] = proc::make_value(initialSnapshot);
+    engine.init(init);
+    engine.register_apply_diff(
+        proc::v2::AlgebraId{ 100 },
+        [](const proc::ValueRef& current, const proc::ValueRef& diff) {
+            auto next = applyTerrainSnapshotPatch(current->bytes(), diff->bytes());
+            if (!next) {
+                throw std::runtime_error("terrain patch does not match the current snapshot");
+            }
+            return proc::Value(std::move(*next));
+        });
+    engine.set_execution_options(proc::ExecutionOptions{ proc::ExecutionMode::Serial, 0, true });
+    return engine;
+}
+
+void appendDagDeltaRows(DagBenchmarkReport& report, int iterations) {
+    constexpr int kEdits = 20;
+    const std::vector<proc::Field> outputs = { "heightSum" };
+
+    for (int cellCount : { 10242, 40962 }) {
+        TerrainSnapshot snapshot;
+        snapshot.subdivisionLevel = cellCount > 20000 ? 6 : 5;
+        snapshot.params = TerrainParams{ 777u, 0, 3.0f };
+        snapshot.cells.resize(static_cast<size_t>(cellCount));
+        std::mt19937 gen(4242u);
+        std::uniform_int_distribution<int> heightDist(-3, 6);
+        std::uniform_real_distribution<float> unitDist(0.0f, 1.0f);
+        for (TerrainCellSnapshot& cell : snapshot.cells) {
+            cell.height = heightDist(gen);
+            cell.temperature = unitDist(gen);
+            cell.humidity = unitDist(gen);
+        }
+        const std::string initial = encodeTerrainSnapshot(snapshot);
+        const QString scenario = QString("terrain %1 cells, 1-cell edits").arg(cellCount);
+
+        for (int i = 0; i < iterations; ++i) {
+            auto fullState = std::make_shared<HeightSumState>();
+            auto deltaState = std::make_shared<HeightSumState>();
+            proc::DefaultDagEngine fullEngine = buildHeightSumEngine(initial, fullState);
+            proc::DefaultDagEngine deltaEngine = buildHeightSumEngine(initial, deltaState);
+            for (proc::DefaultDagEngine* engine : { &fullEngine, &deltaEngine }) {
+                engine->flush_prepare(outputs);
+                engine->ack_outputs();
+            }
+
+            TerrainSnapshot edited = snapshot;
+            proc::ValueRef deltaInput = deltaEngine.input_snapshot().at("terrain");
+            double fullMs = 0.0;
+            double deltaMs = 0.0;
+            double fullNodeMs = 0.0;
+            double deltaNodeMs = 0.0;
+            size_t patchBytes = 0;
+            int64_t fullSum = 0;
+            int64_t deltaSum = 0;
+            bool allPatched = true;
+
+            auto nodeMs = [](const proc::DefaultDagEngine& engine) {
+                double total = 0.0;
+                for (const proc::NodeTiming& timing : engine.last_node_timings()) {
+                    total += static_cast<double>(timing.execute.count()) / 1000000.0;
+                }
+                return total;
+            };
+
+            for (int edit = 0; edit < kEdits; ++edit) {
+                const size_t cell = static_cast<size_t>((edit * 7919 + i * 31) % cellCount);
+                edited.cells[cell].height += 1;
+
+                // Полная замена: снапшот кодируется и публикуется целиком
+                QElapsedTimer timer;
+                timer.start();
+                proc::Commit full;
+                full.set_handle("terrain", proc::make_value(encodeTerrainSnapshot(edited)));
+                fullEngine.push_input(full);
+                fullEngine.flush_prepare(outputs);
+                fullMs += static_cast<double>(timer.nsecsElapsed()) / 1000000.0;
+                fullSum = proc::get_value_as<int64_t>(fullEngine.prepared_output_store(), "heightSum").value_or(0);
+                fullNodeMs += nodeMs(fullEngine);
+                fullEngine.ack_outputs();
+
+                // Дельта: патч изменённых клеток применяется к текущему значению в хранилище
+                timer.restart();
+                const auto base = TerrainSnapshotView::fromBytes(deltaInput->bytes());
+                auto patch = base ? encodeTerrainSnapshotPatch(*base, edited, edited.cells.size() / 8) : std::nullopt;
+                allPatched = allPatched && patch.has_value();
+                proc::Commit delta;
+                if (patch) {
+                    patchBytes += patch->size();
+                    delta.apply_diff("terrain", proc::make_value(std::move(*patch)));
+                }
+                else {
+                    delta.set_handle("terrain", proc::make_value(encodeTerrainSnapshot(edited)));
+                }
+                deltaEngine.push_input(delta);
+                deltaEngine.flush_prepare(outputs);
+                deltaMs += static_cast<double>(timer.nsecsElapsed()) / 1000000.0;
+                deltaSum = proc::get_value_as<int64_t>(deltaEngine.prepared_output_store(), "heightSum").value_or(0);
+                deltaNodeMs += nodeMs(deltaEngine);
+                deltaEngine.ack_outputs();
+                deltaInput = deltaEngine.input_snapshot().at("terrain");
+            }
+
+            const bool compatible = allPatched && fullSum == deltaSum &&
+                deltaInput->bytes() == encodeTerrainSnapshot(edited) &&
+                patchBytes < initial.size();
+            auto addRows = [&](const QString& operation, double fullValue, double deltaValue) {
+                for (const bool patched : { false, true }) {
+                    DagBenchmarkRow row;
+                    row.category = "dag-delta";
+                    row.scenario = scenario;
+                    row.operation = operation;
+                    row.backend = patched ? "Cell patch" : "Full value";
+                    row.iteration = i;
+                    row.elapsedMs = patched ? deltaValue : fullValue;
+                    row.cellCount = cellCount;
+                    row.executedNodes = 1;
+                    row.compatible = patched ? compatible : true;
+                    report.rows.push_back(row);
+                }
+            };
+            addRows(QString("edit x%1").arg(kEdits), fullMs, deltaMs);
+            // Узел по патчу обходит только изменённые клетки
+            addRows(QString("node time x%1").arg(kEdits), fullNodeMs, deltaNodeMs);
+            report.ok = report.ok && compatible;
+        }
+    }
+}
+
+void appendDagTraceRows(DagBenchmarkReport& report, int iterations) {
+    constexpr int kFlushes = 20;
+    constexpr int kWorkRounds = 2000;
+    constexpr size_t kTraceCapacity = 1u << 14;
+    const std::vector<proc::Field> outputs = { "total" };
+
+    for (int branchCount : { 8, 32 }) {
+        const QString scenario = QString("fan-out %1 branches").arg(branchCount);
+        for (int i = 0; i < iterations; ++i) {
+            proc::DefaultDagEngine plain = buildFanOutEngine(branchCount, kWorkRounds);
+            proc::DefaultDagEngine traced = buildFanOutEngine(branchCount, kWorkRounds);
+            traced.set_tracing(kTraceCapacity);
+
+            auto flushAll = [&](proc::DefaultDagEngine& engine, uint64_t& checksum) {
+                QElapsedTimer timer;
+                timer.start();
+                for (int flush = 0; flush < kFlushes; ++flush) {
+                    proc::Commit input;
+                    input.set_handle("seed", proc::make_scalar(uint64_t(i * kFlushes + flush + 1)));
+                    engine.push_input(input);
+                    engine.flush_prepare(outputs);
+                    checksum += proc::get_value_as<uint64_t>(engine.prepared_output_store(), "total").value_or(0);
+                    engine.ack_outputs();
+                }
+                return static_cast<double>(timer.nsecsElapsed()) / 1000000.0;
+            };
+            uint64_t plainChecksum = 0;
+            uint64_t tracedChecksum = 0;
+            const double plainMs = flushAll(plain, plainChecksum);
+            const double tracedMs = flushAll(traced, tracedChecksum);
+
+            // Каждый flush: flush + plan + на узел execute, commit и чтения его входов
+            const proc::Tracer& tracer = *traced.tracer();
+            const uint64_t eventsPerFlush = 2 + uint64_t(branchCount + 1) * 2 + uint64_t(branchCount) * 2;
+            const bool compatible = plainChecksum == tracedChecksum &&
+                tracer.recorded() == eventsPerFlush * kFlushes &&
+                tracer.dropped() == 0;
+
+            for (const bool tracing : { false, true }) {
+                DagBenchmarkRow row;
+                row.category = "dag-trace";
+                row.scenario = scenario;
+                row.operation = QString("flush x%1").arg(kFlushes);
+                row.backend = tracing ? "Tracing on" : "Tracing off";
+                row.iteration = i;
+                row.elapsedMs = tracing ? tracedMs : plainMs;
+                row.executedNodes = branchCount + 1;
+                row.compatible = tracing ? compatible : true;
+                report.rows.push_back(row);
+            }
+            report.ok = report.ok && compatible;
+        }
+    }
+}
+
 void appendSceneDerivedRows(
     DagBenchmarkReport& report,
     const TerrainScenario& scenario) {
@@ -257,6 +879,8 @@ void appendSceneDerivedRows(
         dagRow.skippedGuardNodes = dagStats.skippedGuardNodes;
         dagRow.cacheHits = dagStats.cacheHits;
         dagRow.cacheMisses = dagStats.cacheMisses;
+        dagRow.cacheEvictions = dagStats.cacheEvictions;
+        dagRow.cacheBytes = dagStats.cacheBytes;
         report.rows.push_back(dagRow);
 
         DagBenchmarkRow legacyRow;
@@ -283,7 +907,7 @@ bool writeCsv(const QString& csvPath, const std::vector<DagBenchmarkRow>& rows)
     }
 
     QTextStream out(&file);
-    out << "category,scenario,operation,backend,iteration,elapsed_ms,cell_count,compatible,selection_count,tree_count,model_count,executed_nodes,skipped_guard_nodes,cache_hits,cache_misses\n";
+    out << "category,scenario,operation,backend,iteration,elapsed_ms,cell_count,compatible,selection_count,tree_count,model_count,executed_nodes,skipped_guard_nodes,cache_hits,cache_misses,cache_evictions,cache_bytes,thread_count\n";
     for (const auto& row : rows) {
         out << '"' << row.category << '"' << ','
             << '"' << row.scenario << '"' << ','
@@ -299,7 +923,10 @@ bool writeCsv(const QString& csvPath, const std::vector<DagBenchmarkRow>& rows)
             << row.executedNodes << ','
             << row.skippedGuardNodes << ','
             << row.cacheHits << ','
-            << row.cacheMisses << '\n';
+            << row.cacheMisses << ','
+            << row.cacheEvictions << ','
+            << static_cast<qulonglong>(row.cacheBytes) << ','
+            << row.threadCount << '\n';
     }
     return true;
 }
@@ -319,8 +946,14 @@ DagBenchmarkReport runDagBackendBenchmark(const QString& csvPath, int iterations
     const int safeIterations = std::max(1, iterations);
     for (const auto& scenario : scenarios) {
         appendTerrainRows(report, scenario, safeIterations);
+        appendSteadyStateRows(report, scenario, safeIterations);
         appendSceneDerivedRows(report, scenario);
     }
+    appendModelRegistryRows(report, safeIterations);
+    appendDagStorageRows(report, safeIterations);
+    appendDagWavefrontRows(report, safeIterations);
+    appendDagDeltaRows(report, safeIterations);
+    appendDagTraceRows(report, safeIterations);
 
     if (!writeCsv(csvPath, report.rows)) {
         report.ok = false;
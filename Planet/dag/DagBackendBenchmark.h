@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <vector>
 
 #include <QString>
@@ -20,6 +21,9 @@ struct DagBenchmarkRow {
     int skippedGuardNodes = 0;
     int cacheHits = 0;
     int cacheMisses = 0;
+    int cacheEvictions = 0;
+    size_t cacheBytes = 0;
+    int threadCount = 0;
 };
 
 struct DagBenchmarkReport {
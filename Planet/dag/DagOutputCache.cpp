@@ -0,0 +1,161 @@
+#include "DagOutputCache.h"
+
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+// MurmurHash3 x64/128: fast, well distributed and stable across runs.
+uint64_t rotl64(uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+uint64_t fmix64(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdull;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ull;
+    value ^= value >> 33;
+    return value;
+}
+
+uint64_t readBlock(const char* data) {
+    uint64_t value = 0;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+constexpr uint64_t kC1 = 0x87c37b91114253d5ull;
+constexpr uint64_t kC2 = 0x4cf5ad432745937full;
+
+} // namespace
+
+ContentHash128 hashContent(std::string_view bytes, uint64_t seed) {
+    const char* data = bytes.data();
+    const size_t length = bytes.size();
+    const size_t blockCount = length / 16;
+
+    uint64_t h1 = seed;
+    uint64_t h2 = seed;
+
+    for (size_t i = 0; i < blockCount; ++i) {
+        uint64_t k1 = readBlock(data + i * 16);
+        uint64_t k2 = readBlock(data + i * 16 + 8);
+
+        k1 *= kC1; k1 = rotl64(k1, 31); k1 *= kC2; h1 ^= k1;
+        h1 = rotl64(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+        k2 *= kC2; k2 = rotl64(k2, 33); k2 *= kC1; h2 ^= k2;
+        h2 = rotl64(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+    }
+
+    const auto* tail = reinterpret_cast<const unsigned char*>(data + blockCount * 16);
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    switch (length & 15) {
+    case 15: k2 ^= static_cast<uint64_t>(tail[14]) << 48; [[fallthrough]];
+    case 14: k2 ^= static_cast<uint64_t>(tail[13]) << 40; [[fallthrough]];
+    case 13: k2 ^= static_cast<uint64_t>(tail[12]) << 32; [[fallthrough]];
+    case 12: k2 ^= static_cast<uint64_t>(tail[11]) << 24; [[fallthrough]];
+    case 11: k2 ^= static_cast<uint64_t>(tail[10]) << 16; [[fallthrough]];
+    case 10: k2 ^= static_cast<uint64_t>(tail[9]) << 8; [[fallthrough]];
+    case 9:
+        k2 ^= static_cast<uint64_t>(tail[8]);
+        k2 *= kC2; k2 = rotl64(k2, 33); k2 *= kC1; h2 ^= k2;
+        [[fallthrough]];
+    case 8: k1 ^= static_cast<uint64_t>(tail[7]) << 56; [[fallthrough]];
+    case 7: k1 ^= static_cast<uint64_t>(tail[6]) << 48; [[fallthrough]];
+    case 6: k1 ^= static_cast<uint64_t>(tail[5]) << 40; [[fallthrough]];
+    case 5: k1 ^= static_cast<uint64_t>(tail[4]) << 32; [[fallthrough]];
+    case 4: k1 ^= static_cast<uint64_t>(tail[3]) << 24; [[fallthrough]];
+    case 3: k1 ^= static_cast<uint64_t>(tail[2]) << 16; [[fallthrough]];
+    case 2: k1 ^= static_cast<uint64_t>(tail[1]) << 8; [[fallthrough]];
+    case 1:
+        k1 ^= static_cast<uint64_t>(tail[0]);
+        k1 *= kC1; k1 = rotl64(k1, 31); k1 *= kC2; h1 ^= k1;
+        break;
+    default:
+        break;
+    }
+
+    h1 ^= static_cast<uint64_t>(length);
+    h2 ^= static_cast<uint64_t>(length);
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    h1 += h2;
+    h2 += h1;
+
+    return ContentHash128{ h1, h2 };
+}
+
+ContentHash128 combineContentHash(const ContentHash128& lhs, const ContentHash128& rhs) {
+    std::array<uint64_t, 4> words{ lhs.lo, lhs.hi, rhs.lo, rhs.hi };
+    return hashContent(std::string_view(reinterpret_cast<const char*>(words.data()), sizeof(words)));
+}
+
+DagOutputCache::DagOutputCache(size_t byteBudget)
+    : byteBudget_(byteBudget) {
+}
+
+DagOutputCache::Value DagOutputCache::find(const ContentHash128& key) {
+    const auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++stats_.misses;
+        return nullptr;
+    }
+
+    lru_.splice(lru_.begin(), lru_, it->second);
+    ++stats_.hits;
+    return it->second->value;
+}
+
+void DagOutputCache::insert(const ContentHash128& key, Value value) {
+    if (!value) {
+        return;
+    }
+
+    const size_t bytes = entryBytes(value);
+    if (const auto it = index_.find(key); it != index_.end()) {
+        residentBytes_ -= it->second->bytes;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    // Значение больше всего бюджета не кэшируем, иначе оно вытеснит всё остальное
+    if (bytes > byteBudget_) {
+        return;
+    }
+
+    lru_.push_front(Entry{ key, std::move(value), bytes });
+    index_.emplace(key, lru_.begin());
+    residentBytes_ += bytes;
+    evictToBudget();
+}
+
+void DagOutputCache::clear() {
+    lru_.clear();
+    index_.clear();
+    residentBytes_ = 0;
+}
+
+void DagOutputCache::setByteBudget(size_t byteBudget) {
+    byteBudget_ = byteBudget;
+    evictToBudget();
+}
+
+size_t DagOutputCache::entryBytes(const Value& value) {
+    return value->bytes().size() + sizeof(Entry) + sizeof(ContentHash128);
+}
+
+void DagOutputCache::evictToBudget() {
+    while (residentBytes_ > byteBudget_ && !lru_.empty()) {
+        const Entry& victim = lru_.back();
+        residentBytes_ -= victim.bytes;
+        index_.erase(victim.key);
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <proc/ProcessDag.h>
+
+// 128-bit content hash used as a cache key instead of the raw payload bytes.
+struct ContentHash128 {
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+
+    bool operator==(const ContentHash128&) const = default;
+};
+
+struct ContentHash128Hasher {
+    size_t operator()(const ContentHash128& hash) const noexcept {
+        return static_cast<size_t>(hash.lo ^ (hash.hi * 0x9e3779b97f4a7c15ull));
+    }
+};
+
+ContentHash128 hashContent(std::string_view bytes, uint64_t seed = 0);
+ContentHash128 combineContentHash(const ContentHash128& lhs, const ContentHash128& rhs);
+
+struct DagOutputCacheStats {
+    int hits = 0;
+    int misses = 0;
+    int evictions = 0;
+};
+
+// LRU cache of encoded DAG outputs with a fixed byte budget.
+// Values are shared with the DAG value store, so a hit costs no copy.
+class DagOutputCache {
+public:
+    using Value = proc::ValueRef;
+
+    explicit DagOutputCache(size_t byteBudget);
+
+    Value find(const ContentHash128& key);
+    void insert(const ContentHash128& key, Value value);
+    void clear();
+
+    void setByteBudget(size_t byteBudget);
+    size_t byteBudget() const noexcept { return byteBudget_; }
+    size_t residentBytes() const noexcept { return residentBytes_; }
+    size_t entryCount() const noexcept { return index_.size(); }
+
+    const DagOutputCacheStats& stats() const noexcept { return stats_; }
+    void resetStats() noexcept { stats_ = {}; }
+
+private:
+    struct Entry {
+        ContentHash128 key;
+        Value value;
+        size_t bytes = 0;
+    };
+
+    static size_t entryBytes(const Value& value);
+    void evictToBudget();
+
+    size_t byteBudget_ = 0;
+    size_t residentBytes_ = 0;
+    std::list<Entry> lru_;
+    std::unordered_map<ContentHash128, std::list<Entry>::iterator, ContentHash128Hasher> index_;
+    DagOutputCacheStats stats_;
+};
@@ -12,6 +12,8 @@
 
 #include "model/HexSphereModel.h"
 #include "controllers/PathBuilder.h"
+#include "DagOutputCache.h"
+#include "SnapshotModelRegistry.h"
 #include "TerrainSerialization.h"
 #include "TerrainBackendTypes.h"
 
@@ -21,38 +23,12 @@
 
 namespace {
 
-    // ============================================================
-    // ПОСТРОЕНИЕ МОДЕЛИ ИЗ СНАПШОТА
-    // ============================================================
-
-    HexSphereModel buildModelFromSnapshot(const TerrainSnapshot& snapshot) {
-        IcosphereBuilder builder;
-        HexSphereModel model;
-        model.rebuildFromIcosphere(builder.build(snapshot.subdivisionLevel));
-
-        // Получаем НЕ-const ссылку на ячейки (см. HexSphereModel.h)
-        auto& cells = model.cells();
-
-        // Заполняем ячейки данными из снапшота
-        const size_t count = std::min(snapshot.cells.size(), cells.size());
-        for (size_t i = 0; i < count; ++i) {
-            const auto& src = snapshot.cells[i];
-            auto& dst = cells[i];
-
-            dst.height = src.height;
-            dst.biome = src.biome;
-            dst.temperature = src.temperature;
-            dst.humidity = src.humidity;
-            dst.pressure = src.pressure;
-            dst.oreDensity = src.oreDensity;
-            dst.oreType = src.oreType;
-            dst.oreVisual = src.oreVisual;
-            dst.oreNoiseOffset = src.oreNoiseOffset;
-            // centroid уже установлен в rebuildFromIcosphere
-        }
-
-        return model;
-    }
+    // Состояние запросов одного бэкенда: версия текущего снапшота и
+    // собственный workspace для поиска по общему графу
+    struct PathQueryState {
+        ContentHash128 terrainVersion;
+        PathBuilder::SearchWorkspace workspace;
+    };
 
     // ============================================================
     // ВСПОМОГАТЕЛЬНЫЕ ФУНКЦИИ ЧТЕНИЯ ПОЛЕЙ DAG
@@ -65,27 +41,13 @@ namespace {
         int fallback) {
 
         const auto handle = readHandle(slot);
-        const auto debugView = proc::Commit::debug_view(handle);
-        const auto debugValue = QString::fromUtf8(
-            debugView.data(), static_cast<qsizetype>(debugView.size()));
-
-        bool ok = false;
-        const int parsed = debugValue.toInt(&ok);
-        if (!ok) {
-            qWarning() << "DagPathBackend failed to parse int field"
-                << fieldName(slot).data() << "from" << debugValue;
-            return fallback;
+        if (const auto value = proc::value_as<int>(handle)) {
+            return *value;
         }
-        return parsed;
-    }
 
-    std::string readStringField(
-        const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
-        proc::v2::FieldSlot slot) {
-
-        const auto handle = readHandle(slot);
-        const auto debugView = proc::Commit::debug_view(handle);
-        return std::string(debugView.data(), debugView.size());
+        qWarning() << "DagPathBackend failed to read int field"
+            << fieldName(slot).data() << "from" << QString::fromStdString(proc::Commit::debug_string(handle));
+        return fallback;
     }
 
     proc::Commit executeFindPath(
@@ -97,12 +59,12 @@ namespace {
         proc::v2::FieldSlot startCellSlot,
         proc::v2::FieldSlot goalCellSlot,
         proc::v2::FieldSlot pathResultSlot,
-        const proc::GraphSchema& schema) {
+        const proc::GraphSchema& schema,
+        PathQueryState& state) {
 
-        // Читаем входы
-        const std::string snapshotJson = readStringField(readHandle, terrainSnapshotSlot);
-        auto snapshot = deserializeTerrainSnapshot(
-            QString::fromUtf8(snapshotJson.data(), static_cast<int>(snapshotJson.size())));
+        // Читаем входы: снапшот разбирается на месте, handle держит буфер живым
+        const auto snapshotHandle = readHandle(terrainSnapshotSlot);
+        const auto snapshot = TerrainSnapshotView::fromBytes(proc::Commit::debug_view(snapshotHandle));
 
         if (!snapshot) {
             qWarning() << "DagPathBackend: failed to parse terrain snapshot";
@@ -113,13 +75,11 @@ namespace {
         const int startId = readIntField(readHandle, fieldName, startCellSlot, 0);
         const int goalId = readIntField(readHandle, fieldName, goalCellSlot, 0);
 
-        // Строим модель
-        HexSphereModel model = buildModelFromSnapshot(*snapshot);
-
-        // Строим граф и ищем путь
-        PathBuilder builder(model, smoothMaxDelta);
-        builder.build();
-        std::vector<int> path = builder.astar(startId, goalId);
+        // Модель и граф общие для всех запросов к этой версии снапшота
+        const auto graph = SnapshotModelRegistry::shared().acquirePathGraph(
+            state.terrainVersion, *snapshot, smoothMaxDelta);
+        const HexSphereModel& model = *graph->model;
+        std::vector<int> path = graph->builder->astar(startId, goalId, state.workspace);
 
         // Формируем результат как JSON
         QJsonObject resultJson;
@@ -202,7 +162,7 @@ namespace {
     // ПОСТРОЕНИЕ РЕЕСТРА ИСПОЛНИТЕЛЕЙ
     // ============================================================
 
-    proc::RuntimeOperationRegistry buildPathRuntimeRegistry(const proc::GraphSchema& schema) {
+    proc::RuntimeOperationRegistry buildPathRuntimeRegistry(const proc::GraphSchema& schema, PathQueryState& state) {
         proc::RuntimeOperationRegistry registry(makePathOperationRegistry());
 
         const auto findNodeSlot = schema.find_node("FindPath");
@@ -223,6 +183,7 @@ namespace {
             schema.op_of(*findNodeSlot),
             *findNodeSlot,
             [&schema,
+            &state,
             tsSlot = *terrainSnapshotSlot,
             smdSlot = *smoothMaxDeltaSlot,
             scSlot = *startCellSlot,
@@ -234,7 +195,7 @@ namespace {
 
                     return executeFindPath(
                         readHandle, fieldName, debugString,
-                        tsSlot, smdSlot, scSlot, gcSlot, prSlot, schema);
+                        tsSlot, smdSlot, scSlot, gcSlot, prSlot, schema, state);
             });
 
         return registry;
@@ -249,6 +210,7 @@ namespace {
 struct DagPathBackend::Impl {
     int smoothMaxDelta = 1;
     PathResult lastResult;
+    PathQueryState queryState;
     proc::GraphSchema schema;
     proc::RuntimeOperationRegistry runtimeRegistry;
     proc::GuardRegistry guardRegistry;
@@ -263,7 +225,7 @@ struct DagPathBackend::Impl {
 
     Impl()
         : schema(buildPathSchema())
-        , runtimeRegistry(buildPathRuntimeRegistry(schema))
+        , runtimeRegistry(buildPathRuntimeRegistry(schema, queryState))
         , guardRegistry(proc::make_builtin_guard_registry())
         , engine(schema, runtimeRegistry, guardRegistry)
     {
@@ -283,17 +245,19 @@ struct DagPathBackend::Impl {
 
         proc::ValueStore init;
         init["terrainSnapshot"] = proc::make_value(std::string(""));
-        init["smoothMaxDelta"] = proc::make_value(std::to_string(1));
-        init["startCellId"] = proc::make_value(std::to_string(0));
-        init["goalCellId"] = proc::make_value(std::to_string(0));
+        init["smoothMaxDelta"] = proc::make_scalar(1);
+        init["startCellId"] = proc::make_scalar(0);
+        init["goalCellId"] = proc::make_scalar(0);
         engine.init(init);
     }
 
     void pushTerrainSnapshot(const TerrainSnapshot& snapshot) {
+        std::string encoded = encodeTerrainSnapshot(snapshot);
+        queryState.terrainVersion = hashContent(encoded);
         proc::Commit c;
         c.set(
             terrainSnapshotSlot,                               // ← ИСПОЛЬЗУЕМ СЛОТ
-            serializeTerrainSnapshot(snapshot).toStdString(),
+            std::move(encoded),
             proc::v2::WriteLifetime::Persistent,
             std::string(schema.field_name(terrainSnapshotSlot)));
         engine.push_input(c);
@@ -302,9 +266,9 @@ struct DagPathBackend::Impl {
     void pushSmoothMaxDelta(int delta) {
         smoothMaxDelta = delta;
         proc::Commit c;
-        c.set(
+        c.set_scalar(
             smoothMaxDeltaSlot,                                // ← ИСПОЛЬЗУЕМ СЛОТ
-            std::to_string(delta),
+            delta,
             proc::v2::WriteLifetime::Persistent,
             std::string(schema.field_name(smoothMaxDeltaSlot)));
         engine.push_input(c);
@@ -312,14 +276,14 @@ struct DagPathBackend::Impl {
 
     PathResult findPath(int startId, int goalId) {
         proc::Commit c;
-        c.set(
+        c.set_scalar(
             startCellIdSlot,
-            std::to_string(startId),
+            startId,
             proc::v2::WriteLifetime::Persistent,
             std::string(schema.field_name(startCellIdSlot)));
-        c.set(
+        c.set_scalar(
             goalCellIdSlot,
-            std::to_string(goalId),
+            goalId,
             proc::v2::WriteLifetime::Persistent,
             std::string(schema.field_name(goalCellIdSlot)));
         engine.push_input(c);
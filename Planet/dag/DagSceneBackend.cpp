@@ -1,5 +1,6 @@
 #include "DagSceneBackend.h"
 
+#include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -7,13 +8,17 @@
 #include <QtDebug>
 
 #include <algorithm>
+#include <mutex>
 #include <optional>
 #include <random>
+#include <sstream>
 #include <stdexcept>
 #include <string>
-#include <unordered_map>
+#include <string_view>
 #include <utility>
 
+#include "DagOutputCache.h"
+#include "SnapshotModelRegistry.h"
 #include "TerrainSerialization.h"
 #include "generation/MeshGenerators/SelectionOutlineGenerator.h"
 
@@ -100,30 +105,6 @@ VisualParams deserializeVisualParams(const QString& encoded) {
     return params;
 }
 
-HexSphereModel buildModelFromSnapshot(const TerrainSnapshot& snapshot) {
-    IcosphereBuilder builder;
-    HexSphereModel model;
-    model.rebuildFromIcosphere(builder.build(snapshot.subdivisionLevel));
-
-    auto& cells = model.cells();
-    const size_t count = std::min(snapshot.cells.size(), cells.size());
-    for (size_t i = 0; i < count; ++i) {
-        const auto& source = snapshot.cells[i];
-        auto& target = cells[i];
-        target.height = source.height;
-        target.biome = source.biome;
-        target.temperature = source.temperature;
-        target.humidity = source.humidity;
-        target.pressure = source.pressure;
-        target.oreDensity = source.oreDensity;
-        target.oreType = source.oreType;
-        target.oreVisual = source.oreVisual;
-        target.oreNoiseOffset = source.oreNoiseOffset;
-    }
-
-    return model;
-}
-
 QString serializeFloatArray(const std::vector<float>& values) {
     QJsonArray array;
     for (float value : values) {
@@ -147,10 +128,9 @@ std::vector<float> deserializeFloatArray(const QString& encoded) {
 }
 
 std::vector<float> buildSelectionOutline(
-    const TerrainSnapshot& snapshot,
+    const HexSphereModel& model,
     const std::vector<int>& selectedCells,
     const VisualParams& visual) {
-    HexSphereModel model = buildModelFromSnapshot(snapshot);
     QSet<int> selected;
     for (int cell : selectedCells) {
         selected.insert(cell);
@@ -190,73 +170,113 @@ bool shouldPlaceTree(Biome biome, std::mt19937& gen) {
     }
 }
 
-std::vector<TreePlacement> buildTreePlacements(const TerrainSnapshot& snapshot) {
-    HexSphereModel model = buildModelFromSnapshot(snapshot);
+uint32_t treeBaseSeed(const TerrainSnapshotView& snapshot) {
+    return
+        snapshot.params().seed ^
+        (static_cast<uint32_t>(snapshot.generatorIndex() + 1) * 0x9e3779b9u) ^
+        (static_cast<uint32_t>(snapshot.subdivisionLevel() + 1) * 0x85ebca6bu);
+}
+
+// Генератор засевается индексом клетки, поэтому дерево клетки не зависит от соседей
+std::optional<TreePlacement> buildTreePlacement(const Cell& cell, size_t index, uint32_t baseSeed) {
+    std::mt19937 gen(baseSeed ^ (static_cast<uint32_t>(index + 1) * 0x27d4eb2du));
+    if (!shouldPlaceTree(cell.biome, gen)) {
+        return std::nullopt;
+    }
+
+    std::uniform_real_distribution<float> baryDist(0.1f, 0.8f);
+    std::uniform_real_distribution<float> scaleDist(0.7f, 1.3f);
+    std::uniform_real_distribution<float> rotationDist(0.0f, 6.28318f);
+
+    TreePlacement placement;
+    placement.cellId = static_cast<int>(index);
+    placement.treeType = chooseTreeType(cell.biome, gen);
+    placement.triangleIdx = cell.poly.empty()
+        ? 0
+        : std::uniform_int_distribution<int>(0, static_cast<int>(cell.poly.size()) - 1)(gen);
+
+    placement.baryU = baryDist(gen);
+    placement.baryV = baryDist(gen);
+    if (placement.baryU + placement.baryV > 1.0f) {
+        placement.baryU = 1.0f - placement.baryU;
+        placement.baryV = 1.0f - placement.baryV;
+    }
+    placement.baryW = 1.0f - placement.baryU - placement.baryV;
+    placement.scale = scaleDist(gen);
+    placement.rotation = rotationDist(gen);
+
+    if (cell.biome == Biome::Savanna) {
+        placement.colorType = TreePlacement::TreeColorType::Autumn;
+        placement.isYellowCellTree = true;
+        placement.foliageColor = QVector3D(0.86f, 0.55f, 0.14f);
+        placement.trunkColor = QVector3D(0.35f, 0.20f, 0.08f);
+        placement.scale *= 0.85f;
+    }
+    else if (placement.treeType == TreeType::Fir) {
+        placement.foliageColor = QVector3D(0.16f, 0.45f, 0.30f);
+        placement.trunkColor = QVector3D(0.38f, 0.24f, 0.12f);
+        placement.scale *= 0.9f;
+    }
+    else {
+        placement.foliageColor = QVector3D(0.24f, 0.68f, 0.18f);
+        placement.trunkColor = QVector3D(0.50f, 0.34f, 0.16f);
+        if (cell.humidity > 0.7f) {
+            placement.scale *= 1.2f;
+        }
+        else if (cell.humidity < 0.3f) {
+            placement.scale *= 0.7f;
+        }
+    }
+
+    return placement;
+}
+
+std::vector<TreePlacement> buildTreePlacements(const TerrainSnapshotView& snapshot, const HexSphereModel& model) {
     const auto& cells = model.cells();
 
     std::vector<TreePlacement> placements;
     placements.reserve(cells.size() / 6);
 
-    const uint32_t baseSeed =
-        snapshot.params.seed ^
-        (static_cast<uint32_t>(snapshot.generatorIndex + 1) * 0x9e3779b9u) ^
-        (static_cast<uint32_t>(snapshot.subdivisionLevel + 1) * 0x85ebca6bu);
-
+    const uint32_t baseSeed = treeBaseSeed(snapshot);
     for (size_t i = 0; i < cells.size(); ++i) {
-        const auto& cell = cells[i];
-        std::mt19937 gen(baseSeed ^ (static_cast<uint32_t>(i + 1) * 0x27d4eb2du));
-        if (!shouldPlaceTree(cell.biome, gen)) {
-            continue;
+        if (auto placement = buildTreePlacement(cells[i], i, baseSeed)) {
+            placements.push_back(*placement);
         }
+    }
 
-        std::uniform_real_distribution<float> baryDist(0.1f, 0.8f);
-        std::uniform_real_distribution<float> scaleDist(0.7f, 1.3f);
-        std::uniform_real_distribution<float> rotationDist(0.0f, 6.28318f);
-
-        TreePlacement placement;
-        placement.cellId = static_cast<int>(i);
-        placement.treeType = chooseTreeType(cell.biome, gen);
-        placement.triangleIdx = cell.poly.empty()
-            ? 0
-            : std::uniform_int_distribution<int>(0, static_cast<int>(cell.poly.size()) - 1)(gen);
-
-        placement.baryU = baryDist(gen);
-        placement.baryV = baryDist(gen);
-        if (placement.baryU + placement.baryV > 1.0f) {
-            placement.baryU = 1.0f - placement.baryU;
-            placement.baryV = 1.0f - placement.baryV;
-        }
-        placement.baryW = 1.0f - placement.baryU - placement.baryV;
-        placement.scale = scaleDist(gen);
-        placement.rotation = rotationDist(gen);
-
-        if (cell.biome == Biome::Savanna) {
-            placement.colorType = TreePlacement::TreeColorType::Autumn;
-            placement.isYellowCellTree = true;
-            placement.foliageColor = QVector3D(0.86f, 0.55f, 0.14f);
-            placement.trunkColor = QVector3D(0.35f, 0.20f, 0.08f);
-            placement.scale *= 0.85f;
+    return placements;
+}
+
+// Пересобирает деревья только в клетках из диапазонов патча.
+// placements отсортированы по cellId, как их строит buildTreePlacements.
+void updateTreePlacements(
+    std::vector<TreePlacement>& placements,
+    const std::vector<TerrainCellRange>& ranges,
+    const TerrainSnapshotView& snapshot,
+    const HexSphereModel& model) {
+    const auto& cells = model.cells();
+    const uint32_t baseSeed = treeBaseSeed(snapshot);
+
+    std::vector<TreePlacement> next;
+    next.reserve(placements.size() + 1);
+    size_t kept = 0;
+    for (const TerrainCellRange& range : ranges) {
+        const size_t first = std::min<size_t>(range.first, cells.size());
+        const size_t end = std::min<size_t>(size_t(range.first) + range.count, cells.size());
+        while (kept < placements.size() && static_cast<size_t>(placements[kept].cellId) < first) {
+            next.push_back(placements[kept++]);
         }
-        else if (placement.treeType == TreeType::Fir) {
-            placement.foliageColor = QVector3D(0.16f, 0.45f, 0.30f);
-            placement.trunkColor = QVector3D(0.38f, 0.24f, 0.12f);
-            placement.scale *= 0.9f;
+        while (kept < placements.size() && static_cast<size_t>(placements[kept].cellId) < end) {
+            ++kept;
         }
-        else {
-            placement.foliageColor = QVector3D(0.24f, 0.68f, 0.18f);
-            placement.trunkColor = QVector3D(0.50f, 0.34f, 0.16f);
-            if (cell.humidity > 0.7f) {
-                placement.scale *= 1.2f;
-            }
-            else if (cell.humidity < 0.3f) {
-                placement.scale *= 0.7f;
+        for (size_t i = first; i < end; ++i) {
+            if (auto placement = buildTreePlacement(cells[i], i, baseSeed)) {
+                next.push_back(*placement);
             }
         }
-
-        placements.push_back(placement);
     }
-
-    return placements;
+    next.insert(next.end(), placements.begin() + kept, placements.end());
+    placements = std::move(next);
 }
 
 QJsonObject serializeTreePlacement(const TreePlacement& placement) {
@@ -361,10 +381,9 @@ std::vector<ModelPlacementRequest> deserializeModelRequests(const QString& encod
 }
 
 std::vector<ModelPlacement> buildModelPlacements(
-    const TerrainSnapshot& snapshot,
+    const HexSphereModel& model,
     const std::vector<ModelPlacementRequest>& requests,
     const VisualParams& visual) {
-    HexSphereModel model = buildModelFromSnapshot(snapshot);
     const auto& cells = model.cells();
 
     std::vector<ModelPlacement> result;
@@ -428,6 +447,10 @@ std::vector<ModelPlacement> deserializeModelPlacements(const QString& encoded) {
     return result;
 }
 
+constexpr size_t kDefaultCacheBudgetBytes = 64u * 1024u * 1024u;
+// Патч террейна выгоднее полного снапшота, пока меняется не больше 1/8 клеток
+constexpr size_t kTerrainPatchMaxFraction = 8;
+
 proc::OperationRegistry makeSceneOperationRegistry() {
     proc::OperationRegistry registry = proc::make_builtin_operation_registry();
     registry.register_op("buildSelectionOutline", proc::v2::OpId{ 200 });
@@ -436,6 +459,14 @@ proc::OperationRegistry makeSceneOperationRegistry() {
     return registry;
 }
 
+// terrainSnapshot получает свой тип: diff-алгебра патчей клеток не должна
+// распространяться на остальные строковые поля сцены
+proc::AlgebraRegistry makeSceneAlgebraRegistry() {
+    proc::AlgebraRegistry registry = proc::make_builtin_algebra_registry();
+    registry.register_type("terrainSnapshot", proc::v2::AlgebraId{ 100 });
+    return registry;
+}
+
 proc::GraphSchema buildSceneSchema() {
     proc::GraphSchema::StorageLayout roles;
     roles.inputs.insert("terrainSnapshot");
@@ -455,7 +486,7 @@ proc::GraphSchema buildSceneSchema() {
     return proc::GraphSchemaBuilder::compile(
         roles,
         {
-            {"terrainSnapshot", "str"},
+            {"terrainSnapshot", "terrainSnapshot"},
             {"selectedCells", "str"},
             {"visualParams", "str"},
             {"modelRequests", "str"},
@@ -493,7 +524,7 @@ proc::GraphSchema buildSceneSchema() {
             },
         },
         makeSceneOperationRegistry(),
-        proc::make_builtin_algebra_registry());
+        makeSceneAlgebraRegistry());
 }
 
 } // namespace
@@ -521,13 +552,26 @@ struct DagSceneBackend::Impl {
         "modelCacheHit",
     };
 
-    std::unordered_map<std::string, std::string> selectionCache;
-    std::unordered_map<std::string, std::string> treeCache;
-    std::unordered_map<std::string, std::string> modelCache;
-    std::string lastSelectionKey;
-    std::string lastTreeKey;
-    std::string lastModelKey;
+    // One byte budget for all three outputs; keys are separated by a per-node hash domain.
+    DagOutputCache outputCache{ kDefaultCacheBudgetBytes };
+    // Три узла сцены независимы и выполняются волной на пуле движка, кэш у них общий
+    std::mutex outputCacheMutex;
+    ContentHash128 selectionKey;
+    ContentHash128 treeKey;
+    ContentHash128 modelKey;
+    // Version of the snapshot in terrainSnapshot: key of the shared model in SnapshotModelRegistry
+    ContentHash128 terrainVersion;
+    std::optional<ContentHash128> lastSelectionKey;
+    std::optional<ContentHash128> lastTreeKey;
+    std::optional<ContentHash128> lastModelKey;
+    // Текущее значение terrainSnapshot в движке: база для патча следующего rebuild
+    proc::ValueRef terrainInput;
+    ContentHash128 terrainHash;
+    // Состояние узла деревьев для инкрементального обновления по патчу террейна
+    proc::ValueRef treeTerrain;
+    std::vector<TreePlacement> treeState;
     DagDebugStats lastStats;
+    SnapshotModelStats registryBefore;
 
     Impl()
         : schema(buildSceneSchema())
@@ -541,10 +585,32 @@ struct DagSceneBackend::Impl {
         init["selectedCells"] = proc::make_value(std::string("[]"));
         init["visualParams"] = proc::make_value(std::string("{}"));
         init["modelRequests"] = proc::make_value(std::string("[]"));
-        init["selectionDirty"] = proc::make_value(std::string("0"));
-        init["treeDirty"] = proc::make_value(std::string("0"));
-        init["modelDirty"] = proc::make_value(std::string("0"));
+        init["selectionDirty"] = proc::make_scalar(false);
+        init["treeDirty"] = proc::make_scalar(false);
+        init["modelDirty"] = proc::make_scalar(false);
         engine.init(init);
+        terrainInput = init["terrainSnapshot"];
+        terrainHash = hashContent(std::string_view{});
+        engine.register_apply_diff(
+            schema.algebra_of(terrainSnapshotSlot),
+            [](const proc::ValueRef& current, const proc::ValueRef& diff) {
+                auto next = applyTerrainSnapshotPatch(current->bytes(), diff->bytes());
+                if (!next) {
+                    throw std::runtime_error("DagSceneBackend: terrain patch does not match the current snapshot");
+                }
+                return proc::Value(std::move(*next));
+            });
+        engine.set_execution_options(proc::ExecutionOptions{ proc::ExecutionMode::Wavefront, 0, true });
+    }
+
+    proc::ValueRef findCachedOutput(const ContentHash128& key) {
+        std::lock_guard<std::mutex> lock(outputCacheMutex);
+        return outputCache.find(key);
+    }
+
+    void storeCachedOutput(const ContentHash128& key, const proc::ValueRef& value) {
+        std::lock_guard<std::mutex> lock(outputCacheMutex);
+        outputCache.insert(key, value);
     }
 
     void bindSlots() {
@@ -605,34 +671,27 @@ struct DagSceneBackend::Impl {
                 const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
                 const proc::RuntimeOperationRegistry::FieldNameFn&,
                 const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
-                ++lastStats.executedNodes;
-                const std::string terrainJson = readStringField(readHandle, terrainSlot);
-                const std::string selectedJson = readStringField(readHandle, selectedSlot);
-                const std::string visualJson = readStringField(readHandle, visualSlot);
-                const std::string key = terrainJson + "|" + selectedJson + "|" + visualJson;
-
-                bool cacheHit = false;
-                std::string encoded;
-                if (auto it = selectionCache.find(key); it != selectionCache.end()) {
-                    encoded = it->second;
-                    cacheHit = true;
-                }
-                else {
-                    const auto snapshot = deserializeTerrainSnapshot(QString::fromUtf8(terrainJson.data(), static_cast<int>(terrainJson.size())));
+                proc::ValueRef encoded = findCachedOutput(selectionKey);
+                const bool cacheHit = encoded != nullptr;
+                if (!cacheHit) {
+                    const auto terrainHandle = readHandle(terrainSlot);
+                    const auto snapshot = TerrainSnapshotView::fromBytes(proc::Commit::debug_view(terrainHandle));
                     if (snapshot) {
+                        const std::string selectedJson = readStringField(readHandle, selectedSlot);
+                        const std::string visualJson = readStringField(readHandle, visualSlot);
+                        const auto model = SnapshotModelRegistry::shared().acquireModel(terrainVersion, *snapshot);
                         const auto outline = buildSelectionOutline(
-                            *snapshot,
+                            *model,
                             deserializeSelectedCells(QString::fromUtf8(selectedJson.data(), static_cast<int>(selectedJson.size()))),
                             deserializeVisualParams(QString::fromUtf8(visualJson.data(), static_cast<int>(visualJson.size()))));
-                        encoded = serializeFloatArray(outline).toStdString();
-                        selectionCache.emplace(key, encoded);
+                        encoded = proc::make_value(serializeFloatArray(outline).toStdString());
+                        storeCachedOutput(selectionKey, encoded);
                     }
                 }
 
-                cacheHit ? ++lastStats.cacheHits : ++lastStats.cacheMisses;
                 proc::Commit commit;
-                commit.set(outputSlot, encoded, proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(outputSlot)));
-                commit.set(cacheHitSlot, cacheHit ? "1" : "0", proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(cacheHitSlot)));
+                commit.set_handle(outputSlot, encoded ? encoded : proc::make_value(std::string()), proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(outputSlot)));
+                commit.set_scalar(cacheHitSlot, cacheHit, proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(cacheHitSlot)));
                 return commit;
             });
 
@@ -646,28 +705,31 @@ struct DagSceneBackend::Impl {
                 const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
                 const proc::RuntimeOperationRegistry::FieldNameFn&,
                 const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
-                ++lastStats.executedNodes;
-                const std::string terrainJson = readStringField(readHandle, terrainSlot);
-                const std::string key = terrainJson;
-
-                bool cacheHit = false;
-                std::string encoded;
-                if (auto it = treeCache.find(key); it != treeCache.end()) {
-                    encoded = it->second;
-                    cacheHit = true;
-                }
-                else {
-                    const auto snapshot = deserializeTerrainSnapshot(QString::fromUtf8(terrainJson.data(), static_cast<int>(terrainJson.size())));
+                proc::ValueRef encoded = findCachedOutput(treeKey);
+                const bool cacheHit = encoded != nullptr;
+                if (!cacheHit) {
+                    const auto terrainHandle = readHandle(terrainSlot);
+                    const auto snapshot = TerrainSnapshotView::fromBytes(proc::Commit::debug_view(terrainHandle));
                     if (snapshot) {
-                        encoded = serializeTreePlacements(buildTreePlacements(*snapshot)).toStdString();
-                        treeCache.emplace(key, encoded);
+                        const auto model = SnapshotModelRegistry::shared().acquireModel(terrainVersion, *snapshot);
+                        // Патч от версии, по которой построено treeState: пересобираем только изменённые клетки
+                        const auto diff = proc::value_diff_from(terrainHandle, treeTerrain);
+                        const auto ranges = diff ? terrainSnapshotPatchRanges(diff->bytes()) : std::nullopt;
+                        if (ranges) {
+                            updateTreePlacements(treeState, *ranges, *snapshot, *model);
+                        }
+                        else {
+                            treeState = buildTreePlacements(*snapshot, *model);
+                        }
+                        treeTerrain = terrainHandle;
+                        encoded = proc::make_value(serializeTreePlacements(treeState).toStdString());
+                        storeCachedOutput(treeKey, encoded);
                     }
                 }
 
-                cacheHit ? ++lastStats.cacheHits : ++lastStats.cacheMisses;
                 proc::Commit commit;
-                commit.set(outputSlot, encoded, proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(outputSlot)));
-                commit.set(cacheHitSlot, cacheHit ? "1" : "0", proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(cacheHitSlot)));
+                commit.set_handle(outputSlot, encoded ? encoded : proc::make_value(std::string()), proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(outputSlot)));
+                commit.set_scalar(cacheHitSlot, cacheHit, proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(cacheHitSlot)));
                 return commit;
             });
 
@@ -683,41 +745,71 @@ struct DagSceneBackend::Impl {
                 const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
                 const proc::RuntimeOperationRegistry::FieldNameFn&,
                 const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
-                ++lastStats.executedNodes;
-                const std::string terrainJson = readStringField(readHandle, terrainSlot);
-                const std::string visualJson = readStringField(readHandle, visualSlot);
-                const std::string requestsJson = readStringField(readHandle, modelRequestsSlotLocal);
-                const std::string key = terrainJson + "|" + visualJson + "|" + requestsJson;
-
-                bool cacheHit = false;
-                std::string encoded;
-                if (auto it = modelCache.find(key); it != modelCache.end()) {
-                    encoded = it->second;
-                    cacheHit = true;
-                }
-                else {
-                    const auto snapshot = deserializeTerrainSnapshot(QString::fromUtf8(terrainJson.data(), static_cast<int>(terrainJson.size())));
+                proc::ValueRef encoded = findCachedOutput(modelKey);
+                const bool cacheHit = encoded != nullptr;
+                if (!cacheHit) {
+                    const auto terrainHandle = readHandle(terrainSlot);
+                    const auto snapshot = TerrainSnapshotView::fromBytes(proc::Commit::debug_view(terrainHandle));
                     if (snapshot) {
-                        encoded = serializeModelPlacements(buildModelPlacements(
-                            *snapshot,
+                        const std::string visualJson = readStringField(readHandle, visualSlot);
+                        const std::string requestsJson = readStringField(readHandle, modelRequestsSlotLocal);
+                        const auto model = SnapshotModelRegistry::shared().acquireModel(terrainVersion, *snapshot);
+                        encoded = proc::make_value(serializeModelPlacements(buildModelPlacements(
+                            *model,
                             deserializeModelRequests(QString::fromUtf8(requestsJson.data(), static_cast<int>(requestsJson.size()))),
-                            deserializeVisualParams(QString::fromUtf8(visualJson.data(), static_cast<int>(visualJson.size()))))).toStdString();
-                        modelCache.emplace(key, encoded);
+                            deserializeVisualParams(QString::fromUtf8(visualJson.data(), static_cast<int>(visualJson.size()))))).toStdString());
+                        storeCachedOutput(modelKey, encoded);
                     }
                 }
 
-                cacheHit ? ++lastStats.cacheHits : ++lastStats.cacheMisses;
                 proc::Commit commit;
-                commit.set(outputSlot, encoded, proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(outputSlot)));
-                commit.set(cacheHitSlot, cacheHit ? "1" : "0", proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(cacheHitSlot)));
+                commit.set_handle(outputSlot, encoded ? encoded : proc::make_value(std::string()), proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(outputSlot)));
+                commit.set_scalar(cacheHitSlot, cacheHit, proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(cacheHitSlot)));
                 return commit;
             });
 
         return registry;
     }
 
+    // Пишет террейн в commit: патч изменённых клеток, если он мал, иначе снапшот целиком.
+    // Возвращает false, если террейн не изменился.
+    bool pushTerrain(const SceneDagRequest& request) {
+        const auto current = TerrainSnapshotView::fromBytes(terrainInput ? terrainInput->bytes() : std::string_view{});
+        if (current) {
+            const size_t maxChangedCells = request.terrain.cells.size() / kTerrainPatchMaxFraction;
+            if (auto patch = encodeTerrainSnapshotPatch(*current, request.terrain, maxChangedCells)) {
+                const auto ranges = terrainSnapshotPatchRanges(*patch);
+                if (!ranges || ranges->empty()) {
+                    return false;
+                }
+                proc::Commit commit;
+                commit.apply_diff(
+                    terrainSnapshotSlot,
+                    proc::make_value(std::move(*patch)),
+                    {},
+                    proc::v2::WriteLifetime::Persistent,
+                    std::string(schema.field_name(terrainSnapshotSlot)));
+                engine.push_input(commit);
+                terrainInput = engine.input_snapshot().at("terrainSnapshot");
+                terrainHash = hashContent(terrainInput->bytes());
+                return true;
+            }
+        }
+
+        auto full = proc::make_value(encodeTerrainSnapshot(request.terrain));
+        if (terrainInput && full->bytes() == terrainInput->bytes()) {
+            return false;
+        }
+        proc::Commit commit;
+        commit.set_handle(terrainSnapshotSlot, full, proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(terrainSnapshotSlot)));
+        engine.push_input(commit);
+        terrainHash = hashContent(full->bytes());
+        terrainInput = std::move(full);
+        return true;
+    }
+
     SceneDagResult rebuild(const SceneDagRequest& request) {
-        const QString terrainJson = serializeTerrainSnapshot(request.terrain);
+        pushTerrain(request);
         const QString selectedJson = serializeSelectedCells(request.selectedCells);
         const QString visualJson = serializeVisualParams(VisualParams{
             request.heightStep,
@@ -726,9 +818,14 @@ struct DagSceneBackend::Impl {
         });
         const QString modelRequestsJson = serializeModelRequests(request.modelRequests);
 
-        const std::string selectionKey = terrainJson.toStdString() + "|" + selectedJson.toStdString() + "|" + visualJson.toStdString();
-        const std::string treeKey = terrainJson.toStdString();
-        const std::string modelKey = terrainJson.toStdString() + "|" + visualJson.toStdString() + "|" + modelRequestsJson.toStdString();
+        // The snapshot is hashed once per change (pushTerrain); every node key derives from input hashes.
+        const ContentHash128 selectedHash = hashContent(selectedJson.toStdString());
+        const ContentHash128 visualHash = hashContent(visualJson.toStdString());
+        const ContentHash128 modelRequestsHash = hashContent(modelRequestsJson.toStdString());
+        terrainVersion = terrainHash;
+        selectionKey = combineContentHash(combineContentHash(hashContent("selection"), terrainHash), combineContentHash(selectedHash, visualHash));
+        treeKey = combineContentHash(hashContent("tree"), terrainHash);
+        modelKey = combineContentHash(combineContentHash(hashContent("model"), terrainHash), combineContentHash(visualHash, modelRequestsHash));
 
         const bool selectionDirty = selectionKey != lastSelectionKey;
         const bool treeDirty = treeKey != lastTreeKey;
@@ -738,19 +835,20 @@ struct DagSceneBackend::Impl {
         lastModelKey = modelKey;
 
         lastStats = {};
+        outputCache.resetStats();
+        registryBefore = SnapshotModelRegistry::shared().stats();
         lastStats.skippedGuardNodes =
             (selectionDirty ? 0 : 1) +
             (treeDirty ? 0 : 1) +
             (modelDirty ? 0 : 1);
 
         proc::Commit commit;
-        commit.set(terrainSnapshotSlot, terrainJson.toStdString(), proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(terrainSnapshotSlot)));
         commit.set(selectedCellsSlot, selectedJson.toStdString(), proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(selectedCellsSlot)));
         commit.set(visualParamsSlot, visualJson.toStdString(), proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(visualParamsSlot)));
         commit.set(modelRequestsSlot, modelRequestsJson.toStdString(), proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(modelRequestsSlot)));
-        commit.set(selectionDirtySlot, selectionDirty ? "1" : "0", proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(selectionDirtySlot)));
-        commit.set(treeDirtySlot, treeDirty ? "1" : "0", proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(treeDirtySlot)));
-        commit.set(modelDirtySlot, modelDirty ? "1" : "0", proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(modelDirtySlot)));
+        commit.set_scalar(selectionDirtySlot, selectionDirty, proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(selectionDirtySlot)));
+        commit.set_scalar(treeDirtySlot, treeDirty, proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(treeDirtySlot)));
+        commit.set_scalar(modelDirtySlot, modelDirty, proc::v2::WriteLifetime::Persistent, std::string(schema.field_name(modelDirtySlot)));
         engine.push_input(commit);
 
         try {
@@ -758,6 +856,7 @@ struct DagSceneBackend::Impl {
         }
         catch (const std::exception& e) {
             qWarning() << "DagSceneBackend::flush_prepare failed:" << e.what();
+            collectCacheStats();
             return {};
         }
 
@@ -774,8 +873,27 @@ struct DagSceneBackend::Impl {
         }
 
         engine.ack_outputs();
+        for (const proc::NodeTiming& timing : engine.last_node_timings()) {
+            if (!timing.skipped_guard) {
+                ++lastStats.executedNodes;
+            }
+        }
+        collectCacheStats();
         return result;
     }
+
+    void collectCacheStats() {
+        const SnapshotModelStats registryAfter = SnapshotModelRegistry::shared().stats();
+        lastStats.modelBuilds = static_cast<int>(registryAfter.modelBuilds - registryBefore.modelBuilds);
+        lastStats.modelReuses = static_cast<int>(registryAfter.modelReuses - registryBefore.modelReuses);
+
+        const DagOutputCacheStats& cacheStats = outputCache.stats();
+        lastStats.cacheHits = cacheStats.hits;
+        lastStats.cacheMisses = cacheStats.misses;
+        lastStats.cacheEvictions = cacheStats.evictions;
+        lastStats.cacheBytes = outputCache.residentBytes();
+        lastStats.cacheEntries = outputCache.entryCount();
+    }
 };
 
 DagSceneBackend::DagSceneBackend()
@@ -793,3 +911,27 @@ SceneDagResult DagSceneBackend::rebuild(const SceneDagRequest& request) {
 const DagDebugStats& DagSceneBackend::lastStats() const {
     return impl_->lastStats;
 }
+
+void DagSceneBackend::setCacheBudgetBytes(size_t bytes) {
+    impl_->outputCache.setByteBudget(bytes);
+    impl_->lastStats.cacheBytes = impl_->outputCache.residentBytes();
+    impl_->lastStats.cacheEntries = impl_->outputCache.entryCount();
+}
+
+void DagSceneBackend::setTraceCapacity(size_t capacity) {
+    impl_->engine.set_tracing(capacity);
+}
+
+bool DagSceneBackend::writeChromeTrace(const QString& path) const {
+    std::ostringstream out;
+    if (!impl_->engine.write_chrome_trace(out)) {
+        return false;
+    }
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    const std::string json = out.str();
+    return file.write(json.data(), static_cast<qint64>(json.size())) == static_cast<qint64>(json.size());
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -51,6 +52,12 @@ struct DagDebugStats {
     int skippedGuardNodes = 0;
     int cacheHits = 0;
     int cacheMisses = 0;
+    int cacheEvictions = 0;
+    size_t cacheBytes = 0;
+    size_t cacheEntries = 0;
+    // Shared snapshot model (SnapshotModelRegistry) requests of the executed nodes
+    int modelBuilds = 0;
+    int modelReuses = 0;
 };
 
 class DagSceneBackend {
@@ -65,6 +72,11 @@ public:
 
     SceneDagResult rebuild(const SceneDagRequest& request);
     const DagDebugStats& lastStats() const;
+    void setCacheBudgetBytes(size_t bytes);
+    // Трассировка DAG в кольцевой буфер на capacity событий; 0 - выключена
+    void setTraceCapacity(size_t capacity);
+    // Chrome trace / Perfetto JSON; false, если трассировка выключена или файл не записан
+    bool writeChromeTrace(const QString& path) const;
 
 private:
     struct Impl;
@@ -4,10 +4,13 @@
 
 #include <optional>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <utility>
 
 #include "generation/TerrainGenerator.h"
 #include "model/HexSphereModel.h"
+#include "model/TopologyCache.h"
 #include "TerrainSerialization.h"
 
 //import Proc;
@@ -19,9 +22,8 @@
 
 namespace {
 TerrainSnapshot buildTerrainSnapshot(int generatorIndex, int subdivisionLevel, const TerrainParams& params) {
-    IcosphereBuilder builder;
     HexSphereModel model;
-    model.rebuildFromIcosphere(builder.build(subdivisionLevel));
+    model.rebuildFromTopology(TopologyCache::acquire(subdivisionLevel));
 
     auto generator = createTerrainGeneratorByIndex(generatorIndex);
     generator->generate(model, params);
@@ -57,6 +59,12 @@ struct DagTerrainBackend::Impl {
         runtimeRegistry = std::make_unique<proc::RuntimeOperationRegistry>(buildRuntimeRegistry(*schema));
         guardRegistry = std::make_unique<proc::GuardRegistry>(proc::make_builtin_guard_registry());
         outputs = std::make_unique<std::vector<proc::Field>>(std::initializer_list<proc::Field>{ "terrainSnapshot" });
+
+        // Движок живёт всё время жизни бэкенда: схема, планировщик и слои хранилища
+        // строятся один раз, дальше меняются только входы через push_input.
+        engine = std::make_unique<proc::DefaultDagEngine>(*schema, *runtimeRegistry, *guardRegistry);
+        pushedInputs = makeInputStore();
+        engine->init(pushedInputs);
     }
 
     ITerrainSceneBridge* bridge = nullptr;
@@ -69,6 +77,8 @@ struct DagTerrainBackend::Impl {
     std::unique_ptr<proc::RuntimeOperationRegistry> runtimeRegistry;
     std::unique_ptr<proc::GuardRegistry> guardRegistry;
     std::unique_ptr<std::vector<proc::Field>> outputs;
+    std::unique_ptr<proc::DefaultDagEngine> engine;
+    proc::ValueStore pushedInputs;
 
     static proc::GraphSchema buildSchema() {
         proc::GraphSchema::StorageLayout roles;
@@ -102,38 +112,22 @@ struct DagTerrainBackend::Impl {
             proc::make_builtin_algebra_registry());
     }
 
-    static int readIntField(
+    template <typename T>
+    static T readNumberField(
         const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
         const proc::RuntimeOperationRegistry::FieldNameFn& fieldName,
         proc::v2::FieldSlot slot,
-        int fallback) {
+        T fallback) {
+        // Входы кладутся типизированными скалярами - чтение без разбора строки;
+        // текстовое значение (старые сценарии) value_as разберёт сам
         const auto handle = readHandle(slot);
-        const auto debugView = proc::Commit::debug_view(handle);
-        const auto debugValue = QString::fromUtf8(debugView.data(), static_cast<qsizetype>(debugView.size()));
-        bool ok = false;
-        const int parsed = debugValue.toInt(&ok);
-        if (!ok) {
-            qWarning() << "DagTerrainBackend failed to parse DAG int field" << fieldName(slot).data() << "from" << debugValue;
-            return fallback;
+        if (const auto value = proc::value_as<T>(handle)) {
+            return *value;
         }
-        return parsed;
-    }
-
-    static float readFloatField(
-        const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
-        const proc::RuntimeOperationRegistry::FieldNameFn& fieldName,
-        proc::v2::FieldSlot slot,
-        float fallback) {
-        const auto handle = readHandle(slot);
-        const auto debugView = proc::Commit::debug_view(handle);
-        const auto debugValue = QString::fromUtf8(debugView.data(), static_cast<qsizetype>(debugView.size()));
-        bool ok = false;
-        const float parsed = debugValue.toFloat(&ok);
-        if (!ok) {
-            qWarning() << "DagTerrainBackend failed to parse DAG scalar field" << fieldName(slot).data() << "from" << debugValue;
-            return fallback;
-        }
-        return parsed;
+        const auto debugText = proc::Commit::debug_string(handle);
+        qWarning() << "DagTerrainBackend failed to read DAG field" << fieldName(slot).data()
+            << "from" << QString::fromStdString(debugText);
+        return fallback;
     }
 
     static proc::RuntimeOperationRegistry buildRuntimeRegistry(const proc::GraphSchema& schema) {
@@ -159,19 +153,19 @@ struct DagTerrainBackend::Impl {
                 const proc::RuntimeOperationRegistry::FieldNameFn& fieldName,
                 const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
                 TerrainParams params;
-                params.seed = static_cast<uint32_t>(Impl::readIntField(readHandle, fieldName, seedSlot, 0));
-                params.seaLevel = Impl::readIntField(readHandle, fieldName, seaLevelSlot, 0);
-                params.scale = Impl::readFloatField(readHandle, fieldName, scaleSlot, 1.0f);
+                params.seed = Impl::readNumberField<uint32_t>(readHandle, fieldName, seedSlot, 0u);
+                params.seaLevel = Impl::readNumberField<int>(readHandle, fieldName, seaLevelSlot, 0);
+                params.scale = Impl::readNumberField<float>(readHandle, fieldName, scaleSlot, 1.0f);
 
-                const int generatorIndex = Impl::readIntField(readHandle, fieldName, generatorSlot, 3);
-                const int subdivisionLevel = Impl::readIntField(readHandle, fieldName, subdivisionSlot, 2);
+                const int generatorIndex = Impl::readNumberField<int>(readHandle, fieldName, generatorSlot, 3);
+                const int subdivisionLevel = Impl::readNumberField<int>(readHandle, fieldName, subdivisionSlot, 2);
 
                 const auto snapshot = buildTerrainSnapshot(generatorIndex, subdivisionLevel, params);
 
                 proc::Commit commit;
                 commit.set(
                     outputSlot,
-                    serializeTerrainSnapshot(snapshot).toStdString(),
+                    encodeTerrainSnapshot(snapshot),
                     proc::v2::WriteLifetime::Persistent,
                     std::string(schema.field_name(outputSlot)));
                 return commit;
@@ -181,40 +175,71 @@ struct DagTerrainBackend::Impl {
 
     proc::ValueStore makeInputStore() const {
         proc::ValueStore init;
-        init["generatorIndex"] = proc::make_value(std::to_string(generatorIndex));
-        init["seed"] = proc::make_value(std::to_string(params.seed));
-        init["seaLevel"] = proc::make_value(std::to_string(params.seaLevel));
-        init["scale"] = proc::make_value(QString::number(params.scale, 'g', 9).toStdString());
-        init["subdivisionLevel"] = proc::make_value(std::to_string(subdivisionLevel));
+        init["generatorIndex"] = proc::make_scalar(generatorIndex);
+        init["seed"] = proc::make_scalar(params.seed);
+        init["seaLevel"] = proc::make_scalar(params.seaLevel);
+        init["scale"] = proc::make_scalar(params.scale);
+        init["subdivisionLevel"] = proc::make_scalar(subdivisionLevel);
         return init;
     }
 
-    std::optional<TerrainSnapshot> regenerateViaDag() const {
-        if (!schema || !runtimeRegistry || !guardRegistry || !outputs) {
-            qWarning() << "DagTerrainBackend runtime is not initialized";
-            return std::nullopt;
+    // Отправляет в движок только изменившиеся входы; false - если менять нечего
+    bool pushChangedInputs() {
+        proc::Commit commit;
+        for (auto& [field, value] : makeInputStore()) {
+            auto& pushed = pushedInputs[field];
+            if (pushed && *pushed == *value) {
+                continue;
+            }
+            commit.set_handle(field, value);
+            pushed = std::move(value);
         }
-
-        proc::DefaultDagEngine dag(*schema, *runtimeRegistry, *guardRegistry);
-        dag.init(makeInputStore());
-        if (!dag.flush_prepare(*outputs)) {
-            qWarning() << "DagTerrainBackend flush_prepare failed";
-            return std::nullopt;
+        if (commit.empty()) {
+            return false;
         }
+        engine->push_input(commit);
+        return true;
+    }
 
-        const auto encoded = proc::get_value_view(dag.prepared_output_store(), "terrainSnapshot");
+    std::optional<TerrainSnapshot> decodeOutput(const std::optional<std::string_view>& encoded) const {
         if (!encoded) {
             qWarning() << "DagTerrainBackend produced no terrainSnapshot";
             return std::nullopt;
         }
 
-        auto snapshot = deserializeTerrainSnapshot(QString::fromUtf8(encoded->data(), static_cast<qsizetype>(encoded->size())));
-        if (!snapshot) {
+        const auto view = TerrainSnapshotView::fromBytes(*encoded);
+        if (!view) {
             qWarning() << "DagTerrainBackend failed to decode terrain snapshot";
             return std::nullopt;
         }
+        return view->toSnapshot();
+    }
+
+    std::optional<TerrainSnapshot> regenerateViaDag() {
+        if (!engine || !outputs) {
+            qWarning() << "DagTerrainBackend runtime is not initialized";
+            return std::nullopt;
+        }
+
+        pushChangedInputs();
+
+        bool prepared = false;
+        try {
+            prepared = engine->flush_prepare(*outputs);
+        }
+        catch (const std::exception& e) {
+            qWarning() << "DagTerrainBackend flush_prepare failed:" << e.what();
+            return std::nullopt;
+        }
+
+        // Входы не менялись с прошлого прогона: узел не перезапускается,
+        // результат берётся из опубликованных выходов.
+        if (!prepared) {
+            return decodeOutput(proc::get_value_view(engine->published_output_store(), "terrainSnapshot"));
+        }
 
-        if (!dag.ack_outputs()) {
+        auto snapshot = decodeOutput(proc::get_value_view(engine->prepared_output_store(), "terrainSnapshot"));
+        if (!engine->ack_outputs()) {
             qWarning() << "DagTerrainBackend ack_outputs failed";
         }
         return snapshot;
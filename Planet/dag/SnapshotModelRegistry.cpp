@@ -0,0 +1,100 @@
+#include "SnapshotModelRegistry.h"
+
+#include <algorithm>
+
+#include "TerrainSerialization.h"
+#include "model/TopologyCache.h"
+
+HexSphereModel buildModelFromSnapshot(const TerrainSnapshotView& snapshot) {
+    HexSphereModel model;
+    model.rebuildFromTopology(TopologyCache::acquire(snapshot.subdivisionLevel()));
+
+    auto& cells = model.cells();
+    const size_t count = std::min(snapshot.cellCount(), cells.size());
+    for (size_t i = 0; i < count; ++i) {
+        auto& target = cells[i];
+        target.height = snapshot.height(i);
+        target.biome = snapshot.biome(i);
+        target.temperature = snapshot.temperature(i);
+        target.humidity = snapshot.humidity(i);
+        target.pressure = snapshot.pressure(i);
+        target.oreDensity = snapshot.oreDensity(i);
+        target.oreType = snapshot.oreType(i);
+        target.oreVisual = snapshot.oreVisual(i);
+        target.oreNoiseOffset = snapshot.oreNoiseOffset(i);
+        // centroid уже установлен из общей топологии
+    }
+
+    return model;
+}
+
+std::shared_ptr<const HexSphereModel> SnapshotModelRegistry::acquireModel(
+    const ContentHash128& version,
+    const TerrainSnapshotView& snapshot) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return acquireModelLocked(version, snapshot);
+}
+
+std::shared_ptr<const HexSphereModel> SnapshotModelRegistry::acquireModelLocked(
+    const ContentHash128& version,
+    const TerrainSnapshotView& snapshot) {
+    if (model_ && modelVersion_ == version) {
+        ++stats_.modelReuses;
+        return model_;
+    }
+
+    auto model = std::make_shared<HexSphereModel>(buildModelFromSnapshot(snapshot));
+    // columns() досинхронизируется при первом чтении - делаем это здесь,
+    // пока модель ещё не видна другим потокам
+    model->columns();
+    model_ = std::move(model);
+    modelVersion_ = version;
+    ++stats_.modelBuilds;
+    return model_;
+}
+
+std::shared_ptr<const SnapshotPathGraph> SnapshotModelRegistry::acquirePathGraph(
+    const ContentHash128& version,
+    const TerrainSnapshotView& snapshot,
+    int smoothMaxDelta) {
+    const int maxDelta = PathBuilder::effectiveMaxClimbDelta(smoothMaxDelta);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (graph_ && graphVersion_ == version && graphMaxDelta_ == maxDelta) {
+        ++stats_.graphReuses;
+        return graph_;
+    }
+
+    auto graph = std::make_shared<SnapshotPathGraph>();
+    graph->model = acquireModelLocked(version, snapshot);
+    auto builder = std::make_unique<PathBuilder>(*graph->model, smoothMaxDelta);
+    builder->build();
+    graph->builder = std::move(builder);
+
+    graph_ = std::move(graph);
+    graphVersion_ = version;
+    graphMaxDelta_ = maxDelta;
+    ++stats_.graphBuilds;
+    return graph_;
+}
+
+SnapshotModelStats SnapshotModelRegistry::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void SnapshotModelRegistry::resetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = {};
+}
+
+void SnapshotModelRegistry::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    model_.reset();
+    graph_.reset();
+}
+
+SnapshotModelRegistry& SnapshotModelRegistry::shared() {
+    static SnapshotModelRegistry instance;
+    return instance;
+}
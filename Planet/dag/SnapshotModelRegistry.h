@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "DagOutputCache.h"
+#include "controllers/PathBuilder.h"
+#include "model/HexSphereModel.h"
+
+class TerrainSnapshotView;
+
+struct SnapshotModelStats {
+    uint64_t modelBuilds = 0;
+    uint64_t modelReuses = 0;  // model rebuilds avoided
+    uint64_t graphBuilds = 0;
+    uint64_t graphReuses = 0;  // path graph rebuilds avoided
+};
+
+// A path graph together with the model it references (PathBuilder keeps a
+// reference, so the graph owns a share of the model).
+struct SnapshotPathGraph {
+    std::shared_ptr<const HexSphereModel> model;
+    std::unique_ptr<const PathBuilder> builder;
+};
+
+// Immutable HexSphereModel and path graph of the current terrain snapshot,
+// shared by every DAG backend until the snapshot version changes. The version
+// is the content hash of the encoded snapshot, so backends that receive the
+// same terrain agree on it without coordination.
+//
+// Returned objects are never mutated: queries on a shared graph must pass
+// their own PathBuilder::SearchWorkspace.
+class SnapshotModelRegistry {
+public:
+    std::shared_ptr<const HexSphereModel> acquireModel(
+        const ContentHash128& version,
+        const TerrainSnapshotView& snapshot);
+
+    std::shared_ptr<const SnapshotPathGraph> acquirePathGraph(
+        const ContentHash128& version,
+        const TerrainSnapshotView& snapshot,
+        int smoothMaxDelta);
+
+    SnapshotModelStats stats() const;
+    void resetStats();
+    // Drops the registry's references; holders keep what they acquired
+    void clear();
+
+    // Registry shared by DagSceneBackend and DagPathBackend
+    static SnapshotModelRegistry& shared();
+
+private:
+    std::shared_ptr<const HexSphereModel> acquireModelLocked(
+        const ContentHash128& version,
+        const TerrainSnapshotView& snapshot);
+
+    mutable std::mutex mutex_;
+    ContentHash128 modelVersion_;
+    std::shared_ptr<const HexSphereModel> model_;
+    ContentHash128 graphVersion_;
+    int graphMaxDelta_ = 0;
+    std::shared_ptr<const SnapshotPathGraph> graph_;
+    SnapshotModelStats stats_;
+};
+
+// Fills a model from the shared topology and the snapshot columns
+HexSphereModel buildModelFromSnapshot(const TerrainSnapshotView& snapshot);
@@ -22,6 +22,145 @@ namespace {
             static_cast<float>(array[2].toDouble()));
     }
 
+    constexpr size_t kHeaderSize = 32;
+
+    constexpr std::array<size_t, TerrainSnapshotView::ColumnCount> kColumnStride{
+        sizeof(int32_t),    // Height
+        sizeof(uint8_t),    // BiomeColumn
+        sizeof(float),      // Temperature
+        sizeof(float),      // Humidity
+        sizeof(float),      // Pressure
+        sizeof(float),      // OreDensity
+        sizeof(uint8_t),    // OreType
+        sizeof(float),      // OreVisualDensity
+        sizeof(float),      // OreVisualGrainSize
+        sizeof(float),      // OreVisualGrainContrast
+        sizeof(float) * 3,  // OreVisualBaseColor
+        sizeof(float) * 3,  // OreVisualGrainColor
+        sizeof(float),      // OreNoiseOffset
+    };
+
+    size_t alignColumn(size_t bytes) {
+        return (bytes + 3u) & ~size_t{ 3u };
+    }
+
+    //     ;   -  
+    std::array<size_t, TerrainSnapshotView::ColumnCount + 1> columnOffsets(size_t cellCount) {
+        std::array<size_t, TerrainSnapshotView::ColumnCount + 1> offsets{};
+        size_t offset = kHeaderSize;
+        for (size_t column = 0; column < TerrainSnapshotView::ColumnCount; ++column) {
+            offsets[column] = offset;
+            offset += alignColumn(kColumnStride[column] * cellCount);
+        }
+        offsets[TerrainSnapshotView::ColumnCount] = offset;
+        return offsets;
+    }
+
+    template <typename T>
+    void storeLe(char* out, T value) {
+        auto raw = std::bit_cast<std::array<char, sizeof(T)>>(value);
+        if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+            std::reverse(raw.begin(), raw.end());
+        }
+        std::memcpy(out, raw.data(), sizeof(T));
+    }
+
+    template <typename T>
+    T loadLe(const char* in) {
+        std::array<char, sizeof(T)> raw;
+        std::memcpy(raw.data(), in, sizeof(T));
+        if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+            std::reverse(raw.begin(), raw.end());
+        }
+        return std::bit_cast<T>(raw);
+    }
+
+    void storeVec3(char* out, const QVector3D& value) {
+        storeLe<float>(out, value.x());
+        storeLe<float>(out + sizeof(float), value.y());
+        storeLe<float>(out + sizeof(float) * 2, value.z());
+    }
+
+    //    ; at(column) -     
+    template <typename AtFn>
+    void storeCell(const TerrainCellSnapshot& cell, AtFn&& at) {
+        storeLe<int32_t>(at(TerrainSnapshotView::Height), cell.height);
+        storeLe<uint8_t>(at(TerrainSnapshotView::BiomeColumn), static_cast<uint8_t>(cell.biome));
+        storeLe<float>(at(TerrainSnapshotView::Temperature), cell.temperature);
+        storeLe<float>(at(TerrainSnapshotView::Humidity), cell.humidity);
+        storeLe<float>(at(TerrainSnapshotView::Pressure), cell.pressure);
+        storeLe<float>(at(TerrainSnapshotView::OreDensity), cell.oreDensity);
+        storeLe<uint8_t>(at(TerrainSnapshotView::OreType), cell.oreType);
+        storeLe<float>(at(TerrainSnapshotView::OreVisualDensity), cell.oreVisual.density);
+        storeLe<float>(at(TerrainSnapshotView::OreVisualGrainSize), cell.oreVisual.grainSize);
+        storeLe<float>(at(TerrainSnapshotView::OreVisualGrainContrast), cell.oreVisual.grainContrast);
+        storeVec3(at(TerrainSnapshotView::OreVisualBaseColor), cell.oreVisual.baseColor);
+        storeVec3(at(TerrainSnapshotView::OreVisualGrainColor), cell.oreVisual.grainColor);
+        storeLe<float>(at(TerrainSnapshotView::OreNoiseOffset), cell.oreNoiseOffset);
+    }
+
+    constexpr size_t kPatchHeaderSize = 16;
+    constexpr size_t kPatchDiffChunkCells = 256;
+    constexpr size_t kPatchRangeSize = 8;
+
+    //      ;   -  
+    constexpr std::array<size_t, TerrainSnapshotView::ColumnCount + 1> cellColumnOffsets() {
+        std::array<size_t, TerrainSnapshotView::ColumnCount + 1> offsets{};
+        for (size_t column = 0; column < TerrainSnapshotView::ColumnCount; ++column) {
+            offsets[column + 1] = offsets[column] + kColumnStride[column];
+        }
+        return offsets;
+    }
+
+    constexpr auto kCellColumnOffset = cellColumnOffsets();
+    constexpr size_t kCellBytes = kCellColumnOffset[TerrainSnapshotView::ColumnCount];
+
+    struct PatchLayout {
+        uint32_t baseCellCount = 0;
+        std::vector<TerrainCellRange> ranges;
+        const char* data = nullptr;
+    };
+
+    std::optional<PatchLayout> parsePatch(std::string_view patch) {
+        if (patch.size() < kPatchHeaderSize) {
+            return std::nullopt;
+        }
+        const char* bytes = patch.data();
+        if (loadLe<uint32_t>(bytes + 0) != kTerrainSnapshotPatchMagic) {
+            return std::nullopt;
+        }
+
+        PatchLayout layout;
+        layout.baseCellCount = loadLe<uint32_t>(bytes + 4);
+        const size_t rangeCount = loadLe<uint32_t>(bytes + 8);
+        if (rangeCount > (patch.size() - kPatchHeaderSize) / kPatchRangeSize) {
+            return std::nullopt;
+        }
+
+        layout.ranges.reserve(rangeCount);
+        uint64_t nextFree = 0;
+        uint64_t changedCells = 0;
+        for (size_t r = 0; r < rangeCount; ++r) {
+            const char* entry = bytes + kPatchHeaderSize + r * kPatchRangeSize;
+            const TerrainCellRange range{ loadLe<uint32_t>(entry), loadLe<uint32_t>(entry + 4) };
+            const uint64_t end = uint64_t(range.first) + range.count;
+            //  ,     
+            if (range.count == 0 || range.first < nextFree || end > layout.baseCellCount) {
+                return std::nullopt;
+            }
+            nextFree = end;
+            changedCells += range.count;
+            layout.ranges.push_back(range);
+        }
+
+        const size_t dataOffset = kPatchHeaderSize + rangeCount * kPatchRangeSize;
+        if (patch.size() - dataOffset != changedCells * kCellBytes) {
+            return std::nullopt;
+        }
+        layout.data = bytes + dataOffset;
+        return layout;
+    }
+
 } // namespace
 
 QString serializeTerrainSnapshot(const TerrainSnapshot& snapshot) {
@@ -92,4 +231,217 @@ std::optional<TerrainSnapshot> deserializeTerrainSnapshot(const QString& encoded
     }
 
     return snapshot;
-}
\ No newline at end of file
+}
+
+std::string encodeTerrainSnapshot(const TerrainSnapshot& snapshot) {
+    const size_t cellCount = snapshot.cells.size();
+    const auto offsets = columnOffsets(cellCount);
+
+    std::string buffer(offsets[TerrainSnapshotView::ColumnCount], '\0');
+    char* data = buffer.data();
+
+    storeLe<uint32_t>(data + 0, kTerrainSnapshotMagic);
+    storeLe<uint16_t>(data + 4, kTerrainSnapshotVersion);
+    storeLe<uint16_t>(data + 6, static_cast<uint16_t>(kHeaderSize));
+    storeLe<int32_t>(data + 8, snapshot.subdivisionLevel);
+    storeLe<int32_t>(data + 12, snapshot.generatorIndex);
+    storeLe<uint32_t>(data + 16, snapshot.params.seed);
+    storeLe<int32_t>(data + 20, snapshot.params.seaLevel);
+    storeLe<float>(data + 24, snapshot.params.scale);
+    storeLe<uint32_t>(data + 28, static_cast<uint32_t>(cellCount));
+
+    for (size_t i = 0; i < cellCount; ++i) {
+        storeCell(snapshot.cells[i], [&](TerrainSnapshotView::Column column) {
+            return data + offsets[column] + i * kColumnStride[column];
+        });
+    }
+
+    return buffer;
+}
+
+std::optional<std::string> encodeTerrainSnapshotPatch(
+    const TerrainSnapshotView& base,
+    const TerrainSnapshot& next,
+    size_t maxChangedCells) {
+    const TerrainParams& params = base.params();
+    if (next.subdivisionLevel != base.subdivisionLevel() ||
+        next.generatorIndex != base.generatorIndex() ||
+        next.params.seed != params.seed ||
+        next.params.seaLevel != params.seaLevel ||
+        std::bit_cast<uint32_t>(next.params.scale) != std::bit_cast<uint32_t>(params.scale) ||
+        next.cells.size() != base.cellCount()) {
+        return std::nullopt;
+    }
+
+    //   ,    DAG.   
+    // ,       memcmp; 
+    //     .
+    std::vector<TerrainCellRange> ranges;
+    size_t changedCells = 0;
+    std::vector<char> chunk(kPatchDiffChunkCells * kCellBytes);
+    const size_t cellCount = next.cells.size();
+    for (size_t first = 0; first < cellCount; first += kPatchDiffChunkCells) {
+        const size_t count = std::min(kPatchDiffChunkCells, cellCount - first);
+        auto chunkColumn = [&](size_t column) {
+            return chunk.data() + count * kCellColumnOffset[column];
+        };
+        auto baseColumn = [&](size_t column) {
+            return base.columnData(static_cast<TerrainSnapshotView::Column>(column)) + first * kColumnStride[column];
+        };
+
+        for (size_t k = 0; k < count; ++k) {
+            storeCell(next.cells[first + k], [&](TerrainSnapshotView::Column column) {
+                return chunkColumn(column) + k * kColumnStride[column];
+            });
+        }
+
+        bool sameChunk = true;
+        for (size_t column = 0; column < TerrainSnapshotView::ColumnCount && sameChunk; ++column) {
+            sameChunk = std::memcmp(chunkColumn(column), baseColumn(column), count * kColumnStride[column]) == 0;
+        }
+        if (sameChunk) {
+            continue;
+        }
+
+        for (size_t k = 0; k < count; ++k) {
+            bool same = true;
+            for (size_t column = 0; column < TerrainSnapshotView::ColumnCount && same; ++column) {
+                const size_t stride = kColumnStride[column];
+                same = std::memcmp(chunkColumn(column) + k * stride, baseColumn(column) + k * stride, stride) == 0;
+            }
+            if (same) {
+                continue;
+            }
+
+            if (++changedCells > maxChangedCells) {
+                return std::nullopt;
+            }
+            const size_t i = first + k;
+            if (!ranges.empty() && ranges.back().first + ranges.back().count == i) {
+                ++ranges.back().count;
+            } else {
+                ranges.push_back({ static_cast<uint32_t>(i), 1 });
+            }
+        }
+    }
+
+    std::string patch(kPatchHeaderSize + ranges.size() * kPatchRangeSize + changedCells * kCellBytes, '\0');
+    char* out = patch.data();
+    storeLe<uint32_t>(out + 0, kTerrainSnapshotPatchMagic);
+    storeLe<uint32_t>(out + 4, static_cast<uint32_t>(base.cellCount()));
+    storeLe<uint32_t>(out + 8, static_cast<uint32_t>(ranges.size()));
+    for (size_t r = 0; r < ranges.size(); ++r) {
+        storeLe<uint32_t>(out + kPatchHeaderSize + r * kPatchRangeSize, ranges[r].first);
+        storeLe<uint32_t>(out + kPatchHeaderSize + r * kPatchRangeSize + 4, ranges[r].count);
+    }
+
+    char* data = out + kPatchHeaderSize + ranges.size() * kPatchRangeSize;
+    for (const TerrainCellRange& range : ranges) {
+        for (uint32_t k = 0; k < range.count; ++k) {
+            storeCell(next.cells[range.first + k], [&](TerrainSnapshotView::Column column) {
+                return data + range.count * kCellColumnOffset[column] + k * kColumnStride[column];
+            });
+        }
+        data += size_t(range.count) * kCellBytes;
+    }
+    return patch;
+}
+
+std::optional<std::vector<TerrainCellRange>> terrainSnapshotPatchRanges(std::string_view patch) {
+    auto layout = parsePatch(patch);
+    if (!layout) {
+        return std::nullopt;
+    }
+    return std::move(layout->ranges);
+}
+
+std::optional<std::string> applyTerrainSnapshotPatch(std::string_view base, std::string_view patch) {
+    const auto view = TerrainSnapshotView::fromBytes(base);
+    const auto layout = parsePatch(patch);
+    if (!view || !layout || layout->baseCellCount != view->cellCount()) {
+        return std::nullopt;
+    }
+
+    std::string next(base);
+    const auto offsets = columnOffsets(view->cellCount());
+    const char* data = layout->data;
+    for (const TerrainCellRange& range : layout->ranges) {
+        for (size_t column = 0; column < TerrainSnapshotView::ColumnCount; ++column) {
+            const size_t bytes = size_t(range.count) * kColumnStride[column];
+            std::memcpy(next.data() + offsets[column] + range.first * kColumnStride[column], data, bytes);
+            data += bytes;
+        }
+    }
+    return next;
+}
+
+std::optional<TerrainSnapshotView> TerrainSnapshotView::fromBytes(std::string_view bytes) {
+    if (bytes.size() < kHeaderSize) {
+        return std::nullopt;
+    }
+
+    const char* data = bytes.data();
+    if (loadLe<uint32_t>(data + 0) != kTerrainSnapshotMagic ||
+        loadLe<uint16_t>(data + 4) != kTerrainSnapshotVersion ||
+        loadLe<uint16_t>(data + 6) != kHeaderSize) {
+        return std::nullopt;
+    }
+
+    const size_t cellCount = loadLe<uint32_t>(data + 28);
+    //         
+    if (cellCount > bytes.size()) {
+        return std::nullopt;
+    }
+    const auto offsets = columnOffsets(cellCount);
+    if (offsets[ColumnCount] != bytes.size()) {
+        return std::nullopt;
+    }
+
+    TerrainSnapshotView view;
+    view.subdivisionLevel_ = loadLe<int32_t>(data + 8);
+    view.generatorIndex_ = loadLe<int32_t>(data + 12);
+    view.params_.seed = loadLe<uint32_t>(data + 16);
+    view.params_.seaLevel = loadLe<int32_t>(data + 20);
+    view.params_.scale = loadLe<float>(data + 24);
+    view.cellCount_ = cellCount;
+    for (size_t column = 0; column < ColumnCount; ++column) {
+        view.columns_[column] = data + offsets[column];
+    }
+    return view;
+}
+
+OreVisualParams TerrainSnapshotView::oreVisual(size_t i) const noexcept {
+    OreVisualParams visual;
+    visual.density = load<float>(OreVisualDensity, i);
+    visual.grainSize = load<float>(OreVisualGrainSize, i);
+    visual.grainContrast = load<float>(OreVisualGrainContrast, i);
+    visual.baseColor = loadVec3(OreVisualBaseColor, i);
+    visual.grainColor = loadVec3(OreVisualGrainColor, i);
+    return visual;
+}
+
+TerrainCellSnapshot TerrainSnapshotView::cell(size_t i) const noexcept {
+    TerrainCellSnapshot cell;
+    cell.height = height(i);
+    cell.biome = biome(i);
+    cell.temperature = temperature(i);
+    cell.humidity = humidity(i);
+    cell.pressure = pressure(i);
+    cell.oreDensity = oreDensity(i);
+    cell.oreType = oreType(i);
+    cell.oreVisual = oreVisual(i);
+    cell.oreNoiseOffset = oreNoiseOffset(i);
+    return cell;
+}
+
+TerrainSnapshot TerrainSnapshotView::toSnapshot() const {
+    TerrainSnapshot snapshot;
+    snapshot.subdivisionLevel = subdivisionLevel_;
+    snapshot.generatorIndex = generatorIndex_;
+    snapshot.params = params_;
+    snapshot.cells.reserve(cellCount_);
+    for (size_t i = 0; i < cellCount_; ++i) {
+        snapshot.cells.push_back(cell(i));
+    }
+    return snapshot;
+}
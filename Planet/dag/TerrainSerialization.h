@@ -1,12 +1,141 @@
 #pragma once
 
 #include <QString>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include "TerrainBackendTypes.h"
 
-///  TerrainSnapshot  JSON-
+///  TerrainSnapshot  JSON- (   )
 QString serializeTerrainSnapshot(const TerrainSnapshot& snapshot);
 
-///  TerrainSnapshot  JSON-
-std::optional<TerrainSnapshot> deserializeTerrainSnapshot(const QString& encoded);
\ No newline at end of file
+///  TerrainSnapshot  JSON- (   )
+std::optional<TerrainSnapshot> deserializeTerrainSnapshot(const QString& encoded);
+
+// ============================================================
+//      DAG
+// ============================================================
+//
+//  (32 , little-endian):
+//   u32 magic 'TSNP', u16 version, u16 headerSize,
+//   i32 subdivisionLevel, i32 generatorIndex, u32 seed, i32 seaLevel, f32 scale, u32 cellCount
+//    cellCount ,    4 :
+//   height i32, biome u8, temperature f32, humidity f32, pressure f32, oreDensity f32, oreType u8,
+//   oreVisualDensity f32, oreVisualGrainSize f32, oreVisualGrainContrast f32,
+//   oreVisualBaseColor f32x3, oreVisualGrainColor f32x3, oreNoiseOffset f32
+
+inline constexpr uint32_t kTerrainSnapshotMagic = 0x504E5354u; // "TSNP"
+inline constexpr uint16_t kTerrainSnapshotVersion = 1;
+
+///  TerrainSnapshot    ( DAG- terrainSnapshot)
+std::string encodeTerrainSnapshot(const TerrainSnapshot& snapshot);
+
+///     ,      .
+///     view.
+class TerrainSnapshotView {
+public:
+    enum Column : size_t {
+        Height,
+        BiomeColumn,
+        Temperature,
+        Humidity,
+        Pressure,
+        OreDensity,
+        OreType,
+        OreVisualDensity,
+        OreVisualGrainSize,
+        OreVisualGrainContrast,
+        OreVisualBaseColor,
+        OreVisualGrainColor,
+        OreNoiseOffset,
+        ColumnCount,
+    };
+
+    /// nullopt,   ,       
+    static std::optional<TerrainSnapshotView> fromBytes(std::string_view bytes);
+
+    int subdivisionLevel() const noexcept { return subdivisionLevel_; }
+    int generatorIndex() const noexcept { return generatorIndex_; }
+    const TerrainParams& params() const noexcept { return params_; }
+    size_t cellCount() const noexcept { return cellCount_; }
+    bool empty() const noexcept { return cellCount_ == 0; }
+
+    int height(size_t i) const noexcept { return load<int32_t>(Height, i); }
+    Biome biome(size_t i) const noexcept { return static_cast<Biome>(load<uint8_t>(BiomeColumn, i)); }
+    float temperature(size_t i) const noexcept { return load<float>(Temperature, i); }
+    float humidity(size_t i) const noexcept { return load<float>(Humidity, i); }
+    float pressure(size_t i) const noexcept { return load<float>(Pressure, i); }
+    float oreDensity(size_t i) const noexcept { return load<float>(OreDensity, i); }
+    uint8_t oreType(size_t i) const noexcept { return load<uint8_t>(OreType, i); }
+    float oreNoiseOffset(size_t i) const noexcept { return load<float>(OreNoiseOffset, i); }
+    OreVisualParams oreVisual(size_t i) const noexcept;
+
+    TerrainCellSnapshot cell(size_t i) const noexcept;
+    TerrainSnapshot toSnapshot() const;
+
+    ///  little-endian   (cellCount )
+    const char* columnData(Column column) const noexcept { return columns_[column]; }
+
+private:
+    template <typename T>
+    T load(Column column, size_t index) const noexcept {
+        std::array<char, sizeof(T)> raw;
+        std::memcpy(raw.data(), columns_[column] + index * sizeof(T), sizeof(T));
+        if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+            std::reverse(raw.begin(), raw.end());
+        }
+        return std::bit_cast<T>(raw);
+    }
+
+    QVector3D loadVec3(Column column, size_t index) const noexcept {
+        return QVector3D(
+            load<float>(column, index * 3),
+            load<float>(column, index * 3 + 1),
+            load<float>(column, index * 3 + 2));
+    }
+
+    int subdivisionLevel_ = 0;
+    int generatorIndex_ = 0;
+    TerrainParams params_{};
+    size_t cellCount_ = 0;
+    std::array<const char*, ColumnCount> columns_{};
+};
+
+// ============================================================
+//   (diff  DAG- terrainSnapshot)
+// ============================================================
+//
+//  (16 , little-endian):
+//   u32 magic 'TPCH', u32 baseCellCount, u32 rangeCount, u32 reserved
+//  rangeCount  {u32 firstCell, u32 cellCount}  ,  ,
+//   :      ,  cellCount
+//   ,  .     .
+
+inline constexpr uint32_t kTerrainSnapshotPatchMagic = 0x48435054u; // "TPCH"
+
+struct TerrainCellRange {
+    uint32_t first = 0;
+    uint32_t count = 0;
+};
+
+///   next,   base. nullopt,    : 
+///    ,    maxChangedCells .
+///    -   .
+std::optional<std::string> encodeTerrainSnapshotPatch(
+    const TerrainSnapshotView& base,
+    const TerrainSnapshot& next,
+    size_t maxChangedCells);
+
+///   ; nullopt   
+std::optional<std::vector<TerrainCellRange>> terrainSnapshotPatchRanges(std::string_view patch);
+
+///  : base   . nullopt,      base
+std::optional<std::string> applyTerrainSnapshotPatch(std::string_view base, std::string_view patch);
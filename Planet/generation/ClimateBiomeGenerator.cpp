@@ -1,78 +1,168 @@
 #include "ClimateBiomeGenerator.h"
+#include "CounterRng.h"
+#include "core/ParallelFor.h"
 #include <cmath>
 #include <algorithm>
+#include <vector>
 
-void ClimateBiomeGenerator::generate(HexSphereModel& model, const ClimateParams& params) {
-    Perlin3D elevationNoise(params.seed);
-    Perlin3D tempNoise(params.seed + 1000);
-    Perlin3D humidityNoise(params.seed + 2000);
-    Perlin3D pressureNoise(params.seed + 3000);
-    Perlin3D oreNoise(params.seed + 4000);
+namespace {
+    // Потоки CounterRng: независимые последовательности для одной клетки
+    enum RandomStream : uint32_t {
+        OreOverrideStream = 1,
+    };
+
+    // Клеток на задачу в Mode::Parallel; границы чанков не зависят от числа потоков
+    constexpr size_t kCellsPerChunk = 2048;
+}
 
+struct ClimateBiomeGenerator::Fields {
+    explicit Fields(const ClimateParams& params, size_t n)
+        : elevationNoise(params.seed)
+        , tempNoise(params.seed + 1000)
+        , humidityNoise(params.seed + 2000)
+        , pressureNoise(params.seed + 3000)
+        , oreNoise(params.seed + 4000)
+        , positions(n), xs(n), ys(n), zs(n)
+        , elevation(n), temperature(n), humidity(n), pressure(n), ore(n) {}
+
+    Perlin3D elevationNoise;
+    Perlin3D tempNoise;
+    Perlin3D humidityNoise;
+    Perlin3D pressureNoise;
+    Perlin3D oreNoise;
+
+    // Точки на единичной сфере в SoA - шум считается пачками
+    std::vector<QVector3D> positions;
+    std::vector<float> xs, ys, zs;
+    std::vector<float> elevation, temperature, humidity, pressure, ore;
+};
+
+void ClimateBiomeGenerator::generate(HexSphereModel& model, const ClimateParams& params) {
     auto& cells = model.cells();
+    const size_t n = cells.size();
+    Fields fields(params, n);
+
+    if (params.mode == ClimateParams::Mode::Parallel) {
+        // Каждая клетка пишется ровно одной задачей, шум и RNG - чистые функции
+        // координат и id клетки, поэтому порядок выполнения чанков не важен
+        const size_t chunkCount = (n + kCellsPerChunk - 1) / kCellsPerChunk;
+        parallelFor(chunkCount, resolveThreadCount(params.threadCount), [&](size_t chunk, size_t) {
+            const size_t begin = chunk * kCellsPerChunk;
+            const size_t end = std::min(n, begin + kCellsPerChunk);
+            sampleFields(cells, begin, end, params, fields);
+            for (size_t i = begin; i < end; ++i) {
+                Cell& cell = cells[i];
+                classifyCell(cell, i, fields, params);
+
+                CounterRng rng(params.seed, i, OreOverrideStream);
+                if (rng.below(100) < 25) {
+                    cell.oreType = static_cast<uint8_t>(1 + rng.below(4)); // тип 1-4
+                    cell.oreDensity = 0.3f + rng.below(70) / 100.0f; // плотность 0.3-1.0
+                }
+            }
+        });
+        return;
+    }
+
+    sampleFields(cells, 0, n, params, fields);
 
     std::srand(params.seed);
 
-    for (auto& cell : cells) {
+    for (size_t i = 0; i < n; ++i) {
+        auto& cell = cells[i];
+        classifyCell(cell, i, fields, params);
+
+        if (std::rand() % 100 < 25) {
+            cell.oreType = 1 + (std::rand() % 4); // тип 1-4
+            cell.oreDensity = 0.3f + (std::rand() % 70) / 100.0f; // плотность 0.3-1.0
+        }
+    }
+}
+
+void ClimateBiomeGenerator::sampleFields(const std::vector<Cell>& cells, size_t begin, size_t end,
+    const ClimateParams& params, Fields& fields) const
+{
+    for (size_t i = begin; i < end; ++i) {
+        fields.positions[i] = cells[i].centroid.normalized();
+        fields.xs[i] = fields.positions[i].x();
+        fields.ys[i] = fields.positions[i].y();
+        fields.zs[i] = fields.positions[i].z();
+    }
 
-        const QVector3D& position = cell.centroid.normalized();
+    const size_t count = end - begin;
+    const float* xs = fields.xs.data() + begin;
+    const float* ys = fields.ys.data() + begin;
+    const float* zs = fields.zs.data() + begin;
+
+    PerlinFractal elevationFractal;
+    elevationFractal.frequency = params.elevationScale;
+    elevationFractal.octaves = 4;
+    fields.elevationNoise.fractalBatch(xs, ys, zs, fields.elevation.data() + begin, count, elevationFractal);
+
+    PerlinFractal tempFractal;
+    tempFractal.frequency = params.temperatureScale;
+    fields.tempNoise.fractalBatch(xs, ys, zs, fields.temperature.data() + begin, count, tempFractal);
+
+    PerlinFractal humidityFractal;
+    humidityFractal.frequency = params.humidityScale;
+    humidityFractal.offsetX = 50.0f;
+    humidityFractal.offsetZ = 25.0f;
+    fields.humidityNoise.fractalBatch(xs, ys, zs, fields.humidity.data() + begin, count, humidityFractal);
+
+    PerlinFractal pressureFractal;
+    pressureFractal.frequency = params.pressureScale;
+    fields.pressureNoise.fractalBatch(xs, ys, zs, fields.pressure.data() + begin, count, pressureFractal);
+
+    PerlinFractal oreFractal;
+    oreFractal.frequency = params.oreScale;
+    fields.oreNoise.fractalBatch(xs, ys, zs, fields.ore.data() + begin, count, oreFractal);
+}
 
-        // 1. Высота (основной рельеф)
-        float elevation = calculateElevation(position, params, elevationNoise);
+void ClimateBiomeGenerator::classifyCell(Cell& cell, size_t i, const Fields& fields, const ClimateParams& params) {
+    const QVector3D& position = fields.positions[i];
 
-        // 2. Температура (зависит от широты и высоты)
-        float temperature = calculateTemperature(position, elevation, params, tempNoise);
+    // 1. Высота (основной рельеф)
+    float elevation = calculateElevation(fields.elevation[i]);
 
-        // 3. Влажность (отдельный шум)
-        float humidity = calculateHumidity(position, params, humidityNoise);
+    // 2. Температура (зависит от широты и высоты)
+    float temperature = calculateTemperature(position, elevation, params, fields.temperature[i]);
 
-        // 4. Давление (новый параметр)
-        float pressure = calculatePressure(position, params, pressureNoise);
+    // 3. Влажность (отдельный шум)
+    float humidity = calculateHumidity(fields.humidity[i]);
 
-        // 5. Плотность руды (новый параметр)
-        float oreDensity = calculateOreDensity(position, elevation, params, oreNoise);
+    // 4. Давление (новый параметр)
+    float pressure = calculatePressure(fields.pressure[i]);
 
-        // 6. Определяем биом по таблице
-        Biome biome = determineBiome(elevation, temperature, humidity, params.seaLevel);
+    // 5. Плотность руды (новый параметр)
+    float oreDensity = calculateOreDensity(fields.ore[i], elevation);
 
-        // Устанавливаем значения
-        cell.height = static_cast<int>((elevation - params.seaLevel) * 10.0f);
-        cell.biome = biome;
+    // 6. Определяем биом по таблице
+    Biome biome = determineBiome(elevation, temperature, humidity, params.seaLevel);
 
-        // Сохраняем климатические данные
-        cell.temperature = temperature;
-        cell.humidity = humidity;
-        cell.pressure = pressure;
-        cell.oreDensity = oreDensity;
-        cell.oreType = determineOreType(oreDensity, elevation);
+    // Устанавливаем значения
+    cell.height = static_cast<int>((elevation - params.seaLevel) * 10.0f);
+    cell.biome = biome;
 
-        if (std::rand() % 100 < 25) {
-            cell.oreType = 1 + (std::rand() % 4); // тип 1-4
-            cell.oreDensity = 0.3f + (std::rand() % 70) / 100.0f; // плотность 0.3-1.0
-        }
-    }
+    // Сохраняем климатические данные
+    cell.temperature = temperature;
+    cell.humidity = humidity;
+    cell.pressure = pressure;
+    cell.oreDensity = oreDensity;
+    cell.oreType = determineOreType(oreDensity, elevation);
 }
 
-float ClimateBiomeGenerator::calculatePressure(const QVector3D& position, const ClimateParams& params, Perlin3D& pressureNoise) {
+float ClimateBiomeGenerator::calculatePressure(float pressureNoise) {
     // Давление зависит от высоты и шума
-    float pressure = pressureNoise.noise(
-        position.x() * params.pressureScale,
-        position.y() * params.pressureScale,
-        position.z() * params.pressureScale
-    );
+    float pressure = pressureNoise;
 
     // Нормализуем к [0, 1]
     pressure = (pressure + 1.0f) * 0.5f;
     return std::clamp(pressure, 0.0f, 1.0f);
 }
 
-float ClimateBiomeGenerator::calculateOreDensity(const QVector3D& position, float elevation, const ClimateParams& params, Perlin3D& oreNoise) {
+float ClimateBiomeGenerator::calculateOreDensity(float oreNoise, float elevation) {
     // Плотность руды зависит от высоты и отдельного шума
-    float ore = oreNoise.noise(
-        position.x() * params.oreScale,
-        position.y() * params.oreScale,
-        position.z() * params.oreScale
-    );
+    float ore = oreNoise;
 
     // Увеличиваем вероятность руды в горах
     if (elevation > 0.7f) {
@@ -98,29 +188,12 @@ uint8_t ClimateBiomeGenerator::determineOreType(float oreDensity, float elevatio
     }
 }
 
-float ClimateBiomeGenerator::calculateElevation(const QVector3D& position, const ClimateParams& params, Perlin3D& elevationNoise) {
-    // Многооктавный шум для сложного рельефа
-    float elevation = 0.0f;
-    float amplitude = 1.0f;
-    float frequency = 1.0f;
-    float maxAmplitude = 0.0f;
-
-    for (int i = 0; i < 4; i++) {
-        elevation += amplitude * elevationNoise.noise(
-            position.x() * frequency * params.elevationScale,
-            position.y() * frequency * params.elevationScale,
-            position.z() * frequency * params.elevationScale
-        );
-        maxAmplitude += amplitude;
-        amplitude *= 0.5f;
-        frequency *= 2.0f;
-    }
-
-    elevation /= maxAmplitude;
-    return (elevation + 1.0f) * 0.5f; // Нормализуем к [0, 1]
+float ClimateBiomeGenerator::calculateElevation(float fractalNoise) {
+    // Многооктавный шум (4 октавы, уже нормирован по сумме амплитуд)
+    return (fractalNoise + 1.0f) * 0.5f; // Нормализуем к [0, 1]
 }
 
-float ClimateBiomeGenerator::calculateTemperature(const QVector3D& position, float elevation, const ClimateParams& params, Perlin3D& tempNoise) {
+float ClimateBiomeGenerator::calculateTemperature(const QVector3D& position, float elevation, const ClimateParams& params, float tempNoise) {
     // Широта (y-координата) - основной фактор температуры
     float latitude = std::abs(position.y()); // 0 = экватор, 1 = полюс
 
@@ -132,23 +205,15 @@ float ClimateBiomeGenerator::calculateTemperature(const QVector3D& position, flo
     baseTemp -= std::max(0.0f, heightEffect);
 
     // Добавляем шум для разнообразия
-    float tempNoiseValue = tempNoise.noise(
-        position.x() * params.temperatureScale,
-        position.y() * params.temperatureScale,
-        position.z() * params.temperatureScale
-    ) * 0.2f;
+    float tempNoiseValue = tempNoise * 0.2f;
 
     float temperature = baseTemp + tempNoiseValue;
     return std::clamp(temperature, 0.0f, 1.0f);
 }
 
-float ClimateBiomeGenerator::calculateHumidity(const QVector3D& position, const ClimateParams& params, Perlin3D& humidityNoise) {
+float ClimateBiomeGenerator::calculateHumidity(float humidityNoise) {
     // Влажность - чистый шум с небольшими корреляциями
-    float humidity = humidityNoise.noise(
-        position.x() * params.humidityScale + 50.0f,
-        position.y() * params.humidityScale,
-        position.z() * params.humidityScale + 25.0f
-    );
+    float humidity = humidityNoise;
 
     // Нормализуем к [0, 1]
     humidity = (humidity + 1.0f) * 0.5f;
@@ -12,16 +12,28 @@ public:
         uint32_t seed = 12345;
         float pressureScale = 1.8f;
         float oreScale = 4.0f;
+
+        // Legacy - один проход и std::rand (прежние планеты для того же seed);
+        // Parallel - чанки клеток по потокам, руда из CounterRng(seed, cell, stream):
+        // для одного seed результат побитно совпадает при любом threadCount
+        enum class Mode { Legacy, Parallel };
+        Mode mode = Mode::Legacy;
+        int threadCount = 0; // 0 - по числу аппаратных потоков
     };
 
     void generate(HexSphereModel& model, const ClimateParams& params);
 
 private:
-    float calculateElevation(const QVector3D& position, const ClimateParams& params, Perlin3D& elevationNoise);
-    float calculateTemperature(const QVector3D& position, float elevation, const ClimateParams& params, Perlin3D& tempNoise);
-    float calculateHumidity(const QVector3D& position, const ClimateParams& params, Perlin3D& humidityNoise);
-    float calculatePressure(const QVector3D& position, const ClimateParams& params, Perlin3D& pressureNoise);
-    float calculateOreDensity(const QVector3D& position, float elevation, const ClimateParams& params, Perlin3D& oreNoise);
+    struct Fields;
+    void sampleFields(const std::vector<Cell>& cells, size_t begin, size_t end, const ClimateParams& params, Fields& fields) const;
+    void classifyCell(Cell& cell, size_t i, const Fields& fields, const ClimateParams& params);
+
+    // Принимают заранее посчитанные пачкой значения шума
+    float calculateElevation(float fractalNoise);
+    float calculateTemperature(const QVector3D& position, float elevation, const ClimateParams& params, float tempNoise);
+    float calculateHumidity(float humidityNoise);
+    float calculatePressure(float pressureNoise);
+    float calculateOreDensity(float oreNoise, float elevation);
     uint8_t determineOreType(float oreDensity, float elevation);
     Biome determineBiome(float elevation, float temperature, float humidity, float seaLevel);
 };
\ No newline at end of file
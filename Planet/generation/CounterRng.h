@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+
+// Счётный генератор: каждое значение - чистая функция (seed, key, stream, counter).
+// Для key = id клетки результат не зависит от порядка обхода и числа потоков,
+// в отличие от глобального состояния std::rand.
+class CounterRng {
+public:
+    CounterRng(uint64_t seed, uint64_t key, uint32_t stream)
+        : base_(mix(mix(seed ^ 0x9E3779B97F4A7C15ull) ^ key) ^ (uint64_t(stream) << 32)) {}
+
+    uint32_t next() { return uint32_t(mix(base_ + 0x9E3779B97F4A7C15ull * ++counter_) >> 32); }
+
+    // [0, n), без заметного смещения для малых n
+    uint32_t below(uint32_t n) { return uint32_t((uint64_t(next()) * n) >> 32); }
+
+    // [0, 1)
+    float uniform() { return float(next() >> 8) * (1.0f / 16777216.0f); }
+
+    // splitmix64 finalizer
+    static uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint64_t base_;
+    uint64_t counter_ = 0;
+};
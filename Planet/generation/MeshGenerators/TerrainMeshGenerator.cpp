@@ -1,7 +1,8 @@
 #include "TerrainMeshGenerator.h"
 #include "renderers/TerrainTessellator.h"
 
-TerrainMesh TerrainMeshGenerator::buildTerrainMesh(const HexSphereModel& model, const TerrainMeshOptions& options) {
+namespace {
+TerrainTessellator makeTessellator(const TerrainMeshOptions& options) {
     TerrainTessellator tt;
     tt.R = options.radius;
     tt.heightStep = options.heightStep;
@@ -12,6 +13,20 @@ TerrainMesh TerrainMeshGenerator::buildTerrainMesh(const HexSphereModel& model,
     tt.doBlades = options.doBlades;
     tt.doCornerTris = options.doCornerTris;
     tt.doEdgeCliffs = options.doEdgeCliffs;
+    tt.indexedOutput = options.indexedOutput;
+    tt.threadCount = options.threadCount;
+    return tt;
+}
+}
+
+TerrainMesh TerrainMeshGenerator::buildTerrainMesh(const HexSphereModel& model, const TerrainMeshOptions& options) {
+    return makeTessellator(options).build(model);
+}
 
-    return tt.build(model);
+TerrainMeshPatch TerrainMeshGenerator::updateTerrainMesh(
+    const HexSphereModel& model,
+    const TerrainMeshOptions& options,
+    const std::vector<int>& dirtyCells,
+    TerrainMesh& mesh) {
+    return makeTessellator(options).retessellateCells(model, dirtyCells, mesh);
 }
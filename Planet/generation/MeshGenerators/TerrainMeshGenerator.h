@@ -13,9 +13,17 @@ struct TerrainMeshOptions {
     bool doBlades = true;
     bool doCornerTris = true;
     bool doEdgeCliffs = true;
+    bool indexedOutput = false; // shared vertices within a cell's top face
+    int threadCount = 0; // 0 - hardware concurrency
 };
 
 class TerrainMeshGenerator {
 public:
     static TerrainMesh buildTerrainMesh(const HexSphereModel& model, const TerrainMeshOptions& options);
+    // Patches a mesh built with the same options after edits to dirtyCells.
+    static TerrainMeshPatch updateTerrainMesh(
+        const HexSphereModel& model,
+        const TerrainMeshOptions& options,
+        const std::vector<int>& dirtyCells,
+        TerrainMesh& mesh);
 };
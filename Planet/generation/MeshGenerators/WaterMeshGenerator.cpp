@@ -1,16 +1,28 @@
 #include "WaterMeshGenerator.h"
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <limits>
+#include <unordered_map>
 
-WaterGeometryData WaterMeshGenerator::buildWaterGeometry(const HexSphereModel& model) {
+namespace {
+
+constexpr float SEA_LEVEL = 1.0f;
+constexpr int kMaxSubdivisions = 7;
+constexpr uint32_t kNoVertex = std::numeric_limits<uint32_t>::max();
+
+bool isWaterCell(const Cell& cell) {
+    return cell.biome == Biome::Sea && cell.poly.size() >= 3;
+}
+
+// Прежний генератор: рекурсия через std::function, каждый треугольник со своими вершинами
+WaterGeometryData buildLegacyWaterGeometry(const HexSphereModel& model, unsigned int subdivisions) {
     const auto& cells = model.cells();
     const auto& dual = model.dualVerts();
 
     WaterGeometryData data;
 
-    const float SEA_LEVEL = 1.0f;
-    const unsigned int WATER_SUBDIVISIONS = 3;
-
     std::function<void(const QVector3D&, const QVector3D&, const QVector3D&, float, float, float, unsigned int)> subdivideTriangle;
     subdivideTriangle = [&](const QVector3D& v0, const QVector3D& v1, const QVector3D& v2, float edge0, float edge1, float edge2, unsigned int level) {
         if (level <= 0) {
@@ -50,7 +62,7 @@ WaterGeometryData WaterMeshGenerator::buildWaterGeometry(const HexSphereModel& m
 
     for (size_t cellIdx = 0; cellIdx < cells.size(); ++cellIdx) {
         const auto& cell = cells[cellIdx];
-        if (cell.biome != Biome::Sea || cell.poly.size() < 3) {
+        if (!isWaterCell(cell)) {
             continue;
         }
 
@@ -69,9 +81,223 @@ WaterGeometryData WaterMeshGenerator::buildWaterGeometry(const HexSphereModel& m
         const size_t numVertices = vertices.size();
         for (size_t i = 0; i < numVertices; ++i) {
             size_t next_i = (i + 1) % numVertices;
-            subdivideTriangle(center, vertices[i], vertices[next_i], 0.0f, vertexEdgeFlags[i], vertexEdgeFlags[next_i], WATER_SUBDIVISIONS);
+            subdivideTriangle(center, vertices[i], vertices[next_i], 0.0f, vertexEdgeFlags[i], vertexEdgeFlags[next_i], subdivisions);
+        }
+    }
+
+    return data;
+}
+
+// Треугольная сетка одного треугольника веера (центр A, вершины B, C) со
+// стороной n = 2^depth. Точка (b, c) - барицентрические (n - b - c, b, c).
+// Заполняется от грубых шагов к мелким: новая точка - нормированная середина
+// двух точек грубого ребра, как в рекурсии, поэтому позиции совпадают побитно.
+class FanGrid {
+public:
+    void reset(int n, const QVector3D& a, const QVector3D& b, const QVector3D& c) {
+        n_ = n;
+        const size_t size = static_cast<size_t>(n + 1) * static_cast<size_t>(n + 1);
+        positions_.resize(size);
+        flags_.resize(size);
+        set(0, 0, a, 0.0f);
+        set(n, 0, b, 1.0f);
+        set(0, n, c, 1.0f);
+
+        for (int s = n / 2; s >= 1; s /= 2) {
+            for (int pb = 0; pb <= n; pb += s) {
+                for (int pc = 0; pb + pc <= n; pc += s) {
+                    const int pa = n - pb - pc;
+                    const bool oddB = (pb / s) % 2 != 0;
+                    const bool oddC = (pc / s) % 2 != 0;
+                    const bool oddA = (pa / s) % 2 != 0;
+                    if (!oddB && !oddC) continue; // точка грубого уровня
+
+                    // Ровно две координаты нечётны: ребро идёт вдоль третьей, постоянной
+                    int b0 = pb, c0 = pc, b1 = pb, c1 = pc;
+                    if (oddB && oddC) { b0 -= s; c0 += s; b1 += s; c1 -= s; }
+                    else if (oddB && oddA) { b0 -= s; b1 += s; }
+                    else { c0 -= s; c1 += s; }
+
+                    QVector3D mid = (position(b0, c0) + position(b1, c1)) * 0.5f;
+                    mid = mid.normalized() * SEA_LEVEL;
+                    set(pb, pc, mid, (flag(b0, c0) + flag(b1, c1)) * 0.5f);
+                }
+            }
+        }
+    }
+
+    const QVector3D& position(int b, int c) const { return positions_[at(b, c)]; }
+    float flag(int b, int c) const { return flags_[at(b, c)]; }
+
+private:
+    size_t at(int b, int c) const { return static_cast<size_t>(b) * static_cast<size_t>(n_ + 1) + static_cast<size_t>(c); }
+    void set(int b, int c, const QVector3D& p, float f) {
+        positions_[at(b, c)] = p;
+        flags_[at(b, c)] = f;
+    }
+
+    int n_ = 0;
+    std::vector<QVector3D> positions_;
+    std::vector<float> flags_;
+};
+
+WaterGeometryData buildIndexedWaterGeometry(const HexSphereModel& model, const WaterMeshOptions& options) {
+    const auto& cells = model.cells();
+    const auto& dual = model.dualVerts();
+
+    std::vector<int> regionOfCell;
+    const int regionCount = WaterMeshGenerator::waterRegions(model, regionOfCell);
+    const std::vector<int> depths = WaterMeshGenerator::regionSubdivisions(model, regionOfCell, regionCount, options);
+
+    WaterGeometryData data;
+    auto addVertex = [&data](const QVector3D& p, float flag) {
+        const uint32_t index = static_cast<uint32_t>(data.edgeFlags.size());
+        data.positions.insert(data.positions.end(), { p.x(), p.y(), p.z() });
+        data.edgeFlags.push_back(flag);
+        return index;
+    };
+
+    // Общие вершины: углы клеток по индексу dual, внутренние точки рёбер клеток
+    // по паре углов (от меньшего индекса), точки спиц центр-угол внутри клетки
+    std::vector<uint32_t> cornerVertex(dual.size(), kNoVertex);
+    std::unordered_map<uint64_t, uint32_t> edgeVertices;
+    std::vector<uint32_t> spokeVertices;
+    std::vector<uint32_t> gridVertex;
+    FanGrid grid;
+
+    for (size_t cellIdx = 0; cellIdx < cells.size(); ++cellIdx) {
+        const auto& cell = cells[cellIdx];
+        if (regionOfCell[cellIdx] < 0) {
+            continue;
+        }
+
+        const int n = 1 << depths[static_cast<size_t>(regionOfCell[cellIdx])];
+        const size_t corners = cell.poly.size();
+        const QVector3D center = cell.centroid.normalized() * SEA_LEVEL;
+        const uint32_t centerVertex = addVertex(center, 0.0f);
+        spokeVertices.assign(corners * static_cast<size_t>(n - 1), kNoVertex);
+
+        for (size_t i = 0; i < corners; ++i) {
+            const size_t next = (i + 1) % corners;
+            const uint32_t dualB = static_cast<uint32_t>(cell.poly[i]);
+            const uint32_t dualC = static_cast<uint32_t>(cell.poly[next]);
+            grid.reset(n, center, dual[dualB].normalized() * SEA_LEVEL, dual[dualC].normalized() * SEA_LEVEL);
+
+            // Внутренние точки ребра B-C: первая точка от меньшего угла
+            const uint64_t edgeKey = (uint64_t(std::min(dualB, dualC)) << 32) | uint64_t(std::max(dualB, dualC));
+            uint32_t edgeBase = kNoVertex;
+            if (n > 1) {
+                auto [it, inserted] = edgeVertices.try_emplace(edgeKey, kNoVertex);
+                if (inserted) {
+                    it->second = static_cast<uint32_t>(data.edgeFlags.size());
+                    for (int k = 1; k < n; ++k) {
+                        const int c = dualB < dualC ? k : n - k;
+                        addVertex(grid.position(n - c, c), grid.flag(n - c, c));
+                    }
+                }
+                edgeBase = it->second;
+            }
+
+            auto vertexAt = [&](int b, int c) -> uint32_t {
+                const int a = n - b - c;
+                if (a == n) return centerVertex;
+                if (b == n || c == n) {
+                    const uint32_t dualIndex = b == n ? dualB : dualC;
+                    uint32_t& corner = cornerVertex[dualIndex];
+                    if (corner == kNoVertex) corner = addVertex(grid.position(b, c), grid.flag(b, c));
+                    return corner;
+                }
+                if (a == 0) {
+                    return edgeBase + static_cast<uint32_t>(dualB < dualC ? c - 1 : n - c - 1);
+                }
+                if (c == 0 || b == 0) {
+                    const size_t spoke = c == 0 ? i : next;
+                    uint32_t& vertex = spokeVertices[spoke * static_cast<size_t>(n - 1) + static_cast<size_t>((c == 0 ? b : c) - 1)];
+                    if (vertex == kNoVertex) vertex = addVertex(grid.position(b, c), grid.flag(b, c));
+                    return vertex;
+                }
+                return addVertex(grid.position(b, c), grid.flag(b, c));
+            };
+
+            gridVertex.assign(static_cast<size_t>(n + 1) * static_cast<size_t>(n + 1), kNoVertex);
+            for (int b = 0; b <= n; ++b)
+                for (int c = 0; b + c <= n; ++c)
+                    gridVertex[static_cast<size_t>(b) * static_cast<size_t>(n + 1) + static_cast<size_t>(c)] = vertexAt(b, c);
+            auto index = [&](int b, int c) {
+                return gridVertex[static_cast<size_t>(b) * static_cast<size_t>(n + 1) + static_cast<size_t>(c)];
+            };
+
+            // Обход как у (A, B, C): "верхние" треугольники и перевёрнутые между ними
+            for (int b = 0; b < n; ++b) {
+                for (int c = 0; b + c < n; ++c) {
+                    data.indices.insert(data.indices.end(), { index(b, c), index(b + 1, c), index(b, c + 1) });
+                    if (b + c + 2 <= n) {
+                        data.indices.insert(data.indices.end(), { index(b + 1, c + 1), index(b, c + 1), index(b + 1, c) });
+                    }
+                }
+            }
         }
     }
 
     return data;
 }
+
+} // namespace
+
+int WaterMeshGenerator::waterRegions(const HexSphereModel& model, std::vector<int>& regionOfCell) {
+    const auto& cells = model.cells();
+    regionOfCell.assign(cells.size(), -1);
+    int regionCount = 0;
+    std::vector<int> stack;
+    for (size_t start = 0; start < cells.size(); ++start) {
+        if (regionOfCell[start] >= 0 || !isWaterCell(cells[start])) continue;
+        regionOfCell[start] = regionCount;
+        stack.push_back(static_cast<int>(start));
+        while (!stack.empty()) {
+            const int cellId = stack.back();
+            stack.pop_back();
+            for (int neighbor : cells[static_cast<size_t>(cellId)].neighbors) {
+                if (neighbor < 0 || regionOfCell[static_cast<size_t>(neighbor)] >= 0) continue;
+                if (!isWaterCell(cells[static_cast<size_t>(neighbor)])) continue;
+                regionOfCell[static_cast<size_t>(neighbor)] = regionCount;
+                stack.push_back(neighbor);
+            }
+        }
+        ++regionCount;
+    }
+    return regionCount;
+}
+
+std::vector<int> WaterMeshGenerator::regionSubdivisions(const HexSphereModel& model, const std::vector<int>& regionOfCell,
+    int regionCount, const WaterMeshOptions& options)
+{
+    const int maxDepth = std::clamp(options.subdivisions, 0, kMaxSubdivisions);
+    std::vector<int> depths(static_cast<size_t>(regionCount), maxDepth);
+    if (!options.cameraLod || regionCount == 0) {
+        return depths;
+    }
+
+    const int minDepth = std::clamp(options.minSubdivisions, 0, maxDepth);
+    std::vector<float> nearest(static_cast<size_t>(regionCount), std::numeric_limits<float>::max());
+    const auto& cells = model.cells();
+    for (size_t cellIdx = 0; cellIdx < cells.size(); ++cellIdx) {
+        const int region = regionOfCell[cellIdx];
+        if (region < 0) continue;
+        const float distance = (cells[cellIdx].centroid.normalized() * SEA_LEVEL - options.eye).length();
+        nearest[static_cast<size_t>(region)] = std::min(nearest[static_cast<size_t>(region)], distance);
+    }
+
+    const float lodDistance = std::max(options.lodDistance, 1e-4f);
+    for (size_t r = 0; r < depths.size(); ++r) {
+        const float doublings = std::floor(std::log2(std::max(nearest[r] / lodDistance, 1.0f)));
+        depths[r] = std::max(minDepth, maxDepth - static_cast<int>(std::min(doublings, float(kMaxSubdivisions))));
+    }
+    return depths;
+}
+
+WaterGeometryData WaterMeshGenerator::buildWaterGeometry(const HexSphereModel& model, const WaterMeshOptions& options) {
+    if (options.mode == WaterMeshOptions::Mode::Legacy) {
+        return buildLegacyWaterGeometry(model, static_cast<unsigned int>(std::clamp(options.subdivisions, 0, kMaxSubdivisions)));
+    }
+    return buildIndexedWaterGeometry(model, options);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <QVector3D>
+
 #include <vector>
 #include <cstdint>
 
@@ -12,7 +14,31 @@ struct WaterGeometryData {
     std::vector<uint32_t> indices;
 };
 
+struct WaterMeshOptions {
+    // Legacy - прежняя рекурсивная разбивка, по три своих вершины на треугольник;
+    // Indexed - та же поверхность, но вершины на общих рёбрах общие
+    enum class Mode { Legacy, Indexed };
+    Mode mode = Mode::Indexed;
+
+    // Глубина разбивки треугольника клетки (4^n треугольников) - настройка качества
+    int subdivisions = 3;
+    // Indexed: глубина выбирается на каждую связную область воды по расстоянию
+    // от eye до её ближайшей клетки - каждое удвоение сверх lodDistance
+    // снимает один уровень, но не ниже minSubdivisions. Внутри области глубина
+    // одна, а разные области общих рёбер не имеют, поэтому швов нет.
+    bool cameraLod = false;
+    QVector3D eye;
+    float lodDistance = 0.5f;
+    int minSubdivisions = 1;
+};
+
 class WaterMeshGenerator {
 public:
-    static WaterGeometryData buildWaterGeometry(const HexSphereModel& model);
+    static WaterGeometryData buildWaterGeometry(const HexSphereModel& model, const WaterMeshOptions& options = {});
+
+    // Связные области клеток Biome::Sea (-1 у остальных); возвращает их число
+    static int waterRegions(const HexSphereModel& model, std::vector<int>& regionOfCell);
+    // Глубина разбивки каждой области для options
+    static std::vector<int> regionSubdivisions(const HexSphereModel& model, const std::vector<int>& regionOfCell,
+        int regionCount, const WaterMeshOptions& options);
 };
@@ -1,5 +1,24 @@
 #include "generation/PerlinNoise.h"
 
+#include <algorithm>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define PERLIN_X64 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC/Clang компилируют AVX2-ядро только с атрибутом target; MSVC пускает
+// интринсики в любую функцию, выбор ядра всё равно идёт по CPUID.
+#if defined(PERLIN_X64) && (defined(__GNUC__) || defined(__clang__))
+#define PERLIN_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define PERLIN_AVX2_TARGET
+#endif
+
 Perlin3D::Perlin3D(unsigned seed) {
     // простейший детерминированный псевдорандом
     for (int i = 0; i < 256; i++) perm[i] = i;
@@ -47,4 +66,345 @@ double Perlin3D::noise(double x, double y, double z) const {
                 grad(perm[BB + 1], x - 1, y - 1, z - 1), u),
             v),
         w);
-}
\ No newline at end of file
+}
+
+// ── batched float ───────────────────────────────────────────────────────────
+namespace {
+
+    struct OctaveStep {
+        float frequency;
+        float amplitude;
+    };
+
+    // Частоты/веса октав и нормировка считаются один раз на вызов
+    struct FractalPlan {
+        std::array<OctaveStep, 16> octaves{};
+        int count = 0;
+        float invAmplitude = 1.0f;
+        float offset[3] = { 0.0f, 0.0f, 0.0f };
+    };
+
+    FractalPlan makePlan(const PerlinFractal& fractal) {
+        FractalPlan plan;
+        plan.count = std::clamp(fractal.octaves, 1, static_cast<int>(plan.octaves.size()));
+        float frequency = fractal.frequency;
+        float amplitude = 1.0f;
+        float total = 0.0f;
+        for (int i = 0; i < plan.count; ++i) {
+            plan.octaves[i] = { frequency, amplitude };
+            total += amplitude;
+            frequency *= fractal.lacunarity;
+            amplitude *= fractal.gain;
+        }
+        plan.invAmplitude = total != 0.0f ? 1.0f / total : 1.0f;
+        plan.offset[0] = fractal.offsetX;
+        plan.offset[1] = fractal.offsetY;
+        plan.offset[2] = fractal.offsetZ;
+        return plan;
+    }
+
+    inline float fadeF(float t) { return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f); }
+    inline float lerpF(float a, float b, float t) { return a + t * (b - a); }
+    inline float gradF(int h, float x, float y, float z) {
+        const int g = h & 15;
+        const float u = g < 8 ? x : y;
+        const float v = g < 4 ? y : (g == 12 || g == 14 ? x : z);
+        return ((g & 1) ? -u : u) + ((g & 2) ? -v : v);
+    }
+
+    float noiseScalar(const int* perm, float x, float y, float z) {
+        const float fx = std::floor(x), fy = std::floor(y), fz = std::floor(z);
+        const int X = static_cast<int>(fx) & 255;
+        const int Y = static_cast<int>(fy) & 255;
+        const int Z = static_cast<int>(fz) & 255;
+        x -= fx; y -= fy; z -= fz;
+        const float u = fadeF(x), v = fadeF(y), w = fadeF(z);
+        const int A = perm[X] + Y, AA = perm[A] + Z, AB = perm[A + 1] + Z;
+        const int B = perm[X + 1] + Y, BA = perm[B] + Z, BB = perm[B + 1] + Z;
+
+        return lerpF(
+            lerpF(
+                lerpF(gradF(perm[AA], x, y, z), gradF(perm[BA], x - 1, y, z), u),
+                lerpF(gradF(perm[AB], x, y - 1, z), gradF(perm[BB], x - 1, y - 1, z), u),
+                v),
+            lerpF(
+                lerpF(gradF(perm[AA + 1], x, y, z - 1), gradF(perm[BA + 1], x - 1, y, z - 1), u),
+                lerpF(gradF(perm[AB + 1], x, y - 1, z - 1), gradF(perm[BB + 1], x - 1, y - 1, z - 1), u),
+                v),
+            w);
+    }
+
+    void fractalScalar(const int* perm, const float* xs, const float* ys, const float* zs, float* out,
+        size_t begin, size_t end, const FractalPlan& plan)
+    {
+        for (size_t i = begin; i < end; ++i) {
+            float sum = 0.0f;
+            for (int o = 0; o < plan.count; ++o) {
+                const OctaveStep& step = plan.octaves[o];
+                sum += step.amplitude * noiseScalar(perm,
+                    xs[i] * step.frequency + plan.offset[0],
+                    ys[i] * step.frequency + plan.offset[1],
+                    zs[i] * step.frequency + plan.offset[2]);
+            }
+            out[i] = sum * plan.invAmplitude;
+        }
+    }
+
+#if defined(PERLIN_X64)
+    // ── SSE2: 4 lanes, таблица читается по-скалярному ──
+    inline __m128 select4(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    inline __m128i lookup4(const int* perm, __m128i idx) {
+        alignas(16) int lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), idx);
+        return _mm_setr_epi32(perm[lanes[0]], perm[lanes[1]], perm[lanes[2]], perm[lanes[3]]);
+    }
+
+    inline __m128 grad4(__m128i h, __m128 x, __m128 y, __m128 z) {
+        h = _mm_and_si128(h, _mm_set1_epi32(15));
+        const __m128 lt8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+        const __m128 lt4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+        const __m128 useX = _mm_castsi128_ps(_mm_or_si128(
+            _mm_cmpeq_epi32(h, _mm_set1_epi32(12)), _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+        const __m128 u = select4(lt8, x, y);
+        const __m128 v = select4(lt4, y, select4(useX, x, z));
+        const __m128 signU = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), 31));
+        const __m128 signV = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), 30));
+        return _mm_add_ps(_mm_xor_ps(u, signU), _mm_xor_ps(v, signV));
+    }
+
+    inline __m128 fade4(__m128 t) {
+        const __m128 inner = _mm_add_ps(_mm_mul_ps(t, _mm_sub_ps(_mm_mul_ps(t, _mm_set1_ps(6.0f)), _mm_set1_ps(15.0f))),
+            _mm_set1_ps(10.0f));
+        return _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(t, t), t), inner);
+    }
+
+    inline __m128 lerp4(__m128 a, __m128 b, __m128 t) {
+        return _mm_add_ps(a, _mm_mul_ps(t, _mm_sub_ps(b, a)));
+    }
+
+    // floor без SSE4.1: усечение и поправка для отрицательных дробных
+    inline __m128i floor4(__m128 v, __m128& floored) {
+        const __m128i truncated = _mm_cvttps_epi32(v);
+        const __m128 t = _mm_cvtepi32_ps(truncated);
+        const __m128 fix = _mm_cmpgt_ps(t, v);
+        floored = _mm_sub_ps(t, _mm_and_ps(fix, _mm_set1_ps(1.0f)));
+        return _mm_add_epi32(truncated, _mm_castps_si128(fix));
+    }
+
+    inline __m128 noise4(const int* perm, __m128 x, __m128 y, __m128 z) {
+        __m128 fx, fy, fz;
+        const __m128i byte = _mm_set1_epi32(255);
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i X = _mm_and_si128(floor4(x, fx), byte);
+        const __m128i Y = _mm_and_si128(floor4(y, fy), byte);
+        const __m128i Z = _mm_and_si128(floor4(z, fz), byte);
+        x = _mm_sub_ps(x, fx); y = _mm_sub_ps(y, fy); z = _mm_sub_ps(z, fz);
+        const __m128 u = fade4(x), v = fade4(y), w = fade4(z);
+
+        const __m128i A = _mm_add_epi32(lookup4(perm, X), Y);
+        const __m128i AA = _mm_add_epi32(lookup4(perm, A), Z);
+        const __m128i AB = _mm_add_epi32(lookup4(perm, _mm_add_epi32(A, one)), Z);
+        const __m128i B = _mm_add_epi32(lookup4(perm, _mm_add_epi32(X, one)), Y);
+        const __m128i BA = _mm_add_epi32(lookup4(perm, B), Z);
+        const __m128i BB = _mm_add_epi32(lookup4(perm, _mm_add_epi32(B, one)), Z);
+
+        const __m128 c1 = _mm_set1_ps(1.0f);
+        const __m128 x1 = _mm_sub_ps(x, c1), y1 = _mm_sub_ps(y, c1), z1 = _mm_sub_ps(z, c1);
+        return lerp4(
+            lerp4(
+                lerp4(grad4(lookup4(perm, AA), x, y, z), grad4(lookup4(perm, BA), x1, y, z), u),
+                lerp4(grad4(lookup4(perm, AB), x, y1, z), grad4(lookup4(perm, BB), x1, y1, z), u),
+                v),
+            lerp4(
+                lerp4(grad4(lookup4(perm, _mm_add_epi32(AA, one)), x, y, z1),
+                    grad4(lookup4(perm, _mm_add_epi32(BA, one)), x1, y, z1), u),
+                lerp4(grad4(lookup4(perm, _mm_add_epi32(AB, one)), x, y1, z1),
+                    grad4(lookup4(perm, _mm_add_epi32(BB, one)), x1, y1, z1), u),
+                v),
+            w);
+    }
+
+    size_t fractalSse2(const int* perm, const float* xs, const float* ys, const float* zs, float* out,
+        size_t n, const FractalPlan& plan)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const __m128 px = _mm_loadu_ps(xs + i), py = _mm_loadu_ps(ys + i), pz = _mm_loadu_ps(zs + i);
+            __m128 sum = _mm_setzero_ps();
+            for (int o = 0; o < plan.count; ++o) {
+                const __m128 f = _mm_set1_ps(plan.octaves[o].frequency);
+                const __m128 value = noise4(perm,
+                    _mm_add_ps(_mm_mul_ps(px, f), _mm_set1_ps(plan.offset[0])),
+                    _mm_add_ps(_mm_mul_ps(py, f), _mm_set1_ps(plan.offset[1])),
+                    _mm_add_ps(_mm_mul_ps(pz, f), _mm_set1_ps(plan.offset[2])));
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(plan.octaves[o].amplitude), value));
+            }
+            _mm_storeu_ps(out + i, _mm_mul_ps(sum, _mm_set1_ps(plan.invAmplitude)));
+        }
+        return i;
+    }
+
+    // ── AVX2: 8 lanes, gather по perm ──
+    PERLIN_AVX2_TARGET inline __m256 grad8(__m256i h, __m256 x, __m256 y, __m256 z) {
+        h = _mm256_and_si256(h, _mm256_set1_epi32(15));
+        const __m256 lt8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+        const __m256 lt4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+        const __m256 useX = _mm256_castsi256_ps(_mm256_or_si256(
+            _mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)), _mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))));
+        const __m256 u = _mm256_blendv_ps(y, x, lt8);
+        const __m256 v = _mm256_blendv_ps(_mm256_blendv_ps(z, x, useX), y, lt4);
+        const __m256 signU = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(1)), 31));
+        const __m256 signV = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(h, _mm256_set1_epi32(2)), 30));
+        return _mm256_add_ps(_mm256_xor_ps(u, signU), _mm256_xor_ps(v, signV));
+    }
+
+    PERLIN_AVX2_TARGET inline __m256 fade8(__m256 t) {
+        const __m256 inner = _mm256_add_ps(
+            _mm256_mul_ps(t, _mm256_sub_ps(_mm256_mul_ps(t, _mm256_set1_ps(6.0f)), _mm256_set1_ps(15.0f))),
+            _mm256_set1_ps(10.0f));
+        return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), inner);
+    }
+
+    PERLIN_AVX2_TARGET inline __m256 lerp8(__m256 a, __m256 b, __m256 t) {
+        return _mm256_add_ps(a, _mm256_mul_ps(t, _mm256_sub_ps(b, a)));
+    }
+
+    PERLIN_AVX2_TARGET inline __m256i gather8(const int* perm, __m256i idx) {
+        return _mm256_i32gather_epi32(perm, idx, 4);
+    }
+
+    PERLIN_AVX2_TARGET inline __m256 noise8(const int* perm, __m256 x, __m256 y, __m256 z) {
+        const __m256 fx = _mm256_floor_ps(x), fy = _mm256_floor_ps(y), fz = _mm256_floor_ps(z);
+        const __m256i byte = _mm256_set1_epi32(255);
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i X = _mm256_and_si256(_mm256_cvttps_epi32(fx), byte);
+        const __m256i Y = _mm256_and_si256(_mm256_cvttps_epi32(fy), byte);
+        const __m256i Z = _mm256_and_si256(_mm256_cvttps_epi32(fz), byte);
+        x = _mm256_sub_ps(x, fx); y = _mm256_sub_ps(y, fy); z = _mm256_sub_ps(z, fz);
+        const __m256 u = fade8(x), v = fade8(y), w = fade8(z);
+
+        const __m256i A = _mm256_add_epi32(gather8(perm, X), Y);
+        const __m256i AA = _mm256_add_epi32(gather8(perm, A), Z);
+        const __m256i AB = _mm256_add_epi32(gather8(perm, _mm256_add_epi32(A, one)), Z);
+        const __m256i B = _mm256_add_epi32(gather8(perm, _mm256_add_epi32(X, one)), Y);
+        const __m256i BA = _mm256_add_epi32(gather8(perm, B), Z);
+        const __m256i BB = _mm256_add_epi32(gather8(perm, _mm256_add_epi32(B, one)), Z);
+
+        const __m256 c1 = _mm256_set1_ps(1.0f);
+        const __m256 x1 = _mm256_sub_ps(x, c1), y1 = _mm256_sub_ps(y, c1), z1 = _mm256_sub_ps(z, c1);
+        return lerp8(
+            lerp8(
+                lerp8(grad8(gather8(perm, AA), x, y, z), grad8(gather8(perm, BA), x1, y, z), u),
+                lerp8(grad8(gather8(perm, AB), x, y1, z), grad8(gather8(perm, BB), x1, y1, z), u),
+                v),
+            lerp8(
+                lerp8(grad8(gather8(perm, _mm256_add_epi32(AA, one)), x, y, z1),
+                    grad8(gather8(perm, _mm256_add_epi32(BA, one)), x1, y, z1), u),
+                lerp8(grad8(gather8(perm, _mm256_add_epi32(AB, one)), x, y1, z1),
+                    grad8(gather8(perm, _mm256_add_epi32(BB, one)), x1, y1, z1), u),
+                v),
+            w);
+    }
+
+    PERLIN_AVX2_TARGET size_t fractalAvx2(const int* perm, const float* xs, const float* ys, const float* zs,
+        float* out, size_t n, const FractalPlan& plan)
+    {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            const __m256 px = _mm256_loadu_ps(xs + i), py = _mm256_loadu_ps(ys + i), pz = _mm256_loadu_ps(zs + i);
+            __m256 sum = _mm256_setzero_ps();
+            for (int o = 0; o < plan.count; ++o) {
+                const __m256 f = _mm256_set1_ps(plan.octaves[o].frequency);
+                const __m256 value = noise8(perm,
+                    _mm256_add_ps(_mm256_mul_ps(px, f), _mm256_set1_ps(plan.offset[0])),
+                    _mm256_add_ps(_mm256_mul_ps(py, f), _mm256_set1_ps(plan.offset[1])),
+                    _mm256_add_ps(_mm256_mul_ps(pz, f), _mm256_set1_ps(plan.offset[2])));
+                sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(plan.octaves[o].amplitude), value));
+            }
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(sum, _mm256_set1_ps(plan.invAmplitude)));
+        }
+        return i;
+    }
+
+    bool cpuHasAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        const bool osxsave = (info[2] & (1 << 27)) != 0;
+        const bool avx = (info[2] & (1 << 28)) != 0;
+        if (!osxsave || !avx) return false;
+        // ОС должна сохранять YMM-регистры
+        if ((_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif // PERLIN_X64
+
+} // namespace
+
+PerlinBackend Perlin3D::resolveBackend(PerlinBackend requested) {
+#if defined(PERLIN_X64)
+    static const bool hasAvx2 = cpuHasAvx2();
+    switch (requested) {
+    case PerlinBackend::Scalar:
+        return PerlinBackend::Scalar;
+    case PerlinBackend::SSE2:
+        return PerlinBackend::SSE2;
+    case PerlinBackend::AVX2:
+    case PerlinBackend::Auto:
+    default:
+        return hasAvx2 ? PerlinBackend::AVX2 : PerlinBackend::SSE2;
+    }
+#else
+    (void)requested;
+    return PerlinBackend::Scalar;
+#endif
+}
+
+const char* Perlin3D::backendName(PerlinBackend backend) {
+    switch (backend) {
+    case PerlinBackend::Scalar: return "scalar";
+    case PerlinBackend::SSE2: return "sse2";
+    case PerlinBackend::AVX2: return "avx2";
+    case PerlinBackend::Auto:
+    default: return "auto";
+    }
+}
+
+void Perlin3D::noiseBatch(const float* x, const float* y, const float* z, float* out, size_t n,
+    PerlinBackend backend) const
+{
+    fractalBatch(x, y, z, out, n, PerlinFractal{}, backend);
+}
+
+void Perlin3D::fractalBatch(const float* x, const float* y, const float* z, float* out, size_t n,
+    const PerlinFractal& fractal, PerlinBackend backend) const
+{
+    const FractalPlan plan = makePlan(fractal);
+    size_t done = 0;
+#if defined(PERLIN_X64)
+    switch (resolveBackend(backend)) {
+    case PerlinBackend::AVX2:
+        done = fractalAvx2(perm.data(), x, y, z, out, n, plan);
+        break;
+    case PerlinBackend::SSE2:
+        done = fractalSse2(perm.data(), x, y, z, out, n, plan);
+        break;
+    default:
+        break;
+    }
+#else
+    (void)backend;
+#endif
+    // Хвост (и всё при Scalar) - тем же float-алгоритмом
+    fractalScalar(perm.data(), x, y, z, out, done, n, plan);
+}
@@ -1,16 +1,49 @@
 #pragma once
 #include <cmath>
 #include <array>
+#include <cstddef>
+
+// Параметры фрактального шума: сумма octaves октав, частота точки p на
+// октаве i = frequency * lacunarity^i, вес = gain^i; результат делится на
+// сумму весов. offset прибавляется к уже масштабированной точке.
+struct PerlinFractal {
+    float frequency = 1.0f;
+    int octaves = 1;
+    float lacunarity = 2.0f;
+    float gain = 0.5f;
+    float offsetX = 0.0f;
+    float offsetY = 0.0f;
+    float offsetZ = 0.0f;
+};
+
+enum class PerlinBackend {
+    Auto,   // лучший из доступных на этом CPU
+    Scalar,
+    SSE2,   // 4 lanes
+    AVX2,   // 8 lanes, gather по таблице перестановок
+};
 
 class Perlin3D {
 public:
     Perlin3D(unsigned seed = 2024);
     double noise(double x, double y, double z) const;
 
+    // Batched single-precision evaluation of n points (SoA input).
+    // Matches noise() to float rounding; unsupported backends fall back.
+    void noiseBatch(const float* x, const float* y, const float* z, float* out, size_t n,
+        PerlinBackend backend = PerlinBackend::Auto) const;
+    // All octaves of one point in one pass, see PerlinFractal.
+    void fractalBatch(const float* x, const float* y, const float* z, float* out, size_t n,
+        const PerlinFractal& fractal, PerlinBackend backend = PerlinBackend::Auto) const;
+
+    // Backend that Auto (or the requested one) resolves to on this machine
+    static PerlinBackend resolveBackend(PerlinBackend requested = PerlinBackend::Auto);
+    static const char* backendName(PerlinBackend backend);
+
 private:
     static double fade(double t);
     static double lerp(double a, double b, double t);
     static double grad(int h, double x, double y, double z);
 
     std::array<int, 512> perm;
-};
\ No newline at end of file
+};
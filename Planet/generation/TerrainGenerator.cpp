@@ -4,6 +4,8 @@
 #include "generation/PerlinNoise.h"
 #include "dag/DataAdapters.h"
 #include <cmath>
+#include <utility>
+#include <vector>
 #include <QString>
 
 int normalizeTerrainGeneratorIndex(int idx) {
@@ -92,28 +94,20 @@ void PerlinTerrainGenerator::generate(HexSphereModel& model, const TerrainParams
     const int n = model.cellCount();
     Perlin3D noise(params.seed);
 
+    const auto& cells = std::as_const(model).cells();
+    std::vector<float> xs(n), ys(n), zs(n), heights(n);
     for (int cid = 0; cid < n; ++cid) {
-        const auto& cell = model.cells()[cid];
-        QVector3D point = cell.centroid.normalized();
-
-        float h = 0.0f;
-        float amplitude = 1.0f;
-        float frequency = 1.0f;
-        float maxAmplitude = 0.0f;
-
-        for (int i = 0; i < 4; i++) {
-            h += amplitude * noise.noise(
-                point.x() * frequency,
-                point.y() * frequency,
-                point.z() * frequency
-            );
-            maxAmplitude += amplitude;
-            amplitude *= 0.5f;
-            frequency *= 2.0f;
-        }
+        const QVector3D point = cells[cid].centroid.normalized();
+        xs[cid] = point.x();
+        ys[cid] = point.y();
+        zs[cid] = point.z();
+    }
+    PerlinFractal fractal;
+    fractal.octaves = 4;
+    noise.fractalBatch(xs.data(), ys.data(), zs.data(), heights.data(), static_cast<size_t>(n), fractal);
 
-        h /= maxAmplitude;
-        float heightValue = h * 3.0f;
+    for (int cid = 0; cid < n; ++cid) {
+        float heightValue = heights[cid] * 3.0f;
         converters::HeightSample sample{ heightValue };
         int discreteHeight = converters::HeightmapAdapter::toDiscreteHeight(sample, 1.0f, static_cast<float>(params.seaLevel));
         model.setHeight(cid, discreteHeight);
@@ -140,6 +134,7 @@ void ClimateBiomeTerrainGenerator::generate(HexSphereModel& model, const Terrain
     climateParams.temperatureScale = p.scale * 0.8f;
     climateParams.humidityScale = p.scale * 1.2f;
     climateParams.seaLevel = p.seaLevel * 0.1f;
+    climateParams.mode = ClimateBiomeGenerator::ClimateParams::Mode::Parallel;
 
     climateGenerator.generate(model, climateParams);
 }
@@ -76,34 +76,60 @@ static inline QVector3D triCenter(const QVector3D& a, const QVector3D& b, const
     QVector3D m = (a + b + c) / 3.0f; m.normalize(); return m;
 }
 
-void HexSphereModel::rebuildFromIcosphere(const IcoMesh& ico) {
-    L_ = 0; // we don't store level; optional
+void SphereTopology::bindCells() {
+    cells.assign(csr.cellCount(), Cell{});
+    for (size_t c = 0; c < cells.size(); ++c) {
+        Cell& cell = cells[c];
+        cell.id = int(c);
+        cell.poly = csr.poly(int(c));
+        cell.neighbors = csr.neighborsOf(int(c));
+        cell.isPentagon = (cell.poly.size() == 5);
+        cell.centroid = csr.centroids[c];
+
+        // Инициализируем климатические данные
+        cell.temperature = 0.5f;
+        cell.humidity = 0.5f;
+        cell.pressure = 0.5f;
+        cell.oreDensity = 0.0f;
+        cell.oreType = 0;
+    }
+}
+
+std::shared_ptr<const SphereTopology> SphereTopology::fromIcosphere(const IcoMesh& ico, int level) {
+    auto topo = std::make_shared<SphereTopology>();
+    topo->level = level;
+    auto& dualVerts = topo->dualVerts;
+    CellTopology& csr = topo->csr;
+
     // 1) Dual vertices: one per primal triangle (center on sphere)
-    dualVerts_.resize(ico.F.size());
+    dualVerts.resize(ico.F.size());
     for (int i = 0; i < (int)ico.F.size(); ++i) {
         const auto& t = ico.F[i];
-        dualVerts_[i] = triCenter(ico.P[t.a], ico.P[t.b], ico.P[t.c]);
+        dualVerts[i] = triCenter(ico.P[t.a], ico.P[t.b], ico.P[t.c]);
     }
 
-    dualOwners_.resize(ico.F.size());
+    topo->dualOwners.resize(ico.F.size());
     for (int f = 0; f < (int)ico.F.size(); ++f) {
         const auto& t = ico.F[f];
-        dualOwners_[f] = { t.a, t.b, t.c };
+        topo->dualOwners[f] = { t.a, t.b, t.c };
     }
 
-    // 2) Build cells: one per primal vertex
-    cells_.clear(); cells_.resize(ico.P.size());
-    pentCount_ = 0;
+    // 2) Build cells: one per primal vertex, straight into the CSR arrays
+    csr.offsets.reserve(ico.P.size() + 1);
+    csr.polyVerts.reserve(ico.F.size() * 3);
+    csr.neighbors.reserve(ico.F.size() * 3);
+    csr.centroids.reserve(ico.P.size());
+    topo->pentagonCount = 0;
+    struct AngFace { float ang; int f; };
+    std::vector<AngFace> angs;
     for (int v = 0; v < (int)ico.P.size(); ++v) {
-        auto& cell = cells_[v]; cell.id = v;
         const auto& faces = ico.incidentFaces[v];
         const QVector3D n = ico.P[v].normalized();
         // Build a tangent frame (u,v) around normal n
         QVector3D u = std::abs(QVector3D::dotProduct(n, QVector3D(0, 1, 0))) < 0.9f ? QVector3D(0, 1, 0) : QVector3D(1, 0, 0);
         u = QVector3D::crossProduct(u, n).normalized();
         QVector3D v2 = QVector3D::crossProduct(n, u);
-        struct AngFace { float ang; int f; };
-        std::vector<AngFace> angs; angs.reserve(faces.size());
+        angs.clear();
         for (int f : faces) {
             const auto& tr = ico.F[f];
             QVector3D c = triCenter(ico.P[tr.a], ico.P[tr.b], ico.P[tr.c]);
@@ -114,17 +140,15 @@ void HexSphereModel::rebuildFromIcosphere(const IcoMesh& ico) {
             angs.push_back({ ang, f });
         }
         std::sort(angs.begin(), angs.end(), [](const AngFace& a, const AngFace& b) {return a.ang < b.ang; });
-        cell.poly.reserve(angs.size());
-        for (auto& af : angs) cell.poly.push_back(af.f); // dual vertex index == face index
-        cell.isPentagon = (cell.poly.size() == 5);
-        if (cell.isPentagon) ++pentCount_;
+        const size_t begin = csr.polyVerts.size();
+        for (auto& af : angs) csr.polyVerts.push_back(af.f); // dual vertex index == face index
+        const std::span<const int> poly(csr.polyVerts.data() + begin, angs.size());
+        if (poly.size() == 5) ++topo->pentagonCount;
 
         // Neighbors in CCW order: for each consecutive pair of faces around v, find the opposite vertex
-        cell.neighbors.reserve(cell.poly.size());
-
-        for (size_t i = 0; i < cell.poly.size(); ++i) {
-            int f0 = cell.poly[i];
-            int f1 = cell.poly[(i + 1) % cell.poly.size()];
+        for (size_t i = 0; i < poly.size(); ++i) {
+            int f0 = poly[i];
+            int f1 = poly[(i + 1) % poly.size()];
             const Tri& T0 = ico.F[f0];
             const Tri& T1 = ico.F[f1];
             // Find the shared edge that includes primal vertex v and some neighbor w
@@ -137,103 +161,175 @@ void HexSphereModel::rebuildFromIcosphere(const IcoMesh& ico) {
                 }
                 if (commonOther != -1) break;
             }
-            cell.neighbors.push_back(commonOther);
+            csr.neighbors.push_back(commonOther);
         }
 
         // Centroid (on sphere)
         QVector3D sum(0, 0, 0);
-        for (int f : cell.poly) sum += dualVerts_[f];
-        if (!cell.poly.empty()) sum /= float(cell.poly.size());
+        for (int f : poly) sum += dualVerts[f];
+        if (!poly.empty()) sum /= float(poly.size());
         if (!sum.isNull()) sum.normalize();
-        cell.centroid = sum;
-
-        // Инициализируем климатические данные
-        cell.temperature = 0.5f;
-        cell.humidity = 0.5f;
-        cell.pressure = 0.5f;
-        cell.oreDensity = 0.0f;
-        cell.oreType = 0;
+        csr.centroids.push_back(sum);
+        csr.offsets.push_back(uint32_t(csr.polyVerts.size()));
     }
 
     // 3) Build unique wire edges of the dual mesh
     std::unordered_set<EdgeKey, EdgeKeyHash> E;
-    E.reserve(cells_.size() * 6);
-    for (const auto& cell : cells_) {
-        for (size_t i = 0; i < cell.poly.size(); ++i) {
-            int a = cell.poly[i];
-            int b = cell.poly[(i + 1) % cell.poly.size()];
+    E.reserve(csr.cellCount() * 6);
+    for (int c = 0; c < int(csr.cellCount()); ++c) {
+        const auto poly = csr.poly(c);
+        for (size_t i = 0; i < poly.size(); ++i) {
+            int a = poly[i];
+            int b = poly[(i + 1) % poly.size()];
             EdgeKey ek(a, b); E.insert(ek);
         }
     }
-    wireEdges_.clear(); wireEdges_.reserve(E.size());
+    topo->wireEdges.clear(); topo->wireEdges.reserve(E.size());
     for (const auto& ek : E) {
         int a = int(ek.k >> 32);
         int b = int(ek.k & 0xffffffffu);
-        wireEdges_.push_back({ a,b });
+        topo->wireEdges.push_back({ a,b });
     }
 
     // 4) Build triangle fans for picking (center + edges) per cell
-    pickTris_.clear();
-    for (const auto& cell : cells_) {
-        if (cell.poly.size() < 3) continue;
+    topo->pickTris.clear();
+    for (int c = 0; c < int(csr.cellCount()); ++c) {
+        const auto poly = csr.poly(c);
+        if (poly.size() < 3) continue;
         QVector3D center(0, 0, 0);
-        for (int f : cell.poly) center += dualVerts_[f];
-        center /= float(cell.poly.size());
+        for (int f : poly) center += dualVerts[f];
+        center /= float(poly.size());
         if (!center.isNull()) center.normalize();
-        for (size_t i = 0; i < cell.poly.size(); ++i) {
-            int i0 = cell.poly[i];
-            int i1 = cell.poly[(i + 1) % cell.poly.size()];
-            PickTri pt; pt.cellId = cell.id; pt.v0 = center; pt.v1 = dualVerts_[i0]; pt.v2 = dualVerts_[i1];
-            pickTris_.push_back(pt);
+        for (size_t i = 0; i < poly.size(); ++i) {
+            int i0 = poly[i];
+            int i1 = poly[(i + 1) % poly.size()];
+            PickTri pt; pt.cellId = c; pt.v0 = center; pt.v1 = dualVerts[i0]; pt.v2 = dualVerts[i1];
+            topo->pickTris.push_back(pt);
         }
     }
+
+    topo->bindCells();
+    return topo;
+}
+
+std::shared_ptr<const SphereTopology> SphereTopology::fromCells(std::vector<CellShape> cells, std::vector<QVector3D> dualVerts) {
+    auto topo = std::make_shared<SphereTopology>();
+    topo->dualVerts = std::move(dualVerts);
+    CellTopology& csr = topo->csr;
+    for (const CellShape& cell : cells) {
+        csr.polyVerts.insert(csr.polyVerts.end(), cell.poly.begin(), cell.poly.end());
+        // neighbors may be shorter than poly; pad with -1
+        for (size_t i = 0; i < cell.poly.size(); ++i)
+            csr.neighbors.push_back(i < cell.neighbors.size() ? cell.neighbors[i] : -1);
+        csr.centroids.push_back(cell.centroid);
+        csr.offsets.push_back(uint32_t(csr.polyVerts.size()));
+        if (cell.poly.size() == 5) ++topo->pentagonCount;
+    }
+    topo->bindCells();
+    return topo;
+}
+
+const std::shared_ptr<const SphereTopology>& SphereTopology::empty() {
+    static const std::shared_ptr<const SphereTopology> instance = std::make_shared<SphereTopology>();
+    return instance;
+}
+
+void HexSphereModel::rebuildFromIcosphere(const IcoMesh& ico) {
+    rebuildFromTopology(SphereTopology::fromIcosphere(ico));
+}
+
+void HexSphereModel::rebuildFromTopology(std::shared_ptr<const SphereTopology> topology) {
+    shared_ = topology ? std::move(topology) : SphereTopology::empty();
+    cells_ = shared_->cells;
+    columns_.dirty = true;
+}
+
+const CellColumns& HexSphereModel::columns() const {
+    if (columns_.dirty.load(std::memory_order_acquire)) syncColumns();
+    return columns_.data;
+}
+
+void HexSphereModel::syncColumns() const {
+    std::lock_guard<std::mutex> lock(columns_.mutex);
+    if (!columns_.dirty.load(std::memory_order_relaxed)) return; // собрал другой поток
+
+    CellColumns& columns = columns_.data;
+    const size_t n = cells_.size();
+    columns.height.resize(n);
+    columns.biome.resize(n);
+    columns.temperature.resize(n);
+    columns.humidity.resize(n);
+    columns.pressure.resize(n);
+    columns.oreDensity.resize(n);
+    columns.oreType.resize(n);
+    columns.stateMask.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        const Cell& cell = cells_[i];
+        columns.height[i] = cell.height;
+        columns.biome[i] = cell.biome;
+        columns.temperature[i] = cell.temperature;
+        columns.humidity[i] = cell.humidity;
+        columns.pressure[i] = cell.pressure;
+        columns.oreDensity[i] = cell.oreDensity;
+        columns.oreType[i] = cell.oreType;
+        columns.stateMask[i] = cell.stateMask;
+    }
+    columns_.dirty.store(false, std::memory_order_release);
 }
 
 void HexSphereModel::setHeight(int cellId, int h) {
     if (cellId < 0 || cellId >= static_cast<int>(cells_.size()))
         return;
     cells_[cellId].height = h;
+    if (columnsCurrent()) columns_.data.height[cellId] = cells_[cellId].height;
 }
 
 void HexSphereModel::addHeight(int cellId, int dh) {
     if (cellId < 0 || cellId >= static_cast<int>(cells_.size()))
         return;
     cells_[cellId].height += dh;
+    if (columnsCurrent()) columns_.data.height[cellId] = cells_[cellId].height;
 }
 
 void HexSphereModel::setBiome(int cellId, Biome b) {
     if (cellId < 0 || cellId >= static_cast<int>(cells_.size()))
         return;
     cells_[cellId].biome = b;
+    if (columnsCurrent()) columns_.data.biome[cellId] = cells_[cellId].biome;
 }
 
 void HexSphereModel::setTemperature(int cellId, float temp) {
     if (cellId >= 0 && cellId < (int)cells_.size()) {
         cells_[cellId].temperature = temp;
+        if (columnsCurrent()) columns_.data.temperature[cellId] = cells_[cellId].temperature;
     }
 }
 
 void HexSphereModel::setHumidity(int cellId, float humidity) {
     if (cellId >= 0 && cellId < (int)cells_.size()) {
         cells_[cellId].humidity = humidity;
+        if (columnsCurrent()) columns_.data.humidity[cellId] = cells_[cellId].humidity;
     }
 }
 
 void HexSphereModel::setPressure(int cellId, float pressure) {
     if (cellId >= 0 && cellId < (int)cells_.size()) {
         cells_[cellId].pressure = pressure;
+        if (columnsCurrent()) columns_.data.pressure[cellId] = cells_[cellId].pressure;
     }
 }
 
 void HexSphereModel::setOreDensity(int cellId, float oreDensity) {
     if (cellId >= 0 && cellId < (int)cells_.size()) {
         cells_[cellId].oreDensity = oreDensity;
+        if (columnsCurrent()) columns_.data.oreDensity[cellId] = cells_[cellId].oreDensity;
     }
 }
 
 void HexSphereModel::setOreType(int cellId, uint8_t oreType) {
     if (cellId >= 0 && cellId < (int)cells_.size()) {
         cells_[cellId].oreType = oreType;
+        if (columnsCurrent()) columns_.data.oreType[cellId] = cells_[cellId].oreType;
     }
 }
 
@@ -267,6 +363,7 @@ void HexSphereModel::resetClimateData() {
         cell.oreDensity = 0.0f;
         cell.oreType = 0;
     }
+    columns_.dirty = true;
 }
 
 QVector3D HexSphereModel::biomeColor(Biome b, float temperature) {
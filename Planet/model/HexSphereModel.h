@@ -8,6 +8,9 @@
 #include <optional>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <atomic>
+#include <span>
 
 struct Tri { int a, b, c; };
 
@@ -104,12 +107,14 @@ struct TreePlacement {
     QVector3D getPosition(const HexSphereModel& model) const;
 };
 
-// Dual (hex/pent) sphere data
+// Dual (hex/pent) sphere data. poly and neighbors are views into the shared
+// SphereTopology the cell came from, so copying cells copies no topology
+// storage; only the scalar fields below belong to the model.
 struct Cell {
     int id = -1;                 // equals primal vertex index
     bool isPentagon = false;     // degree==5
-    std::vector<int> poly;       // indices into dualVerts (centers of triangles), CCW around cell
-    std::vector<int> neighbors;  // neighbor cell ids CCW (same length as poly)
+    std::span<const int> poly;       // indices into dualVerts (centers of triangles), CCW around cell
+    std::span<const int> neighbors;  // neighbor cell ids CCW (same length as poly, -1 if none)
     int height = 0;                 // дискретная высота
     Biome biome = Biome::Grass;     // тип биома
     QVector3D centroid;          // normalized average of poly vertices
@@ -128,24 +133,102 @@ struct Cell {
     float oreNoiseOffset = 0.0f; // Смещение для анимации шума
 };
 
+// Cell topology in CSR form: edges of cell c are [offsets[c], offsets[c+1])
+// in both polyVerts and neighbors (a cell has as many neighbours as corners).
+// Part of the shared SphereTopology, immutable.
+struct CellTopology {
+    std::vector<uint32_t> offsets{ 0 }; // cellCount + 1
+    std::vector<int> polyVerts;         // indices into dualVerts, CCW
+    std::vector<int> neighbors;         // neighbour cell ids, CCW (-1 if none)
+    std::vector<QVector3D> centroids;   // per cell
+
+    size_t cellCount() const { return offsets.size() - 1; }
+    int degree(int cellId) const { return int(offsets[size_t(cellId) + 1] - offsets[size_t(cellId)]); }
+    std::span<const int> poly(int cellId) const {
+        return { polyVerts.data() + offsets[size_t(cellId)], size_t(degree(cellId)) };
+    }
+    std::span<const int> neighborsOf(int cellId) const {
+        return { neighbors.data() + offsets[size_t(cellId)], size_t(degree(cellId)) };
+    }
+};
+
+// Per-field columns of mutable cell data, indexed by cell id
+struct CellColumns {
+    std::vector<int> height;
+    std::vector<Biome> biome;
+    std::vector<float> temperature;
+    std::vector<float> humidity;
+    std::vector<float> pressure;
+    std::vector<float> oreDensity;
+    std::vector<uint8_t> oreType;
+    std::vector<uint32_t> stateMask;
+};
+
+// Hand-built cell for SphereTopology::fromCells (tests, contributor scene)
+struct CellShape {
+    std::vector<int> poly;       // indices into dualVerts, CCW
+    std::vector<int> neighbors;  // may be shorter than poly; padded with -1
+    QVector3D centroid;
+};
+
 struct PickTri { // geometry for ray picking
     int cellId;
     QVector3D v0, v1, v2; // triangle positions (world)
 };
 
+// Everything of a HexSphereModel that depends only on the subdivision level.
+// Immutable once built and shared between models (see TopologyCache), so
+// regenerating terrain only rewrites the per-cell scalar fields. Not copyable:
+// cells point into csr.
+struct SphereTopology {
+    SphereTopology() = default;
+    SphereTopology(const SphereTopology&) = delete;
+    SphereTopology& operator=(const SphereTopology&) = delete;
+
+    int level = -1;                                  // -1: not built from a known level
+    int pentagonCount = 0;
+    std::vector<QVector3D> dualVerts;                // vertex per primal triangle
+    std::vector<std::array<int, 3>> dualOwners;      // для каждой дуальной вершины dv -> {cellA,cellB,cellC}
+    std::vector<std::pair<int, int>> wireEdges;      // unique undirected pairs of dual vertex indices
+    std::vector<PickTri> pickTris;                   // triangles for picking and green fill
+    std::vector<Cell> cells;                         // initial cells: views into csr + default climate
+    CellTopology csr;
+
+    // Fills cells from csr; called by every builder once csr is complete
+    void bindCells();
+
+    static std::shared_ptr<const SphereTopology> fromIcosphere(const IcoMesh& ico, int level = -1);
+    // Hand-built cells (tests, contributor scene): no wire edges or pick triangles
+    static std::shared_ptr<const SphereTopology> fromCells(std::vector<CellShape> cells, std::vector<QVector3D> dualVerts);
+    static const std::shared_ptr<const SphereTopology>& empty();
+};
+
 class HexSphereModel {
 public:
     void rebuildFromIcosphere(const IcoMesh& ico);
+    // Shares the topology instead of copying it; cells are reset to topology->cells,
+    // which copies only their scalar fields
+    void rebuildFromTopology(std::shared_ptr<const SphereTopology> topology);
 
-    const std::vector<QVector3D>& dualVerts() const { return dualVerts_; }
-    const std::vector<std::pair<int, int>>& wireEdges() const { return wireEdges_; }
+    const std::vector<QVector3D>& dualVerts() const { return shared_->dualVerts; }
+    const std::vector<std::pair<int, int>>& wireEdges() const { return shared_->wireEdges; }
     const std::vector<Cell>& cells() const { return cells_; }
-    std::vector<Cell>& cells() { return cells_; }
-    const std::vector<PickTri>& pickTris() const { return pickTris_; }
-    const std::vector<std::array<int, 3>>& dualOwners() const { return dualOwners_; }
-
-    int subdivisions() const { return L_; }
-    int pentagonCount() const { return pentCount_; }
+    // Mutable access invalidates columns(); prefer the setters below for single-cell edits
+    std::vector<Cell>& cells() { columns_.dirty = true; return cells_; }
+    const CellTopology& topology() const { return shared_->csr; }
+    const std::shared_ptr<const SphereTopology>& sharedTopology() const { return shared_; }
+    // SoA copy of the scalar fields of cells(), rebuilt on the first call after a
+    // mutable cells() access (the setters below patch it in place instead).
+    // The reference lives as long as the model, but its contents are current
+    // only until the next mutable cells() call - fetch columns() again after
+    // editing through cells(). Concurrent const callers may race to the
+    // rebuild; it runs once under a lock.
+    const CellColumns& columns() const;
+    const std::vector<PickTri>& pickTris() const { return shared_->pickTris; }
+    const std::vector<std::array<int, 3>>& dualOwners() const { return shared_->dualOwners; }
+
+    int subdivisions() const { return shared_->level; }
+    int pentagonCount() const { return shared_->pentagonCount; }
     int cellCount() const { return static_cast<int>(cells_.size()); }
 
     // Удобные сеттеры
@@ -170,19 +253,28 @@ public:
     static QVector3D biomeColor(Biome b, float temperature = 0.5f);
 
     // Для тестирования
-    void debug_setCellsAndDual(std::vector<Cell> c, std::vector<QVector3D> d) {
-        cells_ = std::move(c);
-        dualVerts_ = std::move(d);
+    void debug_setCellsAndDual(std::vector<CellShape> c, std::vector<QVector3D> d) {
+        rebuildFromTopology(SphereTopology::fromCells(std::move(c), std::move(d)));
     }
 
 private:
-    int L_ = 0;
-    int pentCount_ = 0;
-    std::vector<QVector3D> dualVerts_;                  // size == ico.F.size(); vertex per primal triangle
+    // Copies of the model start dirty and rebuild their own columns on demand
+    struct ColumnsCache {
+        CellColumns data;
+        std::atomic<bool> dirty{ true };
+        std::mutex mutex;
+
+        ColumnsCache() = default;
+        ColumnsCache(const ColumnsCache&) {}
+        ColumnsCache& operator=(const ColumnsCache&) { dirty = true; return *this; }
+    };
+
+    void syncColumns() const;
+    bool columnsCurrent() const { return !columns_.dirty.load(std::memory_order_relaxed); }
+
+    std::shared_ptr<const SphereTopology> shared_ = SphereTopology::empty();
     std::vector<Cell> cells_;
-    std::vector<std::pair<int, int>> wireEdges_;         // unique undirected pairs of dual vertex indices
-    std::vector<PickTri> pickTris_;                     // triangles for picking and green fill
-    std::vector<std::array<int, 3>> dualOwners_; // для каждой дуальной вершины dv ? {cellA,cellB,cellC}
+    mutable ColumnsCache columns_;
 };
 
 // Определение TreePlacement::getPosition
@@ -5,6 +5,9 @@
 #include <QOpenGLContext>
 #include <QMatrix4x4>
 
+#include <algorithm>
+#include <cmath>
+
 // ====== ПЕРЕХОД НА ПАРСЕР ЧЕРЕЗ POС ПОТОК ======
 #include <sstream>
 
@@ -452,6 +455,33 @@ bool ModelHandler::hasDrawablePart(const QString& partName) const {
     return part.initialized && part.indexCount > 0;
 }
 
+GLuint ModelHandler::vertexArray(const QString& partName) const {
+    if (partName.isEmpty()) {
+        return glInitialized_ ? vao_ : 0;
+    }
+    auto it = parts_.find(partName);
+    return (it != parts_.end() && it->second.initialized) ? it->second.vao : 0;
+}
+
+GLsizei ModelHandler::indexCount(const QString& partName) const {
+    if (partName.isEmpty()) {
+        return glInitialized_ ? indexCount_ : 0;
+    }
+    auto it = parts_.find(partName);
+    return (it != parts_.end() && it->second.initialized) ? it->second.indexCount : 0;
+}
+
+float ModelHandler::boundingRadius() const {
+    float radiusSq = 0.0f;
+    for (size_t i = 0; i + 2 < mesh_.positions.size(); i += 3) {
+        const float x = mesh_.positions[i];
+        const float y = mesh_.positions[i + 1];
+        const float z = mesh_.positions[i + 2];
+        radiusSq = std::max(radiusSq, x * x + y * y + z * z);
+    }
+    return std::sqrt(radiusSq);
+}
+
 void ModelHandler::draw(GLuint shader,
     const QMatrix4x4& mvp,
     const QMatrix4x4& modelMatrix,
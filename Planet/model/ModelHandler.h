@@ -67,6 +67,13 @@ public:
     bool hasPart(const QString& partName) const;
     bool hasDrawablePart(const QString& partName) const;
 
+    // VAO и число индексов части (пустое имя - вся модель) для инстансинга:
+    // вызывающий сам добавляет атрибуты экземпляров и рисует glDrawElementsInstanced
+    GLuint vertexArray(const QString& partName = QString()) const;
+    GLsizei indexCount(const QString& partName = QString()) const;
+    // Радиус сферы вокруг начала координат модели, накрывающей все вершины
+    float boundingRadius() const;
+
     void clear();
     void clearGPUResources();
 
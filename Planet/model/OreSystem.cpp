@@ -2,6 +2,7 @@
 #include <algorithm>
 #include <numeric>
 #include <cmath>
+#include <utility>
 
 OreSystem::OreSystem() : rng_(std::random_device{}()) {
     oreColors_[1] = QVector3D(0.7f, 0.4f, 0.2f);  // 
@@ -15,7 +16,7 @@ void OreSystem::initialize(HexSphereModel& model) {
     deposits_.clear();
 
     //   
-    const auto& cells = model_->cells();
+    const auto& cells = std::as_const(*model_).cells();
     for (const auto& cell : cells) {
         if (cell.oreType > 0 && cell.oreDensity > 0.1f) {
             addDeposit(cell.id, cell.oreDensity);
@@ -106,8 +107,7 @@ void OreSystem::diffuseOreDensity() {
     for (auto& deposit : deposits_) {
         if (!deposit.active) continue;
 
-        const auto& cell = model_->cells()[deposit.cellId];
-        for (int neighborId : cell.neighbors) {
+        for (int neighborId : model_->topology().neighborsOf(deposit.cellId)) {
             if (neighborId < 0) continue;
 
             auto neighborIt = std::find_if(deposits_.begin(), deposits_.end(),
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "controllers/HexSphereSceneController.h"
+#include <QMatrix4x4>
+#include <QVector4D>
+#include <cmath>
 #include <random>
 
 inline QVector3D computeSurfacePoint(const HexSphereSceneController& scene, int cellId, float heightStep,
@@ -24,9 +27,9 @@ inline QVector3D computeSurfacePoint(const HexSphereSceneController& scene, int
     return computeSurfacePoint(scene, cellId, scene.heightStep());
 }
 
-inline QVector3D computeSurfacePoint(const HexSphereSceneController& scene, const TreePlacement& placement,
+inline QVector3D computeSurfacePoint(const HexSphereModel& model, const TreePlacement& placement,
     float heightStep) {
-    const auto& cells = scene.model().cells();
+    const auto& cells = model.cells();
     if (placement.cellId < 0 || placement.cellId >= static_cast<int>(cells.size())) {
         return QVector3D(0, 0, 1.0f);
     }
@@ -34,6 +37,61 @@ inline QVector3D computeSurfacePoint(const HexSphereSceneController& scene, cons
     const Cell& cell = cells[static_cast<size_t>(placement.cellId)];
     const float surfaceHeight = 1.0f + cell.height * heightStep;
 
-    QVector3D posOnSphere = placement.getPosition(scene.model());
+    QVector3D posOnSphere = placement.getPosition(model);
     return posOnSphere.normalized() * surfaceHeight;
-}
\ No newline at end of file
+}
+
+inline QVector3D computeSurfacePoint(const HexSphereSceneController& scene, const TreePlacement& placement,
+    float heightStep) {
+    return computeSurfacePoint(scene.model(), placement, heightStep);
+}
+
+// Rotation with Y along the surface normal and Z along the seed axis
+// (world Z, or world X near the poles) projected onto the tangent plane
+inline QMatrix4x4 surfaceBasisFromNormal(const QVector3D& normal) {
+    const QVector3D up = normal.normalized();
+    QVector3D forward = (std::abs(QVector3D::dotProduct(up, QVector3D(0, 0, 1))) > 0.99f)
+        ? QVector3D(1, 0, 0)
+        : QVector3D(0, 0, 1);
+    forward = forward - QVector3D::dotProduct(forward, up) * up;
+    if (forward.length() < 1e-4f) {
+        QVector3D refX(1, 0, 0);
+        QVector3D right = refX - QVector3D::dotProduct(refX, up) * up;
+        if (right.length() < 0.01f) {
+            refX = QVector3D(0, 0, 1);
+            right = refX - QVector3D::dotProduct(refX, up) * up;
+        }
+        right.normalize();
+        forward = QVector3D::crossProduct(up, right).normalized();
+    }
+    else {
+        forward.normalize();
+    }
+    const QVector3D right = QVector3D::crossProduct(forward, up).normalized();
+
+    QMatrix4x4 rotation;
+    rotation.setColumn(0, QVector4D(right, 0.0f));
+    rotation.setColumn(1, QVector4D(up, 0.0f));
+    rotation.setColumn(2, QVector4D(forward, 0.0f));
+    return rotation;
+}
+
+inline float treeBaseScale(TreeType type) {
+    return type == TreeType::Fir ? 0.045f : 0.04f;
+}
+
+// Model matrix every tree is drawn with (mesh instances and particles alike):
+// stand on the surface normal at surfacePoint, yaw by placement.rotation,
+// scale by the tree type and placement.scale
+inline QMatrix4x4 treeModelMatrix(const TreePlacement& placement, const QVector3D& surfacePoint) {
+    QMatrix4x4 matrix;
+    matrix.translate(surfacePoint);
+    matrix = matrix * surfaceBasisFromNormal(surfacePoint);
+    matrix.rotate(placement.rotation * 180.0f / 3.14159f, 0, 1, 0);
+    matrix.scale(treeBaseScale(placement.treeType) * placement.scale);
+    return matrix;
+}
+
+inline QMatrix4x4 treeModelMatrix(const HexSphereModel& model, const TreePlacement& placement, float heightStep) {
+    return treeModelMatrix(placement, computeSurfacePoint(model, placement, heightStep));
+}
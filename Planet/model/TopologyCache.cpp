@@ -0,0 +1,112 @@
+#include "model/TopologyCache.h"
+#include "model/TopologyFile.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QtDebug>
+
+#include <future>
+#include <map>
+#include <mutex>
+
+namespace {
+    using TopologyFuture = std::shared_future<std::shared_ptr<const SphereTopology>>;
+
+    struct CacheState {
+        std::mutex mutex;
+        std::map<int, TopologyFuture> levels;
+        QString diskDirectory;
+    };
+
+    CacheState& state() {
+        static CacheState instance;
+        return instance;
+    }
+
+    std::shared_ptr<const SphereTopology> loadOrBuild(int level, const QString& directory) {
+        if (directory.isEmpty()) {
+            IcosphereBuilder icoBuilder;
+            return SphereTopology::fromIcosphere(icoBuilder.build(level), level);
+        }
+
+        const QString path = QDir(directory).filePath(topologyFileName(level));
+        if (QFileInfo::exists(path)) {
+            if (auto topo = loadTopologyFile(path); topo && topo->level == level) {
+                return topo;
+            }
+            qWarning() << "TopologyCache: rebuilding invalid topology file" << path;
+        }
+
+        IcosphereBuilder icoBuilder;
+        auto topo = SphereTopology::fromIcosphere(icoBuilder.build(level), level);
+        if (!writeTopologyFile(path, *topo)) {
+            qWarning() << "TopologyCache: cannot write" << path;
+        }
+        return topo;
+    }
+}
+
+std::shared_ptr<const SphereTopology> TopologyCache::acquire(int level) {
+    if (level < 0) {
+        return SphereTopology::empty();
+    }
+
+    CacheState& cache = state();
+    std::promise<std::shared_ptr<const SphereTopology>> promise;
+    TopologyFuture future;
+    bool builder = false;
+    QString directory;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto it = cache.levels.find(level);
+        if (it != cache.levels.end()) {
+            future = it->second;
+        }
+        else {
+            future = promise.get_future().share();
+            cache.levels.emplace(level, future);
+            builder = true;
+            directory = cache.diskDirectory;
+        }
+    }
+
+    // Строит первый запросивший, без удержания мьютекса: другие уровни
+    // в это время выдаются и строятся параллельно
+    if (builder) {
+        try {
+            promise.set_value(loadOrBuild(level, directory));
+        }
+        catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(cache.mutex);
+                cache.levels.erase(level);
+            }
+            promise.set_exception(std::current_exception());
+        }
+    }
+    return future.get();
+}
+
+void TopologyCache::clear() {
+    CacheState& cache = state();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.levels.clear();
+}
+
+size_t TopologyCache::cachedLevels() {
+    CacheState& cache = state();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.levels.size();
+}
+
+void TopologyCache::setDiskDirectory(const QString& directory) {
+    CacheState& cache = state();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.diskDirectory = directory;
+}
+
+QString TopologyCache::diskDirectory() {
+    CacheState& cache = state();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    return cache.diskDirectory;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <QString>
+#include <cstddef>
+#include <memory>
+
+#include "model/HexSphereModel.h"
+
+// Process-wide cache of SphereTopology by subdivision level. The first request
+// for a level builds it (concurrent requests for the same level wait for that
+// build); later requests return the same immutable object.
+// With a disk directory set, a level missing from memory is first loaded from
+// <dir>/hexsphere-L<level>.topo (see TopologyFile.h) and written there after
+// a build, so later runs skip the icosphere construction.
+class TopologyCache {
+public:
+    static std::shared_ptr<const SphereTopology> acquire(int level);
+
+    // Drops the cache's references; models keep the topologies they hold
+    static void clear();
+    static size_t cachedLevels();
+
+    // Empty path disables the disk cache (the default)
+    static void setDiskDirectory(const QString& directory);
+    static QString diskDirectory();
+};
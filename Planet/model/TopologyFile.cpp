@@ -0,0 +1,318 @@
+#include "model/TopologyFile.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtDebug>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+    constexpr size_t kHeaderSize = 64;
+    constexpr size_t kHeaderChecksumOffset = 56;
+
+    enum Column : size_t {
+        DualVerts,
+        DualOwners,
+        Offsets,
+        PolyVerts,
+        Neighbors,
+        Centroids,
+        WireEdges,
+        PickCells,
+        PickVerts,
+        ColumnCount,
+    };
+
+    struct Counts {
+        uint64_t cells = 0;
+        uint64_t duals = 0;
+        uint64_t corners = 0;
+        uint64_t wireEdges = 0;
+        uint64_t pickTris = 0;
+    };
+
+    uint64_t alignColumn(uint64_t bytes) {
+        return (bytes + 7u) & ~uint64_t{ 7u };
+    }
+
+    // Смещения колонок от начала файла; последний элемент - размер файла
+    std::array<uint64_t, ColumnCount + 1> columnOffsets(const Counts& c) {
+        const std::array<uint64_t, ColumnCount> bytes = {
+            c.duals * 12, c.duals * 12, (c.cells + 1) * 4,
+            c.corners * 4, c.corners * 4, c.cells * 12,
+            c.wireEdges * 8, c.pickTris * 4, c.pickTris * 36,
+        };
+        std::array<uint64_t, ColumnCount + 1> offsets{};
+        uint64_t offset = kHeaderSize;
+        for (size_t column = 0; column < ColumnCount; ++column) {
+            offsets[column] = offset;
+            offset += alignColumn(bytes[column]);
+        }
+        offsets[ColumnCount] = offset;
+        return offsets;
+    }
+
+    template <typename T>
+    void storeLe(char* out, T value) {
+        auto raw = std::bit_cast<std::array<char, sizeof(T)>>(value);
+        if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+            std::reverse(raw.begin(), raw.end());
+        }
+        std::memcpy(out, raw.data(), sizeof(T));
+    }
+
+    template <typename T>
+    T loadLe(const char* in) {
+        std::array<char, sizeof(T)> raw;
+        std::memcpy(raw.data(), in, sizeof(T));
+        if constexpr (std::endian::native == std::endian::big && sizeof(T) > 1) {
+            std::reverse(raw.begin(), raw.end());
+        }
+        return std::bit_cast<T>(raw);
+    }
+
+    void storeVec3(char* out, const QVector3D& value) {
+        storeLe<float>(out, value.x());
+        storeLe<float>(out + 4, value.y());
+        storeLe<float>(out + 8, value.z());
+    }
+
+    QVector3D loadVec3(const char* in) {
+        return QVector3D(loadLe<float>(in), loadLe<float>(in + 4), loadLe<float>(in + 8));
+    }
+
+    // Слова по 8 байт: цепочка xor-умножение держит несколько ГБ/с, этого
+    // хватает, чтобы проверка не съедала выигрыш от чтения вместо построения
+    uint64_t checksum64(const char* data, size_t size) {
+        uint64_t h = 0xCBF29CE484222325ull ^ size;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            h = (h ^ loadLe<uint64_t>(data + i)) * 0x100000001B3ull;
+        }
+        for (; i < size; ++i) {
+            h = (h ^ static_cast<uint8_t>(data[i])) * 0x100000001B3ull;
+        }
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return h;
+    }
+
+    // Плоские колонки из 4-байтных значений: на little-endian - одним memcpy
+    template <typename T>
+    void loadColumn(const char* in, size_t count, T* out) {
+        static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % 4 == 0);
+        if (count == 0) {
+            return;
+        }
+        if constexpr (std::endian::native == std::endian::little) {
+            std::memcpy(out, in, count * sizeof(T));
+        }
+        else {
+            auto* words = reinterpret_cast<uint32_t*>(out);
+            for (size_t i = 0; i < count * sizeof(T) / 4; ++i) {
+                words[i] = loadLe<uint32_t>(in + i * 4);
+            }
+        }
+    }
+
+} // namespace
+
+std::string encodeTopologyFile(const SphereTopology& topology) {
+    const CellTopology& csr = topology.csr;
+    Counts counts;
+    counts.cells = csr.cellCount();
+    counts.duals = topology.dualVerts.size();
+    counts.corners = csr.polyVerts.size();
+    counts.wireEdges = topology.wireEdges.size();
+    counts.pickTris = topology.pickTris.size();
+    const auto offsets = columnOffsets(counts);
+
+    std::string bytes(size_t(offsets[ColumnCount]), '\0');
+    char* out = bytes.data();
+
+    for (size_t i = 0; i < counts.duals; ++i) {
+        storeVec3(out + offsets[DualVerts] + i * 12, topology.dualVerts[i]);
+        const std::array<int, 3> owners = i < topology.dualOwners.size() ? topology.dualOwners[i] : std::array<int, 3>{ -1, -1, -1 };
+        for (size_t k = 0; k < 3; ++k) {
+            storeLe<int32_t>(out + offsets[DualOwners] + i * 12 + k * 4, owners[k]);
+        }
+    }
+    for (size_t i = 0; i <= counts.cells; ++i) {
+        storeLe<uint32_t>(out + offsets[Offsets] + i * 4, csr.offsets[i]);
+    }
+    for (size_t i = 0; i < counts.corners; ++i) {
+        storeLe<int32_t>(out + offsets[PolyVerts] + i * 4, csr.polyVerts[i]);
+        storeLe<int32_t>(out + offsets[Neighbors] + i * 4, csr.neighbors[i]);
+    }
+    for (size_t i = 0; i < counts.cells; ++i) {
+        storeVec3(out + offsets[Centroids] + i * 12, csr.centroids[i]);
+    }
+    for (size_t i = 0; i < counts.wireEdges; ++i) {
+        storeLe<int32_t>(out + offsets[WireEdges] + i * 8, topology.wireEdges[i].first);
+        storeLe<int32_t>(out + offsets[WireEdges] + i * 8 + 4, topology.wireEdges[i].second);
+    }
+    for (size_t i = 0; i < counts.pickTris; ++i) {
+        const PickTri& tri = topology.pickTris[i];
+        storeLe<int32_t>(out + offsets[PickCells] + i * 4, tri.cellId);
+        char* verts = out + offsets[PickVerts] + i * 36;
+        storeVec3(verts, tri.v0);
+        storeVec3(verts + 12, tri.v1);
+        storeVec3(verts + 24, tri.v2);
+    }
+
+    const uint64_t payloadBytes = bytes.size() - kHeaderSize;
+    storeLe<uint32_t>(out + 0, kTopologyFileMagic);
+    storeLe<uint16_t>(out + 4, kTopologyFileVersion);
+    storeLe<uint16_t>(out + 6, uint16_t(kHeaderSize));
+    storeLe<int32_t>(out + 8, topology.level);
+    storeLe<uint32_t>(out + 12, uint32_t(counts.cells));
+    storeLe<uint32_t>(out + 16, uint32_t(counts.duals));
+    storeLe<uint32_t>(out + 20, uint32_t(counts.corners));
+    storeLe<uint32_t>(out + 24, uint32_t(counts.wireEdges));
+    storeLe<uint32_t>(out + 28, uint32_t(counts.pickTris));
+    storeLe<uint32_t>(out + 32, uint32_t(topology.pentagonCount));
+    storeLe<uint32_t>(out + 36, 0u);
+    storeLe<uint64_t>(out + 40, payloadBytes);
+    storeLe<uint64_t>(out + 48, checksum64(out + kHeaderSize, size_t(payloadBytes)));
+    storeLe<uint64_t>(out + kHeaderChecksumOffset, checksum64(out, kHeaderChecksumOffset));
+    return bytes;
+}
+
+std::shared_ptr<const SphereTopology> decodeTopologyFile(std::string_view bytes) {
+    if (bytes.size() < kHeaderSize) {
+        return nullptr;
+    }
+    const char* in = bytes.data();
+    if (loadLe<uint32_t>(in) != kTopologyFileMagic
+        || loadLe<uint16_t>(in + 4) != kTopologyFileVersion
+        || loadLe<uint16_t>(in + 6) != kHeaderSize
+        || loadLe<uint64_t>(in + kHeaderChecksumOffset) != checksum64(in, kHeaderChecksumOffset)) {
+        return nullptr;
+    }
+
+    // Счётчики u32, поэтому 64-битные размеры колонок не переполняются
+    Counts counts;
+    counts.cells = loadLe<uint32_t>(in + 12);
+    counts.duals = loadLe<uint32_t>(in + 16);
+    counts.corners = loadLe<uint32_t>(in + 20);
+    counts.wireEdges = loadLe<uint32_t>(in + 24);
+    counts.pickTris = loadLe<uint32_t>(in + 28);
+    const auto offsets = columnOffsets(counts);
+    const uint64_t payloadBytes = loadLe<uint64_t>(in + 40);
+    if (offsets[ColumnCount] != bytes.size() || payloadBytes != bytes.size() - kHeaderSize
+        || loadLe<uint64_t>(in + 48) != checksum64(in + kHeaderSize, size_t(payloadBytes))) {
+        return nullptr;
+    }
+
+    auto topo = std::make_shared<SphereTopology>();
+    topo->level = loadLe<int32_t>(in + 8);
+    topo->pentagonCount = int(loadLe<uint32_t>(in + 32));
+
+    static_assert(sizeof(QVector3D) == 12, "QVector3D columns are copied as packed floats");
+    topo->dualVerts.resize(size_t(counts.duals));
+    loadColumn(in + offsets[DualVerts], topo->dualVerts.size(), topo->dualVerts.data());
+    topo->dualOwners.resize(size_t(counts.duals));
+    loadColumn(in + offsets[DualOwners], topo->dualOwners.size(), topo->dualOwners.data());
+
+    CellTopology& csr = topo->csr;
+    csr.offsets.resize(size_t(counts.cells) + 1);
+    loadColumn(in + offsets[Offsets], csr.offsets.size(), csr.offsets.data());
+    csr.polyVerts.resize(size_t(counts.corners));
+    loadColumn(in + offsets[PolyVerts], csr.polyVerts.size(), csr.polyVerts.data());
+    csr.neighbors.resize(size_t(counts.corners));
+    loadColumn(in + offsets[Neighbors], csr.neighbors.size(), csr.neighbors.data());
+    csr.centroids.resize(size_t(counts.cells));
+    loadColumn(in + offsets[Centroids], csr.centroids.size(), csr.centroids.data());
+
+    // Контрольная сумма ловит порчу, но не ошибку записи: индексы проверяем
+    // отдельно, чтобы битый файл не стал выходом за границы в модели
+    if (csr.offsets.front() != 0 || csr.offsets.back() != counts.corners) {
+        return nullptr;
+    }
+    for (size_t c = 0; c < counts.cells; ++c) {
+        if (csr.offsets[c] > csr.offsets[c + 1]) return nullptr;
+    }
+    for (size_t i = 0; i < counts.corners; ++i) {
+        if (uint64_t(uint32_t(csr.polyVerts[i])) >= counts.duals) return nullptr;
+        if (csr.neighbors[i] < -1 || csr.neighbors[i] >= int64_t(counts.cells)) return nullptr;
+    }
+    // encodeTopologyFile пишет -1 за отсутствующих владельцев
+    for (const auto& owners : topo->dualOwners) {
+        for (int owner : owners) {
+            if (owner < -1 || owner >= int64_t(counts.cells)) return nullptr;
+        }
+    }
+
+    topo->wireEdges.resize(size_t(counts.wireEdges));
+    for (size_t i = 0; i < topo->wireEdges.size(); ++i) {
+        topo->wireEdges[i] = { loadLe<int32_t>(in + offsets[WireEdges] + i * 8),
+            loadLe<int32_t>(in + offsets[WireEdges] + i * 8 + 4) };
+        if (uint64_t(uint32_t(topo->wireEdges[i].first)) >= counts.duals
+            || uint64_t(uint32_t(topo->wireEdges[i].second)) >= counts.duals) {
+            return nullptr;
+        }
+    }
+    topo->pickTris.resize(size_t(counts.pickTris));
+    for (size_t i = 0; i < topo->pickTris.size(); ++i) {
+        PickTri& tri = topo->pickTris[i];
+        tri.cellId = loadLe<int32_t>(in + offsets[PickCells] + i * 4);
+        if (uint64_t(uint32_t(tri.cellId)) >= counts.cells) {
+            return nullptr;
+        }
+        const char* verts = in + offsets[PickVerts] + i * 36;
+        tri.v0 = loadVec3(verts);
+        tri.v1 = loadVec3(verts + 12);
+        tri.v2 = loadVec3(verts + 24);
+    }
+
+    // Шаблонные клетки - как в SphereTopology::fromIcosphere, ссылками в csr
+    topo->bindCells();
+    return topo;
+}
+
+bool writeTopologyFile(const QString& path, const SphereTopology& topology) {
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        return false;
+    }
+    const std::string bytes = encodeTopologyFile(topology);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    if (file.write(bytes.data(), qint64(bytes.size())) != qint64(bytes.size())) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+std::shared_ptr<const SphereTopology> loadTopologyFile(const QString& path) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    const qint64 size = file.size();
+    if (size < qint64(kHeaderSize)) {
+        return nullptr;
+    }
+    // Отображение вместо чтения: колонки копируются из страничного кэша прямо в векторы
+    if (uchar* mapped = file.map(0, size)) {
+        auto topo = decodeTopologyFile(std::string_view(reinterpret_cast<const char*>(mapped), size_t(size)));
+        file.unmap(mapped);
+        return topo;
+    }
+    const QByteArray bytes = file.readAll();
+    return decodeTopologyFile(std::string_view(bytes.constData(), size_t(bytes.size())));
+}
+
+QString topologyFileName(int level) {
+    return QStringLiteral("hexsphere-L%1.topo").arg(level);
+}
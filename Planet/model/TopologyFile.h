@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QString>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "model/HexSphereModel.h"
+
+// ============================================================
+// Бинарный файл готовой SphereTopology (кэш на диске между запусками)
+// ============================================================
+//
+// Заголовок (64 байта, little-endian):
+//   u32 magic 'HXTP', u16 version, u16 headerSize, i32 level,
+//   u32 cellCount, u32 dualCount, u32 cornerCount, u32 wireEdgeCount,
+//   u32 pickTriCount, u32 pentagonCount, u32 reserved,
+//   u64 payloadBytes, u64 payloadChecksum, u64 headerChecksum (байты 0..55)
+// Затем колонки, каждая выровнена на 8 байт:
+//   dualVerts f32x3, dualOwners i32x3 (dualCount), offsets u32 (cellCount + 1),
+//   polyVerts i32, neighbors i32 (cornerCount), centroids f32x3 (cellCount),
+//   wireEdges i32x2 (wireEdgeCount), pickCells i32, pickVerts f32x9 (pickTriCount)
+//
+// Версию нужно поднимать при любом изменении IcosphereBuilder/fromIcosphere.
+
+inline constexpr uint32_t kTopologyFileMagic = 0x50545848u; // "HXTP"
+inline constexpr uint16_t kTopologyFileVersion = 1;
+
+std::string encodeTopologyFile(const SphereTopology& topology);
+
+/// nullptr, если заголовок, размеры или контрольные суммы не сходятся
+std::shared_ptr<const SphereTopology> decodeTopologyFile(std::string_view bytes);
+
+/// Атомарная запись (временный файл + rename); каталог создаётся при необходимости
+bool writeTopologyFile(const QString& path, const SphereTopology& topology);
+
+/// Читает файл через mmap (QFile::map); nullptr, если файла нет или он повреждён
+std::shared_ptr<const SphereTopology> loadTopologyFile(const QString& path);
+
+QString topologyFileName(int level);
@@ -3,6 +3,7 @@
 #include <QElapsedTimer>
 #include <QOpenGLContext>
 #include <QtDebug>
+#include <algorithm>
 #include <cstddef>
 #include <cmath>
 #include <random>
@@ -34,14 +35,6 @@ namespace {
         rotation.setColumn(2, QVector4D(forwardTangent, 0.0f));
         return rotation;
     }
-
-    void orientToSurfaceNormal(QMatrix4x4& matrix, const QVector3D& normal) {
-        const QVector3D up = normal.normalized();
-        const QVector3D seedForward = (qAbs(QVector3D::dotProduct(up, QVector3D(0, 0, 1))) > 0.99f)
-            ? QVector3D(1, 0, 0)
-            : QVector3D(0, 0, 1);
-        matrix = matrix * basisFromHorizontalForward(up, seedForward);
-    }
 }
 
 EntityRenderer::~EntityRenderer() {
@@ -54,6 +47,9 @@ EntityRenderer::~EntityRenderer() {
     if (steamVbo_ != 0) {
         gl_->glDeleteBuffers(1, &steamVbo_);
     }
+    if (treeInstanceVbo_[0] != 0) {
+        gl_->glDeleteBuffers(GLsizei(TreeInstanceBuilder::kTreeTypeCount), treeInstanceVbo_);
+    }
 }
 
 EntityRenderer::EntityRenderer(QOpenGLFunctions_3_3_Core* gl,
@@ -118,6 +114,15 @@ EntityRenderer::EntityRenderer(QOpenGLFunctions_3_3_Core* gl,
     , carModel_(carModel)
     , factoryModel_(factoryModel)
     , mineModel_(mineModel) {
+    // Tree uniforms are looked up once instead of every frame
+    if (gl_ && progModel_ != 0) {
+        uIsCarModel_ = gl_->glGetUniformLocation(progModel_, "uIsCar");
+        uUseFoliageColorModel_ = gl_->glGetUniformLocation(progModel_, "uUseFoliageColor");
+        uWindTimeModel_ = gl_->glGetUniformLocation(progModel_, "uWindTime");
+        uInstancedModel_ = gl_->glGetUniformLocation(progModel_, "uInstanced");
+        uViewProjModel_ = gl_->glGetUniformLocation(progModel_, "uViewProj");
+        gl_->glGenBuffers(GLsizei(TreeInstanceBuilder::kTreeTypeCount), treeInstanceVbo_);
+    }
 }
 
 void EntityRenderer::initializeSteamResources() {
@@ -449,106 +454,124 @@ void EntityRenderer::renderMine(const HexSphereRenderer::RenderContext& ctx, con
 }
 
 void EntityRenderer::renderTrees(const HexSphereRenderer::RenderContext& ctx) const {
-    if ((!treeModel_ || !treeModel_->isInitialized()) &&
-        (!firTreeModel_ || !firTreeModel_->isInitialized())) return;
+    const bool oakReady = treeModel_ && treeModel_->isInitialized();
+    const bool firReady = firTreeModel_ && firTreeModel_->isInitialized();
+    if (!oakReady && !firReady) return;
+
+    if (progModel_ == 0 || treeInstanceVbo_[0] == 0) return;
+
+    // Transforms and tints are baked once per placement or terrain change; per frame only cull + sort
+    const auto& scene = ctx.graph.scene;
+    if (!treeInstancesBaked_ ||
+        treeInstancesRevision_ != scene.treePlacementsRevision() ||
+        treeInstancesTerrainRevision_ != scene.terrainRevision() ||
+        treeInstancesHeightStep_ != ctx.graph.heightStep) {
+        float modelRadius = 0.0f;
+        if (oakReady) modelRadius = std::max(modelRadius, treeModel_->boundingRadius());
+        if (firReady) modelRadius = std::max(modelRadius, firTreeModel_->boundingRadius());
+        treeInstances_.setPlacements(scene.model(), scene.getTreePlacements(), ctx.graph.heightStep,
+            modelRadius + kTreeSwayMargin);
+        treeInstancesBaked_ = true;
+        treeInstancesRevision_ = scene.treePlacementsRevision();
+        treeInstancesTerrainRevision_ = scene.terrainRevision();
+        treeInstancesHeightStep_ = ctx.graph.heightStep;
+    }
 
-    if (progModel_ == 0) return;
+    constexpr size_t kMaxRenderedTrees = 65536; // nearest first
+    if (treeInstances_.build(ctx.mvp, ctx.cameraPos, kMaxRenderedTrees) == 0) return;
 
     gl_->glUseProgram(progModel_);
 
-    const GLint uIsCar = gl_->glGetUniformLocation(progModel_, "uIsCar");
-    const GLint uUseFoliageColor = gl_->glGetUniformLocation(progModel_, "uUseFoliageColor");
-    const GLint uFoliageColor = gl_->glGetUniformLocation(progModel_, "uFoliageColor");
-    const GLint uTrunkColor = gl_->glGetUniformLocation(progModel_, "uTrunkColor");
-    const GLint uWindTime = gl_->glGetUniformLocation(progModel_, "uWindTime");
-
-    if (uIsCar >= 0) gl_->glUniform1i(uIsCar, 0);
+    if (uIsCarModel_ >= 0) gl_->glUniform1i(uIsCarModel_, 0);
     static float foliageWindTime = 0.0f;
     foliageWindTime += 0.016f;
-    if (uWindTime >= 0) {
-        gl_->glUniform1f(uWindTime, foliageWindTime);
+    if (uWindTimeModel_ >= 0) {
+        gl_->glUniform1f(uWindTimeModel_, foliageWindTime);
     }
+    if (uInstancedModel_ >= 0) gl_->glUniform1i(uInstancedModel_, 1);
+    if (uViewProjModel_ >= 0) gl_->glUniformMatrix4fv(uViewProjModel_, 1, GL_FALSE, ctx.mvp.constData());
 
     const GLboolean cullWasEnabled = gl_->glIsEnabled(GL_CULL_FACE);
     gl_->glDisable(GL_CULL_FACE);
 
     const QVector3D globalLightDir = QVector3D(0.5f, 1.0f, 0.3f).normalized();
-    const QVector3D eye = (ctx.camera.view.inverted() * QVector4D(0, 0, 0, 1)).toVector3D();
-
     gl_->glUniform3f(uLightDir_, globalLightDir.x(), globalLightDir.y(), globalLightDir.z());
-    gl_->glUniform3f(uViewPos_, eye.x(), eye.y(), eye.z());
-
-    const auto& placements = ctx.graph.scene.getTreePlacements();
-
-    constexpr size_t kMaxRenderedTrees = 96;
-    size_t renderedTrees = 0;
-    for (const auto& placement : placements) {
-        if (renderedTrees >= kMaxRenderedTrees) {
-            break;
-        }
-
-        const QVector3D treePos = computeSurfacePoint(ctx.graph.scene, placement, ctx.graph.heightStep);
-
-        QMatrix4x4 model;
-        model.translate(treePos);
-        orientToSurfaceNormal(model, treePos.normalized());
-        model.rotate(placement.rotation * 180.0f / 3.14159f, 0, 1, 0);
-
-        const float baseScale = (placement.treeType == TreeType::Fir) ? 0.045f : 0.04f;
-        model.scale(baseScale * placement.scale);
+    gl_->glUniform3f(uViewPos_, ctx.cameraPos.x(), ctx.cameraPos.y(), ctx.cameraPos.z());
 
-        const QMatrix4x4 mvpTree = ctx.camera.projection * ctx.camera.view * model;
-        const auto& currentModel = (placement.treeType == TreeType::Fir)
-            ? firTreeModel_
-            : treeModel_;
+    // One instanced draw per tree type and part
+    for (const TreeType type : { TreeType::Oak, TreeType::Fir }) {
+        const std::vector<TreeInstance>& instances = treeInstances_.instances(type);
+        const auto& currentModel = (type == TreeType::Fir) ? firTreeModel_ : treeModel_;
+        if (instances.empty() || !currentModel || !currentModel->isInitialized()) continue;
 
-        if (!currentModel || !currentModel->isInitialized()) continue;
+        const GLuint instanceVbo = treeInstanceVbo_[type == TreeType::Fir ? 1 : 0];
+        gl_->glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        gl_->glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(instances.size() * sizeof(TreeInstance)), instances.data(), GL_STREAM_DRAW);
+        const GLsizei instanceCount = GLsizei(instances.size());
 
         const bool hasTrunk = currentModel->hasDrawablePart("trunk");
         const bool hasFoliage = currentModel->hasDrawablePart("foliage");
 
         if (hasTrunk) {
-            if (uUseFoliageColor >= 0) {
-                gl_->glUniform1i(uUseFoliageColor, 0);
+            if (uUseFoliageColorModel_ >= 0) {
+                gl_->glUniform1i(uUseFoliageColorModel_, 0);
             }
-            if (uTrunkColor >= 0) {
-                gl_->glUniform3f(uTrunkColor,
-                    placement.trunkColor.x(),
-                    placement.trunkColor.y(),
-                    placement.trunkColor.z());
-            }
-            currentModel->drawPart("trunk", progModel_, mvpTree, model, ctx.camera.view);
+            drawTreeInstances(currentModel->vertexArray("trunk"), currentModel->indexCount("trunk"), instanceVbo, instanceCount);
         }
 
         if (hasFoliage) {
-            if (uUseFoliageColor >= 0) {
-                gl_->glUniform1i(uUseFoliageColor, 1);
-            }
-            if (uFoliageColor >= 0) {
-                gl_->glUniform3f(uFoliageColor,
-                    placement.foliageColor.x(),
-                    placement.foliageColor.y(),
-                    placement.foliageColor.z());
+            if (uUseFoliageColorModel_ >= 0) {
+                gl_->glUniform1i(uUseFoliageColorModel_, 1);
             }
-            currentModel->drawPart("foliage", progModel_, mvpTree, model, ctx.camera.view);
+            drawTreeInstances(currentModel->vertexArray("foliage"), currentModel->indexCount("foliage"), instanceVbo, instanceCount);
         }
 
         if (!hasTrunk && !hasFoliage) {
-            if (uUseFoliageColor >= 0) {
-                gl_->glUniform1i(uUseFoliageColor, 1);
-            }
-            if (uFoliageColor >= 0) {
-                gl_->glUniform3f(uFoliageColor,
-                    placement.foliageColor.x(),
-                    placement.foliageColor.y(),
-                    placement.foliageColor.z());
+            if (uUseFoliageColorModel_ >= 0) {
+                gl_->glUniform1i(uUseFoliageColorModel_, 1);
             }
-            currentModel->draw(progModel_, mvpTree, model, ctx.camera.view, placement.foliageColor, false);
+            // Как ModelHandler::draw: текстура, если есть UV, иначе цвет листвы (ближайшего дерева)
+            const float* fallbackColor = instances.front().foliageColor;
+            gl_->glUniform3f(uColor_, fallbackColor[0], fallbackColor[1], fallbackColor[2]);
+            gl_->glUniform1i(uUseTexture_, currentModel->hasUVs() ? 1 : 0);
+            drawTreeInstances(currentModel->vertexArray(), currentModel->indexCount(), instanceVbo, instanceCount);
         }
-
-        ++renderedTrees;
     }
 
+    if (uInstancedModel_ >= 0) gl_->glUniform1i(uInstancedModel_, 0);
+
     if (cullWasEnabled) gl_->glEnable(GL_CULL_FACE);
     else gl_->glDisable(GL_CULL_FACE);
 }
+
+void EntityRenderer::drawTreeInstances(GLuint vao, GLsizei indexCount, GLuint instanceVbo, GLsizei instanceCount) const {
+    if (vao == 0 || indexCount == 0 || instanceCount == 0) return;
+
+    gl_->glBindVertexArray(vao);
+    gl_->glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+    const GLsizei stride = GLsizei(sizeof(TreeInstance));
+    for (GLuint column = 0; column < 4; ++column) {
+        const GLuint location = kTreeInstanceModelLocation + column;
+        gl_->glEnableVertexAttribArray(location);
+        gl_->glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, stride,
+            reinterpret_cast<const void*>(offsetof(TreeInstance, model) + column * 4 * sizeof(float)));
+        gl_->glVertexAttribDivisor(location, 1);
+    }
+    gl_->glEnableVertexAttribArray(kTreeInstanceTrunkLocation);
+    gl_->glVertexAttribPointer(kTreeInstanceTrunkLocation, 3, GL_FLOAT, GL_FALSE, stride,
+        reinterpret_cast<const void*>(offsetof(TreeInstance, trunkColor)));
+    gl_->glVertexAttribDivisor(kTreeInstanceTrunkLocation, 1);
+    gl_->glEnableVertexAttribArray(kTreeInstanceFoliageLocation);
+    gl_->glVertexAttribPointer(kTreeInstanceFoliageLocation, 3, GL_FLOAT, GL_FALSE, stride,
+        reinterpret_cast<const void*>(offsetof(TreeInstance, foliageColor)));
+    gl_->glVertexAttribDivisor(kTreeInstanceFoliageLocation, 1);
+
+    gl_->glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr, instanceCount);
+
+    // The VAO belongs to ModelHandler: hand it back without the instance attributes
+    for (GLuint location = kTreeInstanceModelLocation; location <= kTreeInstanceFoliageLocation; ++location) {
+        gl_->glVertexAttribDivisor(location, 0);
+        gl_->glDisableVertexAttribArray(location);
+    }
+    gl_->glBindVertexArray(0);
+}
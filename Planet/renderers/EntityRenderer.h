@@ -6,6 +6,7 @@
 #include <unordered_map>
 
 #include "renderers/HexSphereRenderer.h"
+#include "renderers/TreeInstances.h"
 #include "model/CarModelHandler.h"
 #include "model/FactoryModelHandler.h"
 #include "model/MineModelHandler.h"
@@ -54,6 +55,15 @@ public:
     void initializeSteamResources();
 
 private:
+    // Per-instance attribute locations of VS_MODEL (the mat4 takes four)
+    static constexpr GLuint kTreeInstanceModelLocation = 4;
+    static constexpr GLuint kTreeInstanceTrunkLocation = 8;
+    static constexpr GLuint kTreeInstanceFoliageLocation = 9;
+    // Foliage sway in VS_MODEL moves vertices by up to ~0.025 model units
+    static constexpr float kTreeSwayMargin = 0.05f;
+
+    void drawTreeInstances(GLuint vao, GLsizei indexCount, GLuint instanceVbo, GLsizei instanceCount) const;
+
     struct SteamVertex {
         QVector3D emitter;
         float seed = 0.0f;
@@ -94,6 +104,17 @@ private:
     GLuint steamVao_ = 0;
     GLuint steamVbo_ = 0;
     GLsizei steamParticleCount_ = 0;
+    GLint uIsCarModel_ = -1;
+    GLint uUseFoliageColorModel_ = -1;
+    GLint uWindTimeModel_ = -1;
+    GLint uInstancedModel_ = -1;
+    GLint uViewProjModel_ = -1;
+    GLuint treeInstanceVbo_[TreeInstanceBuilder::kTreeTypeCount] = {};
+    mutable TreeInstanceBuilder treeInstances_;
+    mutable bool treeInstancesBaked_ = false;
+    mutable uint64_t treeInstancesRevision_ = 0;
+    mutable uint64_t treeInstancesTerrainRevision_ = 0;
+    mutable float treeInstancesHeightStep_ = 0.0f;
 
     std::shared_ptr<ModelHandler> treeModel_;
     std::shared_ptr<ModelHandler> firTreeModel_;
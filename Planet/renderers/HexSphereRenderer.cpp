@@ -6,6 +6,7 @@
 #include <QOpenGLVertexArrayObject> 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <utility>
 
@@ -19,39 +20,6 @@
 #include "renderers/WaterRenderer.h"
 
 namespace {
-    QMatrix4x4 surfaceBasisFromForward(const QVector3D& unitUp, QVector3D forwardTangent) {
-        forwardTangent = forwardTangent - QVector3D::dotProduct(forwardTangent, unitUp) * unitUp;
-        if (forwardTangent.length() < 1e-4f) {
-            QVector3D refX(1, 0, 0);
-            QVector3D right = refX - QVector3D::dotProduct(refX, unitUp) * unitUp;
-            if (right.length() < 0.01f) {
-                refX = QVector3D(0, 0, 1);
-                right = refX - QVector3D::dotProduct(refX, unitUp) * unitUp;
-            }
-            right.normalize();
-            forwardTangent = QVector3D::crossProduct(unitUp, right).normalized();
-        }
-        else {
-            forwardTangent.normalize();
-        }
-
-        const QVector3D right = QVector3D::crossProduct(forwardTangent, unitUp).normalized();
-
-        QMatrix4x4 rotation;
-        rotation.setColumn(0, QVector4D(right, 0.0f));
-        rotation.setColumn(1, QVector4D(unitUp, 0.0f));
-        rotation.setColumn(2, QVector4D(forwardTangent, 0.0f));
-        return rotation;
-    }
-
-    void orientTreeToSurface(QMatrix4x4& matrix, const QVector3D& normal) {
-        const QVector3D up = normal.normalized();
-        const QVector3D seedForward = (qAbs(QVector3D::dotProduct(up, QVector3D(0, 0, 1))) > 0.99f)
-            ? QVector3D(1, 0, 0)
-            : QVector3D(0, 0, 1);
-        matrix = matrix * surfaceBasisFromForward(up, seedForward);
-    }
-
     uint64_t quantizedHashFloat(float value) {
         const auto quantized = static_cast<int64_t>(std::llround(static_cast<double>(value) * 100000.0));
         return static_cast<uint64_t>(quantized);
@@ -82,6 +50,7 @@ HexSphereRenderer::~HexSphereRenderer() {
     entityRenderer_.reset();
     overlayRenderer_.reset();
     particleRenderer_.reset();
+    treeParticleRenderer_.reset();
 
     if (treeModel_.use_count() == 1 && treeModel_) {
         treeModel_->clearGPUResources();
@@ -300,6 +269,10 @@ void HexSphereRenderer::initialize(QOpenGLWidget* owner, QOpenGLFunctions_3_3_Co
 
     particleRenderer_ = std::make_unique<ParticleRenderer>();
     particleRenderer_->initialize();
+    treeParticleRenderer_ = std::make_unique<ParticleRenderer>();
+    treeParticleRenderer_->initialize();
+    planetTreeParticleHashes_.clear();
+    planetTreeParticlesValid_ = false;
 
     {
         ContributorAsset treeAsset = buildContributorAsset();
@@ -500,35 +473,128 @@ void HexSphereRenderer::uploadWireInternal(const std::vector<float>& vertices, G
     }
 }
 
-void HexSphereRenderer::uploadTerrainInternal(const TerrainMesh& mesh, GLenum usage) {
+void HexSphereRenderer::uploadTerrainInternal(const TerrainMesh& mesh, GLenum usage, bool packed) {
     qDebug() << "uploadTerrainInternal - original indices:" << mesh.idx.size();
 
     // Р—Р°РіСЂСѓР¶Р°РµРј РІРµСЂС€РёРЅС‹ (СЌС‚Рѕ РЅРµ РјРµРЅСЏРµС‚СЃСЏ)
-    gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainPos_);
-    gl_->glBufferData(GL_ARRAY_BUFFER, mesh.pos.size() * sizeof(float), mesh.pos.data(), usage);
-    gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainCol_);
-    gl_->glBufferData(GL_ARRAY_BUFFER, mesh.col.size() * sizeof(float), mesh.col.data(), usage);
-    gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainNorm_);
-    gl_->glBufferData(GL_ARRAY_BUFFER, mesh.norm.size() * sizeof(float), mesh.norm.data(), usage);
+    if (packed) {
+        // One interleaved 20-byte vertex; the colour and normal buffers are released
+        const std::vector<TerrainPackedVertex> vertices = packTerrainVertices(mesh);
+        gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainPos_);
+        gl_->glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(vertices.size() * sizeof(TerrainPackedVertex)), vertices.data(), usage);
+        gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainCol_);
+        gl_->glBufferData(GL_ARRAY_BUFFER, 0, nullptr, usage);
+        gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainNorm_);
+        gl_->glBufferData(GL_ARRAY_BUFFER, 0, nullptr, usage);
+    }
+    else {
+        gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainPos_);
+        gl_->glBufferData(GL_ARRAY_BUFFER, mesh.pos.size() * sizeof(float), mesh.pos.data(), usage);
+        gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainCol_);
+        gl_->glBufferData(GL_ARRAY_BUFFER, mesh.col.size() * sizeof(float), mesh.col.data(), usage);
+        gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainNorm_);
+        gl_->glBufferData(GL_ARRAY_BUFFER, mesh.norm.size() * sizeof(float), mesh.norm.data(), usage);
+    }
 
     // РќР• Р¤РР›Р¬РўР РЈР•Рњ Р·РґРµСЃСЊ - СЃРѕС…СЂР°РЅСЏРµРј РІСЃРµ РёРЅРґРµРєСЃС‹
-    gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboTerrain_);
-    gl_->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-        mesh.idx.size() * sizeof(uint32_t),
-        mesh.idx.data(),
-        GL_DYNAMIC_DRAW);  // Р’СЃРµРіРґР° DYNAMIC, С‚Р°Рє РєР°Рє Р±СѓРґРµРј РјРµРЅСЏС‚СЊ
-
-    terrainIndexCount_ = GLsizei(mesh.idx.size());
+    uploadTerrainIndices(mesh);
     totalIndexCount_ = mesh.idx.size();  // РЎРѕС…СЂР°РЅСЏРµРј РґР»СЏ СЃС‚Р°С‚РёСЃС‚РёРєРё
 
     // РЎРѕР·РґР°РµРј VAO РѕРґРёРЅ СЂР°Р·
+    const bool layoutChanged = terrainPacked_ != packed;
+    terrainPacked_ = packed;
     if (!vaoTerrain_.isCreated()) {
         recreateTerrainVAO();
     }
+    else if (layoutChanged) {
+        vaoTerrain_.bind();
+        bindTerrainAttributes();
+        vaoTerrain_.release();
+    }
 
     qDebug() << "uploadTerrainInternal - total indexCount:" << terrainIndexCount_;
 }
 
+void HexSphereRenderer::uploadTerrainIndices(const TerrainMesh& mesh) {
+    gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboTerrain_);
+    terrainIndexOffset_ = 0;
+    terrainRanges_.clear();
+
+    switch (terrainIndexUpload_) {
+    case TerrainIndexUpload::SubData:
+        uploadedClusterRevision_ = 0;
+        // Both halves are allocated once per mesh; visibility updates only overwrite one of them
+        terrainIndexCapacity_ = mesh.idx.size();
+        gl_->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+            GLsizeiptr(2 * terrainIndexCapacity_ * sizeof(uint32_t)), nullptr, GL_DYNAMIC_DRAW);
+        gl_->glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0,
+            GLsizeiptr(mesh.idx.size() * sizeof(uint32_t)), mesh.idx.data());
+        currentBuffer_ = 0;
+        nextBuffer_ = 1;
+        buffers_[nextBuffer_].ready = false;
+        terrainIndexCount_ = GLsizei(mesh.idx.size());
+        break;
+    case TerrainIndexUpload::DrawRanges: {
+        // The IBO holds the scene's cluster order and stays put; visibility only picks ranges of it
+        const bool clustered = lastScene_ && lastScene_->supportsTerrainVisibility();
+        if (clustered) {
+            uploadClusteredTerrainIndices();
+        }
+        else {
+            gl_->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                GLsizeiptr(mesh.idx.size() * sizeof(uint32_t)), mesh.idx.data(), GL_STATIC_DRAW);
+            uploadedClusterRevision_ = 0;
+        }
+        const size_t indexCount = clustered ? uploadedClusterIndices_ : mesh.idx.size();
+        terrainRanges_.push_back(TerrainDrawRange{ 0, uint32_t(indexCount) });
+        updateTerrainDrawList();
+        break;
+    }
+    case TerrainIndexUpload::Reallocate:
+    default:
+        uploadedClusterRevision_ = 0;
+        gl_->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+            mesh.idx.size() * sizeof(uint32_t),
+            mesh.idx.data(),
+            GL_DYNAMIC_DRAW);  // Р’СЃРµРіРґР° DYNAMIC, С‚Р°Рє РєР°Рє Р±СѓРґРµРј РјРµРЅСЏС‚СЊ
+        terrainIndexCount_ = GLsizei(mesh.idx.size());
+        break;
+    }
+}
+
+// DrawRanges: the IBO mirrors the scene's cluster order. A new order is uploaded
+// whole; an edit refitted into the same order only rewrites its ranges.
+void HexSphereRenderer::uploadClusteredTerrainIndices() {
+    const std::vector<uint32_t>& clustered = lastScene_->clusteredTerrainIndices();
+    const uint64_t revision = lastScene_->terrainClusterRevision();
+    gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboTerrain_);
+    if (revision != 0 && revision == uploadedClusterRevision_ && clustered.size() == uploadedClusterIndices_) {
+        for (const TerrainDrawRange& range : lastScene_->terrainClusterEdits()) {
+            gl_->glBufferSubData(GL_ELEMENT_ARRAY_BUFFER,
+                GLintptr(size_t(range.firstIndex) * sizeof(uint32_t)),
+                GLsizeiptr(size_t(range.indexCount) * sizeof(uint32_t)),
+                clustered.data() + range.firstIndex);
+        }
+        return;
+    }
+    gl_->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+        GLsizeiptr(clustered.size() * sizeof(uint32_t)), clustered.data(), GL_STATIC_DRAW);
+    uploadedClusterRevision_ = revision;
+    uploadedClusterIndices_ = clustered.size();
+}
+
+void HexSphereRenderer::updateTerrainDrawList() {
+    terrainDrawCounts_.clear();
+    terrainDrawOffsets_.clear();
+    GLsizei total = 0;
+    for (const TerrainDrawRange& range : terrainRanges_) {
+        terrainDrawCounts_.push_back(GLsizei(range.indexCount));
+        terrainDrawOffsets_.push_back(reinterpret_cast<const void*>(size_t(range.firstIndex) * sizeof(uint32_t)));
+        total += GLsizei(range.indexCount);
+    }
+    terrainIndexCount_ = total;
+}
+
 // ========== РќРћР’Р«Р™ РњР•РўРћР” Р”Р›РЇ РћР‘РќРћР’Р›Р•РќРРЇ Р’РР”РРњРћРЎРўР ==========
 //void HexSphereRenderer::updateVisibility(const QVector3D& cameraPos) {
 //    if (!glReady_ || !lastScene_) return;
@@ -579,6 +645,8 @@ void HexSphereRenderer::updateVisibility(const QVector3D& cameraPos) {
     lastScene_->setCameraPosition(cameraPos);
     if (!lastScene_->supportsTerrainVisibility()) {
         terrainIndexCount_ = 0;
+        terrainRanges_.clear();
+        updateTerrainDrawList();
         return;
     }
 
@@ -590,8 +658,54 @@ void HexSphereRenderer::updateVisibility(const QVector3D& cameraPos) {
         QElapsedTimer filterTimer;
         filterTimer.start();
 
-        // РРЎРџР РђР’РРўР¬: РёСЃРїРѕР»СЊР·РѕРІР°С‚СЊ РѕР±С‹С‡РЅСѓСЋ РІРµСЂСЃРёСЋ, РЅРµ СЃ РїСЂРµРґСЃРєР°Р·Р°РЅРёРµРј
-        std::vector<uint32_t> visibleIndices = lastScene_->getVisibleIndices(cameraPos);
+        size_t visibleTriangles = 0;
+        switch (terrainIndexUpload_) {
+        case TerrainIndexUpload::DrawRanges: {
+            // Re-upload only when the scene rebuilt its clusters (new mesh or an edit that changed the order)
+            if (uploadedClusterRevision_ != lastScene_->terrainClusterRevision()) {
+                uploadClusteredTerrainIndices();
+            }
+            terrainRanges_.clear();
+            visibleTriangles = lastScene_->getVisibleRanges(cameraPos, terrainRanges_, kTerrainRangeMergeGap);
+            updateTerrainDrawList();
+            break;
+        }
+        case TerrainIndexUpload::SubData: {
+            // Fill the half the GPU is not reading from: no reallocation, no stall on the drawn half
+            VisibilityBuffer& next = buffers_[nextBuffer_];
+            next.indices.clear();
+            visibleTriangles = lastScene_->appendVisibleIndices(cameraPos, next.indices);
+            gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboTerrain_);
+            if (next.indices.size() > terrainIndexCapacity_) {
+                // The mesh grew without a re-upload: grow both halves once
+                terrainIndexCapacity_ = next.indices.size();
+                gl_->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                    GLsizeiptr(2 * terrainIndexCapacity_ * sizeof(uint32_t)), nullptr, GL_DYNAMIC_DRAW);
+            }
+            const GLintptr offset = GLintptr(size_t(nextBuffer_) * terrainIndexCapacity_ * sizeof(uint32_t));
+            gl_->glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, offset,
+                GLsizeiptr(next.indices.size() * sizeof(uint32_t)), next.indices.data());
+            next.ready = true;
+            next.frameAge = 0;
+            terrainIndexOffset_ = offset;
+            terrainIndexCount_ = GLsizei(next.indices.size());
+            swapBuffers();
+            break;
+        }
+        case TerrainIndexUpload::Reallocate:
+        default: {
+            // РРЎРџР РђР’РРўР¬: РёСЃРїРѕР»СЊР·РѕРІР°С‚СЊ РѕР±С‹С‡РЅСѓСЋ РІРµСЂСЃРёСЋ, РЅРµ СЃ РїСЂРµРґСЃРєР°Р·Р°РЅРёРµРј
+            std::vector<uint32_t> visibleIndices = lastScene_->getVisibleIndices(cameraPos);
+            visibleTriangles = visibleIndices.size() / 3;
+            gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboTerrain_);
+            gl_->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
+                visibleIndices.size() * sizeof(uint32_t),
+                visibleIndices.data(),
+                GL_DYNAMIC_DRAW);
+            terrainIndexCount_ = GLsizei(visibleIndices.size());
+            break;
+        }
+        }
 
         qint64 elapsed = filterTimer.elapsed();
 
@@ -604,19 +718,10 @@ void HexSphereRenderer::updateVisibility(const QVector3D& cameraPos) {
         if (updateCount % 10 == 0) {
             qDebug() << "=== ADAPTIVE UPDATE STATS ===";  // Р’РµСЂРЅСѓС‚СЊ СЃС‚Р°СЂРѕРµ РЅР°Р·РІР°РЅРёРµ
             qDebug() << "Avg filter time:" << (totalTime / updateCount) << "ms";
-            qDebug() << "Triangles:" << (visibleIndices.size() / 3)
+            qDebug() << "Triangles:" << visibleTriangles
                 << "/" << (lastScene_->terrain().idx.size() / 3);
             qDebug() << "==============================";
         }
-
-        // РћР±РЅРѕРІР»СЏРµРј РёРЅРґРµРєСЃРЅС‹Р№ Р±СѓС„РµСЂ
-        gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboTerrain_);
-        gl_->glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-            visibleIndices.size() * sizeof(uint32_t),
-            visibleIndices.data(),
-            GL_DYNAMIC_DRAW);
-
-        terrainIndexCount_ = GLsizei(visibleIndices.size());
         lastScene_->updateLastCameraPosition();
     }
 }
@@ -644,17 +749,7 @@ void HexSphereRenderer::recreateTerrainVAO() {
     vaoTerrain_.bind();
 
     // РќР°СЃС‚СЂР°РёРІР°РµРј Р°С‚СЂРёР±СѓС‚С‹
-    gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainPos_);
-    gl_->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-    gl_->glEnableVertexAttribArray(0);
-
-    gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainCol_);
-    gl_->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-    gl_->glEnableVertexAttribArray(1);
-
-    gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainNorm_);
-    gl_->glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-    gl_->glEnableVertexAttribArray(2);
+    bindTerrainAttributes();
 
     // РџСЂРёРІСЏР·С‹РІР°РµРј РёРЅРґРµРєСЃРЅС‹Р№ Р±СѓС„РµСЂ
     gl_->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboTerrain_);
@@ -716,6 +811,32 @@ void HexSphereRenderer::uploadWire(const std::vector<float>& vertices, GLenum us
     withContext([&]() { uploadWireInternal(vertices, usage); });
 }
 
+// Attribute layout of the bound terrain VAO: three float streams or one
+// interleaved TerrainPackedVertex stream (normalised 8-bit colour, 10:10:10:2 normal).
+void HexSphereRenderer::bindTerrainAttributes() {
+    if (terrainPacked_) {
+        const GLsizei stride = GLsizei(sizeof(TerrainPackedVertex));
+        gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainPos_);
+        gl_->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride,
+            reinterpret_cast<const void*>(offsetof(TerrainPackedVertex, x)));
+        gl_->glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+            reinterpret_cast<const void*>(offsetof(TerrainPackedVertex, color)));
+        gl_->glVertexAttribPointer(2, 4, GL_INT_2_10_10_10_REV, GL_TRUE, stride,
+            reinterpret_cast<const void*>(offsetof(TerrainPackedVertex, normal)));
+    }
+    else {
+        gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainPos_);
+        gl_->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainCol_);
+        gl_->glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+        gl_->glBindBuffer(GL_ARRAY_BUFFER, vboTerrainNorm_);
+        gl_->glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+    }
+    gl_->glEnableVertexAttribArray(0);
+    gl_->glEnableVertexAttribArray(1);
+    gl_->glEnableVertexAttribArray(2);
+}
+
 void HexSphereRenderer::uploadTerrain(const TerrainMesh& mesh, GLenum usage) {
     withContext([&]() { uploadTerrainInternal(mesh, usage); });
 }
@@ -822,11 +943,13 @@ void HexSphereRenderer::renderContributorModel(const RenderContext& ctx) {
 
 void HexSphereRenderer::uploadScene(const HexSphereSceneController& scene, const UploadOptions& options) {
     qDebug() << "uploadScene called, setting lastScene_";
+    if (lastScene_ != &scene) uploadedClusterRevision_ = 0; // revisions of another scene are unrelated
     lastScene_ = const_cast<HexSphereSceneController*>(&scene);
 
+    terrainIndexUpload_ = options.terrainIndexUpload;
     withContext([&]() {
         uploadWireInternal(scene.buildWireVertices(), options.wireUsage);
-        uploadTerrainInternal(scene.terrain(), options.terrainUsage);
+        uploadTerrainInternal(scene.terrain(), options.terrainUsage, options.packedTerrainVertices);
         uploadSelectionOutlineInternal(scene.buildSelectionOutlineVertices());
         uploadPathInternal({});
         uploadWaterInternal(scene.buildWaterGeometry());
@@ -873,7 +996,12 @@ void HexSphereRenderer::renderScene(const RenderGraph& graph, const RenderCamera
 
     RenderContext ctx{ graph, camera, lighting, camera.projection * camera.view, cameraPos };
 
-    terrainRenderer_->render(ctx, terrainIndexCount_);
+    if (terrainIndexUpload_ == TerrainIndexUpload::DrawRanges) {
+        terrainRenderer_->renderRanges(ctx, terrainDrawCounts_.data(), terrainDrawOffsets_.data(), GLsizei(terrainDrawCounts_.size()));
+    }
+    else {
+        terrainRenderer_->render(ctx, terrainIndexCount_, reinterpret_cast<const void*>(terrainIndexOffset_));
+    }
     waterRenderer_->render(ctx);
     entityRenderer_->renderEntities(ctx);
     overlayRenderer_->render(ctx);
@@ -898,7 +1026,7 @@ void HexSphereRenderer::renderScene(const RenderGraph& graph, const RenderCamera
 }
 
 void HexSphereRenderer::renderPlanetTreeParticles(const RenderContext& ctx) {
-    if (!particleRenderer_ || !particleRenderer_->isInitialized()) {
+    if (!treeParticleRenderer_ || !treeParticleRenderer_->isInitialized()) {
         return;
     }
     if (planetTreeParticleTemplate_.empty()) {
@@ -910,22 +1038,65 @@ void HexSphereRenderer::renderPlanetTreeParticles(const RenderContext& ctx) {
         return;
     }
 
-    constexpr size_t kMaxTreesWithParticles = 96;
-    constexpr size_t kMaxParticlesTotal = 30000;
+    // Particles persist between frames: nothing is recomputed until the placements
+    // or the cell heights under them change
+    const uint64_t revision = ctx.graph.scene.treePlacementsRevision();
+    const uint64_t terrainRevision = ctx.graph.scene.terrainRevision();
+    if (!planetTreeParticlesValid_ || revision != planetTreeParticlesRevision_ ||
+        terrainRevision != planetTreeParticlesTerrainRevision_ ||
+        ctx.graph.heightStep != planetTreeParticlesHeightStep_) {
+        updatePlanetTreeParticles(ctx);
+        planetTreeParticlesValid_ = true;
+        planetTreeParticlesRevision_ = revision;
+        planetTreeParticlesTerrainRevision_ = terrainRevision;
+        planetTreeParticlesHeightStep_ = ctx.graph.heightStep;
+    }
+
+    treeParticleRenderer_->render(ctx.mvp, ctx.camera.view, ctx.cameraPos);
+}
+
+void HexSphereRenderer::updatePlanetTreeParticles(const RenderContext& ctx) {
+    const auto& placements = ctx.graph.scene.getTreePlacements();
+
+    constexpr size_t kMaxTreesWithParticles = 1024;
+    constexpr size_t kMaxParticlesTotal = 300000;
     const size_t treeCount = std::min(placements.size(), kMaxTreesWithParticles);
+    if (treeCount == 0) {
+        return;
+    }
 
-    uint64_t placementHash = 1469598103934665603ull;
-    auto hashCombine = [&placementHash](uint64_t value) {
-        placementHash ^= value;
-        placementHash *= 1099511628211ull;
-    };
+    // Every tree owns a fixed slot of particlesPerTree particles, so a changed
+    // tree rewrites only its own slot
+    const size_t templateSize = planetTreeParticleTemplate_.size();
+    const size_t particlesPerTreeBudget = std::max<size_t>(1, kMaxParticlesTotal / treeCount);
+    const size_t sourceStep = std::max<size_t>(1, templateSize / particlesPerTreeBudget);
+    const size_t particlesPerTree = std::min(particlesPerTreeBudget, (templateSize + sourceStep - 1) / sourceStep);
+
+    ParticleSimulator& particles = treeParticleRenderer_->simulator();
+    if (particlesPerTree != planetTreeParticlesPerTree_) {
+        planetTreeParticleHashes_.clear();
+        planetTreeParticlesPerTree_ = particlesPerTree;
+    }
+    if (planetTreeParticleHashes_.size() > treeCount) {
+        planetTreeParticleHashes_.resize(treeCount);
+    }
+    const bool resized = particles.size() != treeCount * particlesPerTree;
+    particles.resize(treeCount * particlesPerTree);
 
-    hashCombine(static_cast<uint64_t>(treeCount));
+    size_t dirtyBegin = treeCount;
+    size_t dirtyEnd = 0;
     for (size_t i = 0; i < treeCount; ++i) {
         const auto& placement = placements[i];
         const QVector3D treePos = computeSurfacePoint(ctx.graph.scene, placement, ctx.graph.heightStep);
+
+        uint64_t placementHash = 1469598103934665603ull;
+        auto hashCombine = [&placementHash](uint64_t value) {
+            placementHash ^= value;
+            placementHash *= 1099511628211ull;
+        };
         hashCombine(static_cast<uint64_t>(placement.cellId + 10007));
         hashCombine(static_cast<uint64_t>(placement.treeType));
+        hashCombine(static_cast<uint64_t>(placement.colorType));
         hashCombine(static_cast<uint64_t>(placement.triangleIdx + 1009));
         hashCombine(quantizedHashFloat(placement.baryU));
         hashCombine(quantizedHashFloat(placement.baryV));
@@ -935,69 +1106,47 @@ void HexSphereRenderer::renderPlanetTreeParticles(const RenderContext& ctx) {
         hashCombine(quantizedHashFloat(treePos.x()));
         hashCombine(quantizedHashFloat(treePos.y()));
         hashCombine(quantizedHashFloat(treePos.z()));
-    }
-
-    if (placementHash != planetTreeParticlesPlacementHash_) {
-        std::vector<ContributorParticle> worldParticles;
-        worldParticles.reserve(std::min(kMaxParticlesTotal, treeCount * planetTreeParticleTemplate_.size()));
-        const size_t particlesPerTreeBudget = std::max<size_t>(1, kMaxParticlesTotal / treeCount);
-        const size_t sourceStep = std::max<size_t>(1, planetTreeParticleTemplate_.size() / particlesPerTreeBudget);
-
-        for (size_t i = 0; i < treeCount; ++i) {
-            const auto& placement = placements[i];
-            const QVector3D treePos = computeSurfacePoint(ctx.graph.scene, placement, ctx.graph.heightStep);
-            const QVector3D up = treePos.normalized();
-
-            QMatrix4x4 transform;
-            transform.translate(treePos);
-            orientTreeToSurface(transform, up);
-            transform.rotate(placement.rotation * 180.0f / 3.14159f, 0, 1, 0);
-            const float baseScale = (placement.treeType == TreeType::Fir) ? 0.045f : 0.04f;
-            transform.scale(baseScale * placement.scale);
 
-            QVector3D foliageColor = placement.foliageColor;
-            if (placement.colorType == TreePlacement::TreeColorType::Autumn) {
-                foliageColor = QVector3D(0.85f, 0.48f, 0.18f);
-            }
-            else {
-                foliageColor = QVector3D(0.22f, 0.68f, 0.24f);
-            }
-
-            size_t emittedForTree = 0;
-            for (size_t sourceIndex = 0; sourceIndex < planetTreeParticleTemplate_.size(); sourceIndex += sourceStep) {
-                if (worldParticles.size() >= kMaxParticlesTotal) {
-                    break;
-                }
-                if (emittedForTree >= particlesPerTreeBudget) {
-                    break;
-                }
-                const auto& source = planetTreeParticleTemplate_[sourceIndex];
-                ContributorParticle particle = source;
-                particle.restPosition = (transform * QVector4D(source.restPosition, 1.0f)).toVector3D();
-                particle.position = (transform * QVector4D(source.position, 1.0f)).toVector3D();
-                particle.normal = transform.mapVector(source.normal).normalized();
-                particle.color = foliageColor;
-                particle.size *= 1.25f;
-                particle.velocity = QVector3D(0.0f, 0.0f, 0.0f);
-                particle.windWeight = 0.0f;
-                worldParticles.push_back(particle);
-                ++emittedForTree;
-            }
-
-            if (worldParticles.size() >= kMaxParticlesTotal) {
-                break;
+        if (i < planetTreeParticleHashes_.size()) {
+            if (planetTreeParticleHashes_[i] == placementHash) {
+                continue;
             }
+            planetTreeParticleHashes_[i] = placementHash;
         }
-
-        if (worldParticles.empty()) {
-            return;
+        else {
+            planetTreeParticleHashes_.push_back(placementHash);
+        }
+        dirtyBegin = std::min(dirtyBegin, i);
+        dirtyEnd = i + 1;
+
+        const QMatrix4x4 transform = treeModelMatrix(placement, treePos);
+
+        const QVector3D foliageColor = (placement.colorType == TreePlacement::TreeColorType::Autumn)
+            ? QVector3D(0.85f, 0.48f, 0.18f)
+            : QVector3D(0.22f, 0.68f, 0.24f);
+
+        const size_t slot = i * particlesPerTree;
+        for (size_t k = 0; k < particlesPerTree; ++k) {
+            const auto& source = planetTreeParticleTemplate_[k * sourceStep];
+            ContributorParticle particle = source;
+            particle.restPosition = (transform * QVector4D(source.restPosition, 1.0f)).toVector3D();
+            particle.position = (transform * QVector4D(source.position, 1.0f)).toVector3D();
+            particle.normal = transform.mapVector(source.normal).normalized();
+            particle.color = foliageColor;
+            particle.size *= 1.25f;
+            particle.velocity = QVector3D(0.0f, 0.0f, 0.0f);
+            particle.windWeight = 0.0f;
+            particles.setParticle(slot + k, particle);
         }
-
-        particleRenderer_->updateParticles(worldParticles);
-        planetTreeParticlesPlacementHash_ = placementHash;
     }
 
-    particleRenderer_->render(ctx.mvp, ctx.camera.view, ctx.cameraPos);
+    // A resize reuploads everything; otherwise only the span of changed trees
+    if (resized) {
+        treeParticleRenderer_->uploadParticles(0, particles.size());
+    }
+    else if (dirtyBegin < dirtyEnd) {
+        treeParticleRenderer_->uploadParticles(dirtyBegin * particlesPerTree, (dirtyEnd - dirtyBegin) * particlesPerTree);
+    }
 }
 
 void HexSphereRenderer::generateEnvCubemap() {
@@ -64,10 +64,22 @@ public:
         QVector3D cameraPos;
     };
 
+    // How a visibility change reaches the terrain IBO
+    enum class TerrainIndexUpload {
+        Reallocate, // glBufferData of the visible indices on every change
+        SubData,    // IBO split in two fixed halves (buffers_), refilled in turn with glBufferSubData
+        DrawRanges, // cluster-ordered IBO uploaded once, visibility drawn as glMultiDrawElements ranges
+    };
+    // glMultiDrawElements is core since GL 1.4, and InputController refuses to run
+    // without a 3.3 core context, so the range path is always available
+    static constexpr TerrainIndexUpload kDefaultTerrainIndexUpload = TerrainIndexUpload::DrawRanges;
+
     struct UploadOptions {
         GLenum terrainUsage = GL_STATIC_DRAW;
         GLenum wireUsage = GL_STATIC_DRAW;
         bool useStaticBuffers = true;
+        bool packedTerrainVertices = false; // one interleaved VBO of TerrainPackedVertex
+        TerrainIndexUpload terrainIndexUpload = kDefaultTerrainIndexUpload;
     };
 
     explicit HexSphereRenderer(QOpenGLWidget* owner);
@@ -110,16 +122,21 @@ private:
     void initPyramidGeometry();
     void withContext(const std::function<void()>& task);
     void uploadWireInternal(const std::vector<float>& vertices, GLenum usage);
-    void uploadTerrainInternal(const TerrainMesh& mesh, GLenum usage);
+    void uploadTerrainInternal(const TerrainMesh& mesh, GLenum usage, bool packed = false);
+    void uploadTerrainIndices(const TerrainMesh& mesh);
+    void uploadClusteredTerrainIndices();
+    void updateTerrainDrawList();
     void uploadSelectionOutlineInternal(const std::vector<float>& vertices);
     void uploadPathInternal(const std::vector<QVector3D>& points);
     void uploadWaterInternal(const WaterGeometryData& data);
     void loadContributorModel();
     void renderContributorModel(const RenderContext& ctx);
     void renderPlanetTreeParticles(const RenderContext& ctx);
+    void updatePlanetTreeParticles(const RenderContext& ctx);
 
     // ����� �����
     void recreateTerrainVAO();
+    void bindTerrainAttributes();
 
     HexSphereSceneController* lastScene_ = nullptr;
 
@@ -145,6 +162,17 @@ private:
     GLuint vaoWire_ = 0, vboPositions_ = 0;
     QOpenGLVertexArrayObject vaoTerrain_;
     GLuint vboTerrainPos_ = 0, vboTerrainCol_ = 0, vboTerrainNorm_ = 0, iboTerrain_ = 0;
+    bool terrainPacked_ = false; // vboTerrainPos_ holds TerrainPackedVertex
+    TerrainIndexUpload terrainIndexUpload_ = kDefaultTerrainIndexUpload;
+    size_t terrainIndexCapacity_ = 0;  // SubData: indices per half of iboTerrain_
+    GLintptr terrainIndexOffset_ = 0;  // SubData: byte offset of the half being drawn
+    uint64_t uploadedClusterRevision_ = 0; // DrawRanges: scene cluster order held by iboTerrain_, 0 if none
+    size_t uploadedClusterIndices_ = 0;    // DrawRanges: indices of that order in iboTerrain_
+    // DrawRanges: ranges closer than one cluster are joined into one draw
+    static constexpr uint32_t kTerrainRangeMergeGap = TerrainClusters::kDefaultClusterTriangles * 3;
+    std::vector<TerrainDrawRange> terrainRanges_;
+    std::vector<GLsizei> terrainDrawCounts_;
+    std::vector<const void*> terrainDrawOffsets_;
     GLuint vaoSel_ = 0, vboSel_ = 0;
     GLuint vaoPath_ = 0, vboPath_ = 0;
     GLuint vaoPyramid_ = 0, vboPyramid_ = 0;
@@ -190,8 +218,16 @@ private:
     std::shared_ptr<FactoryModelHandler> factoryModel_;
     std::shared_ptr<MineModelHandler> mineModel_;
     std::unique_ptr<ParticleRenderer> particleRenderer_;
+    // Planet tree particles persist in their own renderer: contributor uploads do not clobber them
+    std::unique_ptr<ParticleRenderer> treeParticleRenderer_;
     std::vector<ContributorParticle> planetTreeParticleTemplate_;
-    uint64_t planetTreeParticlesPlacementHash_ = 0;
+    // Placement hash of each tree slot already written to treeParticleRenderer_
+    std::vector<uint64_t> planetTreeParticleHashes_;
+    size_t planetTreeParticlesPerTree_ = 0;
+    bool planetTreeParticlesValid_ = false;
+    uint64_t planetTreeParticlesRevision_ = 0;
+    uint64_t planetTreeParticlesTerrainRevision_ = 0;
+    float planetTreeParticlesHeightStep_ = 0.0f;
     ContributorWindField windField_;
 };
 
@@ -115,28 +115,28 @@ void ParticleRenderer::initialize() {
 
     // Позиции (location = 0)
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ContributorParticle),
-        reinterpret_cast<void*>(offsetof(ContributorParticle, position)));
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex),
+        reinterpret_cast<void*>(offsetof(ParticleVertex, position)));
 
     // Цвета (location = 1)
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ContributorParticle),
-        reinterpret_cast<void*>(offsetof(ContributorParticle, color)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex),
+        reinterpret_cast<void*>(offsetof(ParticleVertex, color)));
 
     // Размер (location = 2)
     glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(ContributorParticle),
-        reinterpret_cast<void*>(offsetof(ContributorParticle, size)));
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex),
+        reinterpret_cast<void*>(offsetof(ParticleVertex, size)));
 
     // Вращение (location = 3)
     glEnableVertexAttribArray(3);
-    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(ContributorParticle),
-        reinterpret_cast<void*>(offsetof(ContributorParticle, rotation)));
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex),
+        reinterpret_cast<void*>(offsetof(ParticleVertex, rotation)));
 
     // Нормали (location = 4)
     glEnableVertexAttribArray(4);
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(ContributorParticle),
-        reinterpret_cast<void*>(offsetof(ContributorParticle, normal)));
+    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleVertex),
+        reinterpret_cast<void*>(offsetof(ParticleVertex, normal)));
 
     vao_.release();
     vbo_.release();
@@ -195,13 +195,36 @@ void ParticleRenderer::createShaders() {
 void ParticleRenderer::updateParticles(const std::vector<ContributorParticle>& particles) {
     if (!initialized_ || particles.empty()) return;
 
-    particleCount_ = static_cast<int>(particles.size());
+    simulator_.assign(particles);
+    uploadParticles(0, simulator_.size());
 
+    qDebug() << "ParticleRenderer updated with" << particleCount_ << "particles";
+}
+
+void ParticleRenderer::uploadParticles(size_t first, size_t count) {
+    if (!initialized_) return;
+
+    const size_t total = simulator_.size();
     vbo_.bind();
-    vbo_.allocate(particles.data(), static_cast<int>(particles.size() * sizeof(ContributorParticle)));
+    if (static_cast<size_t>(particleCount_) != total) {
+        // Размер поменялся - буфер заново и целиком
+        particleCount_ = static_cast<int>(total);
+        vbo_.setUsagePattern(QOpenGLBuffer::DynamicDraw);
+        vbo_.allocate(static_cast<int>(total * sizeof(ParticleVertex)));
+        first = 0;
+        count = total;
+    }
+    count = std::min(count, total - std::min(first, total));
+    if (count > 0) {
+        auto* vertices = static_cast<ParticleVertex*>(vbo_.mapRange(
+            static_cast<int>(first * sizeof(ParticleVertex)), static_cast<int>(count * sizeof(ParticleVertex)),
+            QOpenGLBuffer::RangeWrite | QOpenGLBuffer::RangeInvalidate));
+        if (vertices) {
+            simulator_.writeVertices(vertices, first, count);
+        }
+        vbo_.unmap();
+    }
     vbo_.release();
-
-    qDebug() << "ParticleRenderer updated with" << particleCount_ << "particles";
 }
 
 void ParticleRenderer::render(const QMatrix4x4& mvp, const QMatrix4x4& view, const QVector3D& cameraPos) {
@@ -231,56 +254,19 @@ void ParticleRenderer::render(const QMatrix4x4& mvp, const QMatrix4x4& view, con
 }
 void ParticleRenderer::update(float deltaTime, const ContributorWindField& wind, const QVector3D& treeCenter) {
     if (!initialized_ || particleCount_ == 0) return;
+    if (static_cast<size_t>(particleCount_) != simulator_.size()) {
+        uploadParticles(0, simulator_.size());
+    }
 
-    // Ограничиваем deltaTime
-    deltaTime = std::min(deltaTime, 0.033f);
-
-    // Получаем указатель на данные частиц
+    // Симуляция пишет вершины прямо в буфер: старое содержимое не читается,
+    // поэтому он отображается только на запись и сбрасывается целиком
     vbo_.bind();
-    ContributorParticle* particles = reinterpret_cast<ContributorParticle*>(vbo_.map(QOpenGLBuffer::ReadWrite));
-
-    if (!particles) {
+    auto* vertices = static_cast<ParticleVertex*>(vbo_.mapRange(0,
+        static_cast<int>(simulator_.size() * sizeof(ParticleVertex)),
+        QOpenGLBuffer::RangeWrite | QOpenGLBuffer::RangeInvalidateBuffer));
+    simulator_.step(deltaTime, time_, wind, treeCenter, vertices);
+    if (vertices) {
         vbo_.unmap();
-        vbo_.release();
-        return;
     }
-
-    const float stiffness = 8.0f;   // Сила возврата к restPosition
-    const float damping = 3.0f;     // Затухание
-
-    for (int i = 0; i < particleCount_; ++i) {
-        ContributorParticle& p = particles[i];
-
-        // 1. Wind force (ветер)
-        float heightFactor = (p.restPosition.y() - treeCenter.y()) / 5.0f;
-        heightFactor = std::clamp(heightFactor, 0.3f, 1.2f);
-
-        float gust = std::sin(time_ * wind.gustSpeed + p.phase) * wind.gustStrength;
-        float turbulenceX = std::sin(time_ * 2.3f + p.restPosition.y() * 1.5f) * wind.turbulence;
-        float turbulenceZ = std::cos(time_ * 1.7f + p.restPosition.x() * 1.2f) * wind.turbulence;
-
-        QVector3D windForce = wind.direction * (wind.strength + gust) * heightFactor;
-        windForce.setX(windForce.x() + turbulenceX);
-        windForce.setZ(windForce.z() + turbulenceZ);
-        windForce *= p.windWeight;
-
-        // 2. Spring force (возврат к restPosition)
-        QVector3D springForce = (p.restPosition - p.position) * stiffness;
-
-        // 3. Damping force (затухание)
-        QVector3D dampingForce = -p.velocity * damping;
-
-        // Суммарная сила
-        QVector3D acceleration = windForce + springForce + dampingForce;
-
-        // Обновление скорости и позиции
-        p.velocity += acceleration * deltaTime;
-        p.position += p.velocity * deltaTime;
-
-        // Небольшое затухание скорости
-        p.velocity *= 0.99f;
-    }
-
-    vbo_.unmap();
     vbo_.release();
 }
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "contributor/ContributorParticles.h"
+#include "renderers/ParticleSimulator.h"
 
 class ParticleRenderer : protected QOpenGLFunctions_3_3_Core {
 public:
@@ -14,8 +15,14 @@ public:
     ~ParticleRenderer();
 
     void initialize();
+    // Steps simulator() and writes the vertices into the mapped VBO
     void update(float deltaTime, const ContributorWindField& wind, const QVector3D& treeCenter);
     void updateParticles(const std::vector<ContributorParticle>& particles);
+    // Particles edited in place through simulator(): uploads [first, first + count),
+    // or everything when the particle count changed since the last upload
+    void uploadParticles(size_t first, size_t count);
+    ParticleSimulator& simulator() { return simulator_; }
+    const ParticleSimulator& simulator() const { return simulator_; }
     void render(const QMatrix4x4& mvp, const QMatrix4x4& view, const QVector3D& cameraPos);
     bool isInitialized() const { return initialized_; }
 
@@ -33,7 +40,8 @@ private:
     QOpenGLVertexArrayObject vao_;
     QOpenGLBuffer vbo_;
 
-    int particleCount_ = 0;
+    ParticleSimulator simulator_;
+    int particleCount_ = 0; // particles in the VBO
     bool initialized_ = false;
     float time_ = 0.0f;
 };
\ No newline at end of file
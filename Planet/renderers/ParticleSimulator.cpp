@@ -0,0 +1,168 @@
+#include "renderers/ParticleSimulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/ParallelFor.h"
+
+void ParticleSimulator::clear() {
+    resize(0);
+}
+
+void ParticleSimulator::resize(size_t count) {
+    const size_t oldSize = size();
+    const ContributorParticle defaults;
+    for (auto* column : { &restX_, &restY_, &restZ_, &posX_, &posY_, &posZ_, &velX_, &velY_, &velZ_,
+             &windWeight_, &phase_, &gustSin_, &gustCos_, &turbulenceXSin_, &turbulenceXCos_,
+             &turbulenceZSin_, &turbulenceZCos_, &colorR_, &colorG_, &colorB_, &normalX_, &normalY_, &normalZ_,
+             &size_, &rotation_ })
+        column->resize(count);
+    for (size_t i = oldSize; i < count; ++i) setParticle(i, defaults);
+}
+
+void ParticleSimulator::assign(const std::vector<ContributorParticle>& particles) {
+    resize(0);
+    resize(particles.size());
+    for (size_t i = 0; i < particles.size(); ++i) setParticle(i, particles[i]);
+}
+
+void ParticleSimulator::setParticle(size_t index, const ContributorParticle& p) {
+    restX_[index] = p.restPosition.x();
+    restY_[index] = p.restPosition.y();
+    restZ_[index] = p.restPosition.z();
+    posX_[index] = p.position.x();
+    posY_[index] = p.position.y();
+    posZ_[index] = p.position.z();
+    velX_[index] = p.velocity.x();
+    velY_[index] = p.velocity.y();
+    velZ_[index] = p.velocity.z();
+    windWeight_[index] = p.windWeight;
+    phase_[index] = p.phase;
+    gustSin_[index] = std::sin(p.phase);
+    gustCos_[index] = std::cos(p.phase);
+    turbulenceXSin_[index] = std::sin(p.restPosition.y() * 1.5f);
+    turbulenceXCos_[index] = std::cos(p.restPosition.y() * 1.5f);
+    turbulenceZSin_[index] = std::sin(p.restPosition.x() * 1.2f);
+    turbulenceZCos_[index] = std::cos(p.restPosition.x() * 1.2f);
+    colorR_[index] = p.color.x();
+    colorG_[index] = p.color.y();
+    colorB_[index] = p.color.z();
+    normalX_[index] = p.normal.x();
+    normalY_[index] = p.normal.y();
+    normalZ_[index] = p.normal.z();
+    size_[index] = p.size;
+    rotation_[index] = p.rotation;
+}
+
+ContributorParticle ParticleSimulator::particle(size_t index) const {
+    ContributorParticle p;
+    p.restPosition = QVector3D(restX_[index], restY_[index], restZ_[index]);
+    p.position = QVector3D(posX_[index], posY_[index], posZ_[index]);
+    p.velocity = QVector3D(velX_[index], velY_[index], velZ_[index]);
+    p.color = QVector3D(colorR_[index], colorG_[index], colorB_[index]);
+    p.normal = QVector3D(normalX_[index], normalY_[index], normalZ_[index]);
+    p.size = size_[index];
+    p.windWeight = windWeight_[index];
+    p.phase = phase_[index];
+    p.rotation = rotation_[index];
+    return p;
+}
+
+void ParticleSimulator::step(float deltaTime, float time, const ContributorWindField& wind,
+    const QVector3D& treeCenter, ParticleVertex* out)
+{
+    // Ограничиваем deltaTime
+    deltaTime = std::min(deltaTime, 0.033f);
+
+    const size_t count = size();
+    const size_t chunkCount = (count + kChunkSize - 1) / kChunkSize;
+    // Чанки не пересекаются: каждая частица и её вершина пишутся одной задачей
+    parallelFor(chunkCount, resolveThreadCount(threadCount_), [&](size_t chunk, size_t) {
+        const size_t begin = chunk * kChunkSize;
+        const size_t end = std::min(count, begin + kChunkSize);
+        integrate(begin, end, deltaTime, time, wind, treeCenter);
+        if (out) writeVertices(out + begin, begin, end - begin);
+    });
+}
+
+void ParticleSimulator::integrate(size_t begin, size_t end, float deltaTime, float time,
+    const ContributorWindField& wind, const QVector3D& treeCenter)
+{
+    const float stiffness = 8.0f;   // Сила возврата к restPosition
+    const float damping = 3.0f;     // Затухание
+
+    const float windX = wind.direction.x();
+    const float windY = wind.direction.y();
+    const float windZ = wind.direction.z();
+    const float centerY = treeCenter.y();
+    // sin(a + b) = sin a cos b + cos a sin b: a - общий для кадра угол, b - фаза частицы
+    const float gustTimeSin = std::sin(time * wind.gustSpeed) * wind.gustStrength;
+    const float gustTimeCos = std::cos(time * wind.gustSpeed) * wind.gustStrength;
+    const float turbulenceXSin = std::sin(time * 2.3f) * wind.turbulence;
+    const float turbulenceXCos = std::cos(time * 2.3f) * wind.turbulence;
+    const float turbulenceZSin = std::sin(time * 1.7f) * wind.turbulence;
+    const float turbulenceZCos = std::cos(time * 1.7f) * wind.turbulence;
+
+    const float* restX = restX_.data();
+    const float* restY = restY_.data();
+    const float* restZ = restZ_.data();
+    const float* windWeight = windWeight_.data();
+    const float* gustSin = gustSin_.data();
+    const float* gustCos = gustCos_.data();
+    const float* turbulenceXSinB = turbulenceXSin_.data();
+    const float* turbulenceXCosB = turbulenceXCos_.data();
+    const float* turbulenceZSinB = turbulenceZSin_.data();
+    const float* turbulenceZCosB = turbulenceZCos_.data();
+    float* posX = posX_.data();
+    float* posY = posY_.data();
+    float* posZ = posZ_.data();
+    float* velX = velX_.data();
+    float* velY = velY_.data();
+    float* velZ = velZ_.data();
+
+    // Тот же расчёт, что был в ParticleRenderer::update, без ветвлений и sin/cos по частицам
+    for (size_t i = begin; i < end; ++i) {
+        // 1. Wind force (ветер)
+        const float heightFactor = std::min(std::max((restY[i] - centerY) / 5.0f, 0.3f), 1.2f);
+        const float gust = gustTimeSin * gustCos[i] + gustTimeCos * gustSin[i];
+        const float turbulenceX = turbulenceXSin * turbulenceXCosB[i] + turbulenceXCos * turbulenceXSinB[i];
+        const float turbulenceZ = turbulenceZCos * turbulenceZCosB[i] - turbulenceZSin * turbulenceZSinB[i];
+        const float push = (wind.strength + gust) * heightFactor;
+        const float weight = windWeight[i];
+
+        // 2. Spring + 3. Damping
+        const float ax = (windX * push + turbulenceX) * weight + (restX[i] - posX[i]) * stiffness - velX[i] * damping;
+        const float ay = windY * push * weight + (restY[i] - posY[i]) * stiffness - velY[i] * damping;
+        const float az = (windZ * push + turbulenceZ) * weight + (restZ[i] - posZ[i]) * stiffness - velZ[i] * damping;
+
+        velX[i] += ax * deltaTime;
+        velY[i] += ay * deltaTime;
+        velZ[i] += az * deltaTime;
+        posX[i] += velX[i] * deltaTime;
+        posY[i] += velY[i] * deltaTime;
+        posZ[i] += velZ[i] * deltaTime;
+
+        // Небольшое затухание скорости
+        velX[i] *= 0.99f;
+        velY[i] *= 0.99f;
+        velZ[i] *= 0.99f;
+    }
+}
+
+void ParticleSimulator::writeVertices(ParticleVertex* out, size_t first, size_t count) const {
+    for (size_t k = 0; k < count; ++k) {
+        const size_t i = first + k;
+        ParticleVertex& v = out[k];
+        v.position[0] = posX_[i];
+        v.position[1] = posY_[i];
+        v.position[2] = posZ_[i];
+        v.color[0] = colorR_[i];
+        v.color[1] = colorG_[i];
+        v.color[2] = colorB_[i];
+        v.size = size_[i];
+        v.rotation = rotation_[i];
+        v.normal[0] = normalX_[i];
+        v.normal[1] = normalY_[i];
+        v.normal[2] = normalZ_[i];
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QVector3D>
+
+#include <cstddef>
+#include <vector>
+
+#include "contributor/ContributorParticles.h"
+
+// Vertex of ParticleRenderer's VBO: only what the point shader reads.
+struct ParticleVertex {
+    float position[3];
+    float color[3];
+    float size;
+    float rotation;
+    float normal[3];
+};
+static_assert(sizeof(ParticleVertex) == 11 * sizeof(float), "ParticleVertex is uploaded as a tightly packed array");
+
+// Spring/wind simulation of ContributorParticle without GL. The particles are
+// kept as SoA float columns, so step() runs over plain arrays the compiler
+// can vectorize: the per-particle phases of the gust and turbulence waves
+// are stored as sin/cos pairs and combined with the per-frame angle by the
+// angle-sum identities, so the loop has no transcendental calls and no
+// branches. It is cut into chunks of kChunkSize particles that run on
+// parallelFor workers; the results do not depend on the thread count.
+// Vertices are written straight into a caller-provided buffer (a mapped VBO
+// or a staging array) - the simulator never reads the GPU copy back.
+class ParticleSimulator {
+public:
+    static constexpr size_t kChunkSize = 16384;
+
+    size_t size() const { return restX_.size(); }
+    bool empty() const { return restX_.empty(); }
+    void clear();
+    // Keeps the first min(size(), count) particles, new ones are default particles
+    void resize(size_t count);
+
+    void assign(const std::vector<ContributorParticle>& particles);
+    void setParticle(size_t index, const ContributorParticle& particle);
+    ContributorParticle particle(size_t index) const;
+
+    // 0 - by hardware threads; only sets larger than one chunk use them
+    void setThreadCount(int threadCount) { threadCount_ = threadCount; }
+    int threadCount() const { return threadCount_; }
+
+    // One integration step of every particle; writes all size() vertices to
+    // out when it is not null. time drives gusts and turbulence.
+    void step(float deltaTime, float time, const ContributorWindField& wind, const QVector3D& treeCenter,
+        ParticleVertex* out = nullptr);
+    // Writes vertices [first, first + count) to out[0, count)
+    void writeVertices(ParticleVertex* out, size_t first, size_t count) const;
+
+private:
+    void integrate(size_t begin, size_t end, float deltaTime, float time,
+        const ContributorWindField& wind, const QVector3D& treeCenter);
+
+    std::vector<float> restX_, restY_, restZ_;
+    std::vector<float> posX_, posY_, posZ_;
+    std::vector<float> velX_, velY_, velZ_;
+    std::vector<float> windWeight_, phase_;
+    // sin/cos of phase, restY * 1.5 and restX * 1.2
+    std::vector<float> gustSin_, gustCos_;
+    std::vector<float> turbulenceXSin_, turbulenceXCos_;
+    std::vector<float> turbulenceZSin_, turbulenceZCos_;
+    // Render-only attributes, copied to the vertices as is
+    std::vector<float> colorR_, colorG_, colorB_;
+    std::vector<float> normalX_, normalY_, normalZ_;
+    std::vector<float> size_, rotation_;
+    int threadCount_ = 0;
+};
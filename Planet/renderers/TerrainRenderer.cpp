@@ -17,9 +17,9 @@ TerrainRenderer::TerrainRenderer(QOpenGLFunctions_3_3_Core* gl,
     , vao_(vao) {
 }
 
-void TerrainRenderer::render(const HexSphereRenderer::RenderContext& ctx, GLsizei indexCount) const {
-    if (indexCount == 0 || program_ == 0 || vao_ == 0) {
-        return;
+bool TerrainRenderer::beginDraw(const HexSphereRenderer::RenderContext& ctx) const {
+    if (program_ == 0 || vao_ == 0) {
+        return false;
     }
 
     gl_->glUseProgram(program_);
@@ -40,13 +40,33 @@ void TerrainRenderer::render(const HexSphereRenderer::RenderContext& ctx, GLsize
     if (err != GL_NO_ERROR) {
         qDebug() << "OpenGL error ignored before draw:" << err;
     }
+    return true;
+}
 
-    gl_->glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, nullptr);
-
-    err = gl_->glGetError();
+void TerrainRenderer::endDraw() const {
+    GLenum err = gl_->glGetError();
     if (err != GL_NO_ERROR) {
         qDebug() << "OpenGL error ignored after draw:" << err;
     }
 
     gl_->glBindVertexArray(0);
+}
+
+void TerrainRenderer::render(const HexSphereRenderer::RenderContext& ctx, GLsizei indexCount, const void* indexOffset) const {
+    if (indexCount == 0 || !beginDraw(ctx)) {
+        return;
+    }
+
+    gl_->glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indexOffset);
+    endDraw();
+}
+
+void TerrainRenderer::renderRanges(const HexSphereRenderer::RenderContext& ctx, const GLsizei* counts,
+    const void* const* offsets, GLsizei drawCount) const {
+    if (drawCount == 0 || !beginDraw(ctx)) {
+        return;
+    }
+
+    gl_->glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_INT, offsets, drawCount);
+    endDraw();
 }
\ No newline at end of file
@@ -15,13 +15,19 @@ public:
         GLint uNormalMatrix,
         GLuint vao);
 
-    void render(const HexSphereRenderer::RenderContext& ctx, GLsizei indexCount) const;
+    void render(const HexSphereRenderer::RenderContext& ctx, GLsizei indexCount, const void* indexOffset = nullptr) const;
+    // One glMultiDrawElements over the bound IBO; offsets are in bytes
+    void renderRanges(const HexSphereRenderer::RenderContext& ctx, const GLsizei* counts,
+        const void* const* offsets, GLsizei drawCount) const;
     void updateVAO(GLuint newVao) {
         vao_ = newVao;
         qDebug() << "TerrainRenderer VAO updated to:" << newVao;
     }
 
 private:
+    bool beginDraw(const HexSphereRenderer::RenderContext& ctx) const;
+    void endDraw() const;
+
     QOpenGLFunctions_3_3_Core* gl_ = nullptr;
     GLuint program_ = 0;
     GLint uMvp_ = -1;
@@ -1,5 +1,8 @@
 #include "renderers/TerrainTessellator.h"
+#include "core/ParallelFor.h"
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <numeric>
 #include <random>
 
@@ -30,22 +33,22 @@ int TerrainTessellator::findLocalIndex(const Cell& c, int dv) {
 
 // ── высоты для рёбер/углов ──────────────────────────────────────────────────
 float TerrainTessellator::bladeHeightForEdge(const Cell& c, int edgeIdx,
-    const std::vector<Cell>& cells) const {
+    const std::vector<int>& heights) const {
     const int nId = c.neighbors[edgeIdx];
-    if (nId >= 0 && classifyEdge(c.height, cells[size_t(nId)].height, smoothMaxDelta) == EdgeMode::Slope)
-        return 0.5f * (float)c.height + 0.5f * (float)cells[size_t(nId)].height;
+    if (nId >= 0 && classifyEdge(c.height, heights[size_t(nId)], smoothMaxDelta) == EdgeMode::Slope)
+        return 0.5f * (float)c.height + 0.5f * (float)heights[size_t(nId)];
     return float(c.height);
 }
 
 float TerrainTessellator::cornerBlendTargetHeight(const Cell& c, int i,
-    const std::vector<Cell>& cells) const {
+    const std::vector<int>& heights) const {
     const int deg = (int)c.poly.size();
     const int iPrev = (i + deg - 1) % deg;
 
     const int nL = c.neighbors[iPrev], nR = c.neighbors[i];
     const bool hasL = nL >= 0, hasR = nR >= 0;
-    const int  hL = hasL ? cells[size_t(nL)].height : c.height;
-    const int  hR = hasR ? cells[size_t(nR)].height : c.height;
+    const int  hL = hasL ? heights[size_t(nL)] : c.height;
+    const int  hR = hasR ? heights[size_t(nR)] : c.height;
 
     const bool smL = hasL && (classifyEdge(c.height, hL, smoothMaxDelta) == EdgeMode::Slope);
     const bool smR = hasR && (classifyEdge(c.height, hR, smoothMaxDelta) == EdgeMode::Slope);
@@ -212,6 +215,11 @@ QVector3D TerrainTessellator::calculateCellColorWithOre(
 TerrainTessellator::PreCell
 TerrainTessellator::makePreCell(const Cell& c, const std::vector<QVector3D>& dual) const {
     PreCell pc;
+    makePreCell(c, dual, pc);
+    return pc;
+}
+
+void TerrainTessellator::makePreCell(const Cell& c, const std::vector<QVector3D>& dual, PreCell& pc) const {
     const int deg = (int)c.poly.size();
     pc.inner.resize(deg);
     pc.outerUnit.resize(deg);
@@ -230,12 +238,16 @@ TerrainTessellator::makePreCell(const Cell& c, const std::vector<QVector3D>& dua
         pc.inner[i] = liftUnit(u, pc.h);
         pc.outerUnit[i] = dual[size_t(c.poly[i])];
     }
-    return pc;
 }
 
 TerrainTessellator::TrimDirs
 TerrainTessellator::makeTrimDirs(const PreCell& pc) const {
     TrimDirs td;
+    makeTrimDirs(pc, td);
+    return td;
+}
+
+void TerrainTessellator::makeTrimDirs(const PreCell& pc, TrimDirs& td) const {
     const int deg = (int)pc.outerUnit.size();
     const float t = std::clamp(outerTrim, 0.f, 0.49f);
     td.sideL.resize(deg); td.sideR.resize(deg);
@@ -252,20 +264,25 @@ TerrainTessellator::makeTrimDirs(const PreCell& pc) const {
         td.currU[i] = slerpish(U(i), U(j), t);
         td.apexU[i] = U(i);
     }
-    return td;
 }
 
 TerrainTessellator::EdgeHeights
 TerrainTessellator::makeHeights(const Cell& c, const PreCell& pc,
-    const std::vector<Cell>& cells) const {
+    const std::vector<int>& heights) const {
+    EdgeHeights eh;
+    makeHeights(c, pc, heights, eh);
+    return eh;
+}
+
+void TerrainTessellator::makeHeights(const Cell& c, const PreCell& pc,
+    const std::vector<int>& heights, EdgeHeights& eh) const {
     const int deg = (int)c.poly.size();
-    EdgeHeights eh; eh.edgeH.resize(deg); eh.apexH.resize(deg);
+    eh.edgeH.resize(deg); eh.apexH.resize(deg);
     for (int i = 0; i < deg; ++i) {
-        eh.edgeH[i] = bladeHeightForEdge(c, i, cells);
-        const float hBlend = cornerBlendTargetHeight(c, i, cells);
+        eh.edgeH[i] = bladeHeightForEdge(c, i, heights);
+        const float hBlend = cornerBlendTargetHeight(c, i, heights);
         eh.apexH[i] = 0.5f * (pc.h + hBlend);
     }
-    return eh;
 }
 
 // ── MeshBuilder ─────────────────────────────────────────────────────────────
@@ -283,6 +300,12 @@ void TerrainTessellator::MeshBuilder::triToward(QVector3D A, QVector3D B, QVecto
         n = -n; // инвертируем нормаль при смене порядка вершин
     }
 
+    if (shared) {
+        idx.insert(idx.end(), { vertex(A, color, n), vertex(B, color, n), vertex(C, color, n) });
+        if (owner) owner->push_back(cellOwner);
+        return;
+    }
+
     const uint32_t base = uint32_t(pos.size() / 3);
 
     // Позиции
@@ -302,6 +325,38 @@ void TerrainTessellator::MeshBuilder::triToward(QVector3D A, QVector3D B, QVecto
     if (owner) owner->push_back(cellOwner);
 }
 
+void TerrainTessellator::MeshBuilder::beginShared() {
+    shared = true;
+    sharedBase = uint32_t(pos.size() / 3);
+}
+
+void TerrainTessellator::MeshBuilder::endShared() {
+    for (size_t v = size_t(sharedBase) * 3; v + 2 < norm.size(); v += 3) {
+        QVector3D n(norm[v], norm[v + 1], norm[v + 2]);
+        if (!n.isNull()) n.normalize();
+        norm[v] = n.x(); norm[v + 1] = n.y(); norm[v + 2] = n.z();
+    }
+    shared = false;
+}
+
+uint32_t TerrainTessellator::MeshBuilder::vertex(const QVector3D& p, const QVector3D& color, const QVector3D& n) {
+    // Вершин у грани клетки немного (1 + 4*deg), линейный поиск дешевле хеша.
+    // Совпадение точное: общие точки считаются одними и теми же выражениями.
+    const uint32_t end = uint32_t(pos.size() / 3);
+    for (uint32_t v = sharedBase; v < end; ++v) {
+        const size_t o = size_t(v) * 3;
+        if (pos[o] == p.x() && pos[o + 1] == p.y() && pos[o + 2] == p.z() &&
+            col[o] == color.x() && col[o + 1] == color.y() && col[o + 2] == color.z()) {
+            norm[o] += n.x(); norm[o + 1] += n.y(); norm[o + 2] += n.z();
+            return v;
+        }
+    }
+    pos.insert(pos.end(), { p.x(), p.y(), p.z() });
+    col.insert(col.end(), { color.x(), color.y(), color.z() });
+    norm.insert(norm.end(), { n.x(), n.y(), n.z() });
+    return end;
+}
+
 void TerrainTessellator::MeshBuilder::quadToward(const QVector3D& Q0, const QVector3D& Q1,
     const QVector3D& Q2, const QVector3D& Q3,
     const QVector3D& color, const QVector3D& toward,
@@ -349,9 +404,10 @@ void TerrainTessellator::buildCorners(MeshBuilder& mb, const Cell& c, const PreC
 }
 
 // ── реестр рёбер: заполнение сторон при проходе по клетке ───────────────────
-void TerrainTessellator::registerEdgeSide(EdgeRegistry& reg, size_t cid,
-    const Cell& c, int iEdge,
-    const PreCell& pc, const TrimDirs& td, const EdgeHeights& eh) const
+TerrainTessellator::EdgeSide
+TerrainTessellator::makeEdgeSide(size_t cid, const Cell& c, int iEdge,
+    const PreCell& pc, const TrimDirs& td, const EdgeHeights& eh,
+    EdgeKey& key) const
 {
     const int deg = (int)c.poly.size();
     const int j = (iEdge + 1) % deg;
@@ -359,7 +415,7 @@ void TerrainTessellator::registerEdgeSide(EdgeRegistry& reg, size_t cid,
 
     const int dv_i = c.poly[iEdge];
     const int dv_j = c.poly[j];
-    const EdgeKey key{ std::min(dv_i, dv_j), std::max(dv_i, dv_j) };
+    key = EdgeKey{ std::min(dv_i, dv_j), std::max(dv_i, dv_j) };
     const bool canon = (dv_i <= dv_j);
 
     EdgeSide S;
@@ -390,21 +446,17 @@ void TerrainTessellator::registerEdgeSide(EdgeRegistry& reg, size_t cid,
     S.P_edgeR = liftUnit(S.sideR, S.Hedge);
     S.P_apexL = liftUnit(S.apexDirL, S.apexL);
     S.P_apexR = liftUnit(S.apexDirR, S.apexR);
-
-    auto& rec = reg[key];
-    if (!rec.A) rec.A = S;
-    else        rec.B = S;
+    return S;
 }
 
-// ── пост-проход: генерация клифов по парам сторон ───────────────────────────
-void TerrainTessellator::finalizeCliffs(const EdgeRegistry& reg,
-    MeshBuilder& mb,
-    const std::vector<Cell>& cells) const
+// ── пост-проход: клиф/шов по паре сторон ребра ──────────────────────────────
+void TerrainTessellator::emitEdgeSeam(MeshBuilder& mb, const EdgeSide& A, const EdgeSide& B,
+    const std::vector<QVector3D>& centroids) const
 {
     const QVector3D cliffColor(0.55f, 0.38f, 0.25f);
 
     auto towardDir = [&](const EdgeSide& hi, const EdgeSide& lo) {
-        QVector3D t = cells[size_t(lo.cellId)].centroid - cells[size_t(hi.cellId)].centroid;
+        QVector3D t = centroids[size_t(lo.cellId)] - centroids[size_t(hi.cellId)];
         if (t.isNull()) t = (hi.P_edgeL + hi.P_edgeR + lo.P_edgeL + lo.P_edgeR);
         return t;
         };
@@ -413,83 +465,481 @@ void TerrainTessellator::finalizeCliffs(const EdgeRegistry& reg,
         return (a - b).lengthSquared() > (epsApex * epsApex);
         };
 
-    for (const auto& [key, rec] : reg) {
-        if (!rec.A || !rec.B) continue;
-        const EdgeSide& A = *rec.A;
-        const EdgeSide& B = *rec.B;
+    const EdgeMode mode = classifyEdge(A.hCell, B.hCell, smoothMaxDelta);
+    const bool AisHigh = (A.hCell > B.hCell);
+    const EdgeSide& hi = AisHigh ? A : B;
+    const EdgeSide& lo = AisHigh ? B : A;
+    const QVector3D toward = towardDir(hi, lo);
 
-        const EdgeMode mode = classifyEdge(A.hCell, B.hCell, smoothMaxDelta);
-        const bool AisHigh = (A.hCell > B.hCell);
-        const EdgeSide& hi = AisHigh ? A : B;
-        const EdgeSide& lo = AisHigh ? B : A;
-        const QVector3D toward = towardDir(hi, lo);
+    if (mode == EdgeMode::Cliff) {
+        // центральный прямоугольник (общая полоса между inner-прямоугольниками)
+        mb.quadToward(hi.P_edgeL, hi.P_edgeR, lo.P_edgeR, lo.P_edgeL, cliffColor, toward, hi.cellId);
 
-        if (mode == EdgeMode::Cliff) {
-            // центральный прямоугольник (общая полоса между inner-прямоугольниками)
-            mb.quadToward(hi.P_edgeL, hi.P_edgeR, lo.P_edgeR, lo.P_edgeL, cliffColor, toward, hi.cellId);
+        // левая трапеция (общая вершина — P_edgeL)
+        mb.quadToward(hi.P_edgeL, hi.P_apexL, lo.P_apexL, lo.P_edgeL, cliffColor, toward, hi.cellId);
 
-            // левая трапеция (общая вершина — P_edgeL)
-            mb.quadToward(hi.P_edgeL, hi.P_apexL, lo.P_apexL, lo.P_edgeL, cliffColor, toward, hi.cellId);
+        // правая трапеция (общая вершина — P_edgeR)
+        mb.quadToward(hi.P_edgeR, hi.P_apexR, lo.P_apexR, lo.P_edgeR, cliffColor, toward, hi.cellId);
+    }
+    else if (mode == EdgeMode::Slope) {
+        // только если апексы отличаются — шьём угловые треугольники к общей точке полосы
+        if (diff(A.P_apexL, B.P_apexL))
+        {
+            const bool aHigher = (A.apexL > B.apexL);
+            mb.triToward(aHigher ? A.P_apexL : B.P_apexL,
+                aHigher ? A.P_edgeL : B.P_edgeL,
+                aHigher ? B.P_apexL : A.P_apexL,
+                cliffColor, toward,
+                aHigher ? A.cellId : B.cellId);
+        }
 
-            // правая трапеция (общая вершина — P_edgeR)
-            mb.quadToward(hi.P_edgeR, hi.P_apexR, lo.P_apexR, lo.P_edgeR, cliffColor, toward, hi.cellId);
+        if (diff(A.P_apexR, B.P_apexR))
+        {
+            const bool aHigher = (A.apexR > B.apexR);
+            mb.triToward(aHigher ? A.P_apexR : B.P_apexR,
+                aHigher ? A.P_edgeR : B.P_edgeR,
+                aHigher ? B.P_apexR : A.P_apexR,
+                cliffColor, toward,
+                aHigher ? A.cellId : B.cellId);
         }
-        else if (mode == EdgeMode::Slope) {
-            // только если апексы отличаются — шьём угловые треугольники к общей точке полосы
-            if (diff(A.P_apexL, B.P_apexL))
-            {
-                const bool aHigher = (A.apexL > B.apexL);
-                mb.triToward(aHigher ? A.P_apexL : B.P_apexL,
-                    aHigher ? A.P_edgeL : B.P_edgeL,
-                    aHigher ? B.P_apexL : A.P_apexL,
-                    cliffColor, toward,
-                    aHigher ? A.cellId : B.cellId);
-            }
+    }
+}
+
+// ── тело клетки: caps + лопасти + углы ──────────────────────────────────────
+void TerrainTessellator::buildCellBody(MeshBuilder& mb, const Cell& c, const PreCell& pc,
+    const TrimDirs& td, const EdgeHeights& eh) const
+{
+    if (indexedOutput) mb.beginShared();
+    if (doCaps)       buildInnerFan(mb, c, pc);
+    if (doBlades)     buildBlades(mb, c, pc, td, eh);
+    if (doCornerTris) buildCorners(mb, c, pc, td, eh);
+    if (indexedOutput) mb.endShared();
+}
+
+// ── чанк клеток: геометрия клеток + стороны рёбер в порядке регистрации ─────
+void TerrainTessellator::buildChunk(const HexSphereModel& model, size_t cellBegin, size_t cellEnd,
+    CellScratch& scratch, ChunkResult& out) const
+{
+    const auto& cells = model.cells();
+    const auto& heights = model.columns().height; // уже синхронизирована в build()
+    const auto& dual = model.dualVerts();
+
+    MeshBuilder mb{ out.mesh.pos, out.mesh.col, out.mesh.norm, out.mesh.idx };
+    mb.owner = &out.mesh.triOwner;
+    out.cellRanges.assign(cellEnd - cellBegin, TerrainMeshRange{});
+
+    for (size_t cid = cellBegin; cid < cellEnd; ++cid) {
+        const Cell& c = cells[cid];
+        const int deg = (int)c.poly.size();
+        TerrainMeshRange& range = out.cellRanges[cid - cellBegin];
+        range.firstTri = uint32_t(out.mesh.idx.size() / 3);
+        range.firstVertex = uint32_t(out.mesh.pos.size() / 3);
+        if (deg < 3) continue;
+
+        makePreCell(c, dual, scratch.pc);
+        makeTrimDirs(scratch.pc, scratch.td);
+        makeHeights(c, scratch.pc, heights, scratch.eh);
 
-            if (diff(A.P_apexR, B.P_apexR))
-            {
-                const bool aHigher = (A.apexR > B.apexR);
-                mb.triToward(aHigher ? A.P_apexR : B.P_apexR,
-                    aHigher ? A.P_edgeR : B.P_edgeR,
-                    aHigher ? B.P_apexR : A.P_apexR,
-                    cliffColor, toward,
-                    aHigher ? A.cellId : B.cellId);
+        buildCellBody(mb, c, scratch.pc, scratch.td, scratch.eh);
+        range.triCount = uint32_t(out.mesh.idx.size() / 3) - range.firstTri;
+        range.triCapacity = range.triCount;
+        range.vertexCount = uint32_t(out.mesh.pos.size() / 3) - range.firstVertex;
+        range.vertexCapacity = range.vertexCount;
+
+        // регистрируем профиль каждой стороны ребра (для пост-прохода)
+        if (doEdgeCliffs) {
+            for (int i = 0; i < deg; ++i) {
+                SideEntry& entry = out.sides.emplace_back();
+                entry.edge = i;
+                entry.side = makeEdgeSide(cid, c, i, scratch.pc, scratch.td, scratch.eh, entry.key);
             }
         }
     }
 }
 
+void TerrainTessellator::appendMesh(TerrainMesh& dst, const TerrainMesh& src) {
+    const uint32_t base = uint32_t(dst.pos.size() / 3);
+    dst.pos.insert(dst.pos.end(), src.pos.begin(), src.pos.end());
+    dst.col.insert(dst.col.end(), src.col.begin(), src.col.end());
+    dst.norm.insert(dst.norm.end(), src.norm.begin(), src.norm.end());
+    dst.triOwner.insert(dst.triOwner.end(), src.triOwner.begin(), src.triOwner.end());
+    dst.idx.reserve(dst.idx.size() + src.idx.size());
+    for (uint32_t i : src.idx) dst.idx.push_back(base + i);
+}
+
+int TerrainTessellator::resolvedThreadCount() const {
+    return resolveThreadCount(threadCount);
+}
+
 // ── главный проход ──────────────────────────────────────────────────────────
+// Клетки режутся на непрерывные диапазоны id; каждый поток пишет в свой
+// TerrainMesh. Склейка идёт в порядке чанков, клифы - в порядке первой
+// регистрации ребра, поэтому результат не зависит от числа потоков.
 TerrainMesh TerrainTessellator::build(const HexSphereModel& model) const {
+    const auto& cells = model.cells();
+    const auto& centroids = model.topology().centroids;
+    model.columns(); // ленивая синхронизация колонок - до запуска потоков
+    const int threads = resolvedThreadCount();
+    const size_t chunkCells = size_t(std::max(cellsPerChunk, 1));
+    const size_t chunkCount = threads > 1 ? (cells.size() + chunkCells - 1) / chunkCells : 1;
+
+    std::vector<ChunkResult> chunks(chunkCount);
+    std::vector<CellScratch> scratch(static_cast<size_t>(threads));
+    parallelFor(chunkCount, threads, [&](size_t chunk, size_t worker) {
+        const size_t begin = chunk * cells.size() / chunkCount;
+        const size_t end = (chunk + 1) * cells.size() / chunkCount;
+        buildChunk(model, begin, end, scratch[worker], chunks[chunk]);
+    });
+
     TerrainMesh M;
+    M.indexed = indexedOutput;
+    size_t posTotal = 0, idxTotal = 0, triTotal = 0;
+    for (const auto& chunk : chunks) {
+        posTotal += chunk.mesh.pos.size();
+        idxTotal += chunk.mesh.idx.size();
+        triTotal += chunk.mesh.triOwner.size();
+    }
+    M.pos.reserve(posTotal); M.col.reserve(posTotal); M.norm.reserve(posTotal);
+    M.idx.reserve(idxTotal); M.triOwner.reserve(triTotal);
+
+    // Раскладка по клеткам: диапазоны тел и CSR "ребро клетки -> шов"
+    M.cellRanges.reserve(cells.size());
+    M.cellSeamOffsets = model.topology().offsets;
+    M.cellSeams.assign(M.cellSeamOffsets.back(), -1);
+
+    for (const auto& chunk : chunks) {
+        const uint32_t baseTri = uint32_t(M.idx.size() / 3);
+        const uint32_t baseVertex = uint32_t(M.pos.size() / 3);
+        for (TerrainMeshRange range : chunk.cellRanges) {
+            range.firstTri += baseTri;
+            range.firstVertex += baseVertex;
+            M.cellRanges.push_back(range);
+        }
+        appendMesh(M, chunk.mesh);
+    }
+
+    if (!doEdgeCliffs) return M;
+
+    // Все стороны в глобальном порядке регистрации (клетка, локальное ребро)
+    std::vector<const SideEntry*> sides;
+    for (const auto& chunk : chunks)
+        for (const auto& entry : chunk.sides) sides.push_back(&entry);
+
+    // Пары сторон одного ребра: stable_sort сохраняет порядок регистрации внутри ключа,
+    // так что A - первая сторона, B - последняя (как в EdgeRegistry).
+    std::vector<uint32_t> byKey(sides.size());
+    std::iota(byKey.begin(), byKey.end(), 0u);
+    std::stable_sort(byKey.begin(), byKey.end(), [&](uint32_t l, uint32_t r) {
+        const EdgeKey& a = sides[l]->key;
+        const EdgeKey& b = sides[r]->key;
+        return a.v0 != b.v0 ? a.v0 < b.v0 : a.v1 < b.v1;
+    });
+
+    std::vector<std::pair<uint32_t, uint32_t>> pairs;
+    pairs.reserve(sides.size() / 2);
+    for (size_t i = 0; i < byKey.size();) {
+        size_t j = i + 1;
+        while (j < byKey.size() && sides[byKey[j]]->key == sides[byKey[i]]->key) ++j;
+        if (j - i >= 2) pairs.emplace_back(byKey[i], byKey[j - 1]);
+        i = j;
+    }
+    std::sort(pairs.begin(), pairs.end());
+
+    M.seamSides.resize(pairs.size());
+    M.seamRanges.resize(pairs.size());
+    for (size_t p = 0; p < pairs.size(); ++p) {
+        const SideEntry& A = *sides[pairs[p].first];
+        const SideEntry& B = *sides[pairs[p].second];
+        M.seamSides[p] = TerrainMeshSeam{ A.side.cellId, A.edge, B.side.cellId, B.edge };
+        M.cellSeams[M.cellSeamOffsets[size_t(A.side.cellId)] + uint32_t(A.edge)] = int(p);
+        M.cellSeams[M.cellSeamOffsets[size_t(B.side.cellId)] + uint32_t(B.edge)] = int(p);
+    }
+
+    const size_t seamChunkCount = threads > 1 ? std::min(chunkCount, pairs.size()) : 1;
+    std::vector<TerrainMesh> seams(std::max<size_t>(seamChunkCount, 1));
+    parallelFor(seamChunkCount, threads, [&](size_t chunk, size_t) {
+        TerrainMesh& seam = seams[chunk];
+        MeshBuilder mb{ seam.pos, seam.col, seam.norm, seam.idx };
+        mb.owner = &seam.triOwner;
+        const size_t begin = chunk * pairs.size() / seamChunkCount;
+        const size_t end = (chunk + 1) * pairs.size() / seamChunkCount;
+        for (size_t p = begin; p < end; ++p) {
+            TerrainMeshRange& range = M.seamRanges[p];
+            range.firstTri = uint32_t(seam.idx.size() / 3);
+            range.firstVertex = uint32_t(seam.pos.size() / 3);
+            emitEdgeSeam(mb, sides[pairs[p].first]->side, sides[pairs[p].second]->side, centroids);
+            range.triCount = uint32_t(seam.idx.size() / 3) - range.firstTri;
+            range.triCapacity = range.triCount;
+            range.vertexCount = uint32_t(seam.pos.size() / 3) - range.firstVertex;
+            range.vertexCapacity = range.vertexCount;
+        }
+    });
+    for (size_t chunk = 0; chunk < seamChunkCount; ++chunk) {
+        const uint32_t baseTri = uint32_t(M.idx.size() / 3);
+        const uint32_t baseVertex = uint32_t(M.pos.size() / 3);
+        const size_t begin = chunk * pairs.size() / seamChunkCount;
+        const size_t end = (chunk + 1) * pairs.size() / seamChunkCount;
+        for (size_t p = begin; p < end; ++p) {
+            M.seamRanges[p].firstTri += baseTri;
+            M.seamRanges[p].firstVertex += baseVertex;
+        }
+        appendMesh(M, seams[chunk]);
+    }
+
+    return M;
+}
+
+// ── инкрементальная перестройка ─────────────────────────────────────────────
+namespace {
+    void addByteRange(std::vector<TerrainMeshByteRange>& ranges, size_t offset, size_t size) {
+        if (size > 0) ranges.push_back(TerrainMeshByteRange{ offset, size });
+    }
+
+    // Сортирует и склеивает пересекающиеся/соседние диапазоны
+    void coalesceByteRanges(std::vector<TerrainMeshByteRange>& ranges) {
+        std::sort(ranges.begin(), ranges.end(), [](const auto& a, const auto& b) {
+            return a.offset < b.offset;
+        });
+        size_t out = 0;
+        for (size_t i = 0; i < ranges.size(); ++i) {
+            if (out > 0 && ranges[out - 1].offset + ranges[out - 1].size >= ranges[i].offset) {
+                const size_t end = std::max(ranges[out - 1].offset + ranges[out - 1].size,
+                    ranges[i].offset + ranges[i].size);
+                ranges[out - 1].size = end - ranges[out - 1].offset;
+            }
+            else {
+                ranges[out++] = ranges[i];
+            }
+        }
+        ranges.resize(out);
+    }
+
+    constexpr size_t kVertexStride = 3 * sizeof(float);
+    constexpr size_t kTriIndexBytes = 3 * sizeof(uint32_t);
+}
+
+bool TerrainTessellator::hasCellLayout(const TerrainMesh& mesh, const HexSphereModel& model) const {
+    const size_t cellCount = model.cells().size();
+    if (mesh.cellRanges.size() != cellCount || mesh.cellSeamOffsets.size() != cellCount + 1) return false;
+    if (mesh.seamRanges.size() != mesh.seamSides.size()) return false;
+    if (doEdgeCliffs && mesh.seamRanges.empty() && cellCount > 1) return false;
+    if (mesh.indexed != indexedOutput || mesh.idx.size() != mesh.triOwner.size() * 3) return false;
+    if (mesh.col.size() != mesh.pos.size() || mesh.norm.size() != mesh.pos.size()) return false;
+    return indexedOutput || mesh.pos.size() == mesh.idx.size() * 3;
+}
+
+void TerrainTessellator::writeSlot(TerrainMesh& mesh, TerrainMeshRange& range,
+    const TerrainMesh& src, TerrainMeshPatch& patch)
+{
+    const uint32_t newCount = uint32_t(src.idx.size() / 3);
+    const uint32_t newVertices = uint32_t(src.pos.size() / 3);
+    const size_t firstFloat = size_t(range.firstVertex) * 3;
+
+    std::copy(src.pos.begin(), src.pos.end(), mesh.pos.begin() + firstFloat);
+    std::copy(src.col.begin(), src.col.end(), mesh.col.begin() + firstFloat);
+    std::copy(src.norm.begin(), src.norm.end(), mesh.norm.begin() + firstFloat);
+    std::copy(src.triOwner.begin(), src.triOwner.end(), mesh.triOwner.begin() + range.firstTri);
+    addByteRange(patch.vertexBytes, size_t(range.firstVertex) * kVertexStride, size_t(newVertices) * kVertexStride);
+
+    // Живые треугольники - на вершины слота, вырожденные - на его первую вершину.
+    // Пишем только изменившиеся индексы: при той же топологии буфер не трогаем.
+    uint32_t from = std::numeric_limits<uint32_t>::max(), to = 0;
+    for (uint32_t t = 0; t < std::max(newCount, range.triCount); ++t) {
+        const bool live = t < newCount;
+        const size_t tri = size_t(range.firstTri) + t;
+        for (size_t k = 0; k < 3; ++k) {
+            const uint32_t v = range.firstVertex + (live ? src.idx[size_t(t) * 3 + k] : 0u);
+            if (mesh.idx[tri * 3 + k] != v) {
+                mesh.idx[tri * 3 + k] = v;
+                from = std::min(from, t);
+                to = std::max(to, t + 1);
+            }
+        }
+        if (!live) mesh.triOwner[tri] = -1;
+    }
+    if (from < to)
+        addByteRange(patch.indexBytes, size_t(range.firstTri + from) * kTriIndexBytes, size_t(to - from) * kTriIndexBytes);
+    addByteRange(patch.slotIndexBytes, size_t(range.firstTri) * kTriIndexBytes,
+        size_t(std::max(newCount, range.triCount)) * kTriIndexBytes);
+
+    mesh.slackTris = mesh.slackTris + range.triCount - newCount;
+    range.triCount = newCount;
+    range.vertexCount = newVertices;
+}
+
+TerrainMeshPatch TerrainTessellator::retessellateCells(const HexSphereModel& model,
+    const std::vector<int>& dirtyCells, TerrainMesh& mesh) const
+{
+    TerrainMeshPatch patch;
     const auto& cells = model.cells();
+    const auto& heights = model.columns().height;
+    const auto& centroids = model.topology().centroids;
     const auto& dual = model.dualVerts();
 
-    // Инициализация MeshBuilder с поддержкой нормалей
-    MeshBuilder mb{ M.pos, M.col, M.norm, M.idx };
-    mb.owner = &M.triOwner;
-    EdgeRegistry reg;
-
-    for (size_t cid = 0; cid < cells.size(); ++cid) {
-        const Cell& c = cells[cid];
+    auto rebuildAll = [&]() {
+        mesh = build(model);
+        patch = TerrainMeshPatch{};
+        patch.fullRebuild = true;
+        patch.cellsRetessellated = cells.size();
+        return patch;
+    };
+
+    if (!hasCellLayout(mesh, model)) return rebuildAll();
+
+    // Тела: грязные клетки + одно кольцо (их лопасти/углы зависят от высоты соседа)
+    std::vector<int> bodies;
+    for (int cid : dirtyCells) {
+        if (cid < 0 || size_t(cid) >= cells.size()) continue;
+        bodies.push_back(cid);
+        for (int n : model.topology().neighborsOf(cid))
+            if (n >= 0) bodies.push_back(n);
+    }
+    std::sort(bodies.begin(), bodies.end());
+    bodies.erase(std::unique(bodies.begin(), bodies.end()), bodies.end());
+    if (bodies.empty()) return patch;
+
+    // Швы на всех рёбрах затронутых тел
+    std::vector<int> seamIds;
+    for (int cid : bodies) {
+        for (uint32_t e = mesh.cellSeamOffsets[size_t(cid)]; e < mesh.cellSeamOffsets[size_t(cid) + 1]; ++e)
+            if (mesh.cellSeams[e] >= 0) seamIds.push_back(mesh.cellSeams[e]);
+    }
+    std::sort(seamIds.begin(), seamIds.end());
+    seamIds.erase(std::unique(seamIds.begin(), seamIds.end()), seamIds.end());
+
+    // Профили сторон нужны и для внешнего кольца, поэтому считаем их по клеткам
+    std::vector<int> sideCells;
+    for (int s : seamIds) {
+        sideCells.push_back(mesh.seamSides[size_t(s)].cellA);
+        sideCells.push_back(mesh.seamSides[size_t(s)].cellB);
+    }
+    sideCells.insert(sideCells.end(), bodies.begin(), bodies.end());
+    std::sort(sideCells.begin(), sideCells.end());
+    sideCells.erase(std::unique(sideCells.begin(), sideCells.end()), sideCells.end());
+
+    CellScratch scratch;
+    TerrainMesh local;
+    std::vector<std::vector<EdgeSide>> cellSides(sideCells.size());
+    for (size_t k = 0; k < sideCells.size(); ++k) {
+        const int cid = sideCells[k];
+        const Cell& c = cells[size_t(cid)];
         const int deg = (int)c.poly.size();
         if (deg < 3) continue;
 
-        const PreCell    pc = makePreCell(c, dual);
-        const TrimDirs   td = makeTrimDirs(pc);
-        const EdgeHeights eh = makeHeights(c, pc, cells);
-
-        if (doCaps)       buildInnerFan(mb, c, pc);
-        if (doBlades)     buildBlades(mb, c, pc, td, eh);
-        if (doCornerTris) buildCorners(mb, c, pc, td, eh);
+        makePreCell(c, dual, scratch.pc);
+        makeTrimDirs(scratch.pc, scratch.td);
+        makeHeights(c, scratch.pc, heights, scratch.eh);
 
-        // регистрируем профиль каждой стороны ребра (для пост-прохода)
         if (doEdgeCliffs) {
+            cellSides[k].resize(size_t(deg));
+            EdgeKey key{};
             for (int i = 0; i < deg; ++i)
-                registerEdgeSide(reg, cid, c, i, pc, td, eh);
+                cellSides[k][size_t(i)] = makeEdgeSide(size_t(cid), c, i, scratch.pc, scratch.td, scratch.eh, key);
         }
+
+        if (!std::binary_search(bodies.begin(), bodies.end(), cid)) continue;
+
+        // Число треугольников тела зависит только от степени клетки, так что слот совпадает
+        local = TerrainMesh{};
+        MeshBuilder mb{ local.pos, local.col, local.norm, local.idx };
+        mb.owner = &local.triOwner;
+        buildCellBody(mb, c, scratch.pc, scratch.td, scratch.eh);
+        TerrainMeshRange& range = mesh.cellRanges[size_t(cid)];
+        if (local.idx.size() / 3 != range.triCapacity || local.pos.size() / 3 > range.vertexCapacity)
+            return rebuildAll();
+        writeSlot(mesh, range, local, patch);
+        ++patch.cellsRetessellated;
     }
 
-    if (doEdgeCliffs) finalizeCliffs(reg, mb, cells);
-    return M;
-}
\ No newline at end of file
+    auto sideOf = [&](int cid, int edge) -> const EdgeSide& {
+        const size_t k = size_t(std::lower_bound(sideCells.begin(), sideCells.end(), cid) - sideCells.begin());
+        return cellSides[k][size_t(edge)];
+    };
+
+    for (int s : seamIds) {
+        const TerrainMeshSeam& seam = mesh.seamSides[size_t(s)];
+        local = TerrainMesh{};
+        MeshBuilder mb{ local.pos, local.col, local.norm, local.idx };
+        mb.owner = &local.triOwner;
+        emitEdgeSeam(mb, sideOf(seam.cellA, seam.edgeA), sideOf(seam.cellB, seam.edgeB), centroids);
+
+        TerrainMeshRange& range = mesh.seamRanges[size_t(s)];
+        if (local.idx.size() / 3 > range.triCapacity || local.pos.size() / 3 > range.vertexCapacity) {
+            // Шов вырос (например, склон стал клифом): старый слот вырождаем,
+            // новый с запасом на максимальный шов кладём в хвост буферов.
+            writeSlot(mesh, range, TerrainMesh{}, patch);
+
+            // Швы всегда плоские: три вершины на треугольник
+            const uint32_t capacity = std::max<uint32_t>(uint32_t(local.idx.size() / 3), kMaxSeamTris);
+            range.firstTri = uint32_t(mesh.idx.size() / 3);
+            range.triCount = 0;
+            range.triCapacity = capacity;
+            range.firstVertex = uint32_t(mesh.pos.size() / 3);
+            range.vertexCount = 0;
+            range.vertexCapacity = capacity * 3;
+            mesh.pos.resize(mesh.pos.size() + size_t(capacity) * 9, 0.f);
+            mesh.col.resize(mesh.col.size() + size_t(capacity) * 9, 0.f);
+            mesh.norm.resize(mesh.norm.size() + size_t(capacity) * 9, 0.f);
+            mesh.triOwner.resize(mesh.triOwner.size() + capacity, -1);
+            for (uint32_t t = 0; t < capacity; ++t)
+                mesh.idx.insert(mesh.idx.end(), { range.firstVertex, range.firstVertex, range.firstVertex });
+            mesh.slackTris += capacity;
+            addByteRange(patch.indexBytes, size_t(range.firstTri) * kTriIndexBytes, size_t(capacity) * kTriIndexBytes);
+            patch.resized = true;
+        }
+        writeSlot(mesh, range, local, patch);
+        ++patch.seamsRetessellated;
+    }
+
+    // Слишком много вырожденных треугольников - дешевле уплотнить сетку целиком
+    if (size_t(mesh.slackTris) * 8 > mesh.triOwner.size()) return rebuildAll();
+
+    coalesceByteRanges(patch.vertexBytes);
+    coalesceByteRanges(patch.indexBytes);
+    coalesceByteRanges(patch.slotIndexBytes);
+    return patch;
+}
+
+// ── упакованный формат вершин ───────────────────────────────────────────────
+uint32_t packTerrainNormal(const QVector3D& n) {
+    auto snorm10 = [](float v) {
+        const int q = int(std::lround(std::clamp(v, -1.f, 1.f) * 511.f));
+        return uint32_t(q) & 0x3FFu;
+    };
+    return snorm10(n.x()) | (snorm10(n.y()) << 10) | (snorm10(n.z()) << 20);
+}
+
+QVector3D unpackTerrainNormal(uint32_t packed) {
+    auto component = [packed](int shift) {
+        int v = int((packed >> shift) & 0x3FFu);
+        if (v & 0x200) v -= 0x400;
+        return std::max(float(v) / 511.f, -1.f);
+    };
+    return QVector3D(component(0), component(10), component(20));
+}
+
+uint32_t packTerrainColor(const QVector3D& c) {
+    auto unorm8 = [](float v) { return uint32_t(std::lround(std::clamp(v, 0.f, 1.f) * 255.f)); };
+    return unorm8(c.x()) | (unorm8(c.y()) << 8) | (unorm8(c.z()) << 16) | (0xFFu << 24);
+}
+
+QVector3D unpackTerrainColor(uint32_t packed) {
+    return QVector3D(float(packed & 0xFFu), float((packed >> 8) & 0xFFu), float((packed >> 16) & 0xFFu)) / 255.f;
+}
+
+void packTerrainVertices(const TerrainMesh& mesh, size_t firstVertex, size_t count, TerrainPackedVertex* out) {
+    for (size_t v = firstVertex; v < firstVertex + count; ++v, ++out) {
+        const size_t o = v * 3;
+        out->x = mesh.pos[o];
+        out->y = mesh.pos[o + 1];
+        out->z = mesh.pos[o + 2];
+        out->normal = packTerrainNormal(QVector3D(mesh.norm[o], mesh.norm[o + 1], mesh.norm[o + 2]));
+        out->color = packTerrainColor(QVector3D(mesh.col[o], mesh.col[o + 1], mesh.col[o + 2]));
+    }
+}
+
+std::vector<TerrainPackedVertex> packTerrainVertices(const TerrainMesh& mesh) {
+    std::vector<TerrainPackedVertex> out(mesh.pos.size() / 3);
+    packTerrainVertices(mesh, 0, out.size(), out.data());
+    return out;
+}
@@ -9,12 +9,79 @@
 #include <random>
 #include <array>
 
+// Слот треугольников в TerrainMesh: треугольники [firstTri, firstTri+triCapacity),
+// вершины [firstVertex, firstVertex+vertexCapacity). В плоском выводе у каждого
+// треугольника три собственные вершины (firstVertex = 3*firstTri), в индексированном
+// тело клетки делит вершины. Треугольники за triCount вырождены (все индексы на
+// firstVertex, владелец -1).
+struct TerrainMeshRange {
+    uint32_t firstTri = 0;
+    uint32_t triCount = 0;
+    uint32_t triCapacity = 0;
+    uint32_t firstVertex = 0;
+    uint32_t vertexCount = 0;
+    uint32_t vertexCapacity = 0;
+};
+
+// Две стороны шва: клетка/локальное ребро, зарегистрированные первой (A) и второй (B)
+struct TerrainMeshSeam {
+    int cellA = -1, edgeA = -1;
+    int cellB = -1, edgeB = -1;
+};
+
 struct TerrainMesh {
     std::vector<float>    pos; // xyz...
     std::vector<float>    col; // rgb...
     std::vector<float>    norm; // нормали: nx,ny,nz...
     std::vector<uint32_t> idx; // indices
     std::vector<int> triOwner;   // владелец треугольника
+    bool indexed = false;        // построен с TerrainTessellator::indexedOutput
+
+    // Раскладка по клеткам для TerrainTessellator::retessellateCells
+    std::vector<TerrainMeshRange> cellRanges;      // тело клетки, по id
+    std::vector<TerrainMeshRange> seamRanges;      // шов ребра (клиф/стык склона)
+    std::vector<TerrainMeshSeam>  seamSides;
+    std::vector<uint32_t>         cellSeamOffsets; // CSR: рёбра клетки c - [off[c], off[c+1])
+    std::vector<int>              cellSeams;       // шов на ребре клетки или -1
+    uint32_t                      slackTris = 0;   // вырожденные треугольники в слотах
+};
+
+struct TerrainMeshByteRange {
+    size_t offset = 0;
+    size_t size = 0;
+};
+
+// Упакованная вершина для GPU: позиция float, нормаль snorm 10:10:10:2
+// (GL_INT_2_10_10_10_REV), цвет RGBA8. 20 байт против 36 у pos/col/norm.
+struct TerrainPackedVertex {
+    float    x = 0.f, y = 0.f, z = 0.f;
+    uint32_t normal = 0;
+    uint32_t color = 0;
+};
+static_assert(sizeof(TerrainPackedVertex) == 20, "TerrainPackedVertex must stay tightly packed");
+
+uint32_t packTerrainNormal(const QVector3D& n);
+QVector3D unpackTerrainNormal(uint32_t packed);
+uint32_t packTerrainColor(const QVector3D& c);
+QVector3D unpackTerrainColor(uint32_t packed);
+
+// Вершины [firstVertex, firstVertex+count) в упакованном формате
+void packTerrainVertices(const TerrainMesh& mesh, size_t firstVertex, size_t count, TerrainPackedVertex* out);
+std::vector<TerrainPackedVertex> packTerrainVertices(const TerrainMesh& mesh);
+
+// Что изменилось в TerrainMesh после retessellateCells. vertexBytes относятся к
+// pos/col/norm (одинаковая раскладка, 3 float на вершину; в упакованном формате
+// это вершины [offset/12, (offset+size)/12)), indexBytes - к idx.
+struct TerrainMeshPatch {
+    bool fullRebuild = false; // сетка построена заново - грузить целиком
+    bool resized = false;     // буферы выросли (шов переехал в хвост)
+    std::vector<TerrainMeshByteRange> vertexBytes;
+    std::vector<TerrainMeshByteRange> indexBytes;
+    // idx всех переписанных слотов, включая треугольники, у которых сменились
+    // только вершины (для TerrainClusters::refit)
+    std::vector<TerrainMeshByteRange> slotIndexBytes;
+    size_t cellsRetessellated = 0;
+    size_t seamsRetessellated = 0;
 };
 
 class TerrainTessellator {
@@ -36,6 +103,15 @@ public:
     bool doCornerTris = true;
     bool doEdgeCliffs = true; // пост-проход
 
+    // Индексированный вывод: вершины верхней грани клетки общие (нормаль усреднена
+    // по её треугольникам), стены клифов и швы склонов остаются плоскими.
+    bool indexedOutput = false;
+
+    // Параллельная тесселяция: 1 - в вызывающем потоке, 0 - по числу ядер.
+    // Результат не зависит от числа потоков (побитово совпадает с 1 потоком).
+    int threadCount = 1;
+    int cellsPerChunk = 1024; // клеток в одном чанке работы
+
     // Параметры визуализации руды
     bool enableOreVisualization = true;
     float oreAnimationSpeed = 0.1f;  // Скорость анимации шума
@@ -63,6 +139,12 @@ public:
 
     TerrainMesh build(const HexSphereModel& model) const;
 
+    // Перестраивает только грязные клетки, их соседей и швы вокруг них, правя mesh
+    // на месте. mesh должен быть построен build() с теми же параметрами и топологией;
+    // иначе (или если накопилось много вырожденных слотов) строится заново.
+    TerrainMeshPatch retessellateCells(const HexSphereModel& model,
+        const std::vector<int>& dirtyCells, TerrainMesh& mesh) const;
+
 public:
     // ── атомарные утилиты ────────────────────────────────────────────────────
     static QVector3D slerpish(const QVector3D& a, const QVector3D& b, float t);
@@ -72,10 +154,11 @@ public:
     static EdgeMode  classifyEdge(int hA, int hB, int smoothMaxDelta);
 
     static int       findLocalIndex(const Cell& c, int dv);
+    // heights - колонка HexSphereModel::columns().height
     float            bladeHeightForEdge(const Cell& c, int edgeIdx,
-        const std::vector<Cell>& cells) const;
+        const std::vector<int>& heights) const;
     float            cornerBlendTargetHeight(const Cell& c, int i,
-        const std::vector<Cell>& cells) const;
+        const std::vector<int>& heights) const;
 
     // Метод для расчета цвета с учетом руды
     QVector3D calculateCellColorWithOre(const Cell& cell,
@@ -91,6 +174,7 @@ public:
         float                  h = 0.f;
     };
     PreCell makePreCell(const Cell& c, const std::vector<QVector3D>& dual) const;
+    void    makePreCell(const Cell& c, const std::vector<QVector3D>& dual, PreCell& out) const;
 
     struct TrimDirs {
         std::vector<QVector3D> sideL, sideR; // по ребру i→j (смещённые trim)
@@ -98,13 +182,25 @@ public:
         std::vector<QVector3D> apexU;        // на сам угол i
     };
     TrimDirs makeTrimDirs(const PreCell& pc) const;
+    void     makeTrimDirs(const PreCell& pc, TrimDirs& out) const;
 
     struct EdgeHeights {
         std::vector<float> edgeH;  // уровень лопасти на ребре i
         std::vector<float> apexH;  // уровень апекса в угле i
     };
     EdgeHeights makeHeights(const Cell& c, const PreCell& pc,
-        const std::vector<Cell>& cells) const;
+        const std::vector<int>& heights) const;
+    void        makeHeights(const Cell& c, const PreCell& pc,
+        const std::vector<int>& heights, EdgeHeights& out) const;
+
+    // Рабочие буферы клетки; переиспользуются между клетками одного потока
+    struct CellScratch {
+        PreCell     pc;
+        TrimDirs    td;
+        EdgeHeights eh;
+    };
+
+    static constexpr uint32_t kMaxSeamTris = 6; // клиф: три квада
 
     struct MeshBuilder {
         std::vector<float>& pos;
@@ -113,6 +209,11 @@ public:
         std::vector<uint32_t>& idx;
         std::vector<int>* owner = nullptr;
 
+        // Общая поверхность: triToward переиспользует вершины с той же позицией и
+        // цветом, добавленные после beginShared(); endShared() нормирует нормали.
+        void beginShared();
+        void endShared();
+
         void triToward(QVector3D A, QVector3D B, QVector3D C,
             const QVector3D& color, const QVector3D& toward,
             int cellOwner);
@@ -120,6 +221,10 @@ public:
             const QVector3D& Q2, const QVector3D& Q3,
             const QVector3D& color, const QVector3D& toward,
             int cellOwner);
+        uint32_t vertex(const QVector3D& p, const QVector3D& color, const QVector3D& n);
+
+        bool     shared = false;
+        uint32_t sharedBase = 0;
     };
 
     // ── "мягкие" этапы ───────────────────────────────────────────────────────
@@ -128,6 +233,8 @@ public:
         const TrimDirs& td, const EdgeHeights& eh) const;
     void buildCorners(MeshBuilder& mb, const Cell& c, const PreCell& pc,
         const TrimDirs& td, const EdgeHeights& eh) const;
+    void buildCellBody(MeshBuilder& mb, const Cell& c, const PreCell& pc,
+        const TrimDirs& td, const EdgeHeights& eh) const;
 
     // ── реестр рёбер для пост-прохода ────────────────────────────────────────
     struct EdgeKey {
@@ -159,16 +266,33 @@ public:
         QVector3D P_edgeL, P_edgeR;    // blade points на текущем ребре
         QVector3D P_apexL, P_apexR;    // RAW апексы (для Slope)
     };
-    struct EdgeRec { std::optional<EdgeSide> A, B; };
-    using EdgeRegistry = std::unordered_map<EdgeKey, EdgeRec, EdgeKeyHash>;
+    EdgeSide makeEdgeSide(size_t cid, const Cell& c, int iEdge,
+        const PreCell& pc, const TrimDirs& td, const EdgeHeights& eh,
+        EdgeKey& key) const;
+    // Клиф/шов между двумя сторонами ребра; A - сторона, зарегистрированная первой
+    void emitEdgeSeam(MeshBuilder& mb, const EdgeSide& A, const EdgeSide& B,
+        const std::vector<QVector3D>& centroids) const;
 
-    void registerEdgeSide(EdgeRegistry& reg, size_t cid,
-        const Cell& c, int iEdge,
-        const PreCell& pc, const TrimDirs& td, const EdgeHeights& eh) const;
+    // ── чанки для параллельного прохода ──────────────────────────────────────
+    struct SideEntry {
+        EdgeKey  key;
+        int      edge = -1; // локальное ребро клетки side.cellId
+        EdgeSide side;
+    };
+    struct ChunkResult {
+        TerrainMesh                   mesh;
+        std::vector<TerrainMeshRange> cellRanges; // локальные, по клеткам чанка
+        std::vector<SideEntry>        sides;      // в порядке регистрации (клетка, ребро)
+    };
+    void buildChunk(const HexSphereModel& model, size_t cellBegin, size_t cellEnd,
+        CellScratch& scratch, ChunkResult& out) const;
+    static void appendMesh(TerrainMesh& dst, const TerrainMesh& src);
+    int resolvedThreadCount() const;
 
-    void finalizeCliffs(const EdgeRegistry& reg,
-        MeshBuilder& mb,
-        const std::vector<Cell>& cells) const;
+    // ── инкрементальная перестройка ──────────────────────────────────────────
+    bool hasCellLayout(const TerrainMesh& mesh, const HexSphereModel& model) const;
+    static void writeSlot(TerrainMesh& mesh, TerrainMeshRange& range,
+        const TerrainMesh& src, TerrainMeshPatch& patch);
 
 private:
     OreNoiseGenerator oreNoise_{ 12345 };
@@ -0,0 +1,143 @@
+#include "renderers/TreeInstances.h"
+
+#include "model/SurfacePlacement.h"
+
+#include <QVector4D>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+constexpr float kPi = 3.14159265f;
+
+// Для неотрицательных float порядок битов совпадает с порядком значений
+uint32_t orderedBits(float value) {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+} // namespace
+
+void TreeInstanceBuilder::clear() {
+    baked_.clear();
+    bakedInstances_.clear();
+    order_.clear();
+    for (auto& list : instances_) list.clear();
+    culledByFrustum_ = 0;
+    culledByHorizon_ = 0;
+}
+
+void TreeInstanceBuilder::setPlacements(const HexSphereModel& model, const std::vector<TreePlacement>& placements,
+    float heightStep, float modelRadius)
+{
+    clear();
+
+    // Заслоняющая сфера лежит целиком внутри рельефа: радиус самой низкой клетки
+    occluderRadius_ = 1.0f;
+    for (const Cell& cell : model.cells())
+        occluderRadius_ = std::min(occluderRadius_, 1.0f + cell.height * heightStep);
+    occluderRadius_ = std::max(occluderRadius_, 0.0f);
+
+    baked_.reserve(placements.size());
+    bakedInstances_.reserve(placements.size());
+    for (const TreePlacement& placement : placements) {
+        const QVector3D surfacePoint = computeSurfacePoint(model, placement, heightStep);
+        const QMatrix4x4 matrix = treeModelMatrix(placement, surfacePoint);
+
+        TreeInstance instance;
+        std::memcpy(instance.model, matrix.constData(), sizeof(instance.model));
+        instance.trunkColor[0] = placement.trunkColor.x();
+        instance.trunkColor[1] = placement.trunkColor.y();
+        instance.trunkColor[2] = placement.trunkColor.z();
+        instance.foliageColor[0] = placement.foliageColor.x();
+        instance.foliageColor[1] = placement.foliageColor.y();
+        instance.foliageColor[2] = placement.foliageColor.z();
+        bakedInstances_.push_back(instance);
+
+        BakedTree tree;
+        tree.center = surfacePoint;
+        tree.radius = modelRadius * treeBaseScale(placement.treeType) * std::abs(placement.scale);
+        tree.slot = static_cast<uint32_t>(typeSlot(placement.treeType));
+
+        const float distance = surfacePoint.length();
+        tree.direction = distance > 0.0f ? surfacePoint / distance : QVector3D(0, 0, 1);
+        const float top = distance + tree.radius;
+        const float rise = top > occluderRadius_ ? std::acos(std::clamp(occluderRadius_ / top, -1.0f, 1.0f)) : 0.0f;
+        const float spread = distance > tree.radius ? std::asin(tree.radius / distance) : kPi;
+        const float angle = std::min(rise + spread, kPi);
+        tree.horizonCos = std::cos(angle);
+        tree.horizonSin = std::sin(angle);
+        baked_.push_back(tree);
+    }
+}
+
+size_t TreeInstanceBuilder::build(const QMatrix4x4& viewProjection, const QVector3D& eye, size_t maxInstances) {
+    order_.clear();
+    for (auto& list : instances_) list.clear();
+    culledByFrustum_ = 0;
+    culledByHorizon_ = 0;
+
+    // Плоскости пирамиды видимости (Gribb-Hartmann), нормали смотрят внутрь
+    QVector4D planes[6] = {
+        viewProjection.row(3) + viewProjection.row(0),
+        viewProjection.row(3) - viewProjection.row(0),
+        viewProjection.row(3) + viewProjection.row(1),
+        viewProjection.row(3) - viewProjection.row(1),
+        viewProjection.row(3) + viewProjection.row(2),
+        viewProjection.row(3) - viewProjection.row(2),
+    };
+    for (QVector4D& plane : planes) {
+        const float length = plane.toVector3D().length();
+        if (length > 0.0f) plane /= length;
+    }
+
+    // Горизонт: дерево за краем диска на угол beta + свой угол запаса не видно
+    const float eyeDistance = eye.length();
+    const bool horizonTest = eyeDistance > occluderRadius_ && occluderRadius_ > 0.0f;
+    const QVector3D eyeDirection = horizonTest ? eye / eyeDistance : QVector3D();
+    const float betaCos = horizonTest ? occluderRadius_ / eyeDistance : 0.0f;
+    const float betaSin = std::sqrt(std::max(0.0f, 1.0f - betaCos * betaCos));
+
+    for (size_t i = 0; i < baked_.size(); ++i) {
+        const BakedTree& tree = baked_[i];
+
+        bool inside = true;
+        for (const QVector4D& plane : planes) {
+            if (QVector3D::dotProduct(plane.toVector3D(), tree.center) + plane.w() < -tree.radius) {
+                inside = false;
+                break;
+            }
+        }
+        if (!inside) {
+            ++culledByFrustum_;
+            continue;
+        }
+
+        // alpha + beta >= pi: дерево торчит над горизонтом с любой стороны
+        if (horizonTest && betaCos > -tree.horizonCos) {
+            const float limitCos = tree.horizonCos * betaCos - tree.horizonSin * betaSin;
+            if (QVector3D::dotProduct(tree.direction, eyeDirection) <= limitCos) {
+                ++culledByHorizon_;
+                continue;
+            }
+        }
+
+        const float distanceSq = (tree.center - eye).lengthSquared();
+        order_.push_back((uint64_t(orderedBits(distanceSq)) << 32) | uint64_t(i));
+    }
+
+    if (maxInstances > 0 && order_.size() > maxInstances) {
+        std::nth_element(order_.begin(), order_.begin() + static_cast<std::ptrdiff_t>(maxInstances), order_.end());
+        order_.resize(maxInstances);
+    }
+    std::sort(order_.begin(), order_.end());
+
+    for (uint64_t key : order_) {
+        const size_t tree = static_cast<size_t>(key & 0xFFFFFFFFu);
+        instances_[baked_[tree].slot].push_back(bakedInstances_[tree]);
+    }
+    return order_.size();
+}
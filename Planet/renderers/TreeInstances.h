@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QMatrix4x4>
+#include <QVector3D>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "model/HexSphereModel.h"
+
+// Per-instance vertex data of one tree for glDrawElementsInstanced: the model
+// matrix goes to four vec4 attributes and the tints to two vec3 attributes,
+// all with divisor 1.
+struct TreeInstance {
+    float model[16];       // column-major, QMatrix4x4::constData() order
+    float trunkColor[3];
+    float foliageColor[3];
+};
+static_assert(sizeof(TreeInstance) == 22 * sizeof(float), "TreeInstance is uploaded as a tightly packed array");
+
+// CPU side of instanced tree rendering, no GL calls. setPlacements bakes
+// transforms (treeModelMatrix, model/SurfacePlacement.h), tints and bounds
+// once per placement change; build() then only culls, sorts and copies per
+// frame:
+// - frustum: bounding sphere against the six planes of viewProjection;
+// - horizon: trees behind the planet as seen from the eye, with the planet
+//   taken as a sphere of the lowest surface radius (conservative);
+// - the survivors are sorted near to far (front-to-back for early depth
+//   rejection) and split by tree type, one draw call each. maxInstances
+//   keeps only the nearest trees when the budget is exceeded.
+class TreeInstanceBuilder {
+public:
+    static constexpr size_t kTreeTypeCount = 2; // TreeType::Oak, TreeType::Fir
+
+    // modelRadius: bounding-sphere radius of the tree meshes in model units
+    void setPlacements(const HexSphereModel& model, const std::vector<TreePlacement>& placements,
+        float heightStep, float modelRadius = 1.0f);
+    void clear();
+
+    size_t placementCount() const { return baked_.size(); }
+
+    // Returns the number of instances written over all tree types
+    size_t build(const QMatrix4x4& viewProjection, const QVector3D& eye, size_t maxInstances = 0);
+
+    const std::vector<TreeInstance>& instances(TreeType type) const { return instances_[typeSlot(type)]; }
+    size_t culledByFrustum() const { return culledByFrustum_; }
+    size_t culledByHorizon() const { return culledByHorizon_; }
+
+private:
+    static size_t typeSlot(TreeType type) { return type == TreeType::Fir ? 1 : 0; }
+
+    struct BakedTree {
+        QVector3D center;     // bounding-sphere centre
+        float radius = 0.0f;
+        QVector3D direction;  // center.normalized()
+        // Angle the tree can lie past the eye's horizon and still show:
+        // its top rises above the occluder and its sphere has an angular size
+        float horizonCos = 1.0f;
+        float horizonSin = 0.0f;
+        uint32_t slot = 0;
+    };
+
+    std::vector<BakedTree> baked_;
+    std::vector<TreeInstance> bakedInstances_;
+    float occluderRadius_ = 1.0f;
+
+    std::vector<uint64_t> order_; // (distance bits << 32) | tree, reused per frame
+    std::array<std::vector<TreeInstance>, kTreeTypeCount> instances_;
+    size_t culledByFrustum_ = 0;
+    size_t culledByHorizon_ = 0;
+};
@@ -224,9 +224,15 @@ layout(location=0) in vec3 aPos;
 layout(location=1) in vec3 aNormal;
 layout(location=2) in vec2 aUV;
 layout(location=3) in vec3 aColor;
+// Instanced trees: model matrix and tints per instance (divisor 1)
+layout(location=4) in mat4 aInstanceModel;
+layout(location=8) in vec3 aInstanceTrunk;
+layout(location=9) in vec3 aInstanceFoliage;
 
 uniform mat4 uMVP;
 uniform mat4 uModel;
+uniform mat4 uViewProj;
+uniform bool uInstanced;
 uniform bool uUseFoliageColor;
 uniform float uWindTime;
 
@@ -234,6 +240,8 @@ out vec3 vNormal;
 out vec3 vWorldPos;
 out vec2 vUV;
 out vec3 vColor;
+flat out vec3 vTrunkTint;
+flat out vec3 vFoliageTint;
 
 void main() {
     vec3 animatedPos = aPos;
@@ -245,12 +253,15 @@ void main() {
         animatedPos.z += sway * 0.6;
     }
 
-    vec4 worldPos = uModel * vec4(animatedPos, 1.0);
+    mat4 model = uInstanced ? aInstanceModel : uModel;
+    vec4 worldPos = model * vec4(animatedPos, 1.0);
     vWorldPos = worldPos.xyz;
-    vNormal = mat3(transpose(inverse(uModel))) * aNormal;
+    vNormal = mat3(transpose(inverse(model))) * aNormal;
     vUV = aUV;
     vColor = aColor;
-    gl_Position = uMVP * vec4(animatedPos, 1.0);
+    vTrunkTint = aInstanceTrunk;
+    vFoliageTint = aInstanceFoliage;
+    gl_Position = uInstanced ? uViewProj * worldPos : uMVP * vec4(animatedPos, 1.0);
 }
 )GLSL";
 
@@ -260,6 +271,8 @@ in vec3 vNormal;
 in vec3 vWorldPos;
 in vec2 vUV;
 in vec3 vColor;
+flat in vec3 vTrunkTint;
+flat in vec3 vFoliageTint;
 
 out vec4 FragColor;
 
@@ -269,6 +282,7 @@ uniform vec3 uColor;
 uniform bool uUseTexture;
 uniform bool uUseVertexColor;
 uniform int uIsCar;
+uniform bool uInstanced;
 
 // Uniform'С‹ РґР»СЏ РґРµСЂРµРІСЊРµРІ (РёР· РїРµСЂРІРѕР№ РІРµСЂСЃРёРё)
 uniform bool uUseFoliageColor;
@@ -321,7 +335,7 @@ void main() {
         
         if (uUseFoliageColor) {
             // РљСЂРѕРЅР°
-            baseColor = uFoliageColor;
+            baseColor = uInstanced ? vFoliageTint : uFoliageColor;
             
             // Р”РѕР±Р°РІР»СЏРµРј РЅРµР±РѕР»СЊС€СѓСЋ РІР°СЂРёР°С†РёСЋ РґР»СЏ РѕР±СЉРµРјР°
             float leafVar = 0.85 + (sin(vUV.x * 20.0 + vUV.y * 30.0) * 0.15);
@@ -334,7 +348,7 @@ void main() {
             }
         } else {
             // РЎС‚РІРѕР»
-            baseColor = uTrunkColor;
+            baseColor = uInstanced ? vTrunkTint : uTrunkColor;
             
             // РўРµРєСЃС‚СѓСЂР° РєРѕСЂС‹
             float barkVar = 0.8 + (sin(vUV.x * 50.0) * 0.2);
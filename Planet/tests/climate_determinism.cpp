@@ -0,0 +1,113 @@
+#include <QtTest/QtTest>
+
+#include <cstring>
+
+#include "../generation/ClimateBiomeGenerator.h"
+#include "../generation/CounterRng.h"
+
+class ClimateDeterminismTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void parallelIsIndependentOfThreadCount();
+    void parallelOreOverrideRate();
+    void counterRngIsPure();
+};
+
+namespace {
+
+HexSphereModel makeModel(int level) {
+    IcosphereBuilder builder;
+    HexSphereModel model;
+    model.rebuildFromIcosphere(builder.build(level));
+    return model;
+}
+
+HexSphereModel generateParallel(int level, uint32_t seed, int threads) {
+    HexSphereModel model = makeModel(level);
+    ClimateBiomeGenerator::ClimateParams params;
+    params.seed = seed;
+    params.mode = ClimateBiomeGenerator::ClimateParams::Mode::Parallel;
+    params.threadCount = threads;
+    ClimateBiomeGenerator().generate(model, params);
+    return model;
+}
+
+bool sameBits(float a, float b) {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+} // namespace
+
+void ClimateDeterminismTest::parallelIsIndependentOfThreadCount() {
+    // L5: больше одного чанка, последний неполный
+    const HexSphereModel reference = generateParallel(5, 777u, 1);
+    QVERIFY(reference.cellCount() > 4096);
+
+    for (int threads : { 2, 3, 8 }) {
+        const HexSphereModel model = generateParallel(5, 777u, threads);
+        QCOMPARE(model.cellCount(), reference.cellCount());
+        for (int i = 0; i < reference.cellCount(); ++i) {
+            const Cell& a = reference.cells()[i];
+            const Cell& b = model.cells()[i];
+            QCOMPARE(b.height, a.height);
+            QCOMPARE(b.biome, a.biome);
+            QCOMPARE(b.oreType, a.oreType);
+            QVERIFY(sameBits(b.temperature, a.temperature));
+            QVERIFY(sameBits(b.humidity, a.humidity));
+            QVERIFY(sameBits(b.pressure, a.pressure));
+            QVERIFY(sameBits(b.oreDensity, a.oreDensity));
+        }
+    }
+
+    // Другой seed - другая планета
+    const HexSphereModel other = generateParallel(5, 778u, 4);
+    int differentHeights = 0;
+    for (int i = 0; i < reference.cellCount(); ++i) {
+        differentHeights += other.cells()[i].height != reference.cells()[i].height;
+    }
+    QVERIFY(differentHeights > reference.cellCount() / 10);
+}
+
+void ClimateDeterminismTest::parallelOreOverrideRate() {
+    const HexSphereModel model = generateParallel(5, 42u, 4);
+
+    // Переопределение руды даёт плотность вида 0.3 + k/100 и тип 1-4; у шумовой
+    // плотности такие значения практически не встречаются - считаем долю
+    int overridden = 0;
+    for (const Cell& cell : model.cells()) {
+        const float k = (cell.oreDensity - 0.3f) * 100.0f;
+        if (cell.oreType >= 1 && cell.oreType <= 4 && k >= 0.0f && std::abs(k - std::round(k)) < 1e-3f) {
+            ++overridden;
+        }
+        QVERIFY(cell.oreDensity >= 0.0f && cell.oreDensity <= 1.0f);
+    }
+    const double rate = double(overridden) / model.cellCount();
+    QVERIFY2(rate > 0.2 && rate < 0.3, qPrintable(QString::number(rate)));
+}
+
+void ClimateDeterminismTest::counterRngIsPure() {
+    CounterRng a(12345u, 17u, 1u);
+    CounterRng b(12345u, 17u, 1u);
+    for (int i = 0; i < 16; ++i) {
+        QCOMPARE(a.next(), b.next());
+    }
+
+    // Соседние ключи и потоки не дают одинаковых последовательностей
+    QVERIFY(CounterRng(12345u, 17u, 1u).next() != CounterRng(12345u, 18u, 1u).next());
+    QVERIFY(CounterRng(12345u, 17u, 1u).next() != CounterRng(12345u, 17u, 2u).next());
+    QVERIFY(CounterRng(12345u, 17u, 1u).next() != CounterRng(12346u, 17u, 1u).next());
+
+    int histogram[4] = {};
+    for (uint64_t key = 0; key < 40000; ++key) {
+        const uint32_t v = CounterRng(1u, key, 1u).below(4);
+        QVERIFY(v < 4);
+        ++histogram[v];
+    }
+    for (int bucket : histogram) {
+        QVERIFY(bucket > 9500 && bucket < 10500);
+    }
+}
+
+QTEST_MAIN(ClimateDeterminismTest)
+#include "climate_determinism.moc"
@@ -0,0 +1,121 @@
+#include <QtTest/QtTest>
+
+#include <set>
+
+#include "../ECS/ComponentStorage.h"
+
+class ComponentStorageTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void destroySwapsLastIntoHole();
+    void referencesSurviveInsertion();
+    void eachVisitsOnlyFullMatches();
+    void finishedAnimationIsRemoved();
+};
+
+void ComponentStorageTest::destroySwapsLastIntoHole() {
+    ecs::ComponentStorage ecs;
+    for (int i = 0; i < 10; ++i) {
+        auto& entity = ecs.createEntity(QString("E%1").arg(i));
+        ecs.emplace<ecs::Collider>(entity.id).radius = float(i);
+    }
+
+    ecs.destroyEntity(3);
+    ecs.destroyEntity(0);
+    ecs.destroyEntity(42);
+    QCOMPARE(ecs.entityCount(), size_t(8));
+    QVERIFY(!ecs.getEntity(3));
+    QVERIFY(!ecs.get<ecs::Collider>(0));
+
+    // Перенесённые swap-remove элементы по-прежнему находятся по своему id
+    for (int id : { 1, 2, 4, 5, 6, 7, 8, 9 }) {
+        QVERIFY(ecs.getEntity(id));
+        QCOMPARE(ecs.getEntity(id)->name, QString("E%1").arg(id));
+        QCOMPARE(ecs.get<ecs::Collider>(id)->radius, float(id));
+    }
+
+    // Повторный emplace перезаписывает компонент, а не добавляет второй
+    ecs.emplace<ecs::Collider>(5);
+    QCOMPARE(ecs.get<ecs::Collider>(5)->radius, ecs::Collider{}.radius);
+
+    ecs.clear();
+    QCOMPARE(ecs.entityCount(), size_t(0));
+    QCOMPARE(ecs.createEntity().id, 0);
+}
+
+void ComponentStorageTest::referencesSurviveInsertion() {
+    ecs::ComponentStorage ecs;
+    auto& first = ecs.createEntity("First");
+    ecs::Transform& firstTransform = ecs.emplace<ecs::Transform>(first.id);
+    firstTransform.yawAngle = 1.5f;
+
+    for (int i = 0; i < 2000; ++i) {
+        const ecs::EntityId id = ecs.createEntity().id;
+        ecs.emplace<ecs::Transform>(id);
+    }
+
+    QCOMPARE(first.name, QString("First"));
+    QCOMPARE(&firstTransform, ecs.get<ecs::Transform>(first.id));
+    QCOMPARE(firstTransform.yawAngle, 1.5f);
+}
+
+void ComponentStorageTest::eachVisitsOnlyFullMatches() {
+    ecs::ComponentStorage ecs;
+    std::set<int> expected;
+    for (int i = 0; i < 300; ++i) {
+        const ecs::EntityId id = ecs.createEntity().id;
+        ecs.emplace<ecs::Transform>(id);
+        if (i % 3 == 0) {
+            ecs.emplace<ecs::Mesh>(id);
+        }
+        if (i % 5 == 0) {
+            ecs.emplace<ecs::Collider>(id);
+        }
+        if (i % 15 == 0 && i % 2 == 1) {
+            expected.insert(id);
+        }
+    }
+    for (int id = 0; id < 300; id += 2) {
+        ecs.destroyEntity(id);
+    }
+
+    std::set<int> visited;
+    const ecs::ComponentStorage& view = ecs;
+    view.each<ecs::Collider, ecs::Transform, ecs::Mesh>(
+        [&](const ecs::Entity& e, const ecs::Collider&, const ecs::Transform&, const ecs::Mesh&) {
+            QVERIFY(visited.insert(e.id).second);
+        });
+    QCOMPARE(visited, expected);
+
+    int all = 0;
+    ecs.each<>([&](ecs::Entity&) { ++all; });
+    QCOMPARE(all, 150);
+}
+
+void ComponentStorageTest::finishedAnimationIsRemoved() {
+    ecs::ComponentStorage ecs;
+    const ecs::EntityId id = ecs.createEntity().id;
+    ecs.emplace<ecs::Transform>(id);
+    auto& anim = ecs.emplace<ecs::Animation>(id);
+    anim.type = ecs::Animation::Type::Rotate;
+    anim.duration = 0.1f;
+
+    int completed = 0;
+    anim.onComplete = [&](int entityId) {
+        QCOMPARE(entityId, id);
+        ++completed;
+        // Колбэк может добавлять компоненты посреди обхода
+        ecs.emplace<ecs::Collider>(entityId);
+    };
+
+    ecs.update(0.05f);
+    QVERIFY(ecs.get<ecs::Animation>(id));
+    ecs.update(0.1f);
+    QVERIFY(!ecs.get<ecs::Animation>(id));
+    QCOMPARE(completed, 1);
+    QVERIFY(ecs.get<ecs::Collider>(id));
+}
+
+QTEST_MAIN(ComponentStorageTest)
+#include "component_storage.moc"
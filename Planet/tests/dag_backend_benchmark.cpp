@@ -24,10 +24,22 @@ void DagBackendBenchmarkTest::benchmarkProducesCompatibleRows() {
     bool sawLegacyTerrain = false;
     bool sawSceneDagStats = false;
     bool sawLegacyScene = false;
+    bool sawParamTweak = false;
+    bool sawModelRegistry = false;
+    bool sawDagStorage = false;
+    bool sawDagWavefront = false;
+    bool sawDagDelta = false;
+    bool sawDagTrace = false;
     for (const auto& row : report.rows) {
         sawDagTerrain = sawDagTerrain || row.backend == "DAG terrain";
         sawLegacyTerrain = sawLegacyTerrain || row.backend == "Legacy terrain";
         sawLegacyScene = sawLegacyScene || row.backend == "Legacy scene";
+        sawParamTweak = sawParamTweak || (row.operation == "param_tweak" && row.cellCount > 0);
+        sawModelRegistry = sawModelRegistry || (row.category == "model-registry" && row.backend == "Shared snapshot model" && row.compatible && row.cacheHits > 0);
+        sawDagStorage = sawDagStorage || (row.category == "dag-storage" && row.backend == "Typed slots" && row.compatible);
+        sawDagWavefront = sawDagWavefront || (row.category == "dag-wavefront" && row.backend == "Wavefront" && row.compatible);
+        sawDagDelta = sawDagDelta || (row.category == "dag-delta" && row.backend == "Cell patch" && row.compatible);
+        sawDagTrace = sawDagTrace || (row.category == "dag-trace" && row.backend == "Tracing on" && row.compatible);
         sawSceneDagStats = sawSceneDagStats || (row.backend == "DAG scene" && (row.executedNodes > 0 || row.skippedGuardNodes > 0));
     }
 
@@ -35,6 +47,12 @@ void DagBackendBenchmarkTest::benchmarkProducesCompatibleRows() {
     QVERIFY(sawLegacyTerrain);
     QVERIFY(sawLegacyScene);
     QVERIFY(sawSceneDagStats);
+    QVERIFY(sawParamTweak);
+    QVERIFY(sawModelRegistry);
+    QVERIFY(sawDagStorage);
+    QVERIFY(sawDagWavefront);
+    QVERIFY(sawDagDelta);
+    QVERIFY(sawDagTrace);
 }
 
 QTEST_MAIN(DagBackendBenchmarkTest)
@@ -0,0 +1,174 @@
+#include <QtTest/QtTest>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <proc/ProcessDag.h>
+
+class DagDeltaCommitTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void diffPatchesValueInPlace();
+    void consumerSeesPatch();
+    void fallsBackToFullValue();
+};
+
+namespace {
+
+// blob: тип с diff-алгеброй (дописывание байтов), plain: обычная строка
+proc::GraphSchema buildBlobSchema() {
+    proc::GraphSchema::StorageLayout roles;
+    roles.inputs.insert("blob");
+    roles.inputs.insert("plain");
+    roles.outputs.insert("length");
+
+    proc::OperationRegistry operations = proc::make_builtin_operation_registry();
+    operations.register_op("measure", proc::v2::OpId{ 320 });
+    proc::AlgebraRegistry algebras = proc::make_builtin_algebra_registry();
+    algebras.register_type("blob", proc::v2::AlgebraId{ 100 });
+    return proc::GraphSchemaBuilder::compile(
+        roles,
+        {
+            {"blob", "blob"},
+            {"plain", "str"},
+            {"length", "int"},
+        },
+        {
+            proc::GraphSchemaBuilder::NodeDef{ "Measure", "measure", {"blob"}, {"length"}, std::nullopt },
+        },
+        operations,
+        algebras);
+}
+
+struct Measure {
+    proc::ValueRef seen;
+    std::vector<std::string> diffs;
+
+    proc::DefaultDagEngine build(const proc::GraphSchema& schema) {
+        proc::RuntimeOperationRegistry runtime(proc::make_builtin_operation_registry());
+        runtime.register_op("measure", proc::v2::OpId{ 320 });
+
+        const auto node = *schema.find_node("Measure");
+        runtime.bind_executor(
+            schema.op_of(node),
+            node,
+            [this, blob = *schema.find_field("blob"), length = *schema.find_field("length")](
+                const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
+                const proc::RuntimeOperationRegistry::FieldNameFn&,
+                const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
+                const auto value = readHandle(blob);
+                // Узел обновляется инкрементально, если знает версию, от которой пришёл патч
+                const auto diff = proc::value_diff_from(value, seen);
+                diffs.push_back(diff ? std::string(diff->bytes()) : std::string("<full>"));
+                seen = value;
+
+                proc::Commit commit;
+                commit.set_scalar(length, static_cast<int>(value->bytes().size()));
+                return commit;
+            });
+
+        proc::DefaultDagEngine engine(schema, std::move(runtime), proc::make_builtin_guard_registry());
+        proc::ValueStore init;
+        init["blob"] = proc::make_value(std::string("ab"));
+        init["plain"] = proc::make_value(std::string("x"));
+        engine.init(init);
+        engine.register_apply_diff(
+            schema.algebra_of(blob(schema)),
+            [](const proc::ValueRef& current, const proc::ValueRef& diff) {
+                return proc::Value(std::string(current->bytes()) + std::string(diff->bytes()));
+            });
+        return engine;
+    }
+
+    static proc::v2::FieldSlot blob(const proc::GraphSchema& schema) {
+        return *schema.find_field("blob");
+    }
+};
+
+const std::vector<proc::Field> kOutputs = { "length" };
+
+} // namespace
+
+void DagDeltaCommitTest::diffPatchesValueInPlace() {
+    const proc::GraphSchema schema = buildBlobSchema();
+    Measure measure;
+    proc::DefaultDagEngine engine = measure.build(schema);
+    const proc::ValueRef before = engine.input_snapshot().at("blob");
+
+    const auto diff = proc::make_value(std::string("cd"));
+    proc::Commit commit;
+    commit.apply_diff(Measure::blob(schema), diff);
+    engine.push_input(commit);
+
+    const proc::ValueRef after = engine.input_snapshot().at("blob");
+    QCOMPARE(after->bytes(), std::string_view("abcd"));
+    QVERIFY(after->patch() != nullptr);
+    QCOMPARE(proc::value_diff_from(after, before), diff);
+    // Патч не участвует в равенстве значений
+    QVERIFY(*after == *proc::make_value(std::string("abcd")));
+
+    // Цепочка патчей: diff известен только относительно непосредственной базы
+    proc::Commit next;
+    next.apply_diff(Measure::blob(schema), proc::make_value(std::string("e")));
+    engine.push_input(next);
+    const proc::ValueRef latest = engine.input_snapshot().at("blob");
+    QCOMPARE(latest->bytes(), std::string_view("abcde"));
+    QVERIFY(proc::value_diff_from(latest, after) != nullptr);
+    QVERIFY(!proc::value_diff_from(latest, before));
+}
+
+void DagDeltaCommitTest::consumerSeesPatch() {
+    const proc::GraphSchema schema = buildBlobSchema();
+    Measure measure;
+    proc::DefaultDagEngine engine = measure.build(schema);
+    QVERIFY(engine.flush_prepare(kOutputs));
+    QVERIFY(engine.ack_outputs());
+
+    proc::Commit commit;
+    commit.apply_diff(Measure::blob(schema), proc::make_value(std::string("xyz")));
+    engine.push_input(commit);
+    QVERIFY(engine.flush_prepare(kOutputs));
+    QCOMPARE(*proc::get_value_as<int>(engine.prepared_output_store(), "length"), 5);
+    QVERIFY(engine.ack_outputs());
+
+    // Полная запись обрывает цепочку: узел пересчитывает всё
+    proc::Commit full;
+    full.set_handle("blob", proc::make_value(std::string("q")));
+    engine.push_input(full);
+    QVERIFY(engine.flush_prepare(kOutputs));
+    QCOMPARE(*proc::get_value_as<int>(engine.prepared_output_store(), "length"), 1);
+
+    QCOMPARE(measure.diffs, (std::vector<std::string>{ "<full>", "xyz", "<full>" }));
+}
+
+void DagDeltaCommitTest::fallsBackToFullValue() {
+    const proc::GraphSchema schema = buildBlobSchema();
+    Measure measure;
+    proc::DefaultDagEngine engine = measure.build(schema);
+    const auto plain = *schema.find_field("plain");
+
+    // У str нет diff-алгебры: применяется полное значение
+    proc::Commit commit;
+    commit.apply_diff(plain, proc::make_value(std::string("+y")), proc::make_value(std::string("xy")));
+    engine.push_input(commit);
+    const proc::ValueRef value = engine.input_snapshot().at("plain");
+    QCOMPARE(value->bytes(), std::string_view("xy"));
+    QVERIFY(value->patch() == nullptr);
+
+    // Без алгебры и без запасного значения изменение отклоняется
+    proc::Commit rejected;
+    rejected.apply_diff(plain, proc::make_value(std::string("+z")));
+    bool threw = false;
+    try {
+        engine.push_input(rejected);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    QVERIFY(threw);
+    QCOMPARE(engine.input_snapshot().at("plain")->bytes(), std::string_view("xy"));
+}
+
+QTEST_MAIN(DagDeltaCommitTest)
+#include "dag_delta_commit.moc"
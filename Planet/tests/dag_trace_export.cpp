@@ -0,0 +1,254 @@
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <proc/ProcessDag.h>
+
+class DagTraceExportTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void recordsFlushSpans();
+    void ringKeepsNewestEvents();
+    void overflowingFlushKeepsItsFirstEvents();
+    void writesChromeTrace();
+    void wavefrontRecordsSameSpans();
+};
+
+namespace {
+
+// a -> Double; a + guard enabled -> Gated
+proc::GraphSchema buildTracedSchema() {
+    proc::GraphSchema::StorageLayout roles;
+    roles.inputs.insert("a");
+    roles.inputs.insert("enabled");
+    roles.outputs.insert("doubled");
+    roles.outputs.insert("gated");
+
+    proc::OperationRegistry operations = proc::make_builtin_operation_registry();
+    operations.register_op("scale", proc::v2::OpId{ 330 });
+    return proc::GraphSchemaBuilder::compile(
+        roles,
+        {
+            {"a", "str"},
+            {"enabled", "bool"},
+            {"doubled", "str"},
+            {"gated", "str"},
+        },
+        {
+            proc::GraphSchemaBuilder::NodeDef{ "Double", "scale", {"a"}, {"doubled"}, std::nullopt },
+            proc::GraphSchemaBuilder::NodeDef{
+                "Gated",
+                "scale",
+                {"a", "enabled"},
+                {"gated"},
+                proc::GraphSchemaBuilder::GuardDef{ "enabled", "1" },
+            },
+        },
+        operations,
+        proc::make_builtin_algebra_registry());
+}
+
+proc::DefaultDagEngine buildTracedEngine(const proc::GraphSchema& schema) {
+    proc::RuntimeOperationRegistry runtime(proc::make_builtin_operation_registry());
+    runtime.register_op("scale", proc::v2::OpId{ 330 });
+    const auto a = *schema.find_field("a");
+    for (const auto& [node, output] : { std::pair{ "Double", "doubled" }, std::pair{ "Gated", "gated" } }) {
+        const auto slot = *schema.find_node(node);
+        runtime.bind_executor(
+            schema.op_of(slot),
+            slot,
+            [a, out = *schema.find_field(output)](
+                const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
+                const proc::RuntimeOperationRegistry::FieldNameFn&,
+                const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
+                const std::string text(readHandle(a)->bytes());
+                proc::Commit commit;
+                commit.set(out, text + text);
+                return commit;
+            });
+    }
+
+    proc::DefaultDagEngine engine(schema, std::move(runtime), proc::make_builtin_guard_registry());
+    proc::ValueStore init;
+    init["a"] = proc::make_value(std::string("abcd"));
+    init["enabled"] = proc::make_scalar(true);
+    engine.init(init);
+    return engine;
+}
+
+const std::vector<proc::Field> kOutputs = { "doubled", "gated" };
+
+size_t countKind(const std::vector<proc::TraceEvent>& events, proc::TraceEventKind kind) {
+    return static_cast<size_t>(std::count_if(events.begin(), events.end(), [kind](const proc::TraceEvent& event) {
+        return event.kind == kind;
+    }));
+}
+
+} // namespace
+
+void DagTraceExportTest::recordsFlushSpans() {
+    const proc::GraphSchema schema = buildTracedSchema();
+    proc::DefaultDagEngine engine = buildTracedEngine(schema);
+    QVERIFY(!engine.tracer());
+    engine.set_tracing(256);
+    QVERIFY(engine.tracer());
+
+    QVERIFY(engine.flush_prepare(kOutputs));
+    const auto events = engine.tracer()->events();
+    QCOMPARE(countKind(events, proc::TraceEventKind::Flush), size_t(1));
+    QCOMPARE(countKind(events, proc::TraceEventKind::PlanBuild), size_t(1));
+    QCOMPARE(countKind(events, proc::TraceEventKind::Guard), size_t(1));
+    QCOMPARE(countKind(events, proc::TraceEventKind::NodeExecute), size_t(2));
+    QCOMPARE(countKind(events, proc::TraceEventKind::Commit), size_t(2));
+
+    // Flush записывается последним и охватывает все остальные интервалы
+    const proc::TraceEvent& flush = events.back();
+    QCOMPARE(flush.kind, proc::TraceEventKind::Flush);
+    QVERIFY(!flush.flag);
+    const auto aSlot = static_cast<uint32_t>(*schema.find_field("a"));
+    const auto gatedNode = static_cast<uint32_t>(*schema.find_node("Gated"));
+    for (const proc::TraceEvent& event : events) {
+        QCOMPARE(event.flush, flush.flush);
+        QVERIFY(event.start_ns >= flush.start_ns);
+        QVERIFY(event.start_ns + event.duration_ns <= flush.start_ns + flush.duration_ns);
+        if (event.kind == proc::TraceEventKind::Read && event.field == aSlot) {
+            // Чтение приписано узлу, который его сделал
+            QVERIFY(event.node != proc::TraceEvent::kNoSlot);
+            QCOMPARE(event.bytes, uint64_t(4));
+        }
+        if (event.kind == proc::TraceEventKind::Guard) {
+            QCOMPARE(event.node, gatedNode);
+            QVERIFY(event.flag);
+        }
+        if (event.kind == proc::TraceEventKind::Commit) {
+            QCOMPARE(event.bytes, uint64_t(8));
+        }
+    }
+    QCOMPARE(countKind(events, proc::TraceEventKind::Read), size_t(3));
+    engine.ack_outputs();
+
+    // Отключённый guard виден в трассе как непрошедший
+    proc::Commit disable;
+    disable.set_handle("enabled", proc::make_scalar(false));
+    engine.push_input(disable);
+    QVERIFY(engine.flush_prepare(kOutputs));
+    const auto second = engine.tracer()->events();
+    const auto guard = std::find_if(second.rbegin(), second.rend(), [](const proc::TraceEvent& event) {
+        return event.kind == proc::TraceEventKind::Guard;
+    });
+    QVERIFY(guard != second.rend());
+    QVERIFY(!guard->flag);
+    QCOMPARE(guard->flush, engine.tracer()->current_flush());
+}
+
+void DagTraceExportTest::ringKeepsNewestEvents() {
+    const proc::GraphSchema schema = buildTracedSchema();
+    proc::DefaultDagEngine engine = buildTracedEngine(schema);
+    engine.set_tracing(16);
+
+    for (int i = 0; i < 5; ++i) {
+        proc::Commit input;
+        input.set("a", std::string(static_cast<size_t>(i + 1), 'x'));
+        engine.push_input(input);
+        QVERIFY(engine.flush_prepare(kOutputs));
+        engine.ack_outputs();
+    }
+
+    const proc::Tracer& tracer = *engine.tracer();
+    QCOMPARE(tracer.capacity(), size_t(16));
+    QVERIFY(tracer.recorded() > tracer.capacity());
+    QCOMPARE(tracer.dropped(), tracer.recorded() - 16);
+    const auto events = tracer.events();
+    QCOMPARE(events.size(), size_t(16));
+    QCOMPARE(events.back().kind, proc::TraceEventKind::Flush);
+    QCOMPARE(events.back().flush, uint64_t(5));
+
+    // Выключение трассировки освобождает буфер
+    engine.set_tracing(0);
+    QVERIFY(!engine.tracer());
+}
+
+void DagTraceExportTest::overflowingFlushKeepsItsFirstEvents() {
+    const proc::GraphSchema schema = buildTracedSchema();
+    proc::DefaultDagEngine engine = buildTracedEngine(schema);
+    engine.set_execution_options(proc::ExecutionOptions{ proc::ExecutionMode::Wavefront, 2, false });
+    engine.set_tracing(4);
+
+    // Один flush даёт больше событий, чем вмещает буфер: лишние отбрасываются,
+    // а не перезаписывают слоты, в которые ещё пишут другие потоки
+    QVERIFY(engine.flush_prepare(kOutputs));
+    const proc::Tracer& tracer = *engine.tracer();
+    QCOMPARE(tracer.recorded(), uint64_t(4));
+    QVERIFY(tracer.overflowed() > 0);
+    QCOMPARE(tracer.dropped(), tracer.overflowed());
+    auto events = tracer.events();
+    QCOMPARE(events.size(), size_t(4));
+    QCOMPARE(events.front().kind, proc::TraceEventKind::PlanBuild);
+    QVERIFY(std::all_of(events.begin(), events.end(), [](const proc::TraceEvent& e) { return e.flush == 1; }));
+
+    // Следующий flush перезаписывает предыдущий целиком
+    const auto overflowedFirst = tracer.overflowed();
+    engine.ack_outputs();
+    proc::Commit input;
+    input.set("a", std::string("xy"));
+    engine.push_input(input);
+    QVERIFY(engine.flush_prepare(kOutputs));
+    events = tracer.events();
+    QCOMPARE(events.size(), size_t(4));
+    QVERIFY(std::all_of(events.begin(), events.end(), [](const proc::TraceEvent& e) { return e.flush == 2; }));
+    QCOMPARE(tracer.dropped(), uint64_t(4) + tracer.overflowed());
+    QVERIFY(tracer.overflowed() > overflowedFirst);
+
+    std::ostringstream out;
+    QVERIFY(engine.write_chrome_trace(out));
+    QVERIFY(out.str().find("\"overflowed\":" + std::to_string(tracer.overflowed())) != std::string::npos);
+}
+
+void DagTraceExportTest::writesChromeTrace() {
+    const proc::GraphSchema schema = buildTracedSchema();
+    proc::DefaultDagEngine engine = buildTracedEngine(schema);
+
+    std::ostringstream disabled;
+    QVERIFY(!engine.write_chrome_trace(disabled));
+    QVERIFY(disabled.str().empty());
+
+    engine.set_tracing(64);
+    QVERIFY(engine.flush_prepare(kOutputs));
+    std::ostringstream out;
+    QVERIFY(engine.write_chrome_trace(out));
+    const std::string json = out.str();
+    QVERIFY(json.find("\"traceEvents\":[") != std::string::npos);
+    QVERIFY(json.find("\"name\":\"flush #1\"") != std::string::npos);
+    QVERIFY(json.find("\"name\":\"node Double\"") != std::string::npos);
+    QVERIFY(json.find("\"name\":\"guard Gated\"") != std::string::npos);
+    QVERIFY(json.find("\"name\":\"read a\"") != std::string::npos);
+    QVERIFY(json.find("\"cat\":\"commit\"") != std::string::npos);
+    QVERIFY(json.find("\"ph\":\"X\"") != std::string::npos);
+    QVERIFY(json.find("\"passed\":true") != std::string::npos);
+    QCOMPARE(json.substr(json.size() - 4), std::string("\n]}\n"));
+}
+
+void DagTraceExportTest::wavefrontRecordsSameSpans() {
+    const proc::GraphSchema schema = buildTracedSchema();
+    proc::DefaultDagEngine serial = buildTracedEngine(schema);
+    proc::DefaultDagEngine wavefront = buildTracedEngine(schema);
+    wavefront.set_execution_options(proc::ExecutionOptions{ proc::ExecutionMode::Wavefront, 2, false });
+    serial.set_tracing(256);
+    wavefront.set_tracing(256);
+
+    QVERIFY(serial.flush_prepare(kOutputs));
+    QVERIFY(wavefront.flush_prepare(kOutputs));
+    const auto serialEvents = serial.tracer()->events();
+    const auto wavefrontEvents = wavefront.tracer()->events();
+    QCOMPARE(wavefrontEvents.size(), serialEvents.size());
+    for (const auto kind : { proc::TraceEventKind::Guard, proc::TraceEventKind::NodeExecute, proc::TraceEventKind::Read, proc::TraceEventKind::Commit }) {
+        QCOMPARE(countKind(wavefrontEvents, kind), countKind(serialEvents, kind));
+    }
+}
+
+QTEST_MAIN(DagTraceExportTest)
+#include "dag_trace_export.moc"
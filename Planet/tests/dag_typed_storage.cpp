@@ -0,0 +1,209 @@
+#include <QtTest/QtTest>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <proc/ProcessDag.h>
+
+class DagTypedStorageTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void scalarValuesRoundTrip();
+    void stringValuesStayCompatible();
+    void denseLayersFollowLayerProtocol();
+    void engineRunsOnTypedInputs();
+};
+
+namespace {
+
+struct Payload {
+    std::vector<int> cells;
+};
+
+// Тот же размер и то же представление, что у Payload
+struct OtherPayload {
+    std::vector<int> cells;
+};
+
+struct Pair32 {
+    int a;
+    int b;
+};
+
+struct OtherPair32 {
+    int a;
+    int b;
+};
+
+proc::GraphSchema buildSumSchema() {
+    proc::GraphSchema::StorageLayout roles;
+    roles.inputs.insert("a");
+    roles.inputs.insert("b");
+    roles.inputs.insert("enabled");
+    roles.outputs.insert("sum");
+
+    proc::OperationRegistry operations = proc::make_builtin_operation_registry();
+    operations.register_op("sum", proc::v2::OpId{ 300 });
+    return proc::GraphSchemaBuilder::compile(
+        roles,
+        {
+            {"a", "int"},
+            {"b", "int"},
+            {"enabled", "bool"},
+            {"sum", "int"},
+        },
+        {
+            proc::GraphSchemaBuilder::NodeDef{
+                "Sum",
+                "sum",
+                {"a", "b", "enabled"},
+                {"sum"},
+                proc::GraphSchemaBuilder::GuardDef{ "enabled", "1" },
+            },
+        },
+        operations,
+        proc::make_builtin_algebra_registry());
+}
+
+} // namespace
+
+void DagTypedStorageTest::scalarValuesRoundTrip() {
+    const auto count = proc::make_scalar(42);
+    QCOMPARE(count->kind(), proc::Value::Kind::Scalar);
+    QVERIFY(count->holds<int>());
+    QCOMPARE(*proc::value_as<int>(count), 42);
+    // Тип скаляра точный: int не читается как float или int64
+    QVERIFY(!proc::value_as<float>(count));
+    QVERIFY(!proc::value_as<long long>(count));
+    QVERIFY(count->bytes().empty());
+    QCOMPARE(count->debug_string(), std::string("42"));
+
+    QCOMPARE(*proc::value_as<float>(proc::make_scalar(0.25f)), 0.25f);
+    QVERIFY(*proc::make_scalar(7u) == *proc::make_scalar(7u));
+    QVERIFY(!(*proc::make_scalar(7u) == *proc::make_scalar(8u)));
+    QVERIFY(!(*proc::make_scalar(7u) == *proc::make_scalar(7)));
+
+    // Объекты сравниваются по идентичности
+    const auto payload = std::make_shared<const Payload>(Payload{ { 1, 2, 3 } });
+    const auto object = proc::make_object(payload);
+    QCOMPARE(proc::value_object<Payload>(object), payload.get());
+    QVERIFY(!proc::value_object<int>(object));
+    // Тип различают ключи, а не совпадающие по содержимому дескрипторы
+    QVERIFY(!proc::value_object<OtherPayload>(object));
+    // Тот же указатель под другим типом - другое значение
+    const std::shared_ptr<const OtherPayload> alias(payload, reinterpret_cast<const OtherPayload*>(payload.get()));
+    QVERIFY(!(*object == *proc::make_object(alias)));
+    const auto pair = proc::make_scalar(Pair32{ 1, 2 });
+    QVERIFY(pair->holds<Pair32>());
+    QVERIFY(!pair->holds<OtherPair32>());
+    QVERIFY(!proc::value_as<OtherPair32>(pair));
+    QVERIFY(!(*pair == *proc::make_scalar(OtherPair32{ 1, 2 })));
+    QVERIFY(*object == *proc::make_object(payload));
+    QVERIFY(!(*object == *proc::make_object(std::make_shared<const Payload>(*payload))));
+}
+
+void DagTypedStorageTest::stringValuesStayCompatible() {
+    const auto text = proc::make_value("17");
+    QVERIFY(text->is_bytes());
+    QCOMPARE(proc::Commit::debug_view(text), std::string_view("17"));
+    // Старые текстовые значения читаются типизированно
+    QCOMPARE(*proc::value_as<int>(text), 17);
+    QVERIFY(!proc::value_as<int>(proc::make_value("17x")));
+    // Строковый аргумент guard совпадает с типизированным флагом
+    QVERIFY(*proc::make_scalar(true) == *proc::make_value("1"));
+    QVERIFY(!(*proc::make_scalar(false) == *proc::make_value("1")));
+
+    proc::ValueStore store;
+    store["text"] = text;
+    store["count"] = proc::make_scalar(3);
+    QCOMPARE(*proc::get_value_view(store, "text"), std::string_view("17"));
+    QVERIFY(!proc::get_value_view(store, "count"));
+}
+
+void DagTypedStorageTest::denseLayersFollowLayerProtocol() {
+    using SlotState = proc::LayeredState<3, proc::DefaultMemoryPolicy, proc::DenseBaseStore, proc::DenseOverlayStore>;
+    SlotState state;
+    state.G_mut().assign(2, proc::make_scalar(1));
+    state.set_D(5, proc::make_scalar(10));
+    QCOMPARE(*proc::value_as<int>(state.get(2)), 1);
+    QCOMPARE(*proc::value_as<int>(state.get(5)), 10);
+    QVERIFY(!state.get(0));
+
+    state.promote_D_to_V_apply();
+    QVERIFY(state.D().empty());
+    QCOMPARE(state.V().size(), size_t(1));
+
+    // Надгробие в D скрывает нижние слои, promote удаляет поле из V
+    state.erase_D(5);
+    state.erase_D(2);
+    QVERIFY(!state.get(5));
+    QVERIFY(!state.get(2));
+    state.promote_D_to_V_apply();
+    QVERIFY(state.V().empty());
+    QCOMPARE(*proc::value_as<int>(state.get(2)), 1);
+}
+
+void DagTypedStorageTest::engineRunsOnTypedInputs() {
+    const proc::GraphSchema schema = buildSumSchema();
+    const auto nodeSlot = schema.find_node("Sum");
+    const auto aSlot = schema.find_field("a");
+    const auto bSlot = schema.find_field("b");
+    const auto sumSlot = schema.find_field("sum");
+    QVERIFY(nodeSlot && aSlot && bSlot && sumSlot);
+
+    int executions = 0;
+    proc::RuntimeOperationRegistry runtime(proc::make_builtin_operation_registry());
+    runtime.register_op("sum", proc::v2::OpId{ 300 });
+    runtime.bind_executor(
+        schema.op_of(*nodeSlot),
+        *nodeSlot,
+        [&executions, a = *aSlot, b = *bSlot, sum = *sumSlot](
+            const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
+            const proc::RuntimeOperationRegistry::FieldNameFn&,
+            const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
+            ++executions;
+            proc::Commit commit;
+            commit.set_scalar(
+                sum,
+                proc::value_as<int>(readHandle(a)).value_or(0) + proc::value_as<int>(readHandle(b)).value_or(0));
+            return commit;
+        });
+
+    proc::DefaultDagEngine engine(schema, std::move(runtime), proc::make_builtin_guard_registry());
+    proc::ValueStore init;
+    init["a"] = proc::make_scalar(2);
+    init["b"] = proc::make_value("40");
+    init["enabled"] = proc::make_scalar(true);
+    engine.init(init);
+
+    const std::vector<proc::Field> outputs = { "sum" };
+    QVERIFY(engine.flush_prepare(outputs));
+    QCOMPARE(executions, 1);
+    QCOMPARE(*proc::get_value_as<int>(engine.prepared_output_store(), "sum"), 42);
+    QVERIFY(engine.ack_outputs());
+
+    const proc::ValueStore inputs = engine.input_snapshot();
+    QCOMPARE(inputs.size(), size_t(3));
+    QVERIFY(inputs.at("a")->holds<int>());
+
+    // Guard сравнивает типизированный флаг со строковым аргументом "1"
+    proc::Commit disable;
+    disable.set_scalar(schema.find_field("enabled").value(), false);
+    disable.set_scalar(*aSlot, 5);
+    engine.push_input(disable);
+    QVERIFY(engine.flush_prepare(outputs));
+    QCOMPARE(executions, 1);
+
+    // Строковый путь остаётся рабочим: вход по имени поля
+    proc::Commit enable;
+    enable.set("enabled", "1");
+    engine.push_input(enable);
+    QVERIFY(engine.flush_prepare(outputs));
+    QCOMPARE(executions, 2);
+    QCOMPARE(*proc::get_value_as<int>(engine.prepared_output_store(), "sum"), 45);
+}
+
+QTEST_MAIN(DagTypedStorageTest)
+#include "dag_typed_storage.moc"
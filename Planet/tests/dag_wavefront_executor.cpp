@@ -0,0 +1,317 @@
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <proc/ProcessDag.h>
+
+class DagWavefrontExecutorTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void fanOutSplitsIntoLevels();
+    void wavefrontMatchesSerial();
+    void failureKeepsFlushPolicy();
+    void reportsFollowPlanOrder();
+    void workerPoolRunsEveryTask();
+};
+
+namespace {
+
+// a -> Left, Right, Gated(guard enabled) -> Join(left, right)
+proc::GraphSchema buildFanOutSchema() {
+    proc::GraphSchema::StorageLayout roles;
+    roles.inputs.insert("a");
+    roles.inputs.insert("enabled");
+    roles.outputs.insert("sum");
+    roles.outputs.insert("gated");
+
+    proc::OperationRegistry operations = proc::make_builtin_operation_registry();
+    operations.register_op("scale", proc::v2::OpId{ 310 });
+    operations.register_op("join", proc::v2::OpId{ 311 });
+    return proc::GraphSchemaBuilder::compile(
+        roles,
+        {
+            {"a", "int"},
+            {"enabled", "bool"},
+            {"left", "int"},
+            {"right", "int"},
+            {"gated", "int"},
+            {"sum", "int"},
+        },
+        {
+            proc::GraphSchemaBuilder::NodeDef{ "Left", "scale", {"a"}, {"left"}, std::nullopt },
+            proc::GraphSchemaBuilder::NodeDef{ "Right", "scale", {"a"}, {"right"}, std::nullopt },
+            proc::GraphSchemaBuilder::NodeDef{
+                "Gated",
+                "scale",
+                {"a", "enabled"},
+                {"gated"},
+                proc::GraphSchemaBuilder::GuardDef{ "enabled", "1" },
+            },
+            proc::GraphSchemaBuilder::NodeDef{ "Join", "join", {"left", "right"}, {"sum"}, std::nullopt },
+        },
+        operations,
+        proc::make_builtin_algebra_registry());
+}
+
+struct FanOut {
+    std::atomic<int> executions{ 0 };
+    std::atomic<bool> failRight{ false };
+
+    proc::RuntimeOperationRegistry registry(const proc::GraphSchema& schema) {
+        proc::RuntimeOperationRegistry runtime(proc::make_builtin_operation_registry());
+        runtime.register_op("scale", proc::v2::OpId{ 310 });
+        runtime.register_op("join", proc::v2::OpId{ 311 });
+
+        const auto a = *schema.find_field("a");
+        auto bindScale = [&](const char* node, const char* output, int factor) {
+            const auto slot = *schema.find_node(node);
+            runtime.bind_executor(
+                schema.op_of(slot),
+                slot,
+                [this, a, out = *schema.find_field(output), factor, isRight = std::string(node) == "Right"](
+                    const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
+                    const proc::RuntimeOperationRegistry::FieldNameFn&,
+                    const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
+                    ++executions;
+                    if (isRight && failRight) {
+                        throw std::runtime_error("Right failed");
+                    }
+                    proc::Commit commit;
+                    commit.set_scalar(out, proc::value_as<int>(readHandle(a)).value_or(0) * factor);
+                    return commit;
+                });
+        };
+        bindScale("Left", "left", 2);
+        bindScale("Right", "right", 3);
+        bindScale("Gated", "gated", 10);
+
+        const auto join = *schema.find_node("Join");
+        runtime.bind_executor(
+            schema.op_of(join),
+            join,
+            [this, left = *schema.find_field("left"), right = *schema.find_field("right"), sum = *schema.find_field("sum")](
+                const proc::RuntimeOperationRegistry::ReadHandleFn& readHandle,
+                const proc::RuntimeOperationRegistry::FieldNameFn&,
+                const proc::RuntimeOperationRegistry::DebugStringFn&) -> proc::Commit {
+                ++executions;
+                proc::Commit commit;
+                commit.set_scalar(
+                    sum,
+                    proc::value_as<int>(readHandle(left)).value_or(0) + proc::value_as<int>(readHandle(right)).value_or(0));
+                return commit;
+            });
+        return runtime;
+    }
+
+    proc::DefaultDagEngine build(const proc::GraphSchema& schema) {
+        proc::DefaultDagEngine engine(schema, registry(schema), proc::make_builtin_guard_registry());
+        proc::ValueStore init;
+        init["a"] = proc::make_scalar(1);
+        init["enabled"] = proc::make_scalar(true);
+        engine.init(init);
+        return engine;
+    }
+};
+
+const std::vector<proc::Field> kOutputs = { "sum", "gated" };
+
+} // namespace
+
+void DagWavefrontExecutorTest::fanOutSplitsIntoLevels() {
+    const proc::GraphSchema schema = buildFanOutSchema();
+    const proc::Planner planner(schema);
+    const auto plan = planner.build_plan(proc::FieldSet{ "a", "enabled" }, kOutputs);
+    QCOMPARE(plan.topo.size(), size_t(4));
+
+    const auto levels = proc::Executor::wavefront_levels(plan, schema);
+    QCOMPARE(levels.size(), plan.topo.size());
+    for (size_t i = 0; i < plan.topo.size(); ++i) {
+        const std::string name(schema.node_name(plan.topo[i]));
+        // Join ждёт обе ветки, остальные узлы читают только входы
+        QCOMPARE(levels[i], name == "Join" ? 1u : 0u);
+    }
+}
+
+void DagWavefrontExecutorTest::wavefrontMatchesSerial() {
+    const proc::GraphSchema schema = buildFanOutSchema();
+    FanOut serialOps;
+    FanOut wavefrontOps;
+    proc::DefaultDagEngine serial = serialOps.build(schema);
+    proc::DefaultDagEngine wavefront = wavefrontOps.build(schema);
+    serial.set_execution_options(proc::ExecutionOptions{ proc::ExecutionMode::Serial, 0, true });
+    wavefront.set_execution_options(proc::ExecutionOptions{ proc::ExecutionMode::Wavefront, 4, true });
+    QVERIFY(wavefront.execution_options().mode == proc::ExecutionMode::Wavefront);
+
+    for (int step = 0; step < 3; ++step) {
+        proc::Commit input;
+        input.set_handle("a", proc::make_scalar(step + 5));
+        // На втором шаге guard выключает Gated в обоих режимах
+        input.set_handle("enabled", proc::make_scalar(step != 1));
+        for (proc::DefaultDagEngine* engine : { &serial, &wavefront }) {
+            engine->push_input(input);
+            QVERIFY(engine->flush_prepare(kOutputs));
+        }
+
+        QCOMPARE(*proc::get_value_as<int>(wavefront.prepared_output_store(), "sum"), (step + 5) * 5);
+        QCOMPARE(
+            proc::get_value_as<int>(wavefront.prepared_output_store(), "gated"),
+            proc::get_value_as<int>(serial.prepared_output_store(), "gated"));
+
+        // Тайминги в порядке плана, с уровнями и отметкой guard
+        const auto& serialTimings = serial.last_node_timings();
+        const auto& wavefrontTimings = wavefront.last_node_timings();
+        QCOMPARE(wavefrontTimings.size(), size_t(4));
+        QCOMPARE(serialTimings.size(), wavefrontTimings.size());
+        for (size_t i = 0; i < wavefrontTimings.size(); ++i) {
+            const std::string name(schema.node_name(wavefrontTimings[i].node));
+            QCOMPARE(wavefrontTimings[i].node, serialTimings[i].node);
+            QCOMPARE(wavefrontTimings[i].level, serialTimings[i].level);
+            QCOMPARE(wavefrontTimings[i].skipped_guard, step == 1 && name == "Gated");
+            QVERIFY(wavefrontTimings[i].execute.count() >= 0);
+        }
+
+        serial.ack_outputs();
+        wavefront.ack_outputs();
+    }
+    QCOMPARE(wavefrontOps.executions.load(), serialOps.executions.load());
+
+    // Без collect_timings тайминги не собираются
+    wavefront.set_execution_options(proc::ExecutionOptions{ proc::ExecutionMode::Wavefront, 2, false });
+    proc::Commit input;
+    input.set_handle("a", proc::make_scalar(1));
+    wavefront.push_input(input);
+    QVERIFY(wavefront.flush_prepare(kOutputs));
+    QVERIFY(wavefront.last_node_timings().empty());
+    QCOMPARE(*proc::get_value_as<int>(wavefront.prepared_output_store(), "sum"), 5);
+}
+
+void DagWavefrontExecutorTest::failureKeepsFlushPolicy() {
+    const proc::GraphSchema schema = buildFanOutSchema();
+    FanOut ops;
+    proc::DefaultDagEngine engine = ops.build(schema);
+    engine.set_execution_options(proc::ExecutionOptions{ proc::ExecutionMode::Wavefront, 3, false });
+
+    proc::Commit input;
+    input.set_handle("a", proc::make_scalar(7));
+    engine.push_input(input);
+    ops.failRight = true;
+    bool threw = false;
+    try {
+        engine.flush_prepare(kOutputs);
+    } catch (const std::runtime_error& error) {
+        threw = std::string(error.what()) == "Right failed";
+    }
+    QVERIFY(threw);
+    QVERIFY(!engine.has_prepared_outputs());
+    // InvalidateAllInputs: после сбоя грязными считаются все входы
+    QCOMPARE(engine.dirty_inputs().size(), size_t(2));
+
+    ops.failRight = false;
+    QVERIFY(engine.flush_prepare(kOutputs));
+    QCOMPARE(*proc::get_value_as<int>(engine.prepared_output_store(), "sum"), 35);
+}
+
+void DagWavefrontExecutorTest::reportsFollowPlanOrder() {
+    const proc::GraphSchema schema = buildFanOutSchema();
+    const proc::Planner planner(schema);
+    const auto plan = planner.build_plan(proc::FieldSet{ "a", "enabled" }, kOutputs);
+    FanOut ops;
+    const proc::RuntimeOperationRegistry runtime = ops.registry(schema);
+    const proc::GuardRegistry guards = proc::make_builtin_guard_registry();
+    const proc::DefaultMemoryPolicy policy;
+    const proc::Executor executor;
+    proc::WorkerPool pool(3);
+
+    struct Reports {
+        std::vector<std::string> trace;
+        std::vector<std::string> executed;
+        std::vector<std::string> skipped;
+        std::vector<std::string> callbacks;
+    };
+    auto runOnce = [&](bool wavefront, bool failRight) {
+        Reports reports;
+        const std::function<void(proc::v2::NodeSlot)> onSkip = [&](proc::v2::NodeSlot slot) {
+            reports.callbacks.push_back("skip:" + std::string(schema.node_name(slot)));
+        };
+        const std::function<void(proc::v2::NodeSlot, const proc::Commit&)> onCommit =
+            [&](proc::v2::NodeSlot slot, const proc::Commit&) {
+                reports.callbacks.push_back("commit:" + std::string(schema.node_name(slot)));
+            };
+
+        proc::DefaultDagEngine::Storage storage(schema);
+        proc::Commit input;
+        input.set_handle("a", proc::make_scalar(4));
+        input.set_handle("enabled", proc::make_scalar(false));
+        storage.push_input(input, policy, &schema);
+        ops.failRight = failRight;
+        storage.begin_run();
+        try {
+            if (wavefront) {
+                executor.run_wavefront(plan, schema, storage, policy, runtime, guards, pool,
+                    &reports.trace, &reports.executed, &reports.skipped, &onSkip, nullptr, &onCommit);
+            }
+            else {
+                executor.run(plan, schema, storage, policy, runtime, guards,
+                    &reports.trace, &reports.executed, &reports.skipped, &onSkip, nullptr, &onCommit);
+            }
+            storage.end_run_success();
+        } catch (const std::runtime_error&) {
+            storage.end_run_abort();
+        }
+        return reports;
+    };
+
+    // Gated выключен guard'ом посреди уровня: отчёты идут в порядке плана, как в run()
+    for (bool failRight : { false, true }) {
+        const Reports serial = runOnce(false, failRight);
+        const Reports wavefront = runOnce(true, failRight);
+        QCOMPARE(wavefront.trace, serial.trace);
+        QCOMPARE(wavefront.executed, serial.executed);
+        QCOMPARE(wavefront.skipped, serial.skipped);
+        QCOMPARE(wavefront.callbacks, serial.callbacks);
+        if (!failRight) {
+            QCOMPARE(serial.skipped, std::vector<std::string>{ "Gated" });
+            QCOMPARE(serial.executed.size(), size_t(3));
+        }
+        else {
+            QVERIFY(std::find(wavefront.executed.begin(), wavefront.executed.end(), "Right") == wavefront.executed.end());
+            QVERIFY(std::find(wavefront.executed.begin(), wavefront.executed.end(), "Join") == wavefront.executed.end());
+        }
+    }
+}
+
+void DagWavefrontExecutorTest::workerPoolRunsEveryTask() {
+    proc::WorkerPool pool(4);
+    QCOMPARE(pool.size(), size_t(4));
+    for (int round = 0; round < 50; ++round) {
+        std::vector<int> hits(37, 0);
+        pool.run(hits.size(), [&hits](size_t i) { ++hits[i]; });
+        for (int hit : hits) {
+            QCOMPARE(hit, 1);
+        }
+    }
+
+    bool threw = false;
+    try {
+        pool.run(8, [](size_t i) {
+            if (i == 5) throw std::runtime_error("task failed");
+        });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    QVERIFY(threw);
+    // Пул переживает исключение задачи
+    std::atomic<int> total{ 0 };
+    pool.run(8, [&total](size_t i) { total += static_cast<int>(i); });
+    QCOMPARE(total.load(), 28);
+    QCOMPARE(proc::WorkerPool::resolve_size(16, 3), size_t(3));
+}
+
+QTEST_MAIN(DagWavefrontExecutorTest)
+#include "dag_wavefront_executor.moc"
@@ -0,0 +1,162 @@
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "../renderers/ParticleSimulator.h"
+
+class ParticleSimulatorTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void matchesAosReference();
+    void threadCountDoesNotChangeResult();
+    void rangesAndResizeKeepParticles();
+};
+
+namespace {
+
+ContributorWindField testWind() {
+    ContributorWindField wind;
+    wind.direction = QVector3D(0.8f, 0.2f, 0.4f).normalized();
+    wind.strength = 0.35f;
+    wind.gustStrength = 0.4f;
+    wind.gustSpeed = 1.8f;
+    wind.turbulence = 0.2f;
+    return wind;
+}
+
+std::vector<ContributorParticle> makeParticles(size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<ContributorParticle> particles;
+    while (particles.size() < count) {
+        ContributorParticleBlob blob;
+        blob.center = QVector3D(0.0f, 1.5f + static_cast<float>(particles.size() % 7), 0.0f);
+        blob.radius = 1.2f;
+        blob.particleCount = static_cast<int>(std::min<size_t>(500, count - particles.size()));
+        const std::vector<ContributorParticle> part = generateParticleBlob(blob, rng);
+        particles.insert(particles.end(), part.begin(), part.end());
+    }
+    return particles;
+}
+
+// Прежний покадровый цикл ParticleRenderer::update над массивом структур
+void referenceStep(std::vector<ContributorParticle>& particles, float deltaTime, float time,
+    const ContributorWindField& wind, const QVector3D& treeCenter)
+{
+    deltaTime = std::min(deltaTime, 0.033f);
+    const float stiffness = 8.0f;
+    const float damping = 3.0f;
+    for (ContributorParticle& p : particles) {
+        float heightFactor = (p.restPosition.y() - treeCenter.y()) / 5.0f;
+        heightFactor = std::clamp(heightFactor, 0.3f, 1.2f);
+        float gust = std::sin(time * wind.gustSpeed + p.phase) * wind.gustStrength;
+        float turbulenceX = std::sin(time * 2.3f + p.restPosition.y() * 1.5f) * wind.turbulence;
+        float turbulenceZ = std::cos(time * 1.7f + p.restPosition.x() * 1.2f) * wind.turbulence;
+        QVector3D windForce = wind.direction * (wind.strength + gust) * heightFactor;
+        windForce.setX(windForce.x() + turbulenceX);
+        windForce.setZ(windForce.z() + turbulenceZ);
+        windForce *= p.windWeight;
+        QVector3D springForce = (p.restPosition - p.position) * stiffness;
+        QVector3D dampingForce = -p.velocity * damping;
+        QVector3D acceleration = windForce + springForce + dampingForce;
+        p.velocity += acceleration * deltaTime;
+        p.position += p.velocity * deltaTime;
+        p.velocity *= 0.99f;
+    }
+}
+
+} // namespace
+
+void ParticleSimulatorTest::matchesAosReference() {
+    std::vector<ContributorParticle> reference = makeParticles(5000, 7u);
+    ParticleSimulator simulator;
+    simulator.setThreadCount(1);
+    simulator.assign(reference);
+    QCOMPARE(simulator.size(), reference.size());
+
+    const ContributorWindField wind = testWind();
+    const QVector3D center(0.0f, 1.0f, 0.0f);
+    std::vector<ParticleVertex> vertices(simulator.size());
+    float time = 0.0f;
+    for (int frame = 0; frame < 240; ++frame) {
+        time += 0.016f;
+        referenceStep(reference, 0.016f, time, wind, center);
+        simulator.step(0.016f, time, wind, center, vertices.data());
+    }
+
+    // Порядок операций другой, поэтому сравнение с допуском
+    float maxError = 0.0f;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        const ContributorParticle p = simulator.particle(i);
+        maxError = std::max(maxError, (p.position - reference[i].position).length());
+        maxError = std::max(maxError, (p.velocity - reference[i].velocity).length());
+        QCOMPARE(vertices[i].position[0], p.position.x());
+        QCOMPARE(vertices[i].position[2], p.position.z());
+        QCOMPARE(vertices[i].color[1], reference[i].color.y());
+        QCOMPARE(vertices[i].size, reference[i].size);
+        QCOMPARE(vertices[i].rotation, reference[i].rotation);
+        QCOMPARE(vertices[i].normal[0], reference[i].normal.x());
+    }
+    QVERIFY(maxError < 1e-4f);
+
+    // Ветер реально сдвигает частицы
+    QVERIFY((simulator.particle(0).position - simulator.particle(0).restPosition).length() > 1e-4f);
+}
+
+void ParticleSimulatorTest::threadCountDoesNotChangeResult() {
+    const std::vector<ContributorParticle> particles = makeParticles(3 * ParticleSimulator::kChunkSize + 123, 11u);
+    ParticleSimulator serial;
+    serial.setThreadCount(1);
+    serial.assign(particles);
+    ParticleSimulator parallel;
+    parallel.setThreadCount(4);
+    parallel.assign(particles);
+
+    const ContributorWindField wind = testWind();
+    std::vector<ParticleVertex> serialVertices(particles.size());
+    std::vector<ParticleVertex> parallelVertices(particles.size());
+    float time = 0.0f;
+    for (int frame = 0; frame < 30; ++frame) {
+        time += 0.016f;
+        serial.step(0.016f, time, wind, QVector3D(), serialVertices.data());
+        parallel.step(0.016f, time, wind, QVector3D(), parallelVertices.data());
+    }
+    // Каждая частица считается одинаково при любом разбиении на потоки
+    QVERIFY(std::memcmp(serialVertices.data(), parallelVertices.data(), serialVertices.size() * sizeof(ParticleVertex)) == 0);
+}
+
+void ParticleSimulatorTest::rangesAndResizeKeepParticles() {
+    const std::vector<ContributorParticle> particles = makeParticles(100, 3u);
+    ParticleSimulator simulator;
+    simulator.assign(particles);
+
+    // Запись диапазона не трогает соседние вершины
+    std::vector<ParticleVertex> vertices(20);
+    for (ParticleVertex& v : vertices) v.size = -1.0f;
+    simulator.writeVertices(vertices.data() + 5, 40, 10);
+    QCOMPARE(vertices[4].size, -1.0f);
+    QCOMPARE(vertices[15].size, -1.0f);
+    QCOMPARE(vertices[5].position[1], particles[40].position.y());
+    QCOMPARE(vertices[14].size, particles[49].size);
+
+    // resize сохраняет префикс, новые частицы - значения по умолчанию
+    simulator.resize(150);
+    QCOMPARE(simulator.particle(99).restPosition, particles[99].restPosition);
+    QCOMPARE(simulator.particle(120).size, ContributorParticle().size);
+    simulator.setParticle(120, particles[0]);
+    QCOMPARE(simulator.particle(120).phase, particles[0].phase);
+
+    simulator.resize(10);
+    QCOMPARE(simulator.size(), size_t(10));
+    QCOMPARE(simulator.particle(9).normal, particles[9].normal);
+    simulator.clear();
+    QVERIFY(simulator.empty());
+    simulator.step(0.016f, 0.0f, testWind(), QVector3D(), nullptr);
+}
+
+QTEST_MAIN(ParticleSimulatorTest)
+#include "particle_simulator.moc"
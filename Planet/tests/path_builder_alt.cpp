@@ -0,0 +1,97 @@
+#include <QtTest/QtTest>
+
+#include <random>
+
+#include "../controllers/PathBuilder.h"
+#include "../generation/TerrainGenerator.h"
+#include "../model/HexSphereModel.h"
+
+class PathBuilderAltTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void landmarksKeepOptimalCost();
+    void workspaceReuseMatchesFreshSearch();
+    void rebuildDropsLandmarks();
+};
+
+namespace {
+
+HexSphereModel makeModel(int level) {
+    IcosphereBuilder builder;
+    HexSphereModel model;
+    model.rebuildFromIcosphere(builder.build(level));
+    createTerrainGeneratorByIndex(3)->generate(model, TerrainParams{ 12345u, 3, 3.0f });
+    return model;
+}
+
+float pathCost(const PathBuilder& pb, const HexSphereModel& model, const std::vector<int>& path) {
+    float cost = 0.0f;
+    for (size_t i = 0; i + 1 < path.size(); ++i) {
+        cost += pb.traversalCost(model.cells()[size_t(path[i])], model.cells()[size_t(path[i + 1])]);
+    }
+    return cost;
+}
+
+} // namespace
+
+void PathBuilderAltTest::landmarksKeepOptimalCost() {
+    const HexSphereModel model = makeModel(4);
+    PathBuilder greatCircle(model, PathBuilder::kMaxClimbDelta);
+    greatCircle.build();
+    PathBuilder alt(model, PathBuilder::kMaxClimbDelta);
+    alt.build();
+    alt.buildLandmarks(6);
+    QVERIFY(alt.landmarkCount() > 0);
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pick(0, model.cellCount() - 1);
+    int found = 0;
+    for (int q = 0; q < 100; ++q) {
+        const int start = pick(rng);
+        const int goal = pick(rng);
+        const std::vector<int> expected = greatCircle.astar(start, goal);
+        const std::vector<int> actual = alt.astar(start, goal);
+        QCOMPARE(actual.empty(), expected.empty());
+        if (expected.empty()) {
+            continue;
+        }
+        ++found;
+        QCOMPARE(actual.front(), start);
+        QCOMPARE(actual.back(), goal);
+        const float expectedCost = pathCost(greatCircle, model, expected);
+        QVERIFY(std::abs(pathCost(alt, model, actual) - expectedCost) <= 1e-4f * std::max(expectedCost, 1.0f));
+    }
+
+    QVERIFY(found > 0);
+    QCOMPARE(alt.totalSearchStats().queries, uint64_t(100));
+    QVERIFY(alt.totalSearchStats().expandedNodes < greatCircle.totalSearchStats().expandedNodes);
+}
+
+void PathBuilderAltTest::workspaceReuseMatchesFreshSearch() {
+    const HexSphereModel model = makeModel(3);
+    PathBuilder pb(model, 1);
+    pb.build();
+
+    PathBuilder::SearchWorkspace shared;
+    for (int goal = 1; goal < model.cellCount(); goal += 37) {
+        PathBuilder::SearchWorkspace fresh;
+        QCOMPARE(pb.astar(0, goal, shared), pb.astar(0, goal, fresh));
+        QCOMPARE(shared.last.expandedNodes, fresh.last.expandedNodes);
+    }
+    QCOMPARE(pb.astar(5, 5), std::vector<int>{ 5 });
+    QVERIFY(pb.astar(-1, 5).empty());
+}
+
+void PathBuilderAltTest::rebuildDropsLandmarks() {
+    const HexSphereModel model = makeModel(2);
+    PathBuilder pb(model, 1);
+    pb.build();
+    pb.buildLandmarks(4);
+    QVERIFY(pb.landmarkCount() > 0);
+    pb.build();
+    QCOMPARE(pb.landmarkCount(), 0);
+}
+
+QTEST_MAIN(PathBuilderAltTest)
+#include "path_builder_alt.moc"
@@ -0,0 +1,142 @@
+#include <QtTest/QtTest>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../generation/PerlinNoise.h"
+
+class PerlinBatchTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void singleOctaveMatchesDouble();
+    void fractalMatchesDouble();
+    void backendsAgreeOnTails();
+    void batchIsFasterThanDouble();
+};
+
+namespace {
+
+struct Points {
+    std::vector<float> x, y, z;
+};
+
+Points randomPoints(size_t count, float range, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> coord(-range, range);
+    Points points;
+    for (size_t i = 0; i < count; ++i) {
+        points.x.push_back(coord(rng));
+        points.y.push_back(coord(rng));
+        points.z.push_back(coord(rng));
+    }
+    return points;
+}
+
+// Тот же порядок float-операций для координат, что и в пакетных ядрах
+double referenceFractal(const Perlin3D& noise, float x, float y, float z, const PerlinFractal& fractal) {
+    double sum = 0.0;
+    double total = 0.0;
+    float frequency = fractal.frequency;
+    double amplitude = 1.0;
+    for (int o = 0; o < fractal.octaves; ++o) {
+        sum += amplitude * noise.noise(x * frequency + fractal.offsetX,
+            y * frequency + fractal.offsetY,
+            z * frequency + fractal.offsetZ);
+        total += amplitude;
+        frequency *= fractal.lacunarity;
+        amplitude *= fractal.gain;
+    }
+    return sum / total;
+}
+
+const PerlinBackend kBackends[] = { PerlinBackend::Scalar, PerlinBackend::SSE2, PerlinBackend::AVX2, PerlinBackend::Auto };
+
+} // namespace
+
+void PerlinBatchTest::singleOctaveMatchesDouble() {
+    const Perlin3D noise(2024u);
+    // Отрицательные, целые и дробные координаты; 1001 - с хвостом для 4 и 8 lanes
+    Points points = randomPoints(1001, 40.0f, 1u);
+    points.x[0] = -3.0f; points.y[0] = 0.0f; points.z[0] = 7.0f;
+    points.x[1] = -0.5f; points.y[1] = -255.5f; points.z[1] = 256.25f;
+
+    std::vector<float> out(points.x.size());
+    for (PerlinBackend backend : kBackends) {
+        noise.noiseBatch(points.x.data(), points.y.data(), points.z.data(), out.data(), out.size(), backend);
+        double maxError = 0.0;
+        for (size_t i = 0; i < out.size(); ++i) {
+            maxError = std::max(maxError, std::abs(out[i] - noise.noise(points.x[i], points.y[i], points.z[i])));
+        }
+        QVERIFY2(maxError < 1e-5, Perlin3D::backendName(backend));
+    }
+}
+
+void PerlinBatchTest::fractalMatchesDouble() {
+    const Perlin3D noise(12345u);
+    const Points points = randomPoints(4099, 1.0f, 2u);
+    PerlinFractal fractal;
+    fractal.frequency = 2.5f;
+    fractal.octaves = 5;
+    fractal.offsetX = 50.0f;
+    fractal.offsetZ = 25.0f;
+
+    std::vector<float> out(points.x.size());
+    for (PerlinBackend backend : kBackends) {
+        noise.fractalBatch(points.x.data(), points.y.data(), points.z.data(), out.data(), out.size(), fractal, backend);
+        double maxError = 0.0;
+        for (size_t i = 0; i < out.size(); ++i) {
+            const double expected = referenceFractal(noise, points.x[i], points.y[i], points.z[i], fractal);
+            maxError = std::max(maxError, std::abs(out[i] - expected));
+            QVERIFY(out[i] >= -1.0f && out[i] <= 1.0f);
+        }
+        QVERIFY2(maxError < 1e-4, Perlin3D::backendName(backend));
+    }
+}
+
+void PerlinBatchTest::backendsAgreeOnTails() {
+    const Perlin3D noise(7u);
+    for (size_t count : { size_t(0), size_t(1), size_t(3), size_t(7), size_t(9), size_t(17) }) {
+        const Points points = randomPoints(count, 10.0f, uint32_t(count) + 3u);
+        std::vector<float> scalar(count, 5.0f);
+        noise.noiseBatch(points.x.data(), points.y.data(), points.z.data(), scalar.data(), count, PerlinBackend::Scalar);
+        for (PerlinBackend backend : kBackends) {
+            std::vector<float> out(count, 5.0f);
+            noise.noiseBatch(points.x.data(), points.y.data(), points.z.data(), out.data(), count, backend);
+            for (size_t i = 0; i < count; ++i) {
+                QVERIFY(std::abs(out[i] - scalar[i]) < 1e-6f);
+            }
+        }
+    }
+}
+
+void PerlinBatchTest::batchIsFasterThanDouble() {
+    const Perlin3D noise(99u);
+    const Points points = randomPoints(200000, 1.0f, 4u);
+    PerlinFractal fractal;
+    fractal.frequency = 3.0f;
+    fractal.octaves = 4;
+
+    auto start = std::chrono::steady_clock::now();
+    double checksum = 0.0;
+    for (size_t i = 0; i < points.x.size(); ++i) {
+        checksum += referenceFractal(noise, points.x[i], points.y[i], points.z[i], fractal);
+    }
+    const double doubleMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<float> out(points.x.size());
+    start = std::chrono::steady_clock::now();
+    noise.fractalBatch(points.x.data(), points.y.data(), points.z.data(), out.data(), out.size(), fractal);
+    const double batchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    qInfo() << "perlin fractal 200k points: double" << doubleMs << "ms," << Perlin3D::backendName(Perlin3D::resolveBackend())
+        << batchMs << "ms, checksum" << checksum;
+    // Для SIMD-ядер ожидаем кратный выигрыш; запас на шумные CI-машины
+    if (Perlin3D::resolveBackend() != PerlinBackend::Scalar) {
+        QVERIFY(batchMs < doubleMs);
+    }
+}
+
+QTEST_MAIN(PerlinBatchTest)
+#include "perlin_batch.moc"
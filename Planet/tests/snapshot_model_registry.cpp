@@ -0,0 +1,89 @@
+#include <QtTest/QtTest>
+
+#include "../dag/SnapshotModelRegistry.h"
+#include "../dag/TerrainSerialization.h"
+
+class SnapshotModelRegistryTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void sameVersionSharesModel();
+    void pathGraphFollowsVersionAndDelta();
+};
+
+namespace {
+
+TerrainSnapshot makeSnapshot(int heightShift) {
+    TerrainSnapshot snapshot;
+    snapshot.subdivisionLevel = 2;
+    snapshot.cells.resize(10 * 4 * 4 + 2);
+    for (size_t i = 0; i < snapshot.cells.size(); ++i) {
+        snapshot.cells[i].height = static_cast<int>(i % 3) + heightShift;
+        snapshot.cells[i].biome = Biome::Grass;
+    }
+    return snapshot;
+}
+
+} // namespace
+
+void SnapshotModelRegistryTest::sameVersionSharesModel() {
+    SnapshotModelRegistry registry;
+    const std::string first = encodeTerrainSnapshot(makeSnapshot(0));
+    const std::string second = encodeTerrainSnapshot(makeSnapshot(1));
+    const auto firstView = TerrainSnapshotView::fromBytes(first);
+    const auto secondView = TerrainSnapshotView::fromBytes(second);
+    QVERIFY(firstView && secondView);
+
+    const auto a = registry.acquireModel(hashContent(first), *firstView);
+    const auto b = registry.acquireModel(hashContent(first), *firstView);
+    QCOMPARE(a.get(), b.get());
+    QCOMPARE(a->cellCount(), 162);
+    QCOMPARE(a->cells()[4].height, 1);
+
+    // Новая версия - новая модель; старая остаётся у держателя неизменной
+    const auto c = registry.acquireModel(hashContent(second), *secondView);
+    QVERIFY(c.get() != a.get());
+    QCOMPARE(c->cells()[4].height, 2);
+    QCOMPARE(a->cells()[4].height, 1);
+
+    const SnapshotModelStats stats = registry.stats();
+    QCOMPARE(stats.modelBuilds, uint64_t(2));
+    QCOMPARE(stats.modelReuses, uint64_t(1));
+}
+
+void SnapshotModelRegistryTest::pathGraphFollowsVersionAndDelta() {
+    SnapshotModelRegistry registry;
+    const std::string bytes = encodeTerrainSnapshot(makeSnapshot(0));
+    const auto view = TerrainSnapshotView::fromBytes(bytes);
+    QVERIFY(view);
+    const ContentHash128 version = hashContent(bytes);
+
+    const auto graph = registry.acquirePathGraph(version, *view, 1);
+    QCOMPARE(registry.acquirePathGraph(version, *view, 1).get(), graph.get());
+    // Граф строится поверх той же общей модели
+    QCOMPARE(registry.acquireModel(version, *view).get(), graph->model.get());
+
+    PathBuilder::SearchWorkspace workspace;
+    const auto path = graph->builder->astar(0, 100, workspace);
+    QVERIFY(!path.empty());
+    QCOMPARE(path.front(), 0);
+    QCOMPARE(path.back(), 100);
+
+    // Другой допуск по высоте требует другого графа, но не другой модели
+    const auto steeper = registry.acquirePathGraph(version, *view, 2);
+    QVERIFY(steeper.get() != graph.get());
+    QCOMPARE(steeper->model.get(), graph->model.get());
+
+    const SnapshotModelStats stats = registry.stats();
+    QCOMPARE(stats.graphBuilds, uint64_t(2));
+    QCOMPARE(stats.graphReuses, uint64_t(1));
+    QCOMPARE(stats.modelBuilds, uint64_t(1));
+
+    registry.resetStats();
+    registry.clear();
+    QCOMPARE(registry.stats().graphReuses, uint64_t(0));
+    QVERIFY(registry.acquirePathGraph(version, *view, 1).get() != graph.get());
+}
+
+QTEST_MAIN(SnapshotModelRegistryTest)
+#include "snapshot_model_registry.moc"
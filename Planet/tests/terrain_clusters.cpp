@@ -0,0 +1,307 @@
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <set>
+
+#include "../culling/TerrainClusters.h"
+#include "../culling/TerrainCulling.h"
+#include "../generation/TerrainGenerator.h"
+#include "../model/HexSphereModel.h"
+#include "../renderers/TerrainTessellator.h"
+
+class TerrainClustersTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void clustersCoverLiveTriangles();
+    void keepsEveryFrontFacingTriangle();
+    void cullingMeshKeepsOwners();
+    void drawRangesMatchIndexList();
+    void refitKeepsOrderForInPlaceEdits();
+};
+
+namespace {
+
+using TriKey = std::array<uint32_t, 3>;
+
+HexSphereModel makeModel(int level) {
+    IcosphereBuilder builder;
+    HexSphereModel model;
+    model.rebuildFromIcosphere(builder.build(level));
+    createTerrainGeneratorByIndex(3)->generate(model, TerrainParams{ 12345u, 3, 3.0f });
+    return model;
+}
+
+TerrainTessellator makeTessellator() {
+    TerrainTessellator tessellator;
+    tessellator.smoothMaxDelta = 1;
+    tessellator.threadCount = 1;
+    return tessellator;
+}
+
+TerrainMesh makeMesh(int level) {
+    return makeTessellator().build(makeModel(level));
+}
+
+QVector3D vertexAt(const TerrainMesh& mesh, uint32_t i) {
+    return QVector3D(mesh.pos[size_t(i) * 3], mesh.pos[size_t(i) * 3 + 1], mesh.pos[size_t(i) * 3 + 2]);
+}
+
+TriKey triangleAt(const std::vector<uint32_t>& idx, size_t t) {
+    return { idx[t * 3], idx[t * 3 + 1], idx[t * 3 + 2] };
+}
+
+bool isLive(const TerrainMesh& mesh, const std::vector<uint32_t>& idx, size_t t) {
+    const QVector3D v0 = vertexAt(mesh, idx[t * 3]);
+    const QVector3D n = QVector3D::crossProduct(vertexAt(mesh, idx[t * 3 + 1]) - v0, vertexAt(mesh, idx[t * 3 + 2]) - v0);
+    return n.lengthSquared() > 0.0f;
+}
+
+// Камеры по спирали Фибоначчи на нескольких высотах орбиты
+std::vector<QVector3D> orbitCameras() {
+    std::vector<QVector3D> cameras;
+    const int count = 24;
+    for (float distance : { 1.3f, 3.0f, 8.0f }) {
+        for (int i = 0; i < count; ++i) {
+            const float y = 1.0f - 2.0f * (i + 0.5f) / count;
+            const float r = std::sqrt(1.0f - y * y);
+            const float phi = 2.39996323f * i;
+            cameras.push_back(QVector3D(r * std::cos(phi), y, r * std::sin(phi)) * distance);
+        }
+    }
+    return cameras;
+}
+
+} // namespace
+
+void TerrainClustersTest::clustersCoverLiveTriangles() {
+    const TerrainMesh mesh = makeMesh(3);
+    TerrainClusters clusters;
+    clusters.build(mesh, 64);
+    QCOMPARE(clusters.sourceTriangleCount(), mesh.idx.size() / 3);
+
+    // Тот же набор треугольников (с владельцами), только в порядке кластеров
+    std::multiset<std::pair<TriKey, int>> expected;
+    for (size_t t = 0; t < mesh.triOwner.size(); ++t) expected.insert({ triangleAt(mesh.idx, t), mesh.triOwner[t] });
+    std::multiset<std::pair<TriKey, int>> actual;
+    for (size_t t = 0; t < clusters.owners().size(); ++t) actual.insert({ triangleAt(clusters.indices(), t), clusters.owners()[t] });
+    QCOMPARE(actual, expected);
+
+    // Кластеры фиксированного размера лежат подряд; группы накрывают свои кластеры
+    uint32_t next = 0;
+    for (size_t c = 0; c < clusters.clusterCount(); ++c) {
+        const TerrainCluster& cluster = clusters.clusters()[c];
+        QCOMPARE(cluster.firstIndex, next);
+        if (c + 1 < clusters.clusterCount()) QCOMPARE(cluster.indexCount, uint32_t(64 * 3));
+        next += cluster.indexCount;
+        for (uint32_t k = cluster.firstIndex; k < cluster.firstIndex + cluster.indexCount; ++k)
+            QVERIFY((vertexAt(mesh, clusters.indices()[k]) - cluster.center).length() <= cluster.radius * 1.0001f);
+
+        const TerrainCluster& group = clusters.groups()[c / TerrainClusters::kGroupSize];
+        QVERIFY(cluster.firstIndex >= group.firstIndex);
+        QVERIFY(cluster.firstIndex + cluster.indexCount <= group.firstIndex + group.indexCount);
+        QVERIFY((cluster.center - group.center).length() + cluster.radius <= group.radius * 1.0001f);
+    }
+    QCOMPARE(size_t(next), clusters.indices().size());
+
+    // Крыши и стенки разных направлений не смешиваются: конусы нормалей узкие
+    size_t narrowCones = 0;
+    for (const TerrainCluster& cluster : clusters.clusters()) narrowCones += cluster.coneCos > 0.7f ? 1 : 0;
+    QVERIFY(narrowCones * 10 >= clusters.clusterCount() * 9);
+}
+
+void TerrainClustersTest::keepsEveryFrontFacingTriangle() {
+    const TerrainMesh mesh = makeMesh(4);
+    TerrainClusters clusters;
+    clusters.build(mesh, 64);
+
+    size_t visibleTotal = 0;
+    size_t queries = 0;
+    for (const QVector3D& eye : orbitCameras()) {
+        std::vector<uint32_t> visible{ 7, 7, 7 }; // результат дописывается в конец
+        const size_t count = clusters.gatherVisible(eye, 0.0f, visible);
+        QCOMPARE(visible.size(), 3 + count * 3);
+        std::set<TriKey> kept;
+        for (size_t t = 1; t < visible.size() / 3; ++t) kept.insert(triangleAt(visible, t));
+
+        for (size_t t = 0; t < mesh.idx.size() / 3; ++t) {
+            const QVector3D v0 = vertexAt(mesh, mesh.idx[t * 3]);
+            const QVector3D v1 = vertexAt(mesh, mesh.idx[t * 3 + 1]);
+            const QVector3D v2 = vertexAt(mesh, mesh.idx[t * 3 + 2]);
+            const QVector3D n = QVector3D::crossProduct(v1 - v0, v2 - v0);
+            if (n.lengthSquared() <= 0.0f) continue;
+            const bool frontFacing = QVector3D::dotProduct(n, v0 - eye) < 0.0f ||
+                QVector3D::dotProduct(n, v1 - eye) < 0.0f || QVector3D::dotProduct(n, v2 - eye) < 0.0f;
+            if (frontFacing) QVERIFY(kept.count(triangleAt(mesh.idx, t)) == 1);
+        }
+        visibleTotal += count;
+        ++queries;
+    }
+
+    // Обратная сторона планеты отсекается целыми кластерами
+    const double meanFraction = double(visibleTotal) / queries / (mesh.idx.size() / 3);
+    QVERIFY(meanFraction < 0.65);
+
+    // eps > 0 отсекает ещё и скользящие углы, eps < 0 - наоборот оставляет больше
+    std::vector<uint32_t> strict;
+    std::vector<uint32_t> loose;
+    std::vector<uint32_t> exact;
+    const QVector3D eye(0.0f, 0.0f, 3.0f);
+    clusters.gatherVisible(eye, 0.0f, exact);
+    clusters.gatherVisible(eye, 0.3f, strict);
+    clusters.gatherVisible(eye, -0.3f, loose);
+    QVERIFY(strict.size() <= exact.size());
+    QVERIFY(loose.size() >= exact.size());
+}
+
+void TerrainClustersTest::cullingMeshKeepsOwners() {
+    const TerrainMesh mesh = makeMesh(3);
+    std::set<std::pair<TriKey, int>> source;
+    for (size_t t = 0; t < mesh.triOwner.size(); ++t) source.insert({ triangleAt(mesh.idx, t), mesh.triOwner[t] });
+
+    TerrainCulling culling;
+    culling.setFullMesh(mesh);
+    QCOMPARE(culling.getVisibleTriangleCount(), mesh.idx.size() / 3);
+
+    // Смещённый центр планеты: камера сдвигается вместе с ним
+    const QVector3D planetCenter(10.0f, -4.0f, 2.0f);
+    const TerrainMesh& culled = culling.getCulledMesh(planetCenter + QVector3D(0.0f, 3.0f, 0.0f), planetCenter);
+    QCOMPARE(culled.idx.size(), culling.getVisibleTriangleCount() * 3);
+    QCOMPARE(culled.triOwner.size(), culling.getVisibleTriangleCount());
+    QVERIFY(culling.getVisibleTriangleCount() < culling.getTotalTriangleCount());
+    for (size_t t = 0; t < culled.triOwner.size(); ++t)
+        QVERIFY(source.count({ triangleAt(culled.idx, t), culled.triOwner[t] }) == 1);
+
+    // Повторный вызов переиспользует буферы и даёт тот же результат
+    const std::vector<uint32_t> first = culled.idx;
+    QCOMPARE(culling.getCulledMesh(planetCenter + QVector3D(0.0f, 3.0f, 0.0f), planetCenter).idx, first);
+}
+
+void TerrainClustersTest::drawRangesMatchIndexList() {
+    const TerrainMesh mesh = makeMesh(4);
+    TerrainClusters clusters;
+    clusters.build(mesh, 64);
+
+    for (const QVector3D& eye : orbitCameras()) {
+        std::vector<uint32_t> visible;
+        const size_t count = clusters.gatherVisible(eye, 0.0f, visible);
+
+        // Диапазоны по возрастанию, без пересечений и соседних стыков; вместе дают тот же список индексов
+        std::vector<TerrainDrawRange> ranges;
+        QCOMPARE(clusters.gatherVisibleRanges(eye, 0.0f, ranges), count);
+        std::vector<uint32_t> joined;
+        for (size_t r = 0; r < ranges.size(); ++r) {
+            QVERIFY(ranges[r].indexCount > 0);
+            QCOMPARE(ranges[r].indexCount % 3, 0u);
+            if (r > 0) QVERIFY(ranges[r].firstIndex > ranges[r - 1].firstIndex + ranges[r - 1].indexCount);
+            QVERIFY(ranges[r].firstIndex + ranges[r].indexCount <= clusters.indices().size());
+            joined.insert(joined.end(), clusters.indices().begin() + ranges[r].firstIndex,
+                clusters.indices().begin() + ranges[r].firstIndex + ranges[r].indexCount);
+        }
+        QCOMPARE(joined, visible);
+
+        // Склейка через разрыв: меньше вызовов отрисовки, покрытие - надмножество
+        std::vector<TerrainDrawRange> merged{ { 1u, 2u } }; // результат дописывается в конец
+        const size_t mergedCount = clusters.gatherVisibleRanges(eye, 0.0f, merged, 64 * 3 * 4);
+        QCOMPARE(merged.front().firstIndex, 1u);
+        merged.erase(merged.begin());
+        QVERIFY(merged.size() <= ranges.size());
+        QVERIFY(mergedCount >= count);
+        size_t mergedIndices = 0;
+        for (const TerrainDrawRange& range : merged) mergedIndices += range.indexCount;
+        QCOMPARE(mergedIndices, mergedCount * 3);
+        for (const TerrainDrawRange& range : ranges) {
+            const bool covered = std::any_of(merged.begin(), merged.end(), [&](const TerrainDrawRange& m) {
+                return m.firstIndex <= range.firstIndex && range.firstIndex + range.indexCount <= m.firstIndex + m.indexCount;
+            });
+            QVERIFY(covered);
+        }
+    }
+}
+
+void TerrainClustersTest::refitKeepsOrderForInPlaceEdits() {
+    HexSphereModel model = makeModel(3);
+    const TerrainTessellator tessellator = makeTessellator();
+    TerrainMesh mesh = tessellator.build(model);
+    TerrainClusters clusters;
+    clusters.build(mesh, 64);
+    std::vector<TerrainDrawRange> changed;
+
+    // Биом меняет только цвета: индексы и порядок те же
+    const std::vector<uint32_t> initial = clusters.indices();
+    model.setBiome(11, Biome::Desert);
+    TerrainMeshPatch patch = tessellator.retessellateCells(model, { 11 }, mesh);
+    QVERIFY(!patch.slotIndexBytes.empty());
+    QVERIFY(clusters.refit(mesh, patch.slotIndexBytes, changed));
+    QVERIFY(changed.empty());
+    QCOMPARE(clusters.indices(), initial);
+
+    // Швы выросли и переехали в хвост: новым треугольникам в порядке места нет
+    const std::vector<int> dirty{ 7, 8 };
+    for (int cid : dirty) model.addHeight(cid, +3);
+    patch = tessellator.retessellateCells(model, dirty, mesh);
+    QVERIFY(patch.resized);
+    QVERIFY(!clusters.refit(mesh, patch.slotIndexBytes, changed));
+    QVERIFY(changed.empty());
+    QCOMPARE(clusters.indices(), initial);
+    clusters.build(mesh, 64);
+    QCOMPARE(clusters.sourceTriangleCount(), mesh.idx.size() / 3);
+
+    // Обратная правка укладывается в слоты: порядок тот же, переписаны только changed
+    const std::vector<uint32_t> built = clusters.indices();
+    const size_t clusterCount = clusters.clusterCount();
+    for (int cid : dirty) model.addHeight(cid, -3);
+    patch = tessellator.retessellateCells(model, dirty, mesh);
+    QVERIFY(!patch.fullRebuild);
+    QVERIFY(!patch.resized);
+    QVERIFY(clusters.refit(mesh, patch.slotIndexBytes, changed));
+    QVERIFY(!changed.empty());
+    QCOMPARE(clusters.clusterCount(), clusterCount);
+    QCOMPARE(clusters.indices().size(), built.size());
+    std::vector<bool> rewritten(built.size(), false);
+    for (size_t r = 0; r < changed.size(); ++r) {
+        if (r > 0) QVERIFY(changed[r].firstIndex > changed[r - 1].firstIndex + changed[r - 1].indexCount);
+        QVERIFY(changed[r].firstIndex + changed[r].indexCount <= built.size());
+        std::fill(rewritten.begin() + changed[r].firstIndex, rewritten.begin() + changed[r].firstIndex + changed[r].indexCount, true);
+    }
+    for (size_t k = 0; k < built.size(); ++k)
+        if (!rewritten[k]) QCOMPARE(clusters.indices()[k], built[k]);
+
+    // Живые треугольники - те же, что в сетке; умершие остались вырожденными на своих местах
+    std::multiset<std::pair<TriKey, int>> expected;
+    for (size_t t = 0; t < mesh.triOwner.size(); ++t)
+        if (isLive(mesh, mesh.idx, t)) expected.insert({ triangleAt(mesh.idx, t), mesh.triOwner[t] });
+    std::multiset<std::pair<TriKey, int>> actual;
+    for (size_t t = 0; t < clusters.owners().size(); ++t)
+        if (isLive(mesh, clusters.indices(), t)) actual.insert({ triangleAt(clusters.indices(), t), clusters.owners()[t] });
+    QCOMPARE(actual, expected);
+
+    // Границы подогнаны заново: сферы накрывают вершины, отсечение консервативно
+    for (const TerrainCluster& cluster : clusters.clusters()) {
+        for (uint32_t k = cluster.firstIndex; k < cluster.firstIndex + cluster.indexCount; k += 3) {
+            if (!isLive(mesh, clusters.indices(), k / 3)) continue;
+            for (uint32_t v = k; v < k + 3; ++v)
+                QVERIFY((vertexAt(mesh, clusters.indices()[v]) - cluster.center).length() <= cluster.radius * 1.0001f);
+        }
+    }
+    for (const QVector3D& eye : orbitCameras()) {
+        std::vector<uint32_t> visible;
+        clusters.gatherVisible(eye, 0.0f, visible);
+        std::set<TriKey> kept;
+        for (size_t t = 0; t < visible.size() / 3; ++t) kept.insert(triangleAt(visible, t));
+        for (size_t t = 0; t < mesh.idx.size() / 3; ++t) {
+            if (!isLive(mesh, mesh.idx, t)) continue;
+            const QVector3D v0 = vertexAt(mesh, mesh.idx[t * 3]);
+            const QVector3D n = QVector3D::crossProduct(vertexAt(mesh, mesh.idx[t * 3 + 1]) - v0, vertexAt(mesh, mesh.idx[t * 3 + 2]) - v0);
+            bool frontFacing = false;
+            for (size_t v = 0; v < 3; ++v)
+                frontFacing = frontFacing || QVector3D::dotProduct(n, vertexAt(mesh, mesh.idx[t * 3 + v]) - eye) < 0.0f;
+            if (frontFacing) QVERIFY(kept.count(triangleAt(mesh.idx, t)) == 1);
+        }
+    }
+}
+
+QTEST_MAIN(TerrainClustersTest)
+#include "terrain_clusters.moc"
@@ -0,0 +1,104 @@
+#include <QtTest/QtTest>
+
+#include "../dag/TerrainSerialization.h"
+
+class TerrainSnapshotBinaryTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void roundTripPreservesCells();
+    void rejectsTruncatedBuffer();
+    void patchCarriesChangedCells();
+};
+
+namespace {
+
+TerrainSnapshot makeSnapshot() {
+    TerrainSnapshot snapshot;
+    snapshot.subdivisionLevel = 3;
+    snapshot.generatorIndex = 1;
+    snapshot.params = { 4242u, -1, 2.5f };
+    for (int i = 0; i < 7; ++i) {
+        TerrainCellSnapshot cell;
+        cell.height = i - 3;
+        cell.biome = static_cast<Biome>(i % 8);
+        cell.temperature = 0.1f * static_cast<float>(i);
+        cell.humidity = 1.0f - 0.1f * static_cast<float>(i);
+        cell.oreType = static_cast<uint8_t>(i);
+        cell.oreVisual.baseColor = QVector3D(0.1f * i, 0.2f, 0.3f);
+        cell.oreVisual.grainColor = QVector3D(0.5f, 0.1f * i, 0.7f);
+        cell.oreNoiseOffset = 3.0f * static_cast<float>(i);
+        snapshot.cells.push_back(cell);
+    }
+    return snapshot;
+}
+
+} // namespace
+
+void TerrainSnapshotBinaryTest::roundTripPreservesCells() {
+    const TerrainSnapshot source = makeSnapshot();
+    const std::string encoded = encodeTerrainSnapshot(source);
+
+    const auto view = TerrainSnapshotView::fromBytes(encoded);
+    QVERIFY(view.has_value());
+    QCOMPARE(view->cellCount(), source.cells.size());
+    QCOMPARE(view->subdivisionLevel(), source.subdivisionLevel);
+    QCOMPARE(view->params().seed, source.params.seed);
+
+    const TerrainSnapshot decoded = view->toSnapshot();
+    for (size_t i = 0; i < source.cells.size(); ++i) {
+        QCOMPARE(decoded.cells[i].height, source.cells[i].height);
+        QCOMPARE(decoded.cells[i].biome, source.cells[i].biome);
+        QCOMPARE(decoded.cells[i].humidity, source.cells[i].humidity);
+        QCOMPARE(decoded.cells[i].oreType, source.cells[i].oreType);
+        QCOMPARE(decoded.cells[i].oreVisual.grainColor, source.cells[i].oreVisual.grainColor);
+        QCOMPARE(decoded.cells[i].oreNoiseOffset, source.cells[i].oreNoiseOffset);
+    }
+}
+
+void TerrainSnapshotBinaryTest::rejectsTruncatedBuffer() {
+    const std::string encoded = encodeTerrainSnapshot(makeSnapshot());
+    QVERIFY(!TerrainSnapshotView::fromBytes(std::string_view(encoded).substr(0, encoded.size() - 1)));
+    QVERIFY(!TerrainSnapshotView::fromBytes(std::string_view()));
+}
+
+void TerrainSnapshotBinaryTest::patchCarriesChangedCells() {
+    const TerrainSnapshot source = makeSnapshot();
+    const std::string encoded = encodeTerrainSnapshot(source);
+    const auto view = TerrainSnapshotView::fromBytes(encoded);
+    QVERIFY(view.has_value());
+
+    const auto unchanged = encodeTerrainSnapshotPatch(*view, source, 1);
+    QVERIFY(unchanged.has_value());
+    QVERIFY(terrainSnapshotPatchRanges(*unchanged)->empty());
+
+    // Соседние клетки сливаются в один диапазон
+    TerrainSnapshot next = source;
+    next.cells[1].height = 40;
+    next.cells[2].humidity = 0.25f;
+    next.cells[6].oreVisual.baseColor = QVector3D(1.0f, 0.0f, 0.0f);
+    const auto patch = encodeTerrainSnapshotPatch(*view, next, 3);
+    QVERIFY(patch.has_value());
+    QVERIFY(patch->size() < encoded.size());
+
+    const auto ranges = terrainSnapshotPatchRanges(*patch);
+    QVERIFY(ranges.has_value());
+    QCOMPARE(ranges->size(), size_t(2));
+    QCOMPARE((*ranges)[0].first, 1u);
+    QCOMPARE((*ranges)[0].count, 2u);
+    QCOMPARE((*ranges)[1].first, 6u);
+
+    const auto applied = applyTerrainSnapshotPatch(encoded, *patch);
+    QVERIFY(applied.has_value());
+    QVERIFY(*applied == encodeTerrainSnapshot(next));
+
+    // Слишком много изменений или другой заголовок - только полный снапшот
+    QVERIFY(!encodeTerrainSnapshotPatch(*view, next, 2));
+    TerrainSnapshot reseeded = source;
+    reseeded.params.seed += 1;
+    QVERIFY(!encodeTerrainSnapshotPatch(*view, reseeded, source.cells.size()));
+    QVERIFY(!applyTerrainSnapshotPatch(encoded, std::string_view(*patch).substr(0, patch->size() - 1)));
+}
+
+QTEST_MAIN(TerrainSnapshotBinaryTest)
+#include "terrain_snapshot_binary.moc"
@@ -0,0 +1,118 @@
+#include <QtTest/QtTest>
+
+#include "../generation/TerrainGenerator.h"
+#include "../model/HexSphereModel.h"
+#include "../renderers/TerrainTessellator.h"
+
+class TerrainTessellatorIncrementalTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void heightEditMatchesFullBuild();
+    void biomeEditTouchesOnlyOneRing();
+    void foreignMeshFallsBackToFullBuild();
+};
+
+namespace {
+
+HexSphereModel makeModel(int level) {
+    IcosphereBuilder builder;
+    HexSphereModel model;
+    model.rebuildFromIcosphere(builder.build(level));
+    createTerrainGeneratorByIndex(3)->generate(model, TerrainParams{ 12345u, 3, 3.0f });
+    return model;
+}
+
+TerrainTessellator makeTessellator() {
+    TerrainTessellator tessellator;
+    tessellator.smoothMaxDelta = 1;
+    tessellator.threadCount = 1;
+    return tessellator;
+}
+
+// Живые треугольники слота: 9 float позиций/цветов на треугольник
+void compareSlot(const TerrainMesh& actual, const TerrainMeshRange& a,
+    const TerrainMesh& expected, const TerrainMeshRange& e)
+{
+    QCOMPARE(a.triCount, e.triCount);
+    const size_t floats = size_t(a.triCount) * 9;
+    const auto slice = [floats](const std::vector<float>& v, uint32_t firstTri) {
+        const auto begin = v.begin() + ptrdiff_t(firstTri) * 9;
+        return std::vector<float>(begin, begin + ptrdiff_t(floats));
+    };
+    QCOMPARE(slice(actual.pos, a.firstTri), slice(expected.pos, e.firstTri));
+    QCOMPARE(slice(actual.col, a.firstTri), slice(expected.col, e.firstTri));
+    QCOMPARE(slice(actual.norm, a.firstTri), slice(expected.norm, e.firstTri));
+}
+
+void compareLayouts(const TerrainMesh& patched, const TerrainMesh& rebuilt) {
+    QCOMPARE(patched.cellRanges.size(), rebuilt.cellRanges.size());
+    QCOMPARE(patched.seamRanges.size(), rebuilt.seamRanges.size());
+    for (size_t cid = 0; cid < rebuilt.cellRanges.size(); ++cid)
+        compareSlot(patched, patched.cellRanges[cid], rebuilt, rebuilt.cellRanges[cid]);
+    for (size_t s = 0; s < rebuilt.seamRanges.size(); ++s)
+        compareSlot(patched, patched.seamRanges[s], rebuilt, rebuilt.seamRanges[s]);
+}
+
+} // namespace
+
+void TerrainTessellatorIncrementalTest::heightEditMatchesFullBuild() {
+    HexSphereModel model = makeModel(3);
+    const TerrainTessellator tessellator = makeTessellator();
+    TerrainMesh mesh = tessellator.build(model);
+    const size_t initialTris = mesh.triOwner.size();
+
+    // +3 превращает склоны вокруг клетки в клифы - швы переезжают в хвост
+    const std::vector<int> dirty{ 7, 8 };
+    for (int cid : dirty) model.addHeight(cid, +3);
+    const TerrainMeshPatch patch = tessellator.retessellateCells(model, dirty, mesh);
+
+    QVERIFY(!patch.fullRebuild);
+    QVERIFY(!patch.vertexBytes.empty());
+    QVERIFY(patch.cellsRetessellated < model.cells().size() / 4);
+    QVERIFY(mesh.triOwner.size() >= initialTris);
+    compareLayouts(mesh, tessellator.build(model));
+
+    // Обратная правка укладывается в уже выделенные слоты
+    for (int cid : dirty) model.addHeight(cid, -3);
+    const TerrainMeshPatch back = tessellator.retessellateCells(model, dirty, mesh);
+    QVERIFY(!back.fullRebuild);
+    QVERIFY(!back.resized);
+    compareLayouts(mesh, tessellator.build(model));
+}
+
+void TerrainTessellatorIncrementalTest::biomeEditTouchesOnlyOneRing() {
+    HexSphereModel model = makeModel(3);
+    const TerrainTessellator tessellator = makeTessellator();
+    TerrainMesh mesh = tessellator.build(model);
+    const std::vector<uint32_t> idxBefore = mesh.idx;
+
+    const int cid = 11;
+    model.setBiome(cid, Biome::Desert);
+    const TerrainMeshPatch patch = tessellator.retessellateCells(model, { cid }, mesh);
+
+    QVERIFY(!patch.fullRebuild);
+    QVERIFY(!patch.resized);
+    QCOMPARE(patch.cellsRetessellated, model.cells()[size_t(cid)].neighbors.size() + 1);
+    // Высоты не менялись - число треугольников в слотах то же, индексы не трогаем
+    QVERIFY(patch.indexBytes.empty());
+    QCOMPARE(mesh.idx, idxBefore);
+
+    const size_t vertexBufferBytes = mesh.pos.size() * sizeof(float);
+    for (const TerrainMeshByteRange& r : patch.vertexBytes)
+        QVERIFY(r.offset + r.size <= vertexBufferBytes);
+    compareLayouts(mesh, tessellator.build(model));
+}
+
+void TerrainTessellatorIncrementalTest::foreignMeshFallsBackToFullBuild() {
+    HexSphereModel model = makeModel(2);
+    const TerrainTessellator tessellator = makeTessellator();
+    TerrainMesh mesh = tessellator.build(makeModel(1));
+
+    const TerrainMeshPatch patch = tessellator.retessellateCells(model, { 0 }, mesh);
+    QVERIFY(patch.fullRebuild);
+    QCOMPARE(mesh.idx, tessellator.build(model).idx);
+}
+
+QTEST_MAIN(TerrainTessellatorIncrementalTest)
+#include "terrain_tessellator_incremental.moc"
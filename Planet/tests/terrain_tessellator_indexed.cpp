@@ -0,0 +1,144 @@
+#include <QtTest/QtTest>
+
+#include "../generation/TerrainGenerator.h"
+#include "../model/HexSphereModel.h"
+#include "../renderers/TerrainTessellator.h"
+
+class TerrainTessellatorIndexedTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void indexedKeepsFlatTriangles();
+    void heightEditMatchesFullBuild();
+    void packedVertexRoundTrip();
+};
+
+namespace {
+
+HexSphereModel makeModel(int level) {
+    IcosphereBuilder builder;
+    HexSphereModel model;
+    model.rebuildFromIcosphere(builder.build(level));
+    createTerrainGeneratorByIndex(3)->generate(model, TerrainParams{ 12345u, 3, 3.0f });
+    return model;
+}
+
+TerrainTessellator makeTessellator(bool indexed) {
+    TerrainTessellator tessellator;
+    tessellator.smoothMaxDelta = 1;
+    tessellator.threadCount = 1;
+    tessellator.indexedOutput = indexed;
+    return tessellator;
+}
+
+QVector3D vertexAt(const std::vector<float>& v, uint32_t i) {
+    return QVector3D(v[size_t(i) * 3], v[size_t(i) * 3 + 1], v[size_t(i) * 3 + 2]);
+}
+
+// Живые треугольники слота: позиции по индексам и владельцы
+void compareSlot(const TerrainMesh& actual, const TerrainMeshRange& a,
+    const TerrainMesh& expected, const TerrainMeshRange& e)
+{
+    QCOMPARE(a.triCount, e.triCount);
+    QCOMPARE(a.vertexCount, e.vertexCount);
+    for (uint32_t t = 0; t < a.triCount; ++t) {
+        QCOMPARE(actual.triOwner[a.firstTri + t], expected.triOwner[e.firstTri + t]);
+        for (size_t k = 0; k < 3; ++k) {
+            const uint32_t va = actual.idx[size_t(a.firstTri + t) * 3 + k];
+            const uint32_t ve = expected.idx[size_t(e.firstTri + t) * 3 + k];
+            QCOMPARE(va - a.firstVertex, ve - e.firstVertex);
+            QCOMPARE(vertexAt(actual.pos, va), vertexAt(expected.pos, ve));
+            QCOMPARE(vertexAt(actual.norm, va), vertexAt(expected.norm, ve));
+        }
+    }
+}
+
+} // namespace
+
+void TerrainTessellatorIndexedTest::indexedKeepsFlatTriangles() {
+    const HexSphereModel model = makeModel(3);
+    const TerrainMesh flat = makeTessellator(false).build(model);
+    const TerrainMesh indexed = makeTessellator(true).build(model);
+
+    QVERIFY(indexed.indexed);
+    QCOMPARE(indexed.triOwner, flat.triOwner);
+    QCOMPARE(indexed.idx.size(), flat.idx.size());
+    // Тело клетки: 1 + 4*deg вершин вместо 15*deg
+    QVERIFY(indexed.pos.size() * 2 < flat.pos.size());
+    QCOMPARE(indexed.col.size(), indexed.pos.size());
+    QCOMPARE(indexed.norm.size(), indexed.pos.size());
+
+    // Те же треугольники в том же порядке и с той же ориентацией
+    for (size_t t = 0; t < flat.triOwner.size(); ++t) {
+        for (size_t k = 0; k < 3; ++k) {
+            QCOMPARE(vertexAt(indexed.pos, indexed.idx[t * 3 + k]), vertexAt(flat.pos, flat.idx[t * 3 + k]));
+        }
+    }
+
+    const Cell& cell = model.cells()[5];
+    const TerrainMeshRange& body = indexed.cellRanges[5];
+    QCOMPARE(body.vertexCount, uint32_t(1 + 4 * cell.poly.size()));
+    for (uint32_t v = body.firstVertex; v < body.firstVertex + body.vertexCount; ++v) {
+        QVERIFY(std::abs(vertexAt(indexed.norm, v).length() - 1.f) < 1e-4f);
+    }
+
+    // Швы остаются плоскими: своя вершина и нормаль грани на каждый угол
+    for (const TerrainMeshRange& seam : indexed.seamRanges) {
+        QCOMPARE(seam.vertexCount, seam.triCount * 3);
+        for (uint32_t t = 0; t < seam.triCount; ++t) {
+            const uint32_t v = indexed.idx[size_t(seam.firstTri + t) * 3];
+            QCOMPARE(vertexAt(indexed.norm, v), vertexAt(flat.norm, flat.idx[size_t(seam.firstTri + t) * 3]));
+        }
+    }
+}
+
+void TerrainTessellatorIndexedTest::heightEditMatchesFullBuild() {
+    HexSphereModel model = makeModel(3);
+    const TerrainTessellator tessellator = makeTessellator(true);
+    TerrainMesh mesh = tessellator.build(model);
+
+    // Плоская сетка не подходит индексированному тесселятору
+    TerrainMesh flat = makeTessellator(false).build(model);
+    QVERIFY(tessellator.retessellateCells(model, { 0 }, flat).fullRebuild);
+    QVERIFY(flat.indexed);
+
+    const std::vector<int> dirty{ 7, 8 };
+    for (int cid : dirty) model.addHeight(cid, +3);
+    const TerrainMeshPatch patch = tessellator.retessellateCells(model, dirty, mesh);
+    QVERIFY(!patch.fullRebuild);
+    QVERIFY(!patch.vertexBytes.empty());
+
+    const TerrainMesh rebuilt = tessellator.build(model);
+    QCOMPARE(mesh.cellRanges.size(), rebuilt.cellRanges.size());
+    for (size_t cid = 0; cid < rebuilt.cellRanges.size(); ++cid)
+        compareSlot(mesh, mesh.cellRanges[cid], rebuilt, rebuilt.cellRanges[cid]);
+    for (size_t s = 0; s < rebuilt.seamRanges.size(); ++s)
+        compareSlot(mesh, mesh.seamRanges[s], rebuilt, rebuilt.seamRanges[s]);
+
+    const size_t vertexBufferBytes = mesh.pos.size() * sizeof(float);
+    for (const TerrainMeshByteRange& r : patch.vertexBytes)
+        QVERIFY(r.offset + r.size <= vertexBufferBytes);
+}
+
+void TerrainTessellatorIndexedTest::packedVertexRoundTrip() {
+    const TerrainMesh mesh = makeTessellator(true).build(makeModel(2));
+    const std::vector<TerrainPackedVertex> packed = packTerrainVertices(mesh);
+    QCOMPARE(packed.size(), mesh.pos.size() / 3);
+
+    for (size_t v = 0; v < packed.size(); ++v) {
+        const QVector3D pos(packed[v].x, packed[v].y, packed[v].z);
+        QCOMPARE(pos, vertexAt(mesh.pos, uint32_t(v)));
+        // snorm10: шаг 1/511, unorm8: шаг 1/255 (цвет руды может выходить за 1 - насыщается)
+        QVERIFY((unpackTerrainNormal(packed[v].normal) - vertexAt(mesh.norm, uint32_t(v))).length() < 2e-3f);
+        const QVector3D color = vertexAt(mesh.col, uint32_t(v));
+        const QVector3D saturated(std::clamp(color.x(), 0.f, 1.f), std::clamp(color.y(), 0.f, 1.f), std::clamp(color.z(), 0.f, 1.f));
+        QVERIFY((unpackTerrainColor(packed[v].color) - saturated).length() < 4e-3f);
+        QCOMPARE(packed[v].color >> 24, 0xFFu);
+    }
+
+    QCOMPARE(unpackTerrainNormal(packTerrainNormal(QVector3D(-1.f, 0.f, 1.f))), QVector3D(-1.f, 0.f, 1.f));
+    QCOMPARE(unpackTerrainColor(packTerrainColor(QVector3D(2.f, -1.f, 1.f))), QVector3D(1.f, 0.f, 1.f));
+}
+
+QTEST_MAIN(TerrainTessellatorIndexedTest)
+#include "terrain_tessellator_indexed.moc"
@@ -0,0 +1,59 @@
+#include <QtTest/QtTest>
+
+#include "../generation/TerrainGenerator.h"
+#include "../model/HexSphereModel.h"
+#include "../renderers/TerrainTessellator.h"
+
+class TerrainTessellatorParallelTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void parallelBuildMatchesSerial();
+    void singleChunkMatchesSerial();
+};
+
+namespace {
+
+HexSphereModel makeModel(int level) {
+    IcosphereBuilder builder;
+    HexSphereModel model;
+    model.rebuildFromIcosphere(builder.build(level));
+    createTerrainGeneratorByIndex(3)->generate(model, TerrainParams{ 12345u, 3, 3.0f });
+    return model;
+}
+
+TerrainMesh buildMesh(const HexSphereModel& model, int threadCount, int cellsPerChunk) {
+    TerrainTessellator tessellator;
+    tessellator.smoothMaxDelta = 1;
+    tessellator.threadCount = threadCount;
+    tessellator.cellsPerChunk = cellsPerChunk;
+    return tessellator.build(model);
+}
+
+void compareMeshes(const TerrainMesh& actual, const TerrainMesh& expected) {
+    QCOMPARE(actual.pos, expected.pos);
+    QCOMPARE(actual.col, expected.col);
+    QCOMPARE(actual.norm, expected.norm);
+    QCOMPARE(actual.idx, expected.idx);
+    QCOMPARE(actual.triOwner, expected.triOwner);
+}
+
+} // namespace
+
+void TerrainTessellatorParallelTest::parallelBuildMatchesSerial() {
+    const HexSphereModel model = makeModel(3);
+    const TerrainMesh serial = buildMesh(model, 1, 1024);
+    QVERIFY(!serial.idx.empty());
+
+    // Маленькие чанки, чтобы рёбра между клетками разных чанков попали в шов
+    compareMeshes(buildMesh(model, 4, 17), serial);
+    compareMeshes(buildMesh(model, 3, 100), serial);
+}
+
+void TerrainTessellatorParallelTest::singleChunkMatchesSerial() {
+    const HexSphereModel model = makeModel(2);
+    compareMeshes(buildMesh(model, 4, 1 << 20), buildMesh(model, 1, 1024));
+}
+
+QTEST_MAIN(TerrainTessellatorParallelTest)
+#include "terrain_tessellator_parallel.moc"
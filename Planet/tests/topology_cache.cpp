@@ -0,0 +1,115 @@
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "../model/HexSphereModel.h"
+#include "../model/TopologyCache.h"
+
+class TopologyCacheTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void sameLevelSharesOneTopology();
+    void cachedModelMatchesFreshBuild();
+    void concurrentAcquireBuildsOnce();
+    void handBuiltCellsGetOwnTopology();
+};
+
+void TopologyCacheTest::sameLevelSharesOneTopology() {
+    TopologyCache::clear();
+    const auto a = TopologyCache::acquire(3);
+    const auto b = TopologyCache::acquire(3);
+    QCOMPARE(a.get(), b.get());
+    QCOMPARE(a->level, 3);
+    QVERIFY(TopologyCache::acquire(2).get() != a.get());
+    QCOMPARE(TopologyCache::cachedLevels(), size_t(2));
+
+    HexSphereModel first;
+    HexSphereModel second;
+    first.rebuildFromTopology(a);
+    second.rebuildFromTopology(TopologyCache::acquire(3));
+    QCOMPARE(first.sharedTopology().get(), second.sharedTopology().get());
+    QCOMPARE(&first.pickTris(), &second.pickTris());
+    QCOMPARE(first.subdivisions(), 3);
+
+    // Правка клеток одной модели не видна другой
+    first.setHeight(7, 5);
+    QCOMPARE(second.cells()[7].height, 0);
+
+    // clear() не отнимает топологию у моделей
+    TopologyCache::clear();
+    QCOMPARE(TopologyCache::cachedLevels(), size_t(0));
+    QCOMPARE(first.pickTris().size(), a->pickTris.size());
+    QVERIFY(TopologyCache::acquire(3).get() != a.get());
+}
+
+void TopologyCacheTest::cachedModelMatchesFreshBuild() {
+    IcosphereBuilder builder;
+    HexSphereModel fresh;
+    fresh.rebuildFromIcosphere(builder.build(4));
+    HexSphereModel cached;
+    cached.rebuildFromTopology(TopologyCache::acquire(4));
+
+    QCOMPARE(cached.cellCount(), fresh.cellCount());
+    QCOMPARE(cached.pentagonCount(), 12);
+    QCOMPARE(cached.pentagonCount(), fresh.pentagonCount());
+    QCOMPARE(cached.dualVerts().size(), fresh.dualVerts().size());
+    QCOMPARE(cached.wireEdges().size(), fresh.wireEdges().size());
+    QCOMPARE(cached.pickTris().size(), fresh.pickTris().size());
+    QVERIFY(cached.topology().offsets == fresh.topology().offsets);
+    QVERIFY(cached.topology().neighbors == fresh.topology().neighbors);
+    for (int i = 0; i < fresh.cellCount(); ++i) {
+        const Cell& a = cached.cells()[i];
+        const Cell& b = fresh.cells()[i];
+        QCOMPARE(a.id, b.id);
+        QVERIFY(std::ranges::equal(a.poly, b.poly));
+        QVERIFY(std::ranges::equal(a.neighbors, b.neighbors));
+        // Клетки ссылаются на общую топологию, а не на свои копии
+        QCOMPARE(a.poly.data(), cached.topology().poly(i).data());
+        QCOMPARE(a.centroid, b.centroid);
+        QCOMPARE(a.temperature, b.temperature);
+    }
+}
+
+void TopologyCacheTest::concurrentAcquireBuildsOnce() {
+    TopologyCache::clear();
+    std::vector<const SphereTopology*> seen(8, nullptr);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < seen.size(); ++t) {
+        threads.emplace_back([&seen, t]() {
+            seen[t] = TopologyCache::acquire(5).get();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const SphereTopology* topo : seen) {
+        QCOMPARE(topo, seen.front());
+    }
+    QCOMPARE(seen.front()->cells.size(), size_t(10 * 1024 + 2));
+    QCOMPARE(TopologyCache::cachedLevels(), size_t(1));
+}
+
+void TopologyCacheTest::handBuiltCellsGetOwnTopology() {
+    CellShape cell;
+    cell.poly = { 0, 1, 2 };
+    cell.centroid = QVector3D(0, 1, 0);
+
+    HexSphereModel model;
+    QCOMPARE(model.cellCount(), 0);
+    QVERIFY(model.pickTris().empty());
+    model.debug_setCellsAndDual({ cell }, { QVector3D(1, 0, 0), QVector3D(0, 0, 1), QVector3D(-1, 0, 0) });
+    QCOMPARE(model.cellCount(), 1);
+    QCOMPARE(model.subdivisions(), -1);
+    QCOMPARE(model.topology().degree(0), 3);
+    // Недостающие соседи дополняются -1
+    QCOMPARE(model.topology().neighborsOf(0)[2], -1);
+    QCOMPARE(model.cells()[0].neighbors.size(), size_t(3));
+    QCOMPARE(model.cells()[0].centroid, QVector3D(0, 1, 0));
+    QCOMPARE(model.dualVerts().size(), size_t(3));
+}
+
+QTEST_MAIN(TopologyCacheTest)
+#include "topology_cache.moc"
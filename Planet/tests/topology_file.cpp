@@ -0,0 +1,161 @@
+#include <QtTest/QtTest>
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <cstring>
+
+#include "../model/HexSphereModel.h"
+#include "../model/TopologyCache.h"
+#include "../model/TopologyFile.h"
+
+class TopologyFileTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void roundTripMatchesBuild();
+    void corruptionIsRejected();
+    void outOfRangeIndicesAreRejected();
+    void cacheWritesAndReloadsFile();
+};
+
+namespace {
+
+std::shared_ptr<const SphereTopology> buildLevel(int level) {
+    IcosphereBuilder builder;
+    return SphereTopology::fromIcosphere(builder.build(level), level);
+}
+
+bool sameVec(const QVector3D& a, const QVector3D& b) {
+    return std::memcmp(&a, &b, sizeof(QVector3D)) == 0;
+}
+
+void compareTopology(const SphereTopology& a, const SphereTopology& b) {
+    QCOMPARE(a.level, b.level);
+    QCOMPARE(a.pentagonCount, b.pentagonCount);
+    QCOMPARE(a.dualVerts.size(), b.dualVerts.size());
+    for (size_t i = 0; i < a.dualVerts.size(); ++i) {
+        QVERIFY(sameVec(a.dualVerts[i], b.dualVerts[i]));
+    }
+    QVERIFY(a.dualOwners == b.dualOwners);
+    QVERIFY(a.wireEdges == b.wireEdges);
+    QVERIFY(a.csr.offsets == b.csr.offsets);
+    QVERIFY(a.csr.polyVerts == b.csr.polyVerts);
+    QVERIFY(a.csr.neighbors == b.csr.neighbors);
+    QCOMPARE(a.pickTris.size(), b.pickTris.size());
+    for (size_t i = 0; i < a.pickTris.size(); ++i) {
+        QCOMPARE(a.pickTris[i].cellId, b.pickTris[i].cellId);
+        QVERIFY(sameVec(a.pickTris[i].v1, b.pickTris[i].v1));
+    }
+    QCOMPARE(a.cells.size(), b.cells.size());
+    for (size_t i = 0; i < a.cells.size(); ++i) {
+        QCOMPARE(a.cells[i].id, b.cells[i].id);
+        QCOMPARE(a.cells[i].isPentagon, b.cells[i].isPentagon);
+        QVERIFY(std::ranges::equal(a.cells[i].poly, b.cells[i].poly));
+        QVERIFY(std::ranges::equal(a.cells[i].neighbors, b.cells[i].neighbors));
+        QVERIFY(sameVec(a.cells[i].centroid, b.cells[i].centroid));
+        QCOMPARE(a.cells[i].temperature, b.cells[i].temperature);
+    }
+}
+
+} // namespace
+
+void TopologyFileTest::roundTripMatchesBuild() {
+    const auto built = buildLevel(3);
+    const std::string bytes = encodeTopologyFile(*built);
+    QCOMPARE(bytes.size() % 8, size_t(0));
+
+    const auto decoded = decodeTopologyFile(bytes);
+    QVERIFY(decoded);
+    compareTopology(*decoded, *built);
+
+    // Пустая топология тоже кодируется
+    QVERIFY(decodeTopologyFile(encodeTopologyFile(*SphereTopology::empty())));
+}
+
+void TopologyFileTest::corruptionIsRejected() {
+    const std::string bytes = encodeTopologyFile(*buildLevel(2));
+
+    std::string header = bytes;
+    header[12] ^= 0x01; // cellCount
+    QVERIFY(!decodeTopologyFile(header));
+
+    std::string payload = bytes;
+    payload[payload.size() / 2] ^= 0x40;
+    QVERIFY(!decodeTopologyFile(payload));
+
+    QVERIFY(!decodeTopologyFile(std::string_view(bytes).substr(0, bytes.size() - 8)));
+    QVERIFY(!decodeTopologyFile(std::string_view(bytes).substr(0, 32)));
+    QVERIFY(!decodeTopologyFile(bytes + std::string(8, '\0')));
+
+    std::string version = bytes;
+    version[4] = 2;
+    QVERIFY(!decodeTopologyFile(version));
+}
+
+void TopologyFileTest::outOfRangeIndicesAreRejected() {
+    // Одна треугольная клетка; контрольные суммы у файла верные, битые только индексы
+    auto makeTopology = []() {
+        auto topo = std::make_unique<SphereTopology>();
+        topo->dualVerts = { QVector3D(1, 0, 0), QVector3D(0, 0, 1), QVector3D(-1, 0, 0) };
+        topo->dualOwners = { { 0, -1, -1 }, { 0, -1, -1 }, { 0, -1, -1 } };
+        topo->wireEdges = { { 0, 1 }, { 1, 2 }, { 2, 0 } };
+        topo->pickTris = { PickTri{ 0, QVector3D(0, 1, 0), QVector3D(1, 0, 0), QVector3D(0, 0, 1) } };
+        topo->csr.offsets = { 0, 3 };
+        topo->csr.polyVerts = { 0, 1, 2 };
+        topo->csr.neighbors = { -1, -1, -1 };
+        topo->csr.centroids = { QVector3D(0, 1, 0) };
+        return topo;
+    };
+    QVERIFY(decodeTopologyFile(encodeTopologyFile(*makeTopology())));
+
+    auto wire = makeTopology();
+    wire->wireEdges[1].second = 3;
+    QVERIFY(!decodeTopologyFile(encodeTopologyFile(*wire)));
+
+    auto pick = makeTopology();
+    pick->pickTris[0].cellId = 1;
+    QVERIFY(!decodeTopologyFile(encodeTopologyFile(*pick)));
+    pick->pickTris[0].cellId = -1;
+    QVERIFY(!decodeTopologyFile(encodeTopologyFile(*pick)));
+
+    auto owners = makeTopology();
+    owners->dualOwners[2][1] = 1;
+    QVERIFY(!decodeTopologyFile(encodeTopologyFile(*owners)));
+}
+
+void TopologyFileTest::cacheWritesAndReloadsFile() {
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString path = dir.filePath(topologyFileName(3));
+
+    TopologyCache::clear();
+    TopologyCache::setDiskDirectory(dir.path());
+    const auto first = TopologyCache::acquire(3);
+    QVERIFY(QFile::exists(path));
+
+    // Второй «запуск»: память пуста, топология читается из файла
+    TopologyCache::clear();
+    const auto loaded = TopologyCache::acquire(3);
+    QVERIFY(loaded.get() != first.get());
+    compareTopology(*loaded, *first);
+
+    // Испорченный файл перестраивается и перезаписывается
+    {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadWrite));
+        file.seek(100);
+        file.write("garbage", 7);
+    }
+    QVERIFY(!loadTopologyFile(path));
+    TopologyCache::clear();
+    compareTopology(*TopologyCache::acquire(3), *first);
+    QVERIFY(loadTopologyFile(path));
+
+    TopologyCache::setDiskDirectory(QString());
+    TopologyCache::clear();
+}
+
+QTEST_MAIN(TopologyFileTest)
+#include "topology_file.moc"
@@ -0,0 +1,202 @@
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <set>
+
+#include "../generation/TerrainGenerator.h"
+#include "../model/HexSphereModel.h"
+#include "../model/SurfacePlacement.h"
+#include "../renderers/TreeInstances.h"
+
+class TreeInstancesTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void bakesRendererTransforms();
+    void culls100kTreesConservatively();
+    void budgetKeepsNearest();
+};
+
+namespace {
+
+constexpr float kHeightStep = 0.02f;
+constexpr size_t kTreeCount = 100000;
+
+HexSphereModel makeModel(int level) {
+    IcosphereBuilder builder;
+    HexSphereModel model;
+    model.rebuildFromIcosphere(builder.build(level));
+    createTerrainGeneratorByIndex(3)->generate(model, TerrainParams{ 12345u, 3, 3.0f });
+    return model;
+}
+
+std::vector<TreePlacement> randomPlacements(const HexSphereModel& model, size_t count, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> cellPick(0, static_cast<int>(model.cells().size()) - 1);
+    std::vector<TreePlacement> placements(count);
+    for (size_t i = 0; i < count; ++i) {
+        TreePlacement& p = placements[i];
+        p.cellId = cellPick(rng);
+        p.triangleIdx = static_cast<int>(unit(rng) * model.cells()[static_cast<size_t>(p.cellId)].poly.size()) %
+            static_cast<int>(model.cells()[static_cast<size_t>(p.cellId)].poly.size());
+        p.baryU = unit(rng) * 0.5f;
+        p.baryV = unit(rng) * 0.5f;
+        p.baryW = 1.0f - p.baryU - p.baryV;
+        p.scale = 0.8f + 0.4f * unit(rng);
+        p.rotation = unit(rng) * 6.2831853f;
+        p.treeType = i % 3 == 0 ? TreeType::Fir : TreeType::Oak;
+        p.foliageColor = QVector3D(unit(rng), unit(rng), unit(rng));
+    }
+    return placements;
+}
+
+QMatrix4x4 viewProjection(const QVector3D& eye, const QVector3D& target) {
+    QMatrix4x4 projection;
+    projection.perspective(50.0f, 16.0f / 9.0f, 0.01f, 100.0f);
+    QMatrix4x4 view;
+    view.lookAt(eye, target, QVector3D(0, 1, 0));
+    return projection * view;
+}
+
+QVector3D translationOf(const TreeInstance& instance) {
+    return QVector3D(instance.model[12], instance.model[13], instance.model[14]);
+}
+
+// Центр дерева точно виден: внутри объёма отсечения и луч от глаза не задевает заслоняющую сферу
+bool centerVisible(const QMatrix4x4& vp, const QVector3D& eye, const QVector3D& center, float occluder) {
+    const QVector4D clip = vp * QVector4D(center, 1.0f);
+    if (clip.w() <= 0.0f || std::abs(clip.x()) > clip.w() || std::abs(clip.y()) > clip.w() || std::abs(clip.z()) > clip.w())
+        return false;
+    const QVector3D d = center - eye;
+    const float t = std::clamp(-QVector3D::dotProduct(eye, d) / d.lengthSquared(), 0.0f, 1.0f);
+    return (eye + d * t).length() > occluder;
+}
+
+} // namespace
+
+void TreeInstancesTest::bakesRendererTransforms() {
+    const HexSphereModel model = makeModel(3);
+    std::vector<TreePlacement> placements = randomPlacements(model, 64, 7u);
+    placements[5].cellId = -1; // вне модели - computeSurfacePoint отдаёт точку на полюсе
+
+    TreeInstanceBuilder builder;
+    builder.setPlacements(model, placements, kHeightStep);
+    QCOMPARE(builder.placementCount(), placements.size());
+    QCOMPARE(computeSurfacePoint(model, placements[5], kHeightStep), QVector3D(0, 0, 1.0f));
+
+    // Камера далеко: видна вся обращённая к ней сторона
+    const QVector3D eye(0.0f, 0.0f, 40.0f);
+    const size_t count = builder.build(viewProjection(eye, QVector3D()), eye);
+    QVERIFY(count > 0);
+    QCOMPARE(count + builder.culledByFrustum() + builder.culledByHorizon(), placements.size());
+
+    // Каждый экземпляр - та же матрица и те же цвета, что рисовал покадровый цикл
+    size_t matched = 0;
+    for (const TreeType type : { TreeType::Oak, TreeType::Fir }) {
+        for (const TreeInstance& instance : builder.instances(type)) {
+            for (const TreePlacement& placement : placements) {
+                if (placement.treeType != type) continue;
+                const QMatrix4x4 expected = treeModelMatrix(model, placement, kHeightStep);
+                if (!std::equal(instance.model, instance.model + 16, expected.constData())) continue;
+                QCOMPARE(instance.foliageColor[1], placement.foliageColor.y());
+                QCOMPARE(instance.trunkColor[0], placement.trunkColor.x());
+                ++matched;
+                break;
+            }
+        }
+    }
+    QCOMPARE(matched, count);
+
+    // Дерево стоит по нормали: ось Y модели смотрит от центра планеты
+    const QMatrix4x4 m = treeModelMatrix(model, placements[0], kHeightStep);
+    const QVector3D up = m.column(1).toVector3D().normalized();
+    QVERIFY(QVector3D::dotProduct(up, m.column(3).toVector3D().normalized()) > 0.999f);
+}
+
+void TreeInstancesTest::culls100kTreesConservatively() {
+    const HexSphereModel model = makeModel(5);
+    const std::vector<TreePlacement> placements = randomPlacements(model, kTreeCount, 12345u);
+    TreeInstanceBuilder builder;
+    builder.setPlacements(model, placements, kHeightStep);
+
+    float occluder = 1.0f;
+    for (const Cell& cell : model.cells()) occluder = std::min(occluder, 1.0f + cell.height * kHeightStep);
+
+    const std::vector<std::pair<QVector3D, QVector3D>> views = {
+        { QVector3D(0.0f, 0.0f, 2.5f), QVector3D() },
+        { QVector3D(1.2f, 0.4f, 0.3f), QVector3D(0.6f, 0.9f, 0.0f) }, // низко над поверхностью
+        { QVector3D(-3.0f, 2.0f, 1.0f), QVector3D(0.3f, 0.0f, 0.0f) },
+    };
+    for (const auto& [eye, target] : views) {
+        const QMatrix4x4 vp = viewProjection(eye, target);
+        const size_t count = builder.build(vp, eye);
+        QCOMPARE(count + builder.culledByFrustum() + builder.culledByHorizon(), kTreeCount);
+        // Обратная сторона уходит за горизонт; вершины деревьев за краем диска ещё видны
+        QVERIFY(builder.culledByHorizon() > kTreeCount / 20);
+        QVERIFY(count * 10 < kTreeCount * 6);
+
+        // Ближние раньше дальних внутри каждого типа
+        std::multiset<std::array<float, 3>> emitted;
+        size_t total = 0;
+        for (const TreeType type : { TreeType::Oak, TreeType::Fir }) {
+            float previous = 0.0f;
+            for (const TreeInstance& instance : builder.instances(type)) {
+                const QVector3D t = translationOf(instance);
+                const float distance = (t - eye).lengthSquared();
+                QVERIFY(distance >= previous);
+                previous = distance;
+                emitted.insert({ t.x(), t.y(), t.z() });
+            }
+            total += builder.instances(type).size();
+        }
+        QCOMPARE(total, count);
+
+        // Отсечение консервативно: каждое дерево с точно видимым центром на месте
+        for (const TreePlacement& placement : placements) {
+            const QVector3D center = computeSurfacePoint(model, placement, kHeightStep);
+            if (!centerVisible(vp, eye, center, occluder)) continue;
+            const QVector3D t = treeModelMatrix(placement, center).column(3).toVector3D();
+            QVERIFY(emitted.count({ t.x(), t.y(), t.z() }) > 0);
+        }
+    }
+}
+
+void TreeInstancesTest::budgetKeepsNearest() {
+    const HexSphereModel model = makeModel(5);
+    const std::vector<TreePlacement> placements = randomPlacements(model, kTreeCount, 99u);
+    TreeInstanceBuilder builder;
+    builder.setPlacements(model, placements, kHeightStep);
+
+    const QVector3D eye(0.4f, 1.1f, 1.3f);
+    const QMatrix4x4 vp = viewProjection(eye, QVector3D());
+    const size_t uncapped = builder.build(vp, eye);
+    std::vector<float> distances;
+    for (const TreeType type : { TreeType::Oak, TreeType::Fir })
+        for (const TreeInstance& instance : builder.instances(type)) distances.push_back((translationOf(instance) - eye).lengthSquared());
+    std::sort(distances.begin(), distances.end());
+    QCOMPARE(distances.size(), uncapped);
+
+    const size_t budget = 5000;
+    QVERIFY(uncapped > budget);
+    QCOMPARE(builder.build(vp, eye, budget), budget);
+    size_t kept = 0;
+    for (const TreeType type : { TreeType::Oak, TreeType::Fir }) {
+        for (const TreeInstance& instance : builder.instances(type)) {
+            QVERIFY((translationOf(instance) - eye).lengthSquared() <= distances[budget - 1]);
+            ++kept;
+        }
+    }
+    QCOMPARE(kept, budget);
+
+    // Пустой набор после clear
+    builder.clear();
+    QCOMPARE(builder.build(vp, eye), size_t(0));
+    QVERIFY(builder.instances(TreeType::Oak).empty());
+}
+
+QTEST_MAIN(TreeInstancesTest)
+#include "tree_instances.moc"
@@ -0,0 +1,155 @@
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <cmath>
+
+#include "../culling/TriangleBVH.h"
+#include "../generation/TerrainGenerator.h"
+#include "../model/HexSphereModel.h"
+#include "../renderers/TerrainTessellator.h"
+
+class TriangleBVHTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void matchesBruteForceOnPickTris();
+    void refitFollowsMovedTerrain();
+    void emptyAndMismatchedInputs();
+};
+
+namespace {
+
+HexSphereModel makeModel(int level) {
+    IcosphereBuilder builder;
+    HexSphereModel model;
+    model.rebuildFromIcosphere(builder.build(level));
+    createTerrainGeneratorByIndex(3)->generate(model, TerrainParams{ 12345u, 3, 3.0f });
+    return model;
+}
+
+BVHRayHit bruteFirst(const std::vector<BVHTriangle>& tris, const QVector3D& o, const QVector3D& d) {
+    BVHRayHit best;
+    best.t = std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < tris.size(); ++i) {
+        float t;
+        if (TriangleBVH::rayTriangle(o, d, tris[i].v0, tris[i].v1, tris[i].v2, t) && t < best.t) {
+            best.t = t;
+            best.triangle = int(i);
+        }
+    }
+    return best;
+}
+
+// Точка r из n на спирали Фибоначчи по единичной сфере
+QVector3D fibonacciUnit(int r, int n) {
+    const float y = 1.0f - 2.0f * (float(r) + 0.5f) / float(n);
+    const float radius = std::sqrt(std::max(0.0f, 1.0f - y * y));
+    const float phi = 2.39996323f * float(r);
+    return QVector3D(radius * std::cos(phi), y, radius * std::sin(phi));
+}
+
+// Лучи с орбиты без std-распределений: их вывод зависит от стандартной библиотеки.
+// Каждый третий луч уходит от планеты и обязан промахнуться, остальные целят внутрь
+// сферы и в её край; stride (взаимно прост с числом лучей) перемешивает цели
+void compareOrbitRays(const TriangleBVH& bvh, const std::vector<BVHTriangle>& tris, int stride) {
+    constexpr int kRays = 300;
+    float radius = 0.0f;
+    for (const BVHTriangle& tri : tris) {
+        radius = std::max({ radius, tri.v0.length(), tri.v1.length(), tri.v2.length() });
+    }
+
+    int hits = 0;
+    int misses = 0;
+    for (int r = 0; r < kRays; ++r) {
+        // Начало луча втрое дальше самой дальней вершины
+        const QVector3D origin = fibonacciUnit(r, kRays) * (3.0f * radius);
+        const QVector3D target = fibonacciUnit((r * stride) % kRays, kRays);
+        const bool away = r % 3 == 0;
+        // От планеты: расстояние до центра вдоль луча только растёт
+        const QVector3D dir = away
+            ? (origin.normalized() * 2.0f + target).normalized()
+            : (target * (radius * (r % 3 == 1 ? 0.5f : 1.0f)) - origin).normalized();
+        const BVHRayHit expected = bruteFirst(tris, origin, dir);
+        const auto actual = bvh.intersectFirst(origin, dir);
+
+        QCOMPARE(actual.has_value(), expected.triangle >= 0);
+        QCOMPARE(bvh.intersectAny(origin, dir), expected.triangle >= 0);
+        if (away) {
+            QVERIFY(!actual);
+        }
+        if (!actual) {
+            ++misses;
+            continue;
+        }
+        ++hits;
+        QVERIFY(std::abs(actual->t - expected.t) <= 1e-5f * expected.t);
+        // Отсечение по tMax: до ближайшего попадания пусто
+        QVERIFY(!bvh.intersectAny(origin, dir, expected.t * 0.999f));
+    }
+    QVERIFY(hits > 0);
+    QVERIFY(misses > 0);
+}
+
+} // namespace
+
+void TriangleBVHTest::matchesBruteForceOnPickTris() {
+    const HexSphereModel model = makeModel(4);
+    const std::vector<BVHTriangle> tris = TriangleBVH::trianglesOf(model.pickTris());
+    TriangleBVH bvh;
+    bvh.build(tris);
+
+    QCOMPARE(bvh.triangleCount(), model.pickTris().size());
+    QVERIFY(bvh.nodeCount() > 1);
+    compareOrbitRays(bvh, tris, 7);
+}
+
+void TriangleBVHTest::refitFollowsMovedTerrain() {
+    HexSphereModel model = makeModel(3);
+    TerrainTessellator tessellator;
+    tessellator.smoothMaxDelta = 1;
+    TerrainMesh mesh = tessellator.build(model);
+
+    TriangleBVH bvh;
+    bvh.build(TriangleBVH::trianglesOf(mesh));
+    QCOMPARE(bvh.triangleCount(), mesh.triOwner.size());
+
+    // Биом не меняет число треугольников - слоты на месте, хватает refit
+    model.setBiome(5, Biome::Desert);
+    tessellator.retessellateCells(model, { 5 }, mesh);
+    const std::vector<BVHTriangle> same = TriangleBVH::trianglesOf(mesh);
+    QVERIFY(bvh.refit(same));
+    compareOrbitRays(bvh, same, 11);
+
+    // Сдвиг всех вершин наружу: refit обязан расширить рамки узлов
+    std::vector<BVHTriangle> scaled = same;
+    for (BVHTriangle& tri : scaled) {
+        tri.v0 *= 1.2f;
+        tri.v1 *= 1.2f;
+        tri.v2 *= 1.2f;
+    }
+    QVERIFY(bvh.refit(scaled));
+    compareOrbitRays(bvh, scaled, 13);
+}
+
+void TriangleBVHTest::emptyAndMismatchedInputs() {
+    TriangleBVH bvh;
+    QVERIFY(bvh.empty());
+    QVERIFY(!bvh.intersectFirst(QVector3D(0, 0, 3), QVector3D(0, 0, -1)));
+    QVERIFY(!bvh.refit({}));
+
+    const std::vector<BVHTriangle> one{ { QVector3D(-1, -1, 0), QVector3D(1, -1, 0), QVector3D(0, 1, 0) } };
+    bvh.build(one);
+    const auto hit = bvh.intersectFirst(QVector3D(0, 0, 3), QVector3D(0, 0, -1));
+    QVERIFY(hit.has_value());
+    QCOMPARE(hit->triangle, 0);
+    QVERIFY(std::abs(hit->t - 3.0f) < 1e-5f);
+    QVERIFY(!bvh.intersectFirst(QVector3D(0, 0, 3), QVector3D(0, 0, 1)));
+
+    QVERIFY(!bvh.refit({}));
+    QCOMPARE(bvh.triangleCount(), size_t(1));
+    bvh.clear();
+    QVERIFY(bvh.empty());
+}
+
+QTEST_MAIN(TriangleBVHTest)
+#include "triangle_bvh.moc"
@@ -0,0 +1,188 @@
+#include <QtTest/QtTest>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "../generation/MeshGenerators/WaterMeshGenerator.h"
+#include "../generation/TerrainGenerator.h"
+#include "../model/HexSphereModel.h"
+
+class WaterMeshTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void indexedMatchesLegacySurface();
+    void sharedVerticesAreWatertight();
+    void cameraLodPerRegion();
+    void fewerVerticesAndFasterBuild();
+};
+
+namespace {
+
+HexSphereModel makeModel(int level) {
+    IcosphereBuilder builder;
+    HexSphereModel model;
+    model.rebuildFromIcosphere(builder.build(level));
+    createTerrainGeneratorByIndex(3)->generate(model, TerrainParams{ 12345u, 3, 3.0f });
+    return model;
+}
+
+WaterMeshOptions modeOptions(WaterMeshOptions::Mode mode) {
+    WaterMeshOptions options;
+    options.mode = mode;
+    return options;
+}
+
+using Corner = std::array<float, 4>; // x, y, z, edgeFlag
+using Triangle = std::array<Corner, 3>;
+
+// Треугольники как тройки значений; поворот к наименьшей вершине сохраняет обход
+std::vector<Triangle> triangles(const WaterGeometryData& data) {
+    std::vector<Triangle> result;
+    for (size_t t = 0; t + 2 < data.indices.size(); t += 3) {
+        Triangle tri;
+        for (size_t k = 0; k < 3; ++k) {
+            const uint32_t i = data.indices[t + k];
+            tri[k] = { data.positions[size_t(i) * 3], data.positions[size_t(i) * 3 + 1], data.positions[size_t(i) * 3 + 2], data.edgeFlags[i] };
+        }
+        std::rotate(tri.begin(), std::min_element(tri.begin(), tri.end()), tri.end());
+        result.push_back(tri);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+size_t expectedTriangles(const HexSphereModel& model, const std::vector<int>& regionOfCell, const std::vector<int>& depths) {
+    size_t count = 0;
+    for (size_t c = 0; c < model.cells().size(); ++c) {
+        if (regionOfCell[c] < 0) continue;
+        count += model.cells()[c].poly.size() << (2 * depths[size_t(regionOfCell[c])]);
+    }
+    return count;
+}
+
+// Каждое ребро не более чем у двух треугольников, открытые рёбра - только по берегу
+void verifyWatertight(const WaterGeometryData& data) {
+    std::map<std::pair<uint32_t, uint32_t>, int> edges;
+    for (size_t t = 0; t + 2 < data.indices.size(); t += 3) {
+        for (size_t k = 0; k < 3; ++k) {
+            const uint32_t a = data.indices[t + k];
+            const uint32_t b = data.indices[t + (k + 1) % 3];
+            QVERIFY(a != b);
+            ++edges[{ std::min(a, b), std::max(a, b) }];
+        }
+    }
+    for (const auto& [edge, uses] : edges) {
+        QVERIFY(uses <= 2);
+        if (uses == 1) {
+            QCOMPARE(data.edgeFlags[edge.first], 1.0f);
+            QCOMPARE(data.edgeFlags[edge.second], 1.0f);
+        }
+    }
+
+    // Одна вершина на точку поверхности
+    std::set<std::array<float, 3>> unique;
+    for (size_t i = 0; i + 2 < data.positions.size(); i += 3)
+        unique.insert({ data.positions[i], data.positions[i + 1], data.positions[i + 2] });
+    QCOMPARE(unique.size(), data.edgeFlags.size());
+}
+
+} // namespace
+
+void WaterMeshTest::indexedMatchesLegacySurface() {
+    const HexSphereModel model = makeModel(3);
+    const WaterGeometryData legacy = WaterMeshGenerator::buildWaterGeometry(model, modeOptions(WaterMeshOptions::Mode::Legacy));
+    const WaterGeometryData indexed = WaterMeshGenerator::buildWaterGeometry(model, modeOptions(WaterMeshOptions::Mode::Indexed));
+    QVERIFY(!legacy.indices.empty());
+    QCOMPARE(indexed.indices.size(), legacy.indices.size());
+    QCOMPARE(indexed.positions.size(), indexed.edgeFlags.size() * 3);
+
+    // Та же поверхность побитно: те же треугольники с тем же обходом и флагами берега
+    QVERIFY(triangles(indexed) == triangles(legacy));
+
+    // Без разбивки - просто веер клетки
+    WaterMeshOptions flat = modeOptions(WaterMeshOptions::Mode::Indexed);
+    flat.subdivisions = 0;
+    WaterMeshOptions flatLegacy = flat;
+    flatLegacy.mode = WaterMeshOptions::Mode::Legacy;
+    QVERIFY(triangles(WaterMeshGenerator::buildWaterGeometry(model, flat)) ==
+        triangles(WaterMeshGenerator::buildWaterGeometry(model, flatLegacy)));
+}
+
+void WaterMeshTest::sharedVerticesAreWatertight() {
+    const HexSphereModel model = makeModel(4);
+    for (int subdivisions : { 1, 3 }) {
+        WaterMeshOptions options;
+        options.subdivisions = subdivisions;
+        verifyWatertight(WaterMeshGenerator::buildWaterGeometry(model, options));
+    }
+}
+
+void WaterMeshTest::cameraLodPerRegion() {
+    const HexSphereModel model = makeModel(4);
+    std::vector<int> regionOfCell;
+    const int regionCount = WaterMeshGenerator::waterRegions(model, regionOfCell);
+    QVERIFY(regionCount > 1);
+    for (size_t c = 0; c < model.cells().size(); ++c) {
+        const bool sea = model.cells()[c].biome == Biome::Sea;
+        QCOMPARE(regionOfCell[c] >= 0, sea);
+        // Соседние клетки воды - в одной области
+        if (!sea) continue;
+        for (int n : model.cells()[c].neighbors)
+            if (n >= 0 && regionOfCell[size_t(n)] >= 0) QCOMPARE(regionOfCell[size_t(n)], regionOfCell[c]);
+    }
+
+    WaterMeshOptions options;
+    options.subdivisions = 4;
+    options.minSubdivisions = 1;
+    options.cameraLod = true;
+    options.lodDistance = 0.3f;
+    // Камера над первой клеткой воды: её область - с полной глубиной
+    const auto firstSea = std::find(regionOfCell.begin(), regionOfCell.end(), 0) - regionOfCell.begin();
+    options.eye = model.cells()[size_t(firstSea)].centroid.normalized() * 1.2f;
+    const std::vector<int> depths = WaterMeshGenerator::regionSubdivisions(model, regionOfCell, regionCount, options);
+    QCOMPARE(depths.size(), size_t(regionCount));
+    QCOMPARE(depths[0], 4);
+    const int minDepth = *std::min_element(depths.begin(), depths.end());
+    QVERIFY(minDepth >= 1 && minDepth < 4);
+
+    const WaterGeometryData lod = WaterMeshGenerator::buildWaterGeometry(model, options);
+    QCOMPARE(lod.indices.size(), expectedTriangles(model, regionOfCell, depths) * 3);
+    verifyWatertight(lod);
+
+    options.cameraLod = false;
+    const WaterGeometryData uniform = WaterMeshGenerator::buildWaterGeometry(model, options);
+    QCOMPARE(uniform.indices.size(), expectedTriangles(model, regionOfCell, std::vector<int>(size_t(regionCount), 4)) * 3);
+    QVERIFY(lod.indices.size() < uniform.indices.size());
+}
+
+void WaterMeshTest::fewerVerticesAndFasterBuild() {
+    const HexSphereModel model = makeModel(5);
+    auto timed = [&](WaterMeshOptions::Mode mode, WaterGeometryData& out) {
+        double best = 1e30;
+        for (int run = 0; run < 3; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            out = WaterMeshGenerator::buildWaterGeometry(model, modeOptions(mode));
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    };
+    WaterGeometryData legacy;
+    WaterGeometryData indexed;
+    const double legacyMs = timed(WaterMeshOptions::Mode::Legacy, legacy);
+    const double indexedMs = timed(WaterMeshOptions::Mode::Indexed, indexed);
+
+    qInfo() << "water L5: legacy" << legacy.edgeFlags.size() << "vertices," << legacyMs << "ms; indexed"
+        << indexed.edgeFlags.size() << "vertices," << indexedMs << "ms";
+    QCOMPARE(indexed.indices.size(), legacy.indices.size());
+    // У треугольника 3 своих вершины против ~0.5 общей на треугольник
+    QVERIFY(indexed.edgeFlags.size() * 5 < legacy.edgeFlags.size());
+    QVERIFY(indexedMs < legacyMs);
+}
+
+QTEST_MAIN(WaterMeshTest)
+#include "water_mesh.moc"
@@ -18,18 +18,25 @@ Commit::ChangeRecord Commit::make_change(
     std::string field_name,
     v2::ChangeKind kind,
     v2::WriteLifetime lifetime,
-    Handle payload) {
+    Handle payload,
+    Handle fallback) {
     return ChangeRecord{
         field_slot,
         std::move(field_name),
         kind,
         lifetime,
         std::move(payload),
+        std::move(fallback),
     };
 }
 
-Commit::ChangeRecord Commit::make_change(Field field_name, v2::ChangeKind kind, v2::WriteLifetime lifetime, Handle payload) {
-    return make_change(invalid_field_slot(), std::move(field_name), kind, lifetime, std::move(payload));
+Commit::ChangeRecord Commit::make_change(
+    Field field_name,
+    v2::ChangeKind kind,
+    v2::WriteLifetime lifetime,
+    Handle payload,
+    Handle fallback) {
+    return make_change(invalid_field_slot(), std::move(field_name), kind, lifetime, std::move(payload), std::move(fallback));
 }
 
 Commit::ChangeRecord Commit::make_change(const ChangeView& change) {
@@ -38,7 +45,8 @@ Commit::ChangeRecord Commit::make_change(const ChangeView& change) {
         std::string(change.field_name()),
         change.kind(),
         change.lifetime(),
-        change.payload());
+        change.payload(),
+        change.fallback());
 }
 
 void Commit::upsert_change(ChangeRecord next) {
@@ -66,6 +74,20 @@ void Commit::set_handle(Field key, Handle payload, v2::WriteLifetime lifetime) {
     upsert_change(make_change(std::move(key), v2::ChangeKind::SetValue, lifetime, std::move(payload)));
 }
 
+void Commit::apply_diff(v2::FieldSlot key, Handle diff, Handle fallback, v2::WriteLifetime lifetime, std::string debug_name) {
+    upsert_change(make_change(
+        key,
+        std::move(debug_name),
+        v2::ChangeKind::ApplyDiff,
+        lifetime,
+        std::move(diff),
+        std::move(fallback)));
+}
+
+void Commit::apply_diff(Field key, Handle diff, Handle fallback, v2::WriteLifetime lifetime) {
+    upsert_change(make_change(std::move(key), v2::ChangeKind::ApplyDiff, lifetime, std::move(diff), std::move(fallback)));
+}
+
 void Commit::erase(v2::FieldSlot key, v2::WriteLifetime lifetime, std::string debug_name) {
     upsert_change(make_change(key, std::move(debug_name), v2::ChangeKind::Tombstone, lifetime));
 }
@@ -108,7 +130,14 @@ std::string_view Commit::debug_view(const Handle& handle) {
     if (!handle) {
         return {};
     }
-    return *handle;
+    return handle->bytes();
+}
+
+std::string Commit::debug_string(const Handle& handle) {
+    if (!handle) {
+        return {};
+    }
+    return handle->debug_string();
 }
 
 std::string Commit::field_debug_name(const ChangeView& change, const GraphSchema* schema) {
@@ -27,6 +27,8 @@ struct Commit final {
         [[nodiscard]] v2::ChangeKind kind() const noexcept { return kind_; }
         [[nodiscard]] v2::WriteLifetime lifetime() const noexcept { return lifetime_; }
         [[nodiscard]] const Handle& payload() const noexcept { return *payload_; }
+        // Full value used when an ApplyDiff change cannot be applied as a diff.
+        [[nodiscard]] const Handle& fallback() const noexcept { return *fallback_; }
 
     private:
         friend struct Commit;
@@ -36,8 +38,14 @@ struct Commit final {
             std::string_view field_name,
             v2::ChangeKind kind,
             v2::WriteLifetime lifetime,
-            const Handle* payload) noexcept
-            : field_slot_(field_slot), field_name_(field_name), kind_(kind), lifetime_(lifetime), payload_(payload) {}
+            const Handle* payload,
+            const Handle* fallback) noexcept
+            : field_slot_(field_slot),
+              field_name_(field_name),
+              kind_(kind),
+              lifetime_(lifetime),
+              payload_(payload),
+              fallback_(fallback) {}
 
         static constexpr v2::FieldSlot invalid_field_slot() noexcept {
             return std::numeric_limits<v2::FieldSlot>::max();
@@ -48,6 +56,7 @@ struct Commit final {
         v2::ChangeKind kind_{v2::ChangeKind::Tombstone};
         v2::WriteLifetime lifetime_{v2::WriteLifetime::Persistent};
         const Handle* payload_ = nullptr;
+        const Handle* fallback_ = nullptr;
     };
 
     bool its_time = false;
@@ -65,6 +74,7 @@ struct Commit final {
                 change.kind,
                 change.lifetime,
                 &change.payload,
+                &change.fallback,
             });
         }
     }
@@ -77,13 +87,37 @@ struct Commit final {
         std::string debug_name = {});
     void set(Field key, Str payload, v2::WriteLifetime lifetime = v2::WriteLifetime::Persistent);
     void set_handle(Field key, Handle payload, v2::WriteLifetime lifetime = v2::WriteLifetime::Persistent);
+
+    template <class T>
+    void set_scalar(
+        v2::FieldSlot key,
+        const T& value,
+        v2::WriteLifetime lifetime = v2::WriteLifetime::Persistent,
+        std::string debug_name = {}) {
+        set_handle(key, make_scalar(value), lifetime, std::move(debug_name));
+    }
+
+    // Delta write: the storage applies `diff` to the current value through the field's
+    // diff algebra (DefaultMemoryPolicy::register_apply_diff). Without an algebra or a
+    // current value `fallback` is stored as a full replacement; with neither the change
+    // is rejected. Like set(), a later change of the same field replaces this one.
+    void apply_diff(
+        v2::FieldSlot key,
+        Handle diff,
+        Handle fallback = {},
+        v2::WriteLifetime lifetime = v2::WriteLifetime::Persistent,
+        std::string debug_name = {});
+    void apply_diff(Field key, Handle diff, Handle fallback = {}, v2::WriteLifetime lifetime = v2::WriteLifetime::Persistent);
+
     void erase(v2::FieldSlot key, v2::WriteLifetime lifetime = v2::WriteLifetime::Persistent, std::string debug_name = {});
     void erase(Field key, v2::WriteLifetime lifetime = v2::WriteLifetime::Persistent);
 
     void merge_from(const Commit& other);
     [[nodiscard]] Commit resolved(const GraphSchema& schema) const;
 
+    // Byte view of a blob payload (empty for typed payloads); debug_string formats any kind.
     static std::string_view debug_view(const Handle& handle);
+    static std::string debug_string(const Handle& handle);
     static std::string field_debug_name(const ChangeView& change, const GraphSchema* schema = nullptr);
 
 private:
@@ -97,6 +131,7 @@ private:
         v2::ChangeKind kind{v2::ChangeKind::Tombstone};
         v2::WriteLifetime lifetime{v2::WriteLifetime::Persistent};
         Handle payload{};
+        Handle fallback{};
 
         [[nodiscard]] bool has_field_slot() const noexcept {
             return field != invalid_field_slot();
@@ -108,8 +143,14 @@ private:
         std::string field_name,
         v2::ChangeKind kind,
         v2::WriteLifetime lifetime,
-        Handle payload = {});
-    static ChangeRecord make_change(Field field_name, v2::ChangeKind kind, v2::WriteLifetime lifetime, Handle payload = {});
+        Handle payload = {},
+        Handle fallback = {});
+    static ChangeRecord make_change(
+        Field field_name,
+        v2::ChangeKind kind,
+        v2::WriteLifetime lifetime,
+        Handle payload = {},
+        Handle fallback = {});
     static ChangeRecord make_change(const ChangeView& change);
 
     void upsert_change(ChangeRecord next);
@@ -5,6 +5,8 @@
 #include "RuntimeOperationRegistry.h"
 #include "StateTypes.h"
 
+#include <cstddef>
+#include <iosfwd>
 #include <memory>
 #include <string>
 #include <unordered_set>
@@ -58,6 +60,22 @@ public:
     const PublishedStore& published_output_store() const noexcept;
     bool has_prepared_outputs() const noexcept;
 
+    // Enables Commit::apply_diff for every field of the algebra (see DefaultMemoryPolicy).
+    void register_apply_diff(v2::AlgebraId algebra, typename Policy::ApplyDiffFn apply_diff_fn);
+
+    // Serial by default. Wavefront requires thread-safe operation bindings.
+    void set_execution_options(const ExecutionOptions& options);
+    const ExecutionOptions& execution_options() const noexcept;
+    // Per-node timings of the last flush_prepare in plan order (collect_timings only).
+    const std::vector<NodeTiming>& last_node_timings() const noexcept;
+
+    // Opt-in span tracing of flushes (plan, guards, nodes, reads, commits) into a ring of
+    // `capacity` events; 0 turns it off. Export between flushes.
+    void set_tracing(std::size_t capacity);
+    const Tracer* tracer() const noexcept;
+    // Chrome trace / Perfetto JSON of the retained events; false when tracing is off.
+    bool write_chrome_trace(std::ostream& out) const;
+
     void dump_graph() const;
 
 private:
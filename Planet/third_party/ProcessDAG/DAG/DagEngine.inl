@@ -56,7 +56,7 @@ CommitT make_init_commit(const ValueStore& init_snapshot) {
     initial_inputs.reserve(init_snapshot.size());
     for (const auto& [field, value] : init_snapshot) {
         if (value) {
-            initial_inputs.set(field, *value);
+            initial_inputs.set_handle(field, value);
         }
     }
     return initial_inputs;
@@ -76,7 +76,7 @@ struct DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::Impl final {
         : operation_registry(std::move(operation_registry_in)),
           schema(std::move(schema_in)),
           roles(schema.storage_layout()),
-          storage(roles),
+          storage(schema),
           memory_policy(&schema),
           planner(schema),
           guard_registry(std::move(guard_registry_in)),
@@ -90,7 +90,7 @@ struct DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::Impl final {
     }
 
     void reset_runtime() {
-        storage = RuntimeStorage(roles);
+        storage = RuntimeStorage(schema);
         prepared_pending_ack = false;
     }
 
@@ -109,6 +109,10 @@ struct DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::Impl final {
     Planner planner;
     GuardRegistry guard_registry;
     Executor executor;
+    ExecutionOptions execution_options;
+    std::unique_ptr<WorkerPool> worker_pool;
+    std::vector<NodeTiming> node_timings;
+    std::unique_ptr<Tracer> tracer;
     FlushFailurePolicy failure_policy = FlushFailurePolicy::InvalidateAllInputs;
     bool initialized = false;
     bool prepared_pending_ack = false;
@@ -167,24 +171,51 @@ bool DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::flush_prepare(const
         return false;
     }
 
+    Tracer* tracer = impl_->tracer.get();
+    const auto flush_started = tracer ? tracer->now_ns() : 0;
+    if (tracer) tracer->begin_flush();
     const auto plan = impl_->planner.build_plan(dirty_inputs, outputs);
+    if (tracer) tracer->record(TraceEventKind::PlanBuild, flush_started);
+    impl_->node_timings.clear();
 
     try {
         impl_->storage.begin_run();
         try {
-            impl_->executor.run(
-                plan,
-                impl_->schema,
-                impl_->storage,
-                impl_->memory_policy,
-                impl_->operation_registry,
-                impl_->guard_registry,
-                nullptr,
-                nullptr,
-                nullptr,
-                nullptr,
-                nullptr,
-                nullptr);
+            auto* timings = impl_->execution_options.collect_timings ? &impl_->node_timings : nullptr;
+            if (impl_->worker_pool) {
+                impl_->executor.run_wavefront(
+                    plan,
+                    impl_->schema,
+                    impl_->storage,
+                    impl_->memory_policy,
+                    impl_->operation_registry,
+                    impl_->guard_registry,
+                    *impl_->worker_pool,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                    timings,
+                    tracer);
+            } else {
+                impl_->executor.run(
+                    plan,
+                    impl_->schema,
+                    impl_->storage,
+                    impl_->memory_policy,
+                    impl_->operation_registry,
+                    impl_->guard_registry,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                    timings,
+                    tracer);
+            }
             impl_->storage.end_run_success();
         } catch (...) {
             if (impl_->storage.is_dag_open()) {
@@ -199,9 +230,11 @@ bool DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::flush_prepare(const
         if (impl_->failure_policy == FlushFailurePolicy::InvalidateAllInputs) {
             impl_->storage.invalidate_all_inputs_for_retry();
         }
+        if (tracer) tracer->record(TraceEventKind::Flush, flush_started, TraceEvent::kNoSlot, TraceEvent::kNoSlot, 0, true);
         throw;
     }
 
+    if (tracer) tracer->record(TraceEventKind::Flush, flush_started);
     return true;
 }
 
@@ -255,6 +288,58 @@ bool DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::has_prepared_outputs
     return impl_->prepared_pending_ack;
 }
 
+template <class Policy, template <class> class BaseStoreT, template <class> class OverlayStoreT, class CommitT>
+void DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::register_apply_diff(
+    v2::AlgebraId algebra,
+    typename Policy::ApplyDiffFn apply_diff_fn) {
+    impl_->memory_policy.register_apply_diff(algebra, std::move(apply_diff_fn));
+}
+
+template <class Policy, template <class> class BaseStoreT, template <class> class OverlayStoreT, class CommitT>
+void DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::set_execution_options(const ExecutionOptions& options) {
+    impl_->worker_pool.reset();
+    if (options.mode == ExecutionMode::Wavefront) {
+        // No level can be wider than the schema, so never spawn more workers than nodes.
+        impl_->worker_pool = std::make_unique<WorkerPool>(
+            WorkerPool::resolve_size(options.worker_count, impl_->schema.node_count()));
+    }
+    impl_->execution_options = options;
+    impl_->node_timings.clear();
+}
+
+template <class Policy, template <class> class BaseStoreT, template <class> class OverlayStoreT, class CommitT>
+const ExecutionOptions& DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::execution_options() const noexcept {
+    return impl_->execution_options;
+}
+
+template <class Policy, template <class> class BaseStoreT, template <class> class OverlayStoreT, class CommitT>
+const std::vector<NodeTiming>& DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::last_node_timings() const noexcept {
+    return impl_->node_timings;
+}
+
+template <class Policy, template <class> class BaseStoreT, template <class> class OverlayStoreT, class CommitT>
+void DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::set_tracing(std::size_t capacity) {
+    if (capacity == 0) {
+        impl_->tracer.reset();
+        return;
+    }
+    impl_->tracer = std::make_unique<Tracer>(capacity);
+}
+
+template <class Policy, template <class> class BaseStoreT, template <class> class OverlayStoreT, class CommitT>
+const Tracer* DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::tracer() const noexcept {
+    return impl_->tracer.get();
+}
+
+template <class Policy, template <class> class BaseStoreT, template <class> class OverlayStoreT, class CommitT>
+bool DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::write_chrome_trace(std::ostream& out) const {
+    if (!impl_->tracer) {
+        return false;
+    }
+    impl_->tracer->write_chrome_trace(out, impl_->schema);
+    return static_cast<bool>(out);
+}
+
 template <class Policy, template <class> class BaseStoreT, template <class> class OverlayStoreT, class CommitT>
 void DagEngine<Policy, BaseStoreT, OverlayStoreT, CommitT>::dump_graph() const {
     std::cout << "DagEngine nodes:\n";
@@ -4,6 +4,8 @@
 #include "PortStates.h"
 #include "../core/GraphSchema.h"
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 #include <utility>
@@ -23,6 +25,9 @@ enum class WorkRollbackMode {
 // - St_O: prepared output frame in V and published output frame in G.
 // internal_ephemeral is never a separate store: it lives in S and is sweep-cleaned from
 // persisted S layers on begin/end so it never survives a run boundary.
+// St_I and St_S are dense arrays indexed by the compiled v2::FieldSlot: node reads and
+// commit application never hash a field name. St_O keeps the name-keyed BaseStoreT /
+// OverlayStoreT frames, which are the boundary callers read by field name.
 template <
     WorkRollbackMode Mode,
     class Policy = DefaultMemoryPolicy,
@@ -34,23 +39,35 @@ struct DagStorage final {
 
     using Handle = typename Policy::Handle;
     using Roles = GraphSchema::StorageLayout;
-    using InputPort = InputPortState<Policy, BaseStoreT, OverlayStoreT>;
-    using WorkPort = WorkPortState<work_level, Policy, BaseStoreT, OverlayStoreT>;
+    using InputPort = InputPortState<Policy, DenseBaseStore, DenseOverlayStore>;
+    using WorkPort = WorkPortState<work_level, Policy, DenseBaseStore, DenseOverlayStore>;
     using OutputPort = OutputPortState<Policy, BaseStoreT, OverlayStoreT>;
     using PreparedStore = typename OutputPort::Base;
     using PublishedStore = typename OutputPort::Base;
     using InputStore = typename InputPort::Base;
+    using WorkStore = typename WorkPort::Base;
 
+    const GraphSchema* schema = nullptr;
     Roles roles;
     InputPort St_I;
     WorkPort St_S;
     OutputPort St_O;
     bool dag_open = false;
+    std::vector<std::uint8_t> internal_ephemeral_slots;
+    bool has_internal_ephemeral = false;
 
     DagStorage() = default;
 
-    explicit DagStorage(Roles roles_in) : roles(std::move(roles_in)) {
+    // The schema must outlive the storage: slots are resolved against it.
+    explicit DagStorage(const GraphSchema& schema_in) : schema(&schema_in), roles(schema_in.storage_layout()) {
         roles.validate_disjoint_or_throw();
+        reserve_slots(schema_in.field_count());
+        internal_ephemeral_slots.assign(schema_in.field_count(), 0);
+        for (std::size_t i = 0; i < schema_in.field_count(); ++i) {
+            const bool ephemeral = roles.is_internal_ephemeral(schema_in.field_key(static_cast<v2::FieldSlot>(i)));
+            internal_ephemeral_slots[i] = ephemeral ? 1 : 0;
+            has_internal_ephemeral = has_internal_ephemeral || ephemeral;
+        }
     }
 
     [[nodiscard]] bool is_dag_open() const noexcept { return dag_open; }
@@ -63,15 +80,19 @@ struct DagStorage final {
         assert(dag_open && "DagStorage::end_run_* requires begin_run() to open the current DAG run");
     }
 
-    [[nodiscard]] Handle read_node_handle(v2::FieldSlot field_slot, const GraphSchema& schema) const {
-        return read_visible_handle(schema.field_key(field_slot));
+    [[nodiscard]] Handle read_node_handle(v2::FieldSlot field_slot, const GraphSchema&) const {
+        return read_visible_handle(field_slot);
     }
 
-    [[nodiscard]] Handle read_visible_handle(const Field& field) const {
-        if (roles.is_input(field)) {
-            return St_I.get(field);
+    [[nodiscard]] Handle read_visible_handle(v2::FieldSlot field_slot) const {
+        if (roles.is_input_slot(field_slot)) {
+            return St_I.get(field_slot);
         }
-        return St_S.get(field);
+        return St_S.get(field_slot);
+    }
+
+    [[nodiscard]] Handle read_visible_handle(const Field& field) const {
+        return read_visible_handle(slot_of(field, "DagStorage::read_visible_handle"));
     }
 
     [[nodiscard]] Handle read_prepared_output_handle(const Field& field) const {
@@ -94,32 +115,32 @@ struct DagStorage final {
     [[nodiscard]] const PublishedStore& published_outputs() const noexcept { return St_O.G(); }
 
     template <class AnyCommit>
-    void push_input(const AnyCommit& commit, const Policy& memory_policy, const GraphSchema* schema = nullptr) {
+    void push_input(const AnyCommit& commit, const Policy& memory_policy, const GraphSchema* bound_schema = nullptr) {
         require_closed_run("DagStorage::push_input");
         apply_commit_changes(
             commit,
             memory_policy,
-            schema,
+            bound_schema,
             "DagStorage::push_input",
-            [this](const Field& field, const char* where) { validate_input_field(field, where); },
-            [this](const Field& field) { return St_I.get(field); },
-            [this](const Field& field, Handle value) { St_I.set_D(field, std::move(value)); },
-            [this](const Field& field) { St_I.erase_D(field); },
+            [this](v2::FieldSlot field, const char* where) { validate_input_field(field, where); },
+            [this](v2::FieldSlot field) { return St_I.get(field); },
+            [this](v2::FieldSlot field, Handle value) { St_I.set_D(field, std::move(value)); },
+            [this](v2::FieldSlot field) { St_I.erase_D(field); },
             false);
     }
 
     template <class AnyCommit>
-    void apply_node_commit(const AnyCommit& commit, const Policy& memory_policy, const GraphSchema* schema = nullptr) {
+    void apply_node_commit(const AnyCommit& commit, const Policy& memory_policy, const GraphSchema* bound_schema = nullptr) {
         require_open_run("DagStorage::apply_node_commit");
         apply_commit_changes(
             commit,
             memory_policy,
-            schema,
+            bound_schema,
             "DagStorage::apply_node_commit",
-            [this](const Field& field, const char* where) { validate_non_input_field(field, where); },
-            [this](const Field& field) { return St_S.get(field); },
-            [this](const Field& field, Handle value) { St_S.set_D(field, std::move(value)); },
-            [this](const Field& field) { St_S.erase_D(field); },
+            [this](v2::FieldSlot field, const char* where) { validate_non_input_field(field, where); },
+            [this](v2::FieldSlot field) { return St_S.get(field); },
+            [this](v2::FieldSlot field, Handle value) { St_S.set_D(field, std::move(value)); },
+            [this](v2::FieldSlot field) { St_S.erase_D(field); },
             true);
     }
 
@@ -155,21 +176,22 @@ struct DagStorage final {
 
     [[nodiscard]] FieldSet pending_input_fields() const {
         FieldSet pending;
-        for (const auto& [field, _] : St_I.D().kv) {
-            pending.insert(field);
-        }
+        St_I.D().for_each([&](v2::FieldSlot field, const Handle&) {
+            pending.insert(Field(schema->field_name(field)));
+        });
         return pending;
     }
 
     void invalidate_all_inputs_for_retry() {
         require_closed_run("DagStorage::invalidate_all_inputs_for_retry");
         St_I.clear_D();
-        for (const auto& field : roles.inputs) {
-            const auto frozen = St_I.G().kv.find(field);
-            if (frozen == St_I.G().kv.end()) {
-                St_I.erase_D(field);
+        for (std::size_t i = 0; i < roles.slot_roles.size(); ++i) {
+            const auto field = static_cast<v2::FieldSlot>(i);
+            if (!roles.is_input_slot(field)) continue;
+            if (const auto* frozen = St_I.G().lookup(field)) {
+                St_I.set_D(field, Policy::duplicate(*frozen));
             } else {
-                St_I.set_D(field, Policy::duplicate(frozen->second));
+                St_I.erase_D(field);
             }
         }
     }
@@ -182,7 +204,8 @@ struct DagStorage final {
                 throw std::runtime_error("DagStorage::prepare_outputs requested non-output field '" + field + "'");
             }
 
-            Handle handle = prefer_committed_V ? committed_work_handle(field) : St_S.get(field);
+            const auto slot = slot_of(field, "DagStorage::prepare_outputs");
+            Handle handle = prefer_committed_V ? committed_work_handle(slot) : St_S.get(slot);
             if (Policy::is_tombstone(handle)) {
                 continue;
             }
@@ -230,73 +253,80 @@ private:
         }
     }
 
-    void validate_input_field(const Field& field, const char* where) const {
-        if (roles.is_input(field)) return;
-        throw std::runtime_error(std::string(where) + " attempted to mutate non-input field '" + field + "'");
+    void reserve_slots(std::size_t slot_count) {
+        St_I.D_mut().reserve_slots(slot_count);
+        St_I.V_mut().reserve_slots(slot_count);
+        St_I.G_mut().reserve_slots(slot_count);
+        St_S.D_mut().reserve_slots(slot_count);
+        St_S.V_mut().reserve_slots(slot_count);
+        if constexpr (Mode == WorkRollbackMode::Global) {
+            St_S.G_mut().reserve_slots(slot_count);
+        }
     }
 
-    void validate_non_input_field(const Field& field, const char* where) const {
-        if (!roles.is_input(field)) return;
-        throw std::runtime_error(std::string(where) + " attempted to mutate input field '" + field + "'");
+    v2::FieldSlot slot_of(const Field& field, const char* where) const {
+        if (!schema) {
+            throw std::runtime_error(std::string(where) + " requires bound schema to resolve field '" + field + "'");
+        }
+        const auto slot = schema->find_field(field);
+        if (!slot) {
+            throw std::runtime_error(std::string(where) + " references unknown field '" + field + "'");
+        }
+        return *slot;
+    }
+
+    void validate_input_field(v2::FieldSlot field, const char* where) const {
+        if (roles.is_input_slot(field)) return;
+        throw std::runtime_error(
+            std::string(where) + " attempted to mutate non-input field '" + std::string(schema->field_name(field)) + "'");
+    }
+
+    void validate_non_input_field(v2::FieldSlot field, const char* where) const {
+        if (!roles.is_input_slot(field)) return;
+        throw std::runtime_error(
+            std::string(where) + " attempted to mutate input field '" + std::string(schema->field_name(field)) + "'");
     }
 
     static void validate_supported_change(const typename CommitT::ChangeView&, const char*) {
     }
 
-    static Field resolve_field_name(const typename CommitT::ChangeView& change, const GraphSchema* schema) {
+    v2::FieldSlot resolve_field_slot(const typename CommitT::ChangeView& change, const char* where) const {
         if (change.has_field_slot()) {
-            if (!schema) {
+            if (!schema || static_cast<std::size_t>(change.field_slot()) >= schema->field_count()) {
                 throw std::runtime_error(
-                    "DagStorage requires bound schema to apply slot-addressed commit field '" +
-                    Commit::field_debug_name(change) + "'");
+                    std::string(where) + " cannot apply slot-addressed commit field '" + Commit::field_debug_name(change) + "'");
             }
-            return schema->field_key(change.field_slot());
-        }
-        return Field(change.field_name());
-    }
-
-    static v2::FieldSlot resolve_field_slot(
-        const typename CommitT::ChangeView& change,
-        const Field& field,
-        const GraphSchema* schema,
-        const char* where) {
-        if (change.has_field_slot()) {
             return change.field_slot();
         }
-        if (!schema) {
-            throw std::runtime_error(std::string(where) + " requires bound schema to resolve field slot for '" + field + "'");
-        }
-        const auto slot = schema->find_field(field);
-        if (!slot) {
-            throw std::runtime_error(std::string(where) + " references unknown field '" + field + "'");
-        }
-        return *slot;
+        return slot_of(Field(change.field_name()), where);
     }
 
     static Handle materialize_payload(
         const typename CommitT::ChangeView& change,
-        const Field& field,
+        v2::FieldSlot field,
         const Handle& current,
-        const Policy& memory_policy,
-        const GraphSchema* schema,
-        const char* where) {
+        const Policy& memory_policy) {
         if (change.kind() == v2::ChangeKind::ApplyDiff) {
-            const auto field_slot = resolve_field_slot(change, field, schema, where);
-            return memory_policy.apply_diff(field_slot, current, change.payload());
+            if (!Policy::is_tombstone(current) && memory_policy.has_apply_diff(field)) {
+                return memory_policy.apply_diff(field, current, change.payload());
+            }
+            // No diff algebra or nothing to patch: the change degrades to a full replacement.
+            if (Policy::is_tombstone(change.fallback())) {
+                throw std::runtime_error(
+                    "DagStorage cannot apply diff to field '" + Commit::field_debug_name(change) +
+                    "': no diff algebra or base value and no fallback");
+            }
+            return Policy::duplicate(change.fallback());
         }
         return Policy::duplicate(change.payload());
     }
 
     static bool should_skip_set(
         const Policy& memory_policy,
-        const typename CommitT::ChangeView& change,
-        const Field& field,
+        v2::FieldSlot field,
         const Handle& current,
         const Handle& next_value) {
         if (Policy::is_tombstone(current)) return false;
-        if (change.has_field_slot()) {
-            return memory_policy.equal(change.field_slot(), current, next_value);
-        }
         return memory_policy.equal(field, current, next_value);
     }
 
@@ -304,22 +334,25 @@ private:
     void apply_commit_changes(
         const AnyCommit& commit,
         const Policy& memory_policy,
-        const GraphSchema* schema,
+        const GraphSchema* schema_in,
         const char* where,
         ValidateFieldFn&& validate_field,
         CurrentHandleFn&& current_handle_for,
         SetFn&& write_set,
         EraseFn&& write_erase,
         bool allow_skip_equal) {
+        if (schema_in && schema_in != schema) {
+            throw std::runtime_error(std::string(where) + " received a commit for a different schema");
+        }
         commit.for_each_change([&](const auto& change) {
-            const auto field = resolve_field_name(change, schema);
+            const auto field = resolve_field_slot(change, where);
             validate_field(field, where);
             validate_supported_change(change, where);
 
             const auto current = current_handle_for(field);
-            auto next_value = materialize_payload(change, field, current, memory_policy, schema, where);
+            auto next_value = materialize_payload(change, field, current, memory_policy);
             const bool is_tombstone = change.kind() == v2::ChangeKind::Tombstone || Policy::is_tombstone(next_value);
-            if (!is_tombstone && allow_skip_equal && should_skip_set(memory_policy, change, field, current, next_value)) {
+            if (!is_tombstone && allow_skip_equal && should_skip_set(memory_policy, field, current, next_value)) {
                 return;
             }
 
@@ -332,48 +365,36 @@ private:
     }
 
     template <class Layer>
-    static void append_keys(FieldSet& keys, const Layer& layer) {
-        for (const auto& [field, _] : layer.kv) {
-            keys.insert(field);
-        }
-    }
-
-    template <class Layer>
-    static ValueStore collect_visible_values(const Layer& layer) {
-        FieldSet keys;
-        append_keys(keys, layer.D());
-        if constexpr (Layer::level >= 2) append_keys(keys, layer.V());
-        if constexpr (Layer::level >= 3) append_keys(keys, layer.G());
+    ValueStore collect_visible_values(const Layer& layer) const {
+        std::vector<std::uint8_t> seen(schema ? schema->field_count() : 0, 0);
+        const auto mark = [&seen](v2::FieldSlot field, const Handle&) {
+            seen[static_cast<std::size_t>(field)] = 1;
+        };
+        layer.D().for_each(mark);
+        if constexpr (Layer::level >= 2) layer.V().for_each(mark);
+        if constexpr (Layer::level >= 3) layer.G().for_each(mark);
 
         ValueStore out;
-        for (const auto& field : keys) {
+        for (std::size_t i = 0; i < seen.size(); ++i) {
+            if (!seen[i]) continue;
+            const auto field = static_cast<v2::FieldSlot>(i);
             const auto handle = layer.get(field);
             if (!Policy::is_tombstone(handle)) {
-                out[field] = handle;
-            }
-        }
-        return out;
-    }
-
-    static ValueStore collect_visible_values(const BaseStoreT<Policy>& layer) {
-        ValueStore out;
-        for (const auto& [field, handle] : layer.kv) {
-            if (!Policy::is_tombstone(handle)) {
-                out[field] = handle;
+                out[schema->field_key(field)] = handle;
             }
         }
         return out;
     }
 
-    template <class SourceStore>
-    static void apply_overlay_to_store(BaseStoreT<Policy>& destination, const SourceStore& overlay) {
-        for (const auto& [field, handle] : overlay.kv) {
+    template <class Destination, class SourceStore>
+    static void apply_overlay_to_store(Destination& destination, const SourceStore& overlay) {
+        overlay.for_each([&destination](const auto& field, const Handle& handle) {
             if (Policy::is_tombstone(handle)) {
-                destination.kv.erase(field);
+                destination.remove(field);
             } else {
-                destination.kv.insert_or_assign(field, Policy::duplicate(handle));
+                destination.assign(field, Policy::duplicate(handle));
             }
-        }
+        });
     }
 
     void freeze_inputs() {
@@ -383,37 +404,35 @@ private:
     }
 
     void capture_visible_work_to_good() {
-        BaseStoreT<Policy> snapshot;
-        snapshot.kv = St_S.G().kv;
+        WorkStore snapshot = St_S.G();
         apply_overlay_to_store(snapshot, St_S.V());
         apply_overlay_to_store(snapshot, St_S.D());
         St_S.G_mut() = std::move(snapshot);
     }
 
     void rollback_global_work() {
-        St_S.V_mut().kv = St_S.G().kv;
+        St_S.V_mut() = St_S.G();
         St_S.clear_D();
     }
 
-    [[nodiscard]] Handle committed_work_handle(const Field& field) const {
-        if (const auto it = St_S.V().kv.find(field); it != St_S.V().kv.end()) {
-            return it->second;
+    [[nodiscard]] Handle committed_work_handle(v2::FieldSlot field) const {
+        if (const auto* committed = St_S.V().lookup(field)) {
+            return *committed;
         }
         return Policy::tombstone();
     }
 
     template <class Layer>
     void erase_internal_from_layer(Layer& layer) {
-        for (auto it = layer.kv.begin(); it != layer.kv.end();) {
-            if (roles.is_internal_ephemeral(it->first)) {
-                it = layer.kv.erase(it);
-            } else {
-                ++it;
+        for (std::size_t i = 0; i < internal_ephemeral_slots.size(); ++i) {
+            if (internal_ephemeral_slots[i]) {
+                layer.remove(static_cast<v2::FieldSlot>(i));
             }
         }
     }
 
     void cleanup_internal_ephemeral() {
+        if (!has_internal_ephemeral) return;
         erase_internal_from_layer(St_S.D_mut());
         erase_internal_from_layer(St_S.V_mut());
         if constexpr (Mode == WorkRollbackMode::Global) {
@@ -2,8 +2,16 @@
 
 #include "DagStorage.h"
 #include "RuntimeOperationRegistry.h"
+#include "Tracer.h"
+#include "WorkerPool.h"
 #include "../core/GraphSchema.h"
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
 #include <functional>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -69,6 +77,29 @@ inline GuardRegistry make_builtin_guard_registry() {
     return registry;
 }
 
+enum class ExecutionMode {
+    // plan.topo one node at a time, on the calling thread.
+    Serial,
+    // plan.topo grouped into dependency levels; the nodes of a level run on a WorkerPool,
+    // their commits are applied after the level in plan order.
+    Wavefront,
+};
+
+struct ExecutionOptions final {
+    ExecutionMode mode = ExecutionMode::Serial;
+    // Wavefront pool size including the calling thread; 0 = hardware_concurrency.
+    std::size_t worker_count = 0;
+    bool collect_timings = false;
+};
+
+struct NodeTiming final {
+    v2::NodeSlot node{};
+    std::uint32_t level = 0;
+    bool skipped_guard = false;
+    std::chrono::nanoseconds execute{0}; // operation body + Commit::resolved
+    std::chrono::nanoseconds commit{0};  // apply_node_commit
+};
+
 class Executor final {
 public:
     template <class StorageT, class Policy = DefaultMemoryPolicy>
@@ -84,42 +115,95 @@ public:
         std::vector<std::string>* skipped_guard = nullptr,
         const std::function<void(v2::NodeSlot)>* on_guard_skip = nullptr,
         const std::function<void(v2::NodeSlot)>* on_execute_start = nullptr,
-        const std::function<void(v2::NodeSlot, const Commit&)>* on_commit_applied = nullptr) const {
-        if (!storage.is_dag_open()) {
-            throw std::runtime_error("Executor::run requires begin_run() to open a DAG run first");
-        }
-        if (plan.dirty_inputs.bit_count() != schema.field_count()) {
-            throw std::runtime_error("Executor::run dirty_inputs mask shape mismatch");
-        }
-        if (plan.requested_outputs.bit_count() != schema.field_count()) {
-            throw std::runtime_error("Executor::run requested_outputs mask shape mismatch");
-        }
-        if (plan.active_nodes.bit_count() != schema.node_count()) {
-            throw std::runtime_error("Executor::run active_nodes mask shape mismatch");
+        const std::function<void(v2::NodeSlot, const Commit&)>* on_commit_applied = nullptr,
+        std::vector<NodeTiming>* timings = nullptr,
+        Tracer* tracer = nullptr) const {
+        validate_run(plan, schema, storage, "Executor::run");
+
+        const NodeReadBinding<StorageT, Policy> binding(storage, schema, memory_policy, tracer);
+        const RuntimeOperationRegistry::ReadHandleFn read_handle = [&binding](v2::FieldSlot field_slot) {
+            return binding.get_handle(field_slot);
+        };
+        const RuntimeOperationRegistry::FieldNameFn field_name = [&binding](v2::FieldSlot field_slot) {
+            return binding.field_name(field_slot);
+        };
+        const RuntimeOperationRegistry::DebugStringFn debug_string = [&binding](v2::FieldSlot field_slot, const Commit::Handle& handle) {
+            return binding.debug_string(field_slot, handle);
+        };
+
+        std::vector<std::uint32_t> levels;
+        if (timings) {
+            levels = wavefront_levels(plan, schema);
+            timings->clear();
+            timings->reserve(plan.topo.size());
         }
 
-        struct NodeReadBinding final {
-            NodeReadBinding(const StorageT& storage_in, const GraphSchema& schema_in, const Policy& memory_policy_in) noexcept
-                : storage(&storage_in), schema(&schema_in), memory_policy(&memory_policy_in) {}
+        for (std::size_t index = 0; index < plan.topo.size(); ++index) {
+            const auto node_slot = plan.topo[index];
+            const auto op_id = checked_op(plan, schema, operations, node_slot, "Executor::run");
 
-            Commit::Handle get_handle(v2::FieldSlot field_slot) const {
-                return storage->read_node_handle(field_slot, *schema);
+            NodeTiming* timing = nullptr;
+            if (timings) {
+                timing = &timings->emplace_back();
+                timing->node = node_slot;
+                timing->level = levels[index];
             }
 
-            std::string_view field_name(v2::FieldSlot field_slot) const {
-                return schema->field_name(field_slot);
+            if (!guard_passes(schema, memory_policy, guards, binding, node_slot, tracer)) {
+                if (timing) timing->skipped_guard = true;
+                report_guard_skip(schema, node_slot, trace, skipped_guard, on_guard_skip);
+                continue;
             }
 
-            std::string debug_string(v2::FieldSlot field_slot, const Commit::Handle& handle) const {
-                return memory_policy->debug_string(field_slot, handle);
+            if (on_execute_start && *on_execute_start) {
+                (*on_execute_start)(node_slot);
             }
 
-            const StorageT* storage = nullptr;
-            const GraphSchema* schema = nullptr;
-            const Policy* memory_policy = nullptr;
-        };
+            const auto started = timing ? Clock::now() : Clock::time_point{};
+            const auto commit = execute_node(operations, op_id, node_slot, schema, read_handle, field_name, debug_string, tracer);
+            const auto executed_at = timing ? Clock::now() : Clock::time_point{};
+            apply_commit(storage, commit, memory_policy, schema, node_slot, tracer);
+            if (timing) {
+                timing->execute = executed_at - started;
+                timing->commit = Clock::now() - executed_at;
+            }
+
+            report_commit(schema, node_slot, commit, trace, executed, on_commit_applied);
+        }
+    }
 
-        const NodeReadBinding binding(storage, schema, memory_policy);
+    // Wavefront execution of the same plan. Each level only reads fields committed by
+    // lower levels, so its nodes run concurrently against the same storage; the level's
+    // commits are then applied in plan order. Guards are evaluated on the calling thread
+    // before the level is dispatched, and on_execute_start fires for every node of the
+    // level that passed its guard before any of them runs. Guard skips and commits are
+    // reported (trace, executed, skipped_guard, on_guard_skip, on_commit_applied) after
+    // the level has run, in plan order, so these reports come out as in run().
+    // Operations must tolerate concurrent calls from different nodes.
+    // On failure the commits of the level that precede the first failed node (in plan
+    // order) are applied and reported, and that node's exception is rethrown; the caller
+    // aborts the run as after a failure in run(). Unlike run(), the later nodes of that
+    // level have already executed by then: their commits are dropped unreported.
+    template <class StorageT, class Policy = DefaultMemoryPolicy>
+    void run_wavefront(
+        const v2::ExecutionPlan& plan,
+        const GraphSchema& schema,
+        StorageT& storage,
+        const Policy& memory_policy,
+        const RuntimeOperationRegistry& operations,
+        const GuardRegistry& guards,
+        WorkerPool& pool,
+        std::vector<std::string>* trace = nullptr,
+        std::vector<std::string>* executed = nullptr,
+        std::vector<std::string>* skipped_guard = nullptr,
+        const std::function<void(v2::NodeSlot)>* on_guard_skip = nullptr,
+        const std::function<void(v2::NodeSlot)>* on_execute_start = nullptr,
+        const std::function<void(v2::NodeSlot, const Commit&)>* on_commit_applied = nullptr,
+        std::vector<NodeTiming>* timings = nullptr,
+        Tracer* tracer = nullptr) const {
+        validate_run(plan, schema, storage, "Executor::run_wavefront");
+
+        const NodeReadBinding<StorageT, Policy> binding(storage, schema, memory_policy, tracer);
         const RuntimeOperationRegistry::ReadHandleFn read_handle = [&binding](v2::FieldSlot field_slot) {
             return binding.get_handle(field_slot);
         };
@@ -130,45 +214,321 @@ public:
             return binding.debug_string(field_slot, handle);
         };
 
+        std::vector<v2::OpId> ops;
+        ops.reserve(plan.topo.size());
         for (const auto node_slot : plan.topo) {
-            if (!plan.active_nodes.test(node_slot)) {
-                throw std::runtime_error("Executor::run topo contains a node outside active_nodes");
+            ops.push_back(checked_op(plan, schema, operations, node_slot, "Executor::run_wavefront"));
+        }
+
+        const auto levels = wavefront_levels(plan, schema);
+        const std::uint32_t level_count =
+            levels.empty() ? 0 : *std::max_element(levels.begin(), levels.end()) + 1;
+        std::vector<std::vector<std::size_t>> by_level(level_count);
+        for (std::size_t index = 0; index < levels.size(); ++index) {
+            by_level[levels[index]].push_back(index);
+        }
+
+        if (timings) {
+            timings->assign(plan.topo.size(), NodeTiming{});
+            for (std::size_t index = 0; index < plan.topo.size(); ++index) {
+                (*timings)[index].node = plan.topo[index];
+                (*timings)[index].level = levels[index];
             }
+        }
 
-            const auto op_id = schema.op_of(node_slot);
-            if (!operations.contains(op_id)) {
-                throw std::runtime_error(
-                    "Executor::run operation registry mismatch for node '" + std::string(schema.node_name(node_slot)) + "'");
+        struct NodeRun final {
+            std::size_t index = 0;
+            bool skipped_guard = false;
+            std::optional<Commit> commit;
+            std::exception_ptr error;
+        };
+        std::vector<NodeRun> runs;
+        std::vector<NodeRun*> dispatched;
+
+        for (const auto& level : by_level) {
+            runs.clear();
+            runs.reserve(level.size());
+            dispatched.clear();
+            for (const auto index : level) {
+                const auto node_slot = plan.topo[index];
+                NodeRun& node_run = runs.emplace_back(NodeRun{index, false, std::nullopt, nullptr});
+                if (!guard_passes(schema, memory_policy, guards, binding, node_slot, tracer)) {
+                    node_run.skipped_guard = true;
+                    if (timings) (*timings)[index].skipped_guard = true;
+                    continue;
+                }
+                if (on_execute_start && *on_execute_start) {
+                    (*on_execute_start)(node_slot);
+                }
+                dispatched.push_back(&node_run);
             }
 
-            const auto& guard = schema.guard_of(node_slot);
-            if (guard) {
-                const auto current_handle = binding.get_handle(guard->field);
-                const bool guard_ok = guards.eval(memory_policy, guard->predicate, guard->field, current_handle, guard->argument);
-                if (!guard_ok) {
-                    if (on_guard_skip && *on_guard_skip) {
-                        (*on_guard_skip)(node_slot);
-                    }
-                    if (skipped_guard) skipped_guard->push_back(std::string(schema.node_name(node_slot)));
-                    if (trace) trace->push_back("skip_guard:" + std::string(schema.node_name(node_slot)));
+            pool.run(dispatched.size(), [&](std::size_t i) {
+                NodeRun& node_run = *dispatched[i];
+                const auto started = timings ? Clock::now() : Clock::time_point{};
+                try {
+                    node_run.commit.emplace(execute_node(
+                        operations,
+                        ops[node_run.index],
+                        plan.topo[node_run.index],
+                        schema,
+                        read_handle,
+                        field_name,
+                        debug_string,
+                        tracer));
+                } catch (...) {
+                    node_run.error = std::current_exception();
+                }
+                if (timings) (*timings)[node_run.index].execute = Clock::now() - started;
+            });
+
+            // Skips and commits interleave in plan order, as in run()
+            for (auto& node_run : runs) {
+                const auto node_slot = plan.topo[node_run.index];
+                if (node_run.skipped_guard) {
+                    report_guard_skip(schema, node_slot, trace, skipped_guard, on_guard_skip);
                     continue;
                 }
+                if (node_run.error) {
+                    std::rethrow_exception(node_run.error);
+                }
+                const auto started = timings ? Clock::now() : Clock::time_point{};
+                apply_commit(storage, *node_run.commit, memory_policy, schema, node_slot, tracer);
+                if (timings) (*timings)[node_run.index].commit = Clock::now() - started;
+
+                report_commit(schema, node_slot, *node_run.commit, trace, executed, on_commit_applied);
             }
+        }
+    }
 
-            if (on_execute_start && *on_execute_start) {
-                (*on_execute_start)(node_slot);
+    // Dependency level of every plan.topo entry (same indexing). A node is placed above
+    // every earlier node whose writes it reads (guard field included), and not below any
+    // earlier node that reads or writes a field it writes; within one level plan order
+    // decides the commit order, so a wavefront run observes the same values as run().
+    static std::vector<std::uint32_t> wavefront_levels(const v2::ExecutionPlan& plan, const GraphSchema& schema) {
+        constexpr std::int64_t kNone = -1;
+        std::vector<std::int64_t> written_level(schema.field_count(), kNone);
+        std::vector<std::int64_t> read_level(schema.field_count(), kNone);
+        std::vector<std::uint32_t> levels;
+        levels.reserve(plan.topo.size());
+
+        for (const auto node_slot : plan.topo) {
+            const auto& reads = schema.reads_of(node_slot);
+            const auto& writes = schema.writes_of(node_slot);
+            const auto& guard = schema.guard_of(node_slot);
+
+            std::int64_t level = 0;
+            const auto after_writer = [&](v2::FieldSlot field) {
+                level = std::max(level, written_level[static_cast<std::size_t>(field)] + 1);
+            };
+            for (const auto field : reads) after_writer(field);
+            if (guard) after_writer(guard->field);
+            for (const auto field : writes) {
+                level = std::max(level, read_level[static_cast<std::size_t>(field)]);
+                level = std::max(level, written_level[static_cast<std::size_t>(field)]);
             }
 
-            const auto commit = operations.execute(op_id, node_slot, read_handle, field_name, debug_string).resolved(schema);
-            storage.apply_node_commit(commit, memory_policy, &schema);
+            for (const auto field : reads) {
+                auto& slot_level = read_level[static_cast<std::size_t>(field)];
+                slot_level = std::max(slot_level, level);
+            }
+            if (guard) {
+                auto& slot_level = read_level[static_cast<std::size_t>(guard->field)];
+                slot_level = std::max(slot_level, level);
+            }
+            for (const auto field : writes) {
+                auto& slot_level = written_level[static_cast<std::size_t>(field)];
+                slot_level = std::max(slot_level, level);
+            }
+            levels.push_back(static_cast<std::uint32_t>(level));
+        }
+        return levels;
+    }
 
-            if (on_commit_applied && *on_commit_applied) {
-                (*on_commit_applied)(node_slot, commit);
+private:
+    using Clock = std::chrono::steady_clock;
+
+    template <class StorageT, class Policy>
+    struct NodeReadBinding final {
+        NodeReadBinding(
+            const StorageT& storage_in,
+            const GraphSchema& schema_in,
+            const Policy& memory_policy_in,
+            Tracer* tracer_in) noexcept
+            : storage(&storage_in), schema(&schema_in), memory_policy(&memory_policy_in), tracer(tracer_in) {}
+
+        Commit::Handle get_handle(v2::FieldSlot field_slot) const {
+            if (!tracer) {
+                return storage->read_node_handle(field_slot, *schema);
             }
+            const auto started = tracer->now_ns();
+            auto handle = storage->read_node_handle(field_slot, *schema);
+            tracer->record(
+                TraceEventKind::Read,
+                started,
+                Tracer::current_node(),
+                static_cast<std::uint32_t>(field_slot),
+                handle_bytes(handle));
+            return handle;
+        }
+
+        std::string_view field_name(v2::FieldSlot field_slot) const {
+            return schema->field_name(field_slot);
+        }
+
+        std::string debug_string(v2::FieldSlot field_slot, const Commit::Handle& handle) const {
+            return memory_policy->debug_string(field_slot, handle);
+        }
+
+        const StorageT* storage = nullptr;
+        const GraphSchema* schema = nullptr;
+        const Policy* memory_policy = nullptr;
+        Tracer* tracer = nullptr;
+    };
 
-            if (executed) executed->push_back(std::string(schema.node_name(node_slot)));
-            if (trace) trace->push_back("exec:" + std::string(schema.node_name(node_slot)));
+    static std::uint64_t handle_bytes(const Commit::Handle& handle) noexcept {
+        return handle ? handle->payload_size() : 0;
+    }
+
+    static std::uint64_t commit_bytes(const Commit& commit) {
+        std::uint64_t bytes = 0;
+        commit.for_each_change([&bytes](const Commit::ChangeView& change) {
+            bytes += handle_bytes(change.payload());
+        });
+        return bytes;
+    }
+
+    static Commit execute_node(
+        const RuntimeOperationRegistry& operations,
+        v2::OpId op_id,
+        v2::NodeSlot node_slot,
+        const GraphSchema& schema,
+        const RuntimeOperationRegistry::ReadHandleFn& read_handle,
+        const RuntimeOperationRegistry::FieldNameFn& field_name,
+        const RuntimeOperationRegistry::DebugStringFn& debug_string,
+        Tracer* tracer) {
+        if (!tracer) {
+            return operations.execute(op_id, node_slot, read_handle, field_name, debug_string).resolved(schema);
         }
+        const Tracer::NodeScope scope(static_cast<std::uint32_t>(node_slot));
+        const auto started = tracer->now_ns();
+        auto commit = operations.execute(op_id, node_slot, read_handle, field_name, debug_string).resolved(schema);
+        tracer->record(TraceEventKind::NodeExecute, started, static_cast<std::uint32_t>(node_slot));
+        return commit;
+    }
+
+    template <class StorageT, class Policy>
+    static void apply_commit(
+        StorageT& storage,
+        const Commit& commit,
+        const Policy& memory_policy,
+        const GraphSchema& schema,
+        v2::NodeSlot node_slot,
+        Tracer* tracer) {
+        if (!tracer) {
+            storage.apply_node_commit(commit, memory_policy, &schema);
+            return;
+        }
+        const auto started = tracer->now_ns();
+        storage.apply_node_commit(commit, memory_policy, &schema);
+        tracer->record(
+            TraceEventKind::Commit,
+            started,
+            static_cast<std::uint32_t>(node_slot),
+            TraceEvent::kNoSlot,
+            commit_bytes(commit));
+    }
+
+    template <class StorageT>
+    static void validate_run(const v2::ExecutionPlan& plan, const GraphSchema& schema, const StorageT& storage, const std::string& caller) {
+        if (!storage.is_dag_open()) {
+            throw std::runtime_error(caller + " requires begin_run() to open a DAG run first");
+        }
+        if (plan.dirty_inputs.bit_count() != schema.field_count()) {
+            throw std::runtime_error(caller + " dirty_inputs mask shape mismatch");
+        }
+        if (plan.requested_outputs.bit_count() != schema.field_count()) {
+            throw std::runtime_error(caller + " requested_outputs mask shape mismatch");
+        }
+        if (plan.active_nodes.bit_count() != schema.node_count()) {
+            throw std::runtime_error(caller + " active_nodes mask shape mismatch");
+        }
+    }
+
+    static v2::OpId checked_op(
+        const v2::ExecutionPlan& plan,
+        const GraphSchema& schema,
+        const RuntimeOperationRegistry& operations,
+        v2::NodeSlot node_slot,
+        const std::string& caller) {
+        if (!plan.active_nodes.test(node_slot)) {
+            throw std::runtime_error(caller + " topo contains a node outside active_nodes");
+        }
+
+        const auto op_id = schema.op_of(node_slot);
+        if (!operations.contains(op_id)) {
+            throw std::runtime_error(
+                caller + " operation registry mismatch for node '" + std::string(schema.node_name(node_slot)) + "'");
+        }
+        return op_id;
+    }
+
+    template <class Policy, class BindingT>
+    static bool guard_passes(
+        const GraphSchema& schema,
+        const Policy& memory_policy,
+        const GuardRegistry& guards,
+        const BindingT& binding,
+        v2::NodeSlot node_slot,
+        Tracer* tracer) {
+        const auto& guard = schema.guard_of(node_slot);
+        if (!guard) {
+            return true;
+        }
+        if (!tracer) {
+            const auto current_handle = binding.get_handle(guard->field);
+            return guards.eval(memory_policy, guard->predicate, guard->field, current_handle, guard->argument);
+        }
+        const Tracer::NodeScope scope(static_cast<std::uint32_t>(node_slot));
+        const auto started = tracer->now_ns();
+        const auto current_handle = binding.get_handle(guard->field);
+        const bool passed = guards.eval(memory_policy, guard->predicate, guard->field, current_handle, guard->argument);
+        tracer->record(
+            TraceEventKind::Guard,
+            started,
+            static_cast<std::uint32_t>(node_slot),
+            static_cast<std::uint32_t>(guard->field),
+            0,
+            passed);
+        return passed;
+    }
+
+    static void report_guard_skip(
+        const GraphSchema& schema,
+        v2::NodeSlot node_slot,
+        std::vector<std::string>* trace,
+        std::vector<std::string>* skipped_guard,
+        const std::function<void(v2::NodeSlot)>* on_guard_skip) {
+        if (on_guard_skip && *on_guard_skip) {
+            (*on_guard_skip)(node_slot);
+        }
+        if (skipped_guard) skipped_guard->push_back(std::string(schema.node_name(node_slot)));
+        if (trace) trace->push_back("skip_guard:" + std::string(schema.node_name(node_slot)));
+    }
+
+    static void report_commit(
+        const GraphSchema& schema,
+        v2::NodeSlot node_slot,
+        const Commit& commit,
+        std::vector<std::string>* trace,
+        std::vector<std::string>* executed,
+        const std::function<void(v2::NodeSlot, const Commit&)>* on_commit_applied) {
+        if (on_commit_applied && *on_commit_applied) {
+            (*on_commit_applied)(node_slot, commit);
+        }
+
+        if (executed) executed->push_back(std::string(schema.node_name(node_slot)));
+        if (trace) trace->push_back("exec:" + std::string(schema.node_name(node_slot)));
     }
 };
 
@@ -13,6 +13,8 @@ namespace proc {
 // - V: current stable snapshot.
 // - G: last known good / archival snapshot when present.
 // Read precedence is D -> V -> G. Tombstone means explicit delete of lower layers.
+// Layers are keyed by the store's Key: Field for the sparse stores, v2::FieldSlot for
+// the dense ones.
 
 template <int lvl, class Policy = DefaultMemoryPolicy, template <class> class BaseStoreT = BaseStore, template <class> class OverlayStoreT = OverlayStore>
 class LayeredState;
@@ -23,24 +25,23 @@ public:
     static constexpr int level = 1;
     using Handle = typename Policy::Handle;
     using Overlay = OverlayStoreT<Policy>;
+    using Key = typename Overlay::Key;
 
-    [[nodiscard]] Handle get(const Field& field) const {
-        if (const auto it = D_.kv.find(field); it != D_.kv.end()) {
-            return it->second;
-        }
+    [[nodiscard]] Handle get(const Key& field) const {
+        if (const auto* d = D_.lookup(field)) return *d;
         return Policy::tombstone();
     }
 
-    void set_D(Field field, Handle handle) {
-        D_.kv[std::move(field)] = std::move(handle);
+    void set_D(Key field, Handle handle) {
+        D_.assign(std::move(field), std::move(handle));
     }
 
-    void erase_D(Field field) {
-        D_.kv[std::move(field)] = Policy::tombstone();
+    void erase_D(Key field) {
+        D_.assign(std::move(field), Policy::tombstone());
     }
 
-    void drop_D(const Field& field) {
-        D_.kv.erase(field);
+    void drop_D(const Key& field) {
+        D_.remove(field);
     }
 
     void clear_D() noexcept { D_.clear(); }
@@ -59,36 +60,37 @@ public:
     static constexpr int level = 2;
     using Handle = typename Policy::Handle;
     using Overlay = OverlayStoreT<Policy>;
+    using Key = typename Overlay::Key;
     using Base = BaseStoreT<Policy>;
 
-    [[nodiscard]] Handle get(const Field& field) const {
-        if (const auto d = D_.kv.find(field); d != D_.kv.end()) return d->second;
-        if (const auto v = V_.kv.find(field); v != V_.kv.end()) return v->second;
+    [[nodiscard]] Handle get(const Key& field) const {
+        if (const auto* d = D_.lookup(field)) return *d;
+        if (const auto* v = V_.lookup(field)) return *v;
         return Policy::tombstone();
     }
 
-    void set_D(Field field, Handle handle) {
-        D_.kv[std::move(field)] = std::move(handle);
+    void set_D(Key field, Handle handle) {
+        D_.assign(std::move(field), std::move(handle));
     }
 
-    void erase_D(Field field) {
-        D_.kv[std::move(field)] = Policy::tombstone();
+    void erase_D(Key field) {
+        D_.assign(std::move(field), Policy::tombstone());
     }
 
-    void drop_D(const Field& field) {
-        D_.kv.erase(field);
+    void drop_D(const Key& field) {
+        D_.remove(field);
     }
 
     void clear_D() noexcept { D_.clear(); }
 
     void promote_D_to_V_apply() {
-        for (const auto& [field, handle] : D_.kv) {
+        D_.for_each([this](const Key& field, const Handle& handle) {
             if (Policy::is_tombstone(handle)) {
-                V_.kv.erase(field);
+                V_.remove(field);
             } else {
-                V_.kv.insert_or_assign(field, Policy::duplicate(handle));
+                V_.assign(field, Policy::duplicate(handle));
             }
-        }
+        });
         D_.clear();
     }
 
@@ -110,37 +112,38 @@ public:
     static constexpr int level = 3;
     using Handle = typename Policy::Handle;
     using Overlay = OverlayStoreT<Policy>;
+    using Key = typename Overlay::Key;
     using Base = BaseStoreT<Policy>;
 
-    [[nodiscard]] Handle get(const Field& field) const {
-        if (const auto d = D_.kv.find(field); d != D_.kv.end()) return d->second;
-        if (const auto v = V_.kv.find(field); v != V_.kv.end()) return v->second;
-        if (const auto g = G_.kv.find(field); g != G_.kv.end()) return g->second;
+    [[nodiscard]] Handle get(const Key& field) const {
+        if (const auto* d = D_.lookup(field)) return *d;
+        if (const auto* v = V_.lookup(field)) return *v;
+        if (const auto* g = G_.lookup(field)) return *g;
         return Policy::tombstone();
     }
 
-    void set_D(Field field, Handle handle) {
-        D_.kv[std::move(field)] = std::move(handle);
+    void set_D(Key field, Handle handle) {
+        D_.assign(std::move(field), std::move(handle));
     }
 
-    void erase_D(Field field) {
-        D_.kv[std::move(field)] = Policy::tombstone();
+    void erase_D(Key field) {
+        D_.assign(std::move(field), Policy::tombstone());
     }
 
-    void drop_D(const Field& field) {
-        D_.kv.erase(field);
+    void drop_D(const Key& field) {
+        D_.remove(field);
     }
 
     void clear_D() noexcept { D_.clear(); }
 
     void promote_D_to_V_apply() {
-        for (const auto& [field, handle] : D_.kv) {
+        D_.for_each([this](const Key& field, const Handle& handle) {
             if (Policy::is_tombstone(handle)) {
-                V_.kv.erase(field);
+                V_.remove(field);
             } else {
-                V_.kv.insert_or_assign(field, Policy::duplicate(handle));
+                V_.assign(field, Policy::duplicate(handle));
             }
-        }
+        });
         D_.clear();
     }
 
@@ -162,5 +165,6 @@ private:
 static_assert(std::is_default_constructible_v<LayeredState<1>>);
 static_assert(std::is_default_constructible_v<LayeredState<2>>);
 static_assert(std::is_default_constructible_v<LayeredState<3>>);
+static_assert(std::is_default_constructible_v<LayeredState<3, DefaultMemoryPolicy, DenseBaseStore, DenseOverlayStore>>);
 
 } // namespace proc
@@ -16,7 +16,8 @@ struct DefaultMemoryPolicy {
     using Handle = ValueRef;
     using EqualFn = std::function<bool(const Handle&, const Handle&)>;
     using DebugStringFn = std::function<std::string(const Handle&)>;
-    using ApplyDiffFn = std::function<Handle(const Handle&, const Handle&)>;
+    // (current, diff) -> next payload. The policy attaches the ValuePatch provenance.
+    using ApplyDiffFn = std::function<Value(const Handle&, const Handle&)>;
 
     DefaultMemoryPolicy() = default;
 
@@ -87,9 +88,40 @@ struct DefaultMemoryPolicy {
         }
         const auto& entry = entry_of(algebra_id);
         if (!entry.apply_diff) {
-            throw std::runtime_error("MemoryPolicy::apply_diff is not implemented for algebra id");
+            throw std::runtime_error(
+                "MemoryPolicy::apply_diff is not implemented for algebra id " +
+                std::to_string(static_cast<std::size_t>(algebra_id)));
         }
-        return entry.apply_diff(current, diff);
+        return std::make_shared<const Value>(Value::patched(entry.apply_diff(current, diff), current, diff));
+    }
+
+    [[nodiscard]] bool has_apply_diff(v2::FieldSlot field_slot) const {
+        if (!schema_) {
+            return false;
+        }
+        const auto it = algebras_.find(schema_->algebra_of(field_slot));
+        return it != algebras_.end() && static_cast<bool>(it->second.apply_diff);
+    }
+
+    // Diff support for every field of the algebra (schema type tag). Fields without it
+    // take the full-replacement fallback of Commit::apply_diff.
+    void register_apply_diff(v2::AlgebraId id, ApplyDiffFn apply_diff_fn) {
+        if (!apply_diff_fn) {
+            throw std::runtime_error("DefaultMemoryPolicy::register_apply_diff requires a callable");
+        }
+        if (const auto it = algebras_.find(id); it != algebras_.end()) {
+            it->second.apply_diff = std::move(apply_diff_fn);
+            return;
+        }
+        register_algebra(
+            id,
+            [](const Handle& lhs, const Handle& rhs) {
+                return payload_equal(lhs, rhs);
+            },
+            [](const Handle& handle) {
+                return payload_debug_string(handle);
+            },
+            std::move(apply_diff_fn));
     }
 
     [[nodiscard]] Handle begin_mutation(v2::FieldSlot, const Handle& current) const {
@@ -106,10 +138,10 @@ struct DefaultMemoryPolicy {
     static bool same(const Handle& a, const Handle& b) noexcept { return same_value(a, b); }
 
     static std::optional<std::string_view> to_debug_view(const Handle& handle) {
-        if (!handle) {
+        if (!handle || !handle->is_bytes()) {
             return std::nullopt;
         }
-        return std::string_view(*handle);
+        return handle->bytes();
     }
 
     static Handle from_debug_string(std::string value) {
@@ -134,7 +166,7 @@ private:
         if (!handle) {
             return "<tombstone>";
         }
-        return *handle;
+        return handle->debug_string();
     }
 
     [[nodiscard]] bool not_has_algebra(v2::AlgebraId id) const noexcept {
@@ -180,11 +212,6 @@ private:
                 },
                 [](const Handle& handle) {
                     return payload_debug_string(handle);
-                },
-                [algebra_id](const Handle&, const Handle&) -> Handle {
-                    throw std::runtime_error(
-                        "MemoryPolicy::apply_diff is not implemented for algebra id " +
-                        std::to_string(static_cast<std::size_t>(algebra_id)));
                 });
         }
     }
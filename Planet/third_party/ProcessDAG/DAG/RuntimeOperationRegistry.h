@@ -118,7 +118,7 @@ private:
             first = false;
 
             auto handle = read_handle(read_slot);
-            const auto value = Commit::debug_view(handle);
+            const auto value = Commit::debug_string(handle);
             const auto read_name = std::string(field_name(read_slot));
             const auto debug_value = value.empty() ? std::string("<missing>") : std::string(value);
             suffix << read_name;
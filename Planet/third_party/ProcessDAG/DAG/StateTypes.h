@@ -3,16 +3,265 @@
 #include "ProcTypes.h"
 #include "StoreTypes.h"
 
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <system_error>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <variant>
 
 namespace proc {
 
+namespace detail {
+
+// Type identity of a payload: the address of a writable per-T tag. The descriptors
+// below are read-only constants, and identical ones (object_type_of<T> has the same
+// bytes for every T, scalar descriptors of same-size non-arithmetic types share
+// folded functions) may be merged by COMDAT folding (/OPT:ICF) into one address.
+// Writable data is never folded, so type checks compare keys, not descriptors.
+template <class T>
+inline char type_tag = 0;
+
+using TypeKey = const void*;
+
+template <class T>
+constexpr TypeKey type_key() noexcept {
+    return &type_tag<std::remove_cv_t<T>>;
+}
+
+// Runtime descriptor of a scalar payload type, one per T.
+struct ScalarType final {
+    TypeKey key;
+    std::size_t size;
+    std::string (*format)(const void* bytes);
+    bool (*parse)(std::string_view text, void* out);
+};
+
+struct ObjectType final {
+    TypeKey key;
+    const char* debug_name;
+};
+
+template <class T>
+std::string format_scalar(const void* bytes) {
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    if constexpr (std::is_same_v<T, bool>) {
+        return value ? "1" : "0";
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        char buffer[64];
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        return std::string(buffer, result.ptr);
+    } else {
+        static constexpr char kHex[] = "0123456789abcdef";
+        const auto* raw = static_cast<const unsigned char*>(bytes);
+        std::string out = "0x";
+        for (std::size_t i = 0; i < sizeof(T); ++i) {
+            out.push_back(kHex[raw[i] >> 4]);
+            out.push_back(kHex[raw[i] & 0xF]);
+        }
+        return out;
+    }
+}
+
+template <class T>
+bool parse_scalar(std::string_view text, void* out) {
+    if constexpr (std::is_same_v<T, bool>) {
+        if (text == "1" || text == "true") return *static_cast<bool*>(out) = true, true;
+        if (text == "0" || text == "false") return *static_cast<bool*>(out) = false, true;
+        return false;
+    } else if constexpr (std::is_arithmetic_v<T>) {
+        T value{};
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        if (result.ec != std::errc{} || result.ptr != text.data() + text.size()) return false;
+        std::memcpy(out, &value, sizeof(T));
+        return true;
+    } else {
+        return false;
+    }
+}
+
+template <class T>
+inline constexpr ScalarType scalar_type_of{type_key<T>(), sizeof(T), &format_scalar<T>, &parse_scalar<T>};
+
+template <class T>
+inline constexpr ObjectType object_type_of{type_key<T>(), "object"};
+
+} // namespace detail
+
+class Value;
+
+// Provenance of a value built by a diff algebra: the value it was patched from and
+// the diff itself. The base is held weakly, so a chain of patches never pins old versions.
+struct ValuePatch final {
+    std::weak_ptr<const Value> base;
+    std::shared_ptr<const Value> diff;
+};
+
 // Unified value model for all state layers.
-using Value = std::string;
+// A value is one of:
+// - bytes: opaque byte blob (legacy string payloads, serialized snapshots);
+// - scalar: trivially copyable T up to 16 bytes, stored inline without formatting;
+// - object: shared immutable C++ object, compared by identity.
+// Strings stay the compatibility path: make_value(std::string) builds bytes, and
+// typed values format themselves only for debug output and cross-kind comparison.
+// Any kind may carry a ValuePatch; it is metadata and never takes part in equality.
+class Value final {
+public:
+    static constexpr std::size_t kScalarCapacity = 16;
+
+    template <class T>
+    static constexpr bool is_scalar_type_v = std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> &&
+        sizeof(T) <= kScalarCapacity;
+
+    enum class Kind : std::uint8_t {
+        Bytes,
+        Scalar,
+        Object,
+    };
+
+    Value() = default;
+    explicit Value(std::string bytes) : payload_(std::move(bytes)) {}
+
+    template <class T>
+    static Value scalar(const T& value) {
+        static_assert(is_scalar_type_v<T>, "Value::scalar requires a small trivially copyable type");
+        Value out;
+        ScalarPayload payload;
+        payload.type = &detail::scalar_type_of<T>;
+        std::memcpy(payload.bytes, &value, sizeof(T));
+        out.payload_ = payload;
+        return out;
+    }
+
+    template <class T>
+    static Value object(std::shared_ptr<const T> value) {
+        Value out;
+        out.payload_ = ObjectPayload{&detail::object_type_of<T>, std::move(value)};
+        return out;
+    }
+
+    // Result of applying diff to base; the payload is moved, never copied.
+    static Value patched(Value next, const std::shared_ptr<const Value>& base, std::shared_ptr<const Value> diff) {
+        next.patch_ = std::make_shared<const ValuePatch>(ValuePatch{base, std::move(diff)});
+        return next;
+    }
+
+    [[nodiscard]] Kind kind() const noexcept { return static_cast<Kind>(payload_.index()); }
+    [[nodiscard]] const ValuePatch* patch() const noexcept { return patch_.get(); }
+    [[nodiscard]] bool is_bytes() const noexcept { return kind() == Kind::Bytes; }
+
+    // Byte view of a blob value; empty for typed values.
+    [[nodiscard]] std::string_view bytes() const noexcept {
+        const auto* bytes = std::get_if<std::string>(&payload_);
+        return bytes ? std::string_view(*bytes) : std::string_view{};
+    }
+
+    // Payload size in bytes: blob length or scalar width; objects are opaque and report 0.
+    [[nodiscard]] std::size_t payload_size() const noexcept {
+        switch (kind()) {
+        case Kind::Bytes:
+            return std::get<std::string>(payload_).size();
+        case Kind::Scalar:
+            return std::get<ScalarPayload>(payload_).type->size;
+        case Kind::Object:
+            return 0;
+        }
+        return 0;
+    }
+
+    template <class T>
+    [[nodiscard]] bool holds() const noexcept {
+        const auto* scalar = std::get_if<ScalarPayload>(&payload_);
+        return scalar && scalar->type->key == detail::type_key<T>();
+    }
+
+    // Exact-type read of a scalar. A bytes value is parsed as the legacy textual form.
+    template <class T>
+    [[nodiscard]] std::optional<T> as() const {
+        static_assert(is_scalar_type_v<T>, "Value::as requires a small trivially copyable type");
+        if (const auto* scalar = std::get_if<ScalarPayload>(&payload_)) {
+            if (scalar->type->key != detail::type_key<T>()) return std::nullopt;
+            T value;
+            std::memcpy(&value, scalar->bytes, sizeof(T));
+            return value;
+        }
+        if (const auto* bytes = std::get_if<std::string>(&payload_)) {
+            T value{};
+            if (detail::scalar_type_of<T>.parse(*bytes, &value)) return value;
+        }
+        return std::nullopt;
+    }
+
+    template <class T>
+    [[nodiscard]] const T* as_object() const noexcept {
+        const auto* object = std::get_if<ObjectPayload>(&payload_);
+        if (!object || object->type->key != detail::type_key<T>()) return nullptr;
+        return static_cast<const T*>(object->ptr.get());
+    }
+
+    [[nodiscard]] std::string debug_string() const {
+        switch (kind()) {
+        case Kind::Bytes:
+            return std::get<std::string>(payload_);
+        case Kind::Scalar: {
+            const auto& scalar = std::get<ScalarPayload>(payload_);
+            return scalar.type->format(scalar.bytes);
+        }
+        case Kind::Object:
+            return "<object>";
+        }
+        return {};
+    }
+
+    // Same kind: payload equality (scalars bitwise, objects by identity).
+    // Bytes vs scalar: the scalar's textual form is compared, so string guard
+    // arguments like "1" still match typed flags.
+    friend bool operator==(const Value& lhs, const Value& rhs) {
+        if (lhs.kind() == rhs.kind()) {
+            switch (lhs.kind()) {
+            case Kind::Bytes:
+                return std::get<std::string>(lhs.payload_) == std::get<std::string>(rhs.payload_);
+            case Kind::Scalar: {
+                const auto& a = std::get<ScalarPayload>(lhs.payload_);
+                const auto& b = std::get<ScalarPayload>(rhs.payload_);
+                return a.type->key == b.type->key && std::memcmp(a.bytes, b.bytes, a.type->size) == 0;
+            }
+            case Kind::Object: {
+                const auto& a = std::get<ObjectPayload>(lhs.payload_);
+                const auto& b = std::get<ObjectPayload>(rhs.payload_);
+                return a.type->key == b.type->key && a.ptr == b.ptr;
+            }
+            }
+        }
+        if (lhs.kind() == Kind::Object || rhs.kind() == Kind::Object) {
+            return false;
+        }
+        return lhs.debug_string() == rhs.debug_string();
+    }
+
+private:
+    struct ScalarPayload final {
+        const detail::ScalarType* type = nullptr;
+        unsigned char bytes[kScalarCapacity]{};
+    };
+
+    struct ObjectPayload final {
+        const detail::ObjectType* type = nullptr;
+        std::shared_ptr<const void> ptr;
+    };
+
+    std::variant<std::string, ScalarPayload, ObjectPayload> payload_;
+    std::shared_ptr<const ValuePatch> patch_;
+};
+
 using ValueRef = std::shared_ptr<const Value>;
 using ValueStore = std::unordered_map<Field, ValueRef>;
 
@@ -20,6 +269,36 @@ inline ValueRef make_value(std::string value) {
     return std::make_shared<const Value>(std::move(value));
 }
 
+template <class T>
+inline ValueRef make_scalar(const T& value) {
+    return std::make_shared<const Value>(Value::scalar(value));
+}
+
+template <class T>
+inline ValueRef make_object(std::shared_ptr<const T> value) {
+    return std::make_shared<const Value>(Value::object(std::move(value)));
+}
+
+template <class T>
+inline std::optional<T> value_as(const ValueRef& value) {
+    if (!value) return std::nullopt;
+    return value->as<T>();
+}
+
+template <class T>
+inline const T* value_object(const ValueRef& value) noexcept {
+    return value ? value->as_object<T>() : nullptr;
+}
+
+// Diff that turned exactly `base` into `value`; null when value was written in full or
+// was patched from another version (the consumer then rebuilds from the full value).
+inline ValueRef value_diff_from(const ValueRef& value, const ValueRef& base) {
+    if (!value || !base) return nullptr;
+    const ValuePatch* patch = value->patch();
+    if (!patch || patch->base.lock() != base) return nullptr;
+    return patch->diff;
+}
+
 // Current contract: identity-only comparison.
 // We intentionally compare pointers (not payload) because values are treated as heavy objects.
 // Semantic payload equality lives in MemoryPolicy and may differ from this low-level handle comparison.
@@ -27,12 +306,13 @@ inline bool same_value(const ValueRef& a, const ValueRef& b) {
     return a == b;
 }
 
+// String views are only available for byte values; typed values are read with value_as<T>.
 inline std::optional<std::string_view> get_value_view(const ValueStore& values, std::string_view key) {
     const auto it = values.find(Field(key));
-    if (it == values.end() || !it->second) {
+    if (it == values.end() || !it->second || !it->second->is_bytes()) {
         return std::nullopt;
     }
-    return std::string_view(*it->second);
+    return it->second->bytes();
 }
 
 template <class Policy>
@@ -53,4 +333,13 @@ inline std::optional<std::string_view> get_value_view(const OverlayStore<Policy>
     return Policy::to_debug_view(it->second);
 }
 
+template <class T, class Policy>
+inline std::optional<T> get_value_as(const BaseStore<Policy>& values, std::string_view key) {
+    const auto it = values.find(Field(key));
+    if (it == values.end()) {
+        return std::nullopt;
+    }
+    return value_as<T>(it->second);
+}
+
 } // namespace proc
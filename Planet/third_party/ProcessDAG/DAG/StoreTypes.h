@@ -1,15 +1,23 @@
 #pragma once
 
+#include "CoreV2.h"
 #include "ProcTypes.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace proc {
 
 namespace detail {
 
+// Name-keyed store: the compatibility layer for boundary frames (prepared/published
+// outputs) and for callers that still address fields by string.
 template <class Policy, class Tag>
 struct SparseStore {
+    using Key = Field;
     using Handle = typename Policy::Handle;
     using Map = std::unordered_map<Field, Handle>;
     using const_iterator = typename Map::const_iterator;
@@ -23,6 +31,88 @@ struct SparseStore {
     [[nodiscard]] const_iterator begin() const noexcept { return kv.begin(); }
     [[nodiscard]] const_iterator end() const noexcept { return kv.end(); }
     [[nodiscard]] const_iterator find(const Field& field) const { return kv.find(field); }
+
+    [[nodiscard]] const Handle* lookup(const Field& field) const {
+        const auto it = kv.find(field);
+        return it == kv.end() ? nullptr : &it->second;
+    }
+
+    void assign(Field field, Handle handle) { kv.insert_or_assign(std::move(field), std::move(handle)); }
+    void remove(const Field& field) { kv.erase(field); }
+
+    template <class Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& [field, handle] : kv) fn(field, handle);
+    }
+};
+
+// Slot-keyed store: dense handle array indexed by the compiled v2::FieldSlot.
+// Presence is tracked separately from the handle, so an overlay can hold an explicit
+// tombstone that hides lower layers. Reads are an index, never a hash of the field name.
+template <class Policy, class Tag>
+struct DenseSlotStore {
+    using Key = v2::FieldSlot;
+    using Handle = typename Policy::Handle;
+
+    std::vector<Handle> values;
+    std::vector<std::uint8_t> present;
+    std::size_t present_count = 0;
+
+    void reserve_slots(std::size_t slot_count) {
+        if (values.size() < slot_count) {
+            values.resize(slot_count);
+            present.resize(slot_count, 0);
+        }
+    }
+
+    void clear() noexcept {
+        if (present_count == 0) return;
+        for (std::size_t i = 0; i < present.size(); ++i) {
+            if (present[i]) {
+                present[i] = 0;
+                values[i] = Handle{};
+            }
+        }
+        present_count = 0;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return present_count == 0; }
+    [[nodiscard]] std::size_t size() const noexcept { return present_count; }
+
+    [[nodiscard]] bool contains(v2::FieldSlot slot) const noexcept {
+        const auto index = static_cast<std::size_t>(slot);
+        return index < present.size() && present[index] != 0;
+    }
+
+    [[nodiscard]] const Handle* lookup(v2::FieldSlot slot) const noexcept {
+        return contains(slot) ? &values[static_cast<std::size_t>(slot)] : nullptr;
+    }
+
+    void assign(v2::FieldSlot slot, Handle handle) {
+        const auto index = static_cast<std::size_t>(slot);
+        reserve_slots(index + 1);
+        if (!present[index]) {
+            present[index] = 1;
+            ++present_count;
+        }
+        values[index] = std::move(handle);
+    }
+
+    void remove(v2::FieldSlot slot) noexcept {
+        const auto index = static_cast<std::size_t>(slot);
+        if (index >= present.size() || !present[index]) return;
+        present[index] = 0;
+        values[index] = Handle{};
+        --present_count;
+    }
+
+    template <class Fn>
+    void for_each(Fn&& fn) const {
+        if (present_count == 0) return;
+        for (std::size_t i = 0; i < present.size(); ++i) {
+            if (present[i]) fn(static_cast<v2::FieldSlot>(i), values[i]);
+        }
+    }
 };
 
 struct base_store_tag final {};
@@ -40,4 +130,14 @@ struct OverlayStore final : detail::SparseStore<Policy, detail::overlay_store_ta
     using detail::SparseStore<Policy, detail::overlay_store_tag>::SparseStore;
 };
 
+template <class Policy>
+struct DenseBaseStore final : detail::DenseSlotStore<Policy, detail::base_store_tag> {
+    using detail::DenseSlotStore<Policy, detail::base_store_tag>::DenseSlotStore;
+};
+
+template <class Policy>
+struct DenseOverlayStore final : detail::DenseSlotStore<Policy, detail::overlay_store_tag> {
+    using detail::DenseSlotStore<Policy, detail::overlay_store_tag>::DenseSlotStore;
+};
+
 } // namespace proc
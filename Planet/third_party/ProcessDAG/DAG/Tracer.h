@@ -0,0 +1,252 @@
+#pragma once
+
+#include "../core/GraphSchema.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace proc {
+
+enum class TraceEventKind : std::uint8_t {
+    Flush,       // whole flush_prepare; flag = failed
+    PlanBuild,   // Planner::build_plan
+    Guard,       // guard evaluation of a node; flag = passed
+    NodeExecute, // operation body + Commit::resolved
+    Read,        // one storage read made by a node; bytes = payload size
+    Commit,      // apply_node_commit; bytes = sum of change payloads
+};
+
+// Fixed-size record: nothing is allocated or formatted while tracing, names are
+// resolved from the schema on export.
+struct TraceEvent final {
+    static constexpr std::uint32_t kNoSlot = std::numeric_limits<std::uint32_t>::max();
+
+    std::uint64_t flush = 0;
+    std::int64_t start_ns = 0; // since the tracer epoch
+    std::int64_t duration_ns = 0;
+    std::uint64_t bytes = 0;
+    std::uint32_t node = kNoSlot;
+    std::uint32_t field = kNoSlot;
+    std::uint32_t thread = 0;
+    TraceEventKind kind = TraceEventKind::Flush;
+    bool flag = false;
+};
+
+// Opt-in span recorder for DagEngine. Events go to a ring buffer of fixed capacity:
+// recording is one atomic increment and a store. Events of earlier flushes are
+// overwritten oldest first, but within one flush a slot is never reused: worker
+// threads of a wavefront run record concurrently, so events past the capacity are
+// dropped and counted in overflowed(). events()/export must run between flushes.
+class Tracer final {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Tracer(std::size_t capacity)
+        : events_(std::max<std::size_t>(capacity, 1)), epoch_(Clock::now()) {}
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    [[nodiscard]] std::size_t capacity() const noexcept { return events_.size(); }
+    // Events stored since clear(), including the ones already overwritten.
+    [[nodiscard]] std::uint64_t recorded() const noexcept {
+        return std::min<std::uint64_t>(next_.load(std::memory_order_relaxed), flush_begin_ + capacity());
+    }
+    // Events lost because a single flush produced more than the capacity.
+    [[nodiscard]] std::uint64_t overflowed() const noexcept { return overflowed_.load(std::memory_order_relaxed); }
+    // Events not retained: overwritten by later flushes or overflowed.
+    [[nodiscard]] std::uint64_t dropped() const noexcept {
+        const auto total = recorded();
+        return (total > capacity() ? total - capacity() : 0) + overflowed();
+    }
+    [[nodiscard]] std::uint64_t current_flush() const noexcept { return flush_; }
+
+    [[nodiscard]] std::int64_t now_ns() const noexcept {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch_).count();
+    }
+
+    // Called between flushes, while no thread records.
+    std::uint64_t begin_flush() noexcept {
+        flush_begin_ = recorded();
+        next_.store(flush_begin_, std::memory_order_relaxed);
+        return ++flush_;
+    }
+
+    void record(
+        TraceEventKind kind,
+        std::int64_t start_ns,
+        std::uint32_t node = TraceEvent::kNoSlot,
+        std::uint32_t field = TraceEvent::kNoSlot,
+        std::uint64_t bytes = 0,
+        bool flag = false) noexcept {
+        const auto index = next_.fetch_add(1, std::memory_order_relaxed);
+        if (index - flush_begin_ >= events_.size()) {
+            overflowed_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        TraceEvent& event = events_[static_cast<std::size_t>(index % events_.size())];
+        event.flush = flush_;
+        event.start_ns = start_ns;
+        event.duration_ns = now_ns() - start_ns;
+        event.bytes = bytes;
+        event.node = node;
+        event.field = field;
+        event.thread = thread_index();
+        event.kind = kind;
+        event.flag = flag;
+    }
+
+    // Retained events, oldest first.
+    [[nodiscard]] std::vector<TraceEvent> events() const {
+        const auto total = recorded();
+        const auto count = static_cast<std::size_t>(std::min<std::uint64_t>(total, events_.size()));
+        std::vector<TraceEvent> out;
+        out.reserve(count);
+        for (auto index = total - count; index < total; ++index) {
+            out.push_back(events_[static_cast<std::size_t>(index % events_.size())]);
+        }
+        return out;
+    }
+
+    void clear() noexcept {
+        next_.store(0, std::memory_order_relaxed);
+        overflowed_.store(0, std::memory_order_relaxed);
+        flush_begin_ = 0;
+    }
+
+    // Chrome trace / Perfetto JSON ("traceEvents" of complete "X" events, ts in us).
+    void write_chrome_trace(std::ostream& out, const GraphSchema& schema) const {
+        out << "{\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped\":" << dropped()
+            << ",\"overflowed\":" << overflowed() << "},\"traceEvents\":[";
+        bool first = true;
+        for (const TraceEvent& event : events()) {
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":";
+            write_json_string(out, event_name(event, schema));
+            out << ",\"cat\":\"" << category(event.kind) << "\",\"ph\":\"X\",\"ts\":";
+            write_micros(out, event.start_ns);
+            out << ",\"dur\":";
+            write_micros(out, event.duration_ns);
+            out << ",\"pid\":1,\"tid\":" << event.thread << ",\"args\":{\"flush\":" << event.flush;
+            if (event.node != TraceEvent::kNoSlot) {
+                out << ",\"node\":";
+                write_json_string(out, schema.node_name(static_cast<v2::NodeSlot>(event.node)));
+            }
+            if (event.field != TraceEvent::kNoSlot) {
+                out << ",\"field\":";
+                write_json_string(out, schema.field_name(static_cast<v2::FieldSlot>(event.field)));
+            }
+            if (event.kind == TraceEventKind::Read || event.kind == TraceEventKind::Commit) {
+                out << ",\"bytes\":" << event.bytes;
+            }
+            if (event.kind == TraceEventKind::Guard) {
+                out << ",\"passed\":" << (event.flag ? "true" : "false");
+            }
+            if (event.kind == TraceEventKind::Flush) {
+                out << ",\"failed\":" << (event.flag ? "true" : "false");
+            }
+            out << "}}";
+        }
+        out << "\n]}\n";
+    }
+
+    // Node the calling thread is executing; reads made by the operation body are
+    // attributed to it.
+    class NodeScope final {
+    public:
+        explicit NodeScope(std::uint32_t node) noexcept : previous_(current_node_) { current_node_ = node; }
+        ~NodeScope() { current_node_ = previous_; }
+        NodeScope(const NodeScope&) = delete;
+        NodeScope& operator=(const NodeScope&) = delete;
+
+    private:
+        std::uint32_t previous_;
+    };
+
+    [[nodiscard]] static std::uint32_t current_node() noexcept { return current_node_; }
+
+private:
+    static std::uint32_t thread_index() noexcept {
+        static std::atomic<std::uint32_t> next_thread{0};
+        thread_local const std::uint32_t index = next_thread.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    static const char* category(TraceEventKind kind) noexcept {
+        switch (kind) {
+        case TraceEventKind::Flush: return "flush";
+        case TraceEventKind::PlanBuild: return "plan";
+        case TraceEventKind::Guard: return "guard";
+        case TraceEventKind::NodeExecute: return "node";
+        case TraceEventKind::Read: return "read";
+        case TraceEventKind::Commit: return "commit";
+        }
+        return "dag";
+    }
+
+    static std::string event_name(const TraceEvent& event, const GraphSchema& schema) {
+        switch (event.kind) {
+        case TraceEventKind::Flush:
+            return "flush #" + std::to_string(event.flush);
+        case TraceEventKind::PlanBuild:
+            return "build_plan";
+        case TraceEventKind::Read:
+            return "read " + std::string(schema.field_name(static_cast<v2::FieldSlot>(event.field)));
+        case TraceEventKind::Guard:
+        case TraceEventKind::NodeExecute:
+        case TraceEventKind::Commit:
+            return std::string(category(event.kind)) + " " +
+                std::string(schema.node_name(static_cast<v2::NodeSlot>(event.node)));
+        }
+        return {};
+    }
+
+    static void write_micros(std::ostream& out, std::int64_t ns) {
+        const auto value = static_cast<long long>(std::max<std::int64_t>(ns, 0));
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%lld.%03lld", value / 1000, value % 1000);
+        out << buffer;
+    }
+
+    static void write_json_string(std::ostream& out, std::string_view text) {
+        out << '"';
+        for (const char c : text) {
+            switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out << escaped;
+                } else {
+                    out << c;
+                }
+            }
+        }
+        out << '"';
+    }
+
+    static inline thread_local std::uint32_t current_node_ = TraceEvent::kNoSlot;
+
+    std::vector<TraceEvent> events_;
+    std::atomic<std::uint64_t> next_{0};
+    std::atomic<std::uint64_t> overflowed_{0};
+    std::uint64_t flush_begin_ = 0; // next_ at begin_flush; a flush claims [flush_begin_, flush_begin_ + capacity)
+    std::uint64_t flush_ = 0;
+    Clock::time_point epoch_;
+};
+
+} // namespace proc
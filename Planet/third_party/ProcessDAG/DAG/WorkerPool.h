@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace proc {
+
+// Fixed set of worker threads for batches of independent tasks.
+// run() blocks until the batch is done; the calling thread takes tasks too, so a
+// pool of size N owns N - 1 threads. One batch at a time: run() is not reentrant.
+class WorkerPool final {
+public:
+    using Task = std::function<void(std::size_t)>;
+
+    explicit WorkerPool(std::size_t size) {
+        const std::size_t thread_count = size > 1 ? size - 1 : 0;
+        threads_.reserve(thread_count);
+        for (std::size_t i = 0; i < thread_count; ++i) {
+            threads_.emplace_back([this] { worker_loop(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& thread : threads_) thread.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    [[nodiscard]] std::size_t size() const noexcept { return threads_.size() + 1; }
+
+    static std::size_t resolve_size(std::size_t requested, std::size_t max_tasks) {
+        std::size_t size = requested;
+        if (size == 0) {
+            size = std::thread::hardware_concurrency();
+        }
+        if (max_tasks != 0 && size > max_tasks) {
+            size = max_tasks;
+        }
+        return size == 0 ? 1 : size;
+    }
+
+    // Runs task(i) for i in [0, count). The first exception thrown by a task is
+    // rethrown after every task has finished.
+    void run(std::size_t count, const Task& task) {
+        if (count == 0) return;
+        if (threads_.empty() || count == 1) {
+            for (std::size_t i = 0; i < count; ++i) task(i);
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            task_ = &task;
+            count_ = count;
+            next_.store(0, std::memory_order_relaxed);
+            busy_ = threads_.size();
+            error_ = nullptr;
+            ++generation_;
+        }
+        wake_.notify_all();
+        drain();
+
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            done_.wait(lock, [this] { return busy_ == 0; });
+            task_ = nullptr;
+            error = std::exchange(error_, nullptr);
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+private:
+    void worker_loop() {
+        std::uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+            }
+            drain();
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--busy_ == 0) done_.notify_one();
+            }
+        }
+    }
+
+    void drain() {
+        for (std::size_t i = next_.fetch_add(1); i < count_; i = next_.fetch_add(1)) {
+            try {
+                (*task_)(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    const Task* task_ = nullptr;
+    std::size_t count_ = 0;
+    std::atomic<std::size_t> next_{0};
+    std::size_t busy_ = 0;
+    std::uint64_t generation_ = 0;
+    std::exception_ptr error_;
+    bool stop_ = false;
+};
+
+} // namespace proc
@@ -116,7 +116,7 @@ std::string_view Logger::to_string(LogLevel level) noexcept {
 void Logger::print_lines(const std::vector<std::string>& values) { ::proc::print_lines(values); }
 void Logger::print_fields_sorted(const FieldSet& fields) { print_sorted_field_set(fields); }
 
-void Logger::print_values(const ValueStore& values, const char* title) { const auto fields = sorted_keys(values); print_fields(fields, title, [&](const Field& field) { const auto it = values.find(field); return it->second ? *it->second : std::string("<missing>"); }); }
+void Logger::print_values(const ValueStore& values, const char* title) { const auto fields = sorted_keys(values); print_fields(fields, title, [&](const Field& field) { const auto it = values.find(field); return it->second ? it->second->debug_string() : std::string("<missing>"); }); }
 
 void Logger::print_graph_schema(const GraphSchema& schema) {
     std::cout << "=== GRAPH SCHEMA ===\nFields:\n";
@@ -143,9 +143,9 @@ void Logger::print_graph_schema(const GraphSchema& schema) {
 }
 
 void Logger::print_plan(const DefaultDagEngine::Plan& plan) { std::cout << "\n--- PLAN ---\ndirty_input_fields:\n"; ::proc::print_lines(plan.changed_fields); std::cout << "trigger map:\n"; for (const auto& [field, readers] : plan.trigger_map) { std::cout << "  " << field << " -> "; if (readers.empty()) std::cout << "<none>"; else for (std::size_t i = 0; i < readers.size(); ++i) std::cout << (i ? ", " : "") << readers[i]; std::cout << "\n"; } std::cout << "triggered_nodes:\n"; ::proc::print_lines(plan.triggered_nodes); std::cout << "active_nodes:\n"; ::proc::print_lines(plan.active_nodes); std::cout << "topo:\n"; ::proc::print_lines(plan.topo); }
-void Logger::print_commit(const Commit& commit, const char* title) { std::cout << "\n" << title << ":\n"; commit.for_each_change([&](const Commit::ChangeView& change) { std::cout << "  " << Commit::field_debug_name(change) << " = " << (change.kind() == v2::ChangeKind::Tombstone ? "DEL" : std::string(Commit::debug_view(change.payload()))) << "\n"; }); }
+void Logger::print_commit(const Commit& commit, const char* title) { std::cout << "\n" << title << ":\n"; commit.for_each_change([&](const Commit::ChangeView& change) { std::cout << "  " << Commit::field_debug_name(change) << " = " << (change.kind() == v2::ChangeKind::Tombstone ? "DEL" : Commit::debug_string(change.payload())) << "\n"; }); }
 void Logger::print_input_state(const ValueStore& values) { print_values(values, "Staged input values"); }
-void Logger::print_outputs(const ValueStore& values, const std::vector<Field>& outputs, const char* title) { print_fields(outputs, title, [&](const Field& field) { const auto value = get_value_view(values, field); return value ? std::string(*value) : std::string("<missing>"); }); }
+void Logger::print_outputs(const ValueStore& values, const std::vector<Field>& outputs, const char* title) { print_fields(outputs, title, [&](const Field& field) { const auto it = values.find(field); return it != values.end() && it->second ? it->second->debug_string() : std::string("<missing>"); }); }
 
 void Logger::print_prepare(bool did_prepare, const std::vector<Field>& outputs, const DefaultDagEngine& dag, const char* title) {
     print_engine_phase(
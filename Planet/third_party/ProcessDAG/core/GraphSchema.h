@@ -24,6 +24,29 @@ public:
         FieldSet inputs;
         FieldSet state;
         FieldSet outputs;
+        // Filled by GraphSchema::storage_layout(): role per compiled slot, so the
+        // runtime can classify fields without hashing names. Empty for hand-built layouts.
+        std::vector<v2::FieldRole> slot_roles;
+
+        bool has_slot_roles() const noexcept {
+            return !slot_roles.empty();
+        }
+
+        bool is_input_slot(v2::FieldSlot slot) const {
+            return slot_role(slot) == v2::FieldRole::Input;
+        }
+
+        bool is_output_slot(v2::FieldSlot slot) const {
+            return slot_role(slot) == v2::FieldRole::Output;
+        }
+
+        v2::FieldRole slot_role(v2::FieldSlot slot) const {
+            const auto index = static_cast<std::size_t>(slot);
+            if (index >= slot_roles.size()) {
+                throw std::out_of_range("StorageLayout field slot out of range");
+            }
+            return slot_roles[index];
+        }
 
         bool is_input(const Field& field) const {
             return inputs.contains(field);
@@ -106,9 +129,11 @@ public:
     bool is_internal_ephemeral(v2::FieldSlot slot) const { return field_at(slot).internal_ephemeral; }
     StorageLayout storage_layout() const {
         StorageLayout layout;
+        layout.slot_roles.reserve(field_count());
         for (std::size_t i = 0; i < field_count(); ++i) {
             const auto slot = static_cast<v2::FieldSlot>(i);
             const Field field(field_name(slot));
+            layout.slot_roles.push_back(role_of(slot));
             switch (role_of(slot)) {
             case v2::FieldRole::Input:
                 layout.inputs.insert(field);
@@ -0,0 +1,69 @@
+from __future__ import annotations
+
+import argparse
+import json
+import sys
+from pathlib import Path
+
+
+def load_cases(path: Path) -> dict[tuple, dict]:
+    report = json.loads(path.read_text(encoding="utf-8"))
+    cases = {}
+    for case in report.get("cases", []):
+        key = (case["pipeline"], case.get("variant", ""), case.get("level", -1), case.get("items", {}).get("file", ""))
+        cases[key] = case
+    return cases
+
+
+def describe(key: tuple) -> str:
+    pipeline, variant, level, file_name = key
+    name = f"{pipeline} [{variant}]" if variant else pipeline
+    if file_name:
+        return f"{name} {file_name}"
+    return f"{name} L{level}" if level >= 0 else name
+
+
+def ratio(new: float, old: float) -> float:
+    return new / old if old > 0 else 1.0
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Compare two pipeline_benchmark JSON reports.")
+    parser.add_argument("baseline", type=Path)
+    parser.add_argument("candidate", type=Path)
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="relative slowdown of the median wall time counted as a regression")
+    parser.add_argument("--min-ms", type=float, default=0.5,
+                        help="cases faster than this in both reports are not judged on time")
+    args = parser.parse_args()
+
+    baseline = load_cases(args.baseline)
+    candidate = load_cases(args.candidate)
+
+    regressions = 0
+    print(f"{'case':<44} {'base ms':>10} {'new ms':>10} {'time':>8} {'allocs':>8} {'peak rss':>9}")
+    for key in sorted(baseline.keys() & candidate.keys(), key=lambda k: (k[0], k[1], k[2], k[3])):
+        old, new = baseline[key], candidate[key]
+        old_ms, new_ms = old["wall_ms"]["median"], new["wall_ms"]["median"]
+        time_ratio = ratio(new_ms, old_ms)
+        alloc_ratio = ratio(new["memory"]["allocations_per_run"], old["memory"]["allocations_per_run"])
+        rss_ratio = ratio(new["memory"]["peak_rss_kb"], old["memory"]["peak_rss_kb"])
+
+        judged = max(old_ms, new_ms) >= args.min_ms
+        regressed = judged and time_ratio > 1.0 + args.threshold
+        mismatched = not new.get("ok", True)
+        regressions += regressed or mismatched
+        marker = "  <-- mismatch" if mismatched else "  <-- slower" if regressed else ""
+        print(f"{describe(key):<44} {old_ms:>10.3f} {new_ms:>10.3f} {time_ratio:>7.2f}x "
+              f"{alloc_ratio:>7.2f}x {rss_ratio:>8.2f}x{marker}")
+
+    for key in sorted(baseline.keys() ^ candidate.keys()):
+        side = "baseline" if key in baseline else "candidate"
+        print(f"{describe(key):<44} only in {side}")
+
+    print(f"\n{regressions} regression(s) above {args.threshold:.0%}")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
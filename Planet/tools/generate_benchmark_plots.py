@@ -1,5 +1,6 @@
 from __future__ import annotations
 
+import json
 from pathlib import Path
 
 import matplotlib.pyplot as plt
@@ -8,6 +9,7 @@ import pandas as pd
 
 ROOT = Path(__file__).resolve().parents[1]
 CSV_PATH = ROOT / "dag_backend_benchmark_results.csv"
+PIPELINE_JSON_PATH = ROOT / "pipeline_benchmark.json"
 OUT_DIR = ROOT / "benchmark_charts"
 
 
@@ -25,6 +27,9 @@ def load_data() -> pd.DataFrame:
         "skipped_guard_nodes",
         "cache_hits",
         "cache_misses",
+        "cache_evictions",
+        "cache_bytes",
+        "thread_count",
     ]
     for column in numeric_columns:
         if column in df.columns:
@@ -32,6 +37,27 @@ def load_data() -> pd.DataFrame:
     return df
 
 
+def load_pipeline_cases() -> pd.DataFrame:
+    """One row per case of tools/pipeline_benchmark.cpp, items flattened into columns."""
+    columns = ["pipeline", "variant", "level", "median_ms", "mean_ms", "ok"]
+    if not PIPELINE_JSON_PATH.exists():
+        return pd.DataFrame(columns=columns)
+    report = json.loads(PIPELINE_JSON_PATH.read_text(encoding="utf-8"))
+    rows = []
+    for case in report.get("cases", []):
+        row = {
+            "pipeline": case["pipeline"],
+            "variant": case.get("variant", ""),
+            "level": case.get("level", -1),
+            "median_ms": case["wall_ms"]["median"],
+            "mean_ms": case["wall_ms"]["mean"],
+            "ok": case.get("ok", True),
+        }
+        row.update(case.get("items", {}))
+        rows.append(row)
+    return pd.DataFrame(rows) if rows else pd.DataFrame(columns=columns)
+
+
 def ensure_output_dir() -> None:
     OUT_DIR.mkdir(parents=True, exist_ok=True)
 
@@ -66,6 +92,486 @@ def plot_terrain(df: pd.DataFrame) -> None:
     save_figure(fig, "terrain_benchmark_comparison.png")
 
 
+def plot_terrain_steady_state(df: pd.DataFrame) -> None:
+    steady = df[df["category"] == "terrain-steady-state"].copy()
+    if steady.empty:
+        return
+    operations_order = ["cold_regenerate", "param_tweak", "unchanged_regenerate"]
+    summary = steady.groupby(["scenario", "operation"], as_index=False)["elapsed_ms"].mean()
+    pivot = summary.pivot(index="scenario", columns="operation", values="elapsed_ms").reindex(columns=operations_order)
+
+    fig, ax = plt.subplots(figsize=(11, 6))
+    pivot.plot(kind="bar", ax=ax, color=["#B91C1C", "#2563EB", "#0F766E"], width=0.75)
+    ax.set_title("DAG Terrain: Cold vs Persistent Engine", fontsize=15, weight="bold")
+    ax.set_xlabel("Scenario")
+    ax.set_ylabel("Average time (ms)")
+    ax.grid(axis="y", linestyle="--", alpha=0.35)
+    ax.legend(["Cold regenerate", "One-parameter tweak", "Unchanged inputs"], title="")
+    ax.set_axisbelow(True)
+
+    for container in ax.containers:
+        ax.bar_label(container, fmt="%.1f", padding=3, fontsize=9)
+
+    save_figure(fig, "terrain_benchmark_steady_state.png")
+
+
+def plot_tessellation_scaling(cases: pd.DataFrame) -> None:
+    tessellation = cases[cases["pipeline"] == "tessellation_threads"].copy()
+    if tessellation.empty:
+        return
+    tessellation["scenario"] = "L" + tessellation["level"].astype(str)
+    pivot = tessellation.pivot(index="threads", columns="scenario", values="median_ms").sort_index()
+    speedup = pivot.iloc[0] / pivot
+
+    fig, ax = plt.subplots(figsize=(11, 6))
+    speedup.plot(kind="line", marker="o", ax=ax)
+    ax.plot(pivot.index, pivot.index / pivot.index[0], color="#111827", linestyle="--", linewidth=1, label="Linear")
+    ax.set_title("Terrain Tessellation: Thread Scaling", fontsize=15, weight="bold")
+    ax.set_xlabel("Threads")
+    ax.set_ylabel("Speedup vs 1 thread (median)")
+    ax.grid(linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+
+    save_figure(fig, "terrain_benchmark_tessellation_scaling.png")
+
+
+def plot_terrain_format(cases: pd.DataFrame) -> None:
+    formats = cases[cases["pipeline"] == "terrain_format"].copy()
+    if formats.empty:
+        return
+    order = [b for b in ["Flat float", "Flat packed", "Indexed float", "Indexed packed"] if b in set(formats["variant"])]
+    formats["scenario"] = "terrain L" + formats["level"].astype(str)
+    formats["mib"] = formats["gpu_bytes"] / (1024 * 1024)
+    colors = ["#6B7280", "#9CA3AF", "#2563EB", "#059669"]
+
+    fig, (time_ax, size_ax) = plt.subplots(1, 2, figsize=(14, 6))
+    formats.pivot(index="scenario", columns="variant", values="median_ms")[order].plot(
+        kind="bar", ax=time_ax, color=colors, width=0.75)
+    time_ax.set_title("Build (+ pack) time", fontsize=13, weight="bold")
+    time_ax.set_ylabel("Median time (ms)")
+    formats.pivot(index="scenario", columns="variant", values="mib")[order].plot(
+        kind="bar", ax=size_ax, color=colors, width=0.75)
+    size_ax.set_title("Vertex + index buffers", fontsize=13, weight="bold")
+    size_ax.set_ylabel("MiB")
+    for ax in (time_ax, size_ax):
+        ax.set_xlabel("")
+        ax.grid(axis="y", linestyle="--", alpha=0.35)
+        ax.legend(title="")
+        ax.set_axisbelow(True)
+        ax.tick_params(axis="x", rotation=0)
+    size_ax.bar_label(size_ax.containers[-1], fmt="%.1f", padding=3, fontsize=8)
+    fig.suptitle("Terrain Mesh Format: Flat vs Indexed, Float vs Packed", fontsize=15, weight="bold")
+
+    save_figure(fig, "terrain_format_benchmark.png")
+
+
+def plot_terrain_culling(cases: pd.DataFrame) -> None:
+    culling = cases[cases["pipeline"].isin(["culling_triangles", "culling_clusters"])].copy()
+    if culling.empty:
+        return
+    order = [b for b in ["Per-triangle", "Clusters 64", "Clusters 256"] if b in set(culling["variant"])]
+    culling["scenario"] = "culling L" + culling["level"].astype(str)
+    colors = ["#D97706", "#2563EB", "#059669"]
+
+    fig, (time_ax, kept_ax) = plt.subplots(1, 2, figsize=(14, 6))
+    culling.pivot(index="scenario", columns="variant", values="median_ms")[order].plot(
+        kind="bar", ax=time_ax, color=colors, width=0.75)
+    time_ax.set_title("Camera sweep time", fontsize=13, weight="bold")
+    time_ax.set_ylabel("Median time (ms)")
+    culling.pivot(index="scenario", columns="variant", values="kept_triangles_avg")[order].plot(
+        kind="bar", ax=kept_ax, color=colors, width=0.75)
+    kept_ax.set_title("Triangles kept per view", fontsize=13, weight="bold")
+    kept_ax.set_ylabel("Triangles")
+    for ax in (time_ax, kept_ax):
+        ax.set_xlabel("")
+        ax.grid(axis="y", linestyle="--", alpha=0.35)
+        ax.legend(title="")
+        ax.set_axisbelow(True)
+        ax.tick_params(axis="x", rotation=0)
+    fig.suptitle("Terrain Culling: Per-Triangle Test vs Clusters", fontsize=15, weight="bold")
+
+    save_figure(fig, "terrain_culling_benchmark.png")
+
+
+def plot_terrain_visibility_upload(cases: pd.DataFrame) -> None:
+    upload = cases[cases["pipeline"] == "visibility_upload"].copy()
+    if upload.empty:
+        return
+    order = [b for b in ["Index list", "Draw ranges", "Draw ranges (merged)"] if b in set(upload["variant"])]
+    upload["scenario"] = "visibility L" + upload["level"].astype(str)
+    upload["kib"] = upload["bytes_per_view"] / 1024
+    colors = ["#D97706", "#2563EB", "#059669"]
+
+    fig, (time_ax, bytes_ax, draws_ax) = plt.subplots(1, 3, figsize=(18, 6))
+    for ax, column, title, label in (
+        (time_ax, "median_ms", "Camera sweep time", "Median time (ms)"),
+        (bytes_ax, "kib", "Data submitted per view", "KiB"),
+        (draws_ax, "draws_per_view", "Draw calls per view", "Ranges"),
+    ):
+        upload.pivot(index="scenario", columns="variant", values=column)[order].plot(
+            kind="bar", ax=ax, color=colors, width=0.75)
+        ax.set_title(title, fontsize=13, weight="bold")
+        ax.set_ylabel(label)
+        ax.set_xlabel("")
+        ax.grid(axis="y", linestyle="--", alpha=0.35)
+        ax.legend(title="")
+        ax.set_axisbelow(True)
+        ax.tick_params(axis="x", rotation=0)
+    bytes_ax.set_yscale("log")
+    fig.suptitle("Terrain Visibility Upload: Index List vs Draw Ranges", fontsize=15, weight="bold")
+
+    save_figure(fig, "terrain_visibility_upload_benchmark.png")
+
+
+def plot_tree_instances(cases: pd.DataFrame) -> None:
+    trees = cases[cases["pipeline"] == "trees_frame"].copy()
+    if trees.empty:
+        return
+    order = [b for b in ["Per-tree matrices", "Instance builder"] if b in set(trees["variant"])]
+    summary = trees.set_index("variant").loc[order].reset_index()
+    colors = ["#D97706", "#2563EB"]
+
+    fig, (time_ax, draws_ax, trees_ax) = plt.subplots(1, 3, figsize=(18, 6))
+    for ax, column, title, label in (
+        (time_ax, "median_ms", "Camera sweep time", "Median time (ms)"),
+        (draws_ax, "draws_per_view", "Draw calls per view", "Draws"),
+        (trees_ax, "trees_per_view", "Trees sent to GL per view", "Trees"),
+    ):
+        ax.bar(summary["variant"], summary[column], color=colors[: len(summary)])
+        ax.set_title(title, fontsize=13, weight="bold")
+        ax.set_ylabel(label)
+        ax.grid(axis="y", linestyle="--", alpha=0.35)
+        ax.set_axisbelow(True)
+    draws_ax.set_yscale("log")
+    fig.suptitle("Tree Rendering: Per-Tree Draws vs Instance Builder", fontsize=15, weight="bold")
+
+    save_figure(fig, "tree_instances_benchmark.png")
+
+
+def plot_particle_simulation(cases: pd.DataFrame) -> None:
+    particles = cases[cases["pipeline"] == "particles_step"].copy()
+    if particles.empty:
+        return
+    summary = particles.sort_values("median_ms", ascending=False)
+    summary["mib"] = summary["bytes_per_step"] / (1024 * 1024)
+
+    fig, (time_ax, bytes_ax) = plt.subplots(1, 2, figsize=(15, 6))
+    time_ax.bar(summary["variant"], summary["median_ms"], color="#2563EB")
+    time_ax.set_title("Simulation steps", fontsize=13, weight="bold")
+    time_ax.set_ylabel("Median time (ms)")
+    bytes_ax.bar(summary["variant"], summary["mib"], color="#059669")
+    bytes_ax.set_title("Data written per step", fontsize=13, weight="bold")
+    bytes_ax.set_ylabel("MiB")
+    for ax in (time_ax, bytes_ax):
+        ax.grid(axis="y", linestyle="--", alpha=0.35)
+        ax.set_axisbelow(True)
+        ax.tick_params(axis="x", rotation=15)
+    fig.suptitle("Tree Particles: AoS Loop vs SoA Simulator", fontsize=15, weight="bold")
+
+    save_figure(fig, "particle_simulation_benchmark.png")
+
+
+def plot_water_mesh(cases: pd.DataFrame) -> None:
+    water = cases[cases["pipeline"] == "water_mesh"].copy()
+    if water.empty:
+        return
+    order = [b for b in ["Recursive unindexed", "Indexed", "Indexed + camera LOD"] if b in set(water["variant"])]
+    water["scenario"] = "water L" + water["level"].astype(str)
+    water["kib"] = water["bytes"] / 1024
+    colors = ["#D97706", "#2563EB", "#059669"]
+
+    fig, (time_ax, vertices_ax, bytes_ax) = plt.subplots(1, 3, figsize=(18, 6))
+    for ax, column, title, label in (
+        (time_ax, "median_ms", "Build time", "Median time (ms)"),
+        (vertices_ax, "vertices", "Vertices", "Vertices"),
+        (bytes_ax, "kib", "Vertex + index data", "KiB"),
+    ):
+        water.pivot(index="scenario", columns="variant", values=column)[order].plot(
+            kind="bar", ax=ax, color=colors, width=0.75)
+        ax.set_title(title, fontsize=13, weight="bold")
+        ax.set_ylabel(label)
+        ax.set_xlabel("")
+        ax.grid(axis="y", linestyle="--", alpha=0.35)
+        ax.legend(title="")
+        ax.set_axisbelow(True)
+        ax.tick_params(axis="x", rotation=0)
+    fig.suptitle("Water Mesh: Recursive vs Indexed Generator", fontsize=15, weight="bold")
+
+    save_figure(fig, "water_mesh_benchmark.png")
+
+
+def plot_cell_layout(cases: pd.DataFrame) -> None:
+    layout = cases[cases["pipeline"] == "cell_layout"].copy()
+    if layout.empty:
+        return
+    layout["case"] = "L" + layout["level"].astype(str) + " / " + layout["scan"]
+    pivot = layout.pivot(index="case", columns="layout", values="median_ms")
+
+    fig, ax = plt.subplots(figsize=(11, 6))
+    pivot.plot(kind="bar", ax=ax, color=["#D97706", "#2563EB"], width=0.75)
+    ax.set_title("Full-Planet Scans: AoS Cells vs SoA Columns", fontsize=15, weight="bold")
+    ax.set_xlabel("Scan")
+    ax.set_ylabel("Median time (ms)")
+    ax.grid(axis="y", linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+
+    for container in ax.containers:
+        ax.bar_label(container, fmt="%.3f", padding=3, fontsize=8)
+
+    save_figure(fig, "cell_layout_benchmark.png")
+
+
+def plot_path_search(cases: pd.DataFrame) -> None:
+    search = cases[cases["pipeline"].isin(["astar", "astar_alt"])].copy()
+    if search.empty:
+        return
+    search["scenario"] = "L" + search["level"].astype(str)
+    search["heuristic"] = search["pipeline"].map({"astar": "Great-circle", "astar_alt": "ALT"})
+
+    fig, axes = plt.subplots(1, 2, figsize=(13, 6))
+    for ax, column, label in (
+        (axes[0], "median_ms", "Median batch time (ms)"),
+        (axes[1], "expanded_nodes", "Expanded nodes per batch"),
+    ):
+        pivot = search.pivot(index="scenario", columns="heuristic", values=column)
+        pivot.plot(kind="bar", ax=ax, color=["#0F766E", "#D97706"], width=0.75)
+        ax.set_xlabel("Scenario")
+        ax.set_ylabel(label)
+        ax.grid(axis="y", linestyle="--", alpha=0.35)
+        ax.legend(title="")
+        ax.set_axisbelow(True)
+    fig.suptitle("A* Path Search: Great-Circle vs ALT Heuristic", fontsize=15, weight="bold")
+
+    save_figure(fig, "path_search_benchmark.png")
+
+
+def plot_picking(cases: pd.DataFrame) -> None:
+    queries = {
+        "picking": ("first_hit", "BVH"),
+        "picking_brute": ("first_hit", "Brute force"),
+        "picking_any": ("any_hit", "BVH"),
+        "picking_any_brute": ("any_hit", "Brute force"),
+    }
+    picking = cases[cases["pipeline"].isin(queries.keys())].copy()
+    if picking.empty:
+        return
+    picking["query"] = picking["pipeline"].map(lambda name: queries[name][0])
+    picking["backend"] = picking["pipeline"].map(lambda name: queries[name][1])
+    picking["target"] = picking["variant"].replace("", "terrain")
+    picking["case"] = picking["target"] + " L" + picking["level"].astype(str) + " / " + picking["query"]
+    pivot = picking.pivot(index="case", columns="backend", values="median_ms")
+
+    fig, ax = plt.subplots(figsize=(12, 6))
+    pivot.plot(kind="bar", ax=ax, color=["#2563EB", "#D97706"], width=0.75, logy=True)
+    ax.set_title("Ray Picking: Brute Force vs BVH", fontsize=15, weight="bold")
+    ax.set_xlabel("Target / query")
+    ax.set_ylabel("Median batch time (ms, log)")
+    ax.grid(axis="y", linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+    ax.tick_params(axis="x", rotation=30)
+
+    save_figure(fig, "picking_benchmark.png")
+
+
+def plot_ecs_iteration(cases: pd.DataFrame) -> None:
+    ecs = cases[cases["pipeline"].str.startswith("ecs_")].copy()
+    if ecs.empty:
+        return
+    ecs["case"] = (ecs["entities"] // 1000).astype(int).astype(str) + "k / " + ecs["pipeline"].str.replace("ecs_", "", regex=False)
+    pivot = ecs.pivot(index="case", columns="storage", values="median_ms")
+
+    fig, ax = plt.subplots(figsize=(12, 6))
+    pivot.plot(kind="bar", ax=ax, color=["#D97706", "#2563EB"], width=0.75, logy=True)
+    ax.set_title("ECS Storage: Hash Maps vs Sparse Sets", fontsize=15, weight="bold")
+    ax.set_xlabel("Entities / operation")
+    ax.set_ylabel("Median time (ms, log)")
+    ax.grid(axis="y", linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+    ax.tick_params(axis="x", rotation=30)
+
+    save_figure(fig, "ecs_iteration_benchmark.png")
+
+
+def plot_perlin_noise(cases: pd.DataFrame) -> None:
+    perlin = cases[cases["pipeline"] == "perlin_fractal"].copy()
+    if perlin.empty:
+        return
+    perlin["scenario"] = "fractal 4 octaves / " + (perlin["points"] // 1000).astype(int).astype(str) + "k points"
+    pivot = perlin.pivot(index="scenario", columns="backend", values="median_ms")
+    order = [b for b in ["double per point", "float scalar", "float sse2", "float avx2"] if b in pivot.columns]
+    pivot = pivot[order]
+
+    fig, ax = plt.subplots(figsize=(11, 6))
+    pivot.plot(kind="bar", ax=ax, color=["#9CA3AF", "#D97706", "#059669", "#2563EB"][:len(order)], width=0.75)
+    ax.set_title("Perlin Noise: Per-Point Double vs Batched Float", fontsize=15, weight="bold")
+    ax.set_xlabel("")
+    ax.set_ylabel("Median time (ms)")
+    ax.grid(axis="y", linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+    ax.tick_params(axis="x", rotation=0)
+
+    save_figure(fig, "perlin_noise_benchmark.png")
+
+
+def plot_climate_scaling(cases: pd.DataFrame) -> None:
+    climate = cases[(cases["pipeline"] == "climate_threads") & (cases["mode"] == "parallel")].copy()
+    if climate.empty:
+        return
+    climate["scenario"] = "climate L" + climate["level"].astype(str)
+    pivot = climate.pivot(index="threads", columns="scenario", values="median_ms").sort_index()
+    speedup = pivot.iloc[0] / pivot
+
+    fig, ax = plt.subplots(figsize=(11, 6))
+    speedup.plot(kind="line", marker="o", ax=ax)
+    ax.plot(pivot.index, pivot.index / pivot.index[0], color="#111827", linestyle="--", linewidth=1, label="Linear")
+    ax.set_title("Climate Generation: Thread Scaling", fontsize=15, weight="bold")
+    ax.set_xlabel("Threads")
+    ax.set_ylabel("Speedup vs 1 thread (median)")
+    ax.grid(linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+
+    save_figure(fig, "climate_generation_scaling.png")
+
+
+def plot_topology_cache(cases: pd.DataFrame) -> None:
+    backends = {"icosphere": "Fresh icosphere", "icosphere_disk": "Topology file", "icosphere_cached": "Shared topology"}
+    topology = cases[cases["pipeline"].isin(backends.keys())].copy()
+    if topology.empty:
+        return
+    topology["scenario"] = "topology L" + topology["level"].astype(str)
+    topology["backend"] = topology["pipeline"].map(backends)
+    pivot = topology.pivot(index="scenario", columns="backend", values="median_ms")
+    order = [b for b in backends.values() if b in pivot.columns]
+    pivot = pivot[order]
+    palette = {"Fresh icosphere": "#D97706", "Topology file": "#059669", "Shared topology": "#2563EB"}
+
+    fig, ax = plt.subplots(figsize=(11, 6))
+    pivot.plot(kind="bar", ax=ax, color=[palette[b] for b in order], width=0.75, logy=True)
+    ax.set_title("Model Rebuild: Fresh Icosphere vs Topology File vs Shared Topology", fontsize=15, weight="bold")
+    ax.set_xlabel("")
+    ax.set_ylabel("Median time (ms, log)")
+    ax.grid(axis="y", linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+    ax.tick_params(axis="x", rotation=0)
+
+    save_figure(fig, "topology_cache_benchmark.png")
+
+
+def plot_model_registry(df: pd.DataFrame) -> None:
+    registry = df[df["category"] == "model-registry"].copy()
+    if registry.empty:
+        return
+    summary = registry.groupby(["scenario", "backend"], as_index=False)["elapsed_ms"].mean()
+    pivot = summary.pivot(index="scenario", columns="backend", values="elapsed_ms")
+    pivot = pivot[[b for b in ["Rebuild per query", "Shared snapshot model"] if b in pivot.columns]]
+
+    fig, ax = plt.subplots(figsize=(11, 6))
+    pivot.plot(kind="bar", ax=ax, color=["#D97706", "#2563EB"], width=0.75)
+    ax.set_title("Path Queries: Per-Query Model Rebuild vs Shared Snapshot Model", fontsize=15, weight="bold")
+    ax.set_xlabel("")
+    ax.set_ylabel("Average batch time (ms)")
+    ax.grid(axis="y", linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+    ax.tick_params(axis="x", rotation=0)
+
+    save_figure(fig, "model_registry_benchmark.png")
+
+
+def plot_dag_storage(df: pd.DataFrame) -> None:
+    storage = df[df["category"] == "dag-storage"].copy()
+    if storage.empty:
+        return
+    storage["case"] = storage["scenario"] + "\n" + storage["operation"]
+    summary = storage.groupby(["case", "backend"], as_index=False)["elapsed_ms"].mean()
+    pivot = summary.pivot(index="case", columns="backend", values="elapsed_ms")
+    pivot = pivot[[b for b in ["String fields", "Typed slots"] if b in pivot.columns]]
+
+    fig, ax = plt.subplots(figsize=(11, 6))
+    pivot.plot(kind="bar", ax=ax, color=["#D97706", "#2563EB"], width=0.75)
+    ax.set_title("DAG Field Storage: String Fields vs Typed Slot Arrays", fontsize=15, weight="bold")
+    ax.set_xlabel("")
+    ax.set_ylabel("Average time (ms)")
+    ax.grid(axis="y", linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+    ax.tick_params(axis="x", rotation=0)
+
+    save_figure(fig, "dag_storage_benchmark.png")
+
+
+def plot_dag_wavefront(df: pd.DataFrame) -> None:
+    wavefront = df[df["category"] == "dag-wavefront"].copy()
+    if wavefront.empty:
+        return
+    wavefront["case"] = wavefront["scenario"] + "\n" + wavefront["operation"]
+    summary = wavefront.groupby(["case", "backend"], as_index=False)["elapsed_ms"].mean()
+    pivot = summary.pivot(index="case", columns="backend", values="elapsed_ms")
+    pivot = pivot[[b for b in ["Serial", "Wavefront"] if b in pivot.columns]]
+
+    fig, ax = plt.subplots(figsize=(11, 6))
+    pivot.plot(kind="bar", ax=ax, color=["#6B7280", "#059669"], width=0.75)
+    ax.set_title("DAG Executor: Serial vs Wavefront Levels", fontsize=15, weight="bold")
+    ax.set_xlabel("")
+    ax.set_ylabel("Average time (ms)")
+    ax.grid(axis="y", linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+    ax.tick_params(axis="x", rotation=0)
+
+    save_figure(fig, "dag_wavefront_benchmark.png")
+
+
+def plot_dag_delta(df: pd.DataFrame) -> None:
+    delta = df[df["category"] == "dag-delta"].copy()
+    if delta.empty:
+        return
+    delta["case"] = delta["scenario"] + "\n" + delta["operation"]
+    summary = delta.groupby(["case", "backend"], as_index=False)["elapsed_ms"].mean()
+    pivot = summary.pivot(index="case", columns="backend", values="elapsed_ms")
+    pivot = pivot[[b for b in ["Full value", "Cell patch"] if b in pivot.columns]]
+
+    fig, ax = plt.subplots(figsize=(11, 6))
+    pivot.plot(kind="bar", ax=ax, color=["#6B7280", "#7C3AED"], width=0.75)
+    ax.set_title("DAG Commits: Full Value vs Cell Patch", fontsize=15, weight="bold")
+    ax.set_xlabel("")
+    ax.set_ylabel("Average time (ms)")
+    ax.grid(axis="y", linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+    ax.tick_params(axis="x", rotation=0)
+
+    save_figure(fig, "dag_delta_benchmark.png")
+
+
+def plot_dag_trace(df: pd.DataFrame) -> None:
+    trace = df[df["category"] == "dag-trace"].copy()
+    if trace.empty:
+        return
+    summary = trace.groupby(["scenario", "backend"], as_index=False)["elapsed_ms"].mean()
+    pivot = summary.pivot(index="scenario", columns="backend", values="elapsed_ms")
+    pivot = pivot[[b for b in ["Tracing off", "Tracing on"] if b in pivot.columns]]
+
+    fig, ax = plt.subplots(figsize=(10, 6))
+    pivot.plot(kind="bar", ax=ax, color=["#6B7280", "#DC2626"], width=0.7)
+    ax.set_title("DAG Tracing Overhead (ring buffer)", fontsize=15, weight="bold")
+    ax.set_xlabel("")
+    ax.set_ylabel("Average time (ms)")
+    ax.grid(axis="y", linestyle="--", alpha=0.35)
+    ax.legend(title="")
+    ax.set_axisbelow(True)
+    ax.tick_params(axis="x", rotation=0)
+
+    save_figure(fig, "dag_trace_benchmark.png")
+
+
 def plot_scene_operations(df: pd.DataFrame) -> None:
     scene = df[df["category"] == "scene-derived"].copy()
     operations_order = [
@@ -182,7 +688,28 @@ def plot_scene_speedup(df: pd.DataFrame) -> None:
 def main() -> None:
     ensure_output_dir()
     df = load_data()
+    cases = load_pipeline_cases()
     plot_terrain(df)
+    plot_terrain_steady_state(df)
+    plot_tessellation_scaling(cases)
+    plot_terrain_format(cases)
+    plot_terrain_culling(cases)
+    plot_terrain_visibility_upload(cases)
+    plot_tree_instances(cases)
+    plot_particle_simulation(cases)
+    plot_water_mesh(cases)
+    plot_cell_layout(cases)
+    plot_path_search(cases)
+    plot_picking(cases)
+    plot_ecs_iteration(cases)
+    plot_perlin_noise(cases)
+    plot_climate_scaling(cases)
+    plot_topology_cache(cases)
+    plot_model_registry(df)
+    plot_dag_storage(df)
+    plot_dag_wavefront(df)
+    plot_dag_delta(df)
+    plot_dag_trace(df)
     plot_scene_operations(df)
     plot_dag_metrics(df)
     plot_scene_speedup(df)
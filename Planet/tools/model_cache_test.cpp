@@ -1,17 +1,11 @@
 #include <QCoreApplication>
 #include <QDebug>
-#include <windows.h>
-#include <psapi.h>
 #include <fstream>
+#include "core/ProcessMemory.h"
 #include "model/ModelHandler.h"
 
-// --- Ïîëó÷åíèå RSS ïîä Windows ---
 static size_t currentRSSBytes() {
-    PROCESS_MEMORY_COUNTERS info;
-    if (GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info))) {
-        return static_cast<size_t>(info.WorkingSetSize); // RSS àíàëîã
-    }
-    return 0;
+    return sampleProcessMemory().rssBytes;
 }
 
 int main(int argc, char** argv) {
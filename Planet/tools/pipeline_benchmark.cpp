@@ -0,0 +1,1376 @@
+// Headless benchmark of the CPU pipelines (no OpenGL context needed).
+//
+// Cases per subdivision level: icosphere build (fresh, from the topology
+// cache and from a topology file on disk), climate/biome generation and its
+// thread scaling, tessellation (and its thread scaling, flat/indexed and
+// float/packed output), AoS vs SoA cell scans, culling (TerrainCulling, and
+// a camera sweep per triangle vs per cluster, and what the visible set
+// costs to upload as an index list vs draw ranges), water mesh (recursive
+// vs indexed, with and without camera LOD), picking (BVH vs brute force,
+// first and any hit, terrain and pick triangles), A* (great-circle and ALT
+// heuristics). Level-independent: ECS component iteration (sparse sets vs
+// hash maps), batched Perlin fractal noise per SIMD backend, per-tree
+// matrices vs the tree instance builder over a camera sweep, tree particle
+// steps (AoS loop vs the SoA simulator); OBJ parsing runs once per file.
+// Every case reports wall time, heap allocations (counted by the operator
+// new replacement below) and peak RSS into one JSON file; compare two runs
+// with tools/compare_pipeline_benchmarks.py. Cases that compare an
+// implementation against a reference carry "ok"; the exit code is 2 when
+// one of them does not match.
+//
+// Linux build from the Planet directory, as one command line (QtCore + QtGui
+// for QVector3D):
+//   g++ -std=c++20 -O2 -fPIC -I. $(pkg-config --cflags Qt6Core Qt6Gui)
+//       tools/pipeline_benchmark.cpp core/ProcessMemory.cpp dag/DataAdapters.cpp
+//       model/HexSphereModel.cpp model/TopologyCache.cpp model/TopologyFile.cpp
+//       model/OreSystem.cpp generation/TerrainGenerator.cpp
+//       generation/ClimateBiomeGenerator.cpp generation/PerlinNoise.cpp
+//       generation/MeshGenerators/TerrainMeshGenerator.cpp
+//       renderers/TerrainTessellator.cpp culling/TerrainCulling.cpp
+//       culling/TerrainClusters.cpp culling/TriangleBVH.cpp
+//       controllers/PathBuilder.cpp ECS/ComponentStorage.cpp
+//       renderers/TreeInstances.cpp renderers/ParticleSimulator.cpp
+//       contributor/ContributorParticles.cpp
+//       generation/MeshGenerators/WaterMeshGenerator.cpp
+//       $(pkg-config --libs Qt6Core Qt6Gui) -pthread -o pipeline_benchmark
+//   ./pipeline_benchmark --levels 3,4,5,6 --repeat 5 --out bench.json
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMatrix4x4>
+#include <QSysInfo>
+#include <QtDebug>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <new>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "ECS/ComponentStorage.h"
+#include "contributor/ContributorParticles.h"
+#include "controllers/PathBuilder.h"
+#include "core/ProcessMemory.h"
+#include "culling/TerrainClusters.h"
+#include "culling/TerrainCulling.h"
+#include "culling/TriangleBVH.h"
+#include "generation/ClimateBiomeGenerator.h"
+#include "generation/MeshGenerators/TerrainMeshGenerator.h"
+#include "generation/MeshGenerators/WaterMeshGenerator.h"
+#include "generation/PerlinNoise.h"
+#include "generation/TerrainGenerator.h"
+#include "model/HexSphereModel.h"
+#include "model/SurfacePlacement.h"
+#include "model/TopologyCache.h"
+#include "model/TopologyFile.h"
+#include "model/simple3d_parser.hpp"
+#include "renderers/ParticleSimulator.h"
+#include "renderers/TreeInstances.h"
+
+// --- Счётчик аллокаций: замена глобального operator new ---
+namespace {
+    std::atomic<uint64_t> gAllocations{ 0 };
+    std::atomic<uint64_t> gAllocatedBytes{ 0 };
+
+    void* countedAlloc(std::size_t size) {
+        gAllocations.fetch_add(1, std::memory_order_relaxed);
+        gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        if (void* p = std::malloc(size ? size : 1)) return p;
+        throw std::bad_alloc();
+    }
+
+    // alignas(>16) типы (SIMD-буферы) идут через перегрузки с std::align_val_t
+    void* countedAlignedAlloc(std::size_t size, std::align_val_t alignment) {
+        gAllocations.fetch_add(1, std::memory_order_relaxed);
+        gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+        const std::size_t align = static_cast<std::size_t>(alignment);
+#if defined(_MSC_VER)
+        if (void* p = _aligned_malloc(size ? size : 1, align)) return p;
+#else
+        // aligned_alloc требует размер, кратный выравниванию
+        const std::size_t rounded = ((size ? size : 1) + align - 1) / align * align;
+        if (void* p = std::aligned_alloc(align, rounded)) return p;
+#endif
+        throw std::bad_alloc();
+    }
+
+    void alignedFree(void* p) noexcept {
+#if defined(_MSC_VER)
+        _aligned_free(p);
+#else
+        std::free(p);
+#endif
+    }
+}
+
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return countedAlignedAlloc(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return countedAlignedAlloc(size, alignment); }
+void operator delete(void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+
+namespace {
+
+    constexpr uint32_t kSeed = 12345u;
+    constexpr int kRaysPerRun = 256;
+    constexpr int kPathQueriesPerRun = 100;
+    constexpr int kCameraPositionsPerRun = 16;
+    constexpr int kSweepViews = 64;
+
+    struct RunSample {
+        double wallMs = 0.0;
+        uint64_t allocations = 0;
+        uint64_t allocatedBytes = 0;
+    };
+
+    // Один прогон кейса; prepare() не входит в замер.
+    // variant различает реализации одного пайплайна (ключ сравнения отчётов),
+    // check() после замеров сверяет результат с эталоном - false роняет отчёт
+    struct BenchCase {
+        QString pipeline;
+        int level = -1;
+        std::function<void()> prepare;
+        std::function<void()> run;
+        std::function<QJsonObject()> items;
+        QString variant = QString();
+        std::function<bool()> check = nullptr;
+    };
+
+    HexSphereModel makeModel(int level, bool withTerrain) {
+        IcosphereBuilder builder;
+        HexSphereModel model;
+        model.rebuildFromIcosphere(builder.build(level));
+        if (withTerrain) {
+            createTerrainGeneratorByIndex(3)->generate(model, TerrainParams{ kSeed, 3, 3.0f });
+        }
+        return model;
+    }
+
+    // 1, 2, 4, 8 и число аппаратных потоков, если его нет в списке
+    std::vector<int> scalingThreadCounts() {
+        std::vector<int> threadCounts = { 1, 2, 4, 8 };
+        const int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+        if (hardwareThreads > 0 &&
+            std::find(threadCounts.begin(), threadCounts.end(), hardwareThreads) == threadCounts.end()) {
+            threadCounts.push_back(hardwareThreads);
+        }
+        return threadCounts;
+    }
+
+    bool sameTopology(const HexSphereModel& model, const HexSphereModel& reference) {
+        return model.cellCount() == reference.cellCount() &&
+            model.topology().offsets == reference.topology().offsets &&
+            model.topology().polyVerts == reference.topology().polyVerts &&
+            model.topology().neighbors == reference.topology().neighbors &&
+            model.pickTris().size() == reference.pickTris().size();
+    }
+
+    bool climateIdentical(const HexSphereModel& lhs, const HexSphereModel& rhs) {
+        if (lhs.cellCount() != rhs.cellCount()) {
+            return false;
+        }
+        for (int i = 0; i < lhs.cellCount(); ++i) {
+            const Cell& a = lhs.cells()[i];
+            const Cell& b = rhs.cells()[i];
+            if (a.height != b.height || a.biome != b.biome || a.oreType != b.oreType ||
+                a.temperature != b.temperature || a.humidity != b.humidity ||
+                a.pressure != b.pressure || a.oreDensity != b.oreDensity) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool meshesIdentical(const TerrainMesh& lhs, const TerrainMesh& rhs) {
+        return lhs.pos == rhs.pos &&
+            lhs.col == rhs.col &&
+            lhs.norm == rhs.norm &&
+            lhs.idx == rhs.idx &&
+            lhs.triOwner == rhs.triOwner;
+    }
+
+    // Полный проход по планете в двух раскладках: AoS-вектор Cell и SoA-колонки/CSR
+    struct CellScan {
+        QString name;
+        std::function<int64_t(const HexSphereModel&)> aos;
+        std::function<int64_t(const HexSphereModel&)> soa;
+    };
+
+    const std::vector<CellScan>& cellScans() {
+        static const std::vector<CellScan> scans = {
+            { "height_sum",
+                [](const HexSphereModel& model) {
+                    int64_t sum = 0;
+                    for (const auto& cell : model.cells()) sum += cell.height;
+                    return sum;
+                },
+                [](const HexSphereModel& model) {
+                    int64_t sum = 0;
+                    for (int h : model.columns().height) sum += h;
+                    return sum;
+                } },
+            { "neighbor_heights",
+                [](const HexSphereModel& model) {
+                    const auto& cells = model.cells();
+                    int64_t sum = 0;
+                    for (const auto& cell : cells)
+                        for (int n : cell.neighbors)
+                            if (n >= 0) sum += cells[static_cast<size_t>(n)].height;
+                    return sum;
+                },
+                [](const HexSphereModel& model) {
+                    const auto& heights = model.columns().height;
+                    int64_t sum = 0;
+                    for (int n : model.topology().neighbors)
+                        if (n >= 0) sum += heights[static_cast<size_t>(n)];
+                    return sum;
+                } },
+            { "biome_count",
+                [](const HexSphereModel& model) {
+                    int64_t count = 0;
+                    for (const auto& cell : model.cells()) count += cell.biome == Biome::Grass;
+                    return count;
+                },
+                [](const HexSphereModel& model) {
+                    int64_t count = 0;
+                    for (Biome biome : model.columns().biome) count += biome == Biome::Grass;
+                    return count;
+                } },
+        };
+        return scans;
+    }
+
+    // Те же треугольники (позиции вершин и владельцы) при любой раскладке вершин
+    bool sameTriangles(const TerrainMesh& lhs, const TerrainMesh& rhs) {
+        if (lhs.idx.size() != rhs.idx.size() || lhs.triOwner != rhs.triOwner) return false;
+        for (size_t i = 0; i < lhs.idx.size(); ++i) {
+            const size_t a = size_t(lhs.idx[i]) * 3;
+            const size_t b = size_t(rhs.idx[i]) * 3;
+            if (lhs.pos[a] != rhs.pos[b] || lhs.pos[a + 1] != rhs.pos[b + 1] || lhs.pos[a + 2] != rhs.pos[b + 2]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Камеры по спирали Фибоначчи вокруг планеты, через одну ближе к поверхности
+    std::vector<QVector3D> sweepViews(int count) {
+        std::vector<QVector3D> views;
+        for (int v = 0; v < count; ++v) {
+            const float y = 1.0f - 2.0f * (static_cast<float>(v) + 0.5f) / count;
+            const float r = std::sqrt(std::max(0.0f, 1.0f - y * y));
+            const float phi = 2.39996323f * static_cast<float>(v);
+            const float distance = v % 2 == 0 ? 3.0f : 1.5f;
+            views.push_back(QVector3D(r * std::cos(phi), y, r * std::sin(phi)) * distance);
+        }
+        return views;
+    }
+
+    QVector3D randomUnit(std::mt19937& rng) {
+        std::normal_distribution<float> gauss(0.0f, 1.0f);
+        const QVector3D v(gauss(rng), gauss(rng), gauss(rng));
+        return v.lengthSquared() > 0.0f ? v.normalized() : QVector3D(0.0f, 0.0f, 1.0f);
+    }
+
+    // Раскладка ECS до sparse-set: unordered_map на тип компонента, обход в порядке создания
+    struct HashMapStorage {
+        std::vector<ecs::EntityId> order;
+        std::unordered_map<ecs::EntityId, ecs::Entity> entities;
+        std::unordered_map<ecs::EntityId, ecs::Transform> transforms;
+        std::unordered_map<ecs::EntityId, ecs::Mesh> meshes;
+        std::unordered_map<ecs::EntityId, ecs::Collider> colliders;
+
+        template<typename Map>
+        static bool has(const Map& map, ecs::EntityId id) { return map.find(id) != map.end(); }
+
+        void destroy(ecs::EntityId id) {
+            entities.erase(id);
+            transforms.erase(id);
+            meshes.erase(id);
+            colliders.erase(id);
+            order.erase(std::remove(order.begin(), order.end(), id), order.end());
+        }
+    };
+
+    // Все сущности с Transform, половина с Mesh, каждая восьмая с Collider
+    void fillEcsStorages(int entityCount, ecs::ComponentStorage& sparse, HashMapStorage& hashed) {
+        sparse = ecs::ComponentStorage{};
+        hashed = HashMapStorage{};
+        for (int e = 0; e < entityCount; ++e) {
+            ecs::Entity& entity = sparse.createEntity();
+            entity.currentCell = e;
+            hashed.order.push_back(entity.id);
+            hashed.entities.emplace(entity.id, entity);
+            const QVector3D position(float(e % 97), float(e % 13), 1.0f);
+            sparse.emplace<ecs::Transform>(entity.id).position = position;
+            hashed.transforms[entity.id].position = position;
+            if (e % 2 == 0) {
+                sparse.emplace<ecs::Mesh>(entity.id);
+                hashed.meshes[entity.id];
+            }
+            if (e % 8 == 0) {
+                sparse.emplace<ecs::Collider>(entity.id).radius = 0.5f;
+                hashed.colliders[entity.id].radius = 0.5f;
+            }
+        }
+    }
+
+    // Камера на орбите смотрит в случайную точку около планеты - часть лучей мимо
+    template<class Fn>
+    void castOrbitRays(Fn&& fn) {
+        std::mt19937 rng(kSeed);
+        std::uniform_real_distribution<float> spread(0.0f, 1.3f);
+        for (int r = 0; r < kRaysPerRun; ++r) {
+            const QVector3D origin = randomUnit(rng) * 3.0f;
+            const QVector3D dir = (randomUnit(rng) * spread(rng) - origin).normalized();
+            fn(r, origin, dir);
+        }
+    }
+
+    BVHRayHit bruteFirstHit(const std::vector<BVHTriangle>& tris, const QVector3D& origin, const QVector3D& dir) {
+        BVHRayHit best;
+        best.t = std::numeric_limits<float>::infinity();
+        for (size_t i = 0; i < tris.size(); ++i) {
+            float t;
+            if (TriangleBVH::rayTriangle(origin, dir, tris[i].v0, tris[i].v1, tris[i].v2, t) && t < best.t) {
+                best.t = t;
+                best.triangle = static_cast<int>(i);
+            }
+        }
+        return best;
+    }
+
+    bool bruteAnyHit(const std::vector<BVHTriangle>& tris, const QVector3D& origin, const QVector3D& dir) {
+        for (const BVHTriangle& tri : tris) {
+            float t;
+            if (TriangleBVH::rayTriangle(origin, dir, tri.v0, tri.v1, tri.v2, t)) return true;
+        }
+        return false;
+    }
+
+    QJsonObject runCase(const BenchCase& bench, int repeat) {
+        std::vector<RunSample> samples;
+        samples.reserve(static_cast<size_t>(repeat));
+        const bool peakReset = resetPeakRss();
+        const ProcessMemorySample before = sampleProcessMemory();
+
+        for (int r = 0; r < repeat; ++r) {
+            if (bench.prepare) bench.prepare();
+            const uint64_t allocs0 = gAllocations.load(std::memory_order_relaxed);
+            const uint64_t bytes0 = gAllocatedBytes.load(std::memory_order_relaxed);
+            QElapsedTimer timer;
+            timer.start();
+            bench.run();
+            RunSample sample;
+            sample.wallMs = static_cast<double>(timer.nsecsElapsed()) / 1000000.0;
+            sample.allocations = gAllocations.load(std::memory_order_relaxed) - allocs0;
+            sample.allocatedBytes = gAllocatedBytes.load(std::memory_order_relaxed) - bytes0;
+            samples.push_back(sample);
+        }
+        const ProcessMemorySample after = sampleProcessMemory();
+
+        std::vector<double> wall;
+        for (const RunSample& s : samples) wall.push_back(s.wallMs);
+        std::sort(wall.begin(), wall.end());
+        double sum = 0.0;
+        uint64_t allocations = 0;
+        uint64_t bytes = 0;
+        for (const RunSample& s : samples) {
+            sum += s.wallMs;
+            allocations += s.allocations;
+            bytes += s.allocatedBytes;
+        }
+        const double runs = static_cast<double>(samples.size());
+
+        QJsonObject wallObj;
+        wallObj["min"] = wall.front();
+        wallObj["median"] = wall[wall.size() / 2];
+        wallObj["mean"] = sum / runs;
+        wallObj["max"] = wall.back();
+
+        QJsonObject memory;
+        memory["allocations_per_run"] = static_cast<double>(allocations) / runs;
+        memory["allocated_bytes_per_run"] = static_cast<double>(bytes) / runs;
+        memory["rss_before_kb"] = static_cast<double>(before.rssBytes / 1024);
+        memory["rss_after_kb"] = static_cast<double>(after.rssBytes / 1024);
+        memory["peak_rss_kb"] = static_cast<double>(after.peakRssBytes / 1024);
+        memory["peak_rss_is_per_case"] = peakReset;
+
+        QJsonObject result;
+        result["pipeline"] = bench.pipeline;
+        if (!bench.variant.isEmpty()) result["variant"] = bench.variant;
+        if (bench.level >= 0) result["level"] = bench.level;
+        result["runs"] = static_cast<int>(samples.size());
+        result["wall_ms"] = wallObj;
+        result["memory"] = memory;
+        if (bench.items) result["items"] = bench.items();
+        result["ok"] = !bench.check || bench.check();
+        return result;
+    }
+
+    QList<int> parseLevels(const QString& text) {
+        QList<int> levels;
+        for (const QString& part : text.split(',', Qt::SkipEmptyParts)) {
+            bool ok = false;
+            const int level = part.trimmed().toInt(&ok);
+            if (ok && level >= 0 && level <= 8) levels.push_back(level);
+        }
+        return levels;
+    }
+
+    // Пайплайны пишут qDebug на каждый вызов (TerrainCulling) - это искажает замер
+    QtMessageHandler gDefaultHandler = nullptr;
+    void dropDebugMessages(QtMsgType type, const QMessageLogContext& context, const QString& message) {
+        if (type != QtDebugMsg) gDefaultHandler(type, context, message);
+    }
+
+    QString compilerName() {
+#if defined(_MSC_VER)
+        return QString("MSVC %1").arg(_MSC_VER);
+#elif defined(__clang__)
+        return QString("clang %1.%2.%3").arg(__clang_major__).arg(__clang_minor__).arg(__clang_patchlevel__);
+#elif defined(__GNUC__)
+        return QString("gcc %1.%2.%3").arg(__GNUC__).arg(__GNUC_MINOR__).arg(__GNUC_PATCHLEVEL__);
+#else
+        return QString("unknown");
+#endif
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless Planet pipeline benchmark");
+    parser.addHelpOption();
+    const QCommandLineOption levelsOption("levels", "Comma-separated subdivision levels.", "list", "3,4,5");
+    const QCommandLineOption repeatOption("repeat", "Timed runs per case.", "n", "3");
+    const QCommandLineOption outOption("out", "JSON report path.", "file", "pipeline_benchmark.json");
+    const QCommandLineOption objOption("obj", "OBJ file to parse (repeatable).", "file");
+    const QCommandLineOption labelOption("label", "Free-form build label stored in the report.", "text");
+    const QCommandLineOption verboseOption("verbose", "Keep qDebug output of the pipelines.");
+    const QCommandLineOption topologyDirOption("topology-cache", "Directory for the topology files of icosphere_disk.",
+        "dir", QDir::temp().filePath("planet-topology-bench"));
+    parser.addOptions({ levelsOption, repeatOption, outOption, objOption, labelOption, verboseOption, topologyDirOption });
+    parser.process(app);
+    if (!parser.isSet(verboseOption)) {
+        gDefaultHandler = qInstallMessageHandler(dropDebugMessages);
+    }
+
+    const QList<int> levels = parseLevels(parser.value(levelsOption));
+    const int repeat = std::max(1, parser.value(repeatOption).toInt());
+    QStringList objFiles = parser.values(objOption);
+    if (objFiles.isEmpty()) {
+        const QDir resources("resources");
+        for (const QString& name : resources.entryList({ "*.obj" }, QDir::Files, QDir::Name)) {
+            objFiles.push_back(resources.filePath(name));
+        }
+    }
+
+    QJsonArray cases;
+    bool allOk = true;
+    auto record = [&](const BenchCase& bench) {
+        const QJsonObject result = runCase(bench, repeat);
+        qInfo().noquote() << bench.pipeline << bench.variant << "L" << bench.level
+            << "median ms:" << result["wall_ms"].toObject()["median"].toDouble();
+        if (!result["ok"].toBool()) {
+            qWarning().noquote() << bench.pipeline << bench.variant << "L" << bench.level << "does not match its reference";
+            allOk = false;
+        }
+        cases.push_back(result);
+    };
+
+    for (int level : levels) {
+        // icosphere: построение сферы и дуального графа клеток; результат - эталон
+        // топологии для icosphere_cached и icosphere_disk
+        HexSphereModel fresh;
+        record({ "icosphere", level, nullptr,
+            [&]() {
+                IcosphereBuilder builder;
+                fresh = HexSphereModel{};
+                fresh.rebuildFromIcosphere(builder.build(level));
+            },
+            [&]() { return QJsonObject{ { "cells", fresh.cellCount() } }; } });
+
+        // icosphere_cached: та же модель из прогретого TopologyCache
+        {
+            HexSphereModel model;
+            record({ "icosphere_cached", level,
+                [&]() { TopologyCache::acquire(level); },
+                [&]() {
+                    model = HexSphereModel{};
+                    model.rebuildFromTopology(TopologyCache::acquire(level));
+                },
+                [&]() { return QJsonObject{ { "cells", model.cellCount() } }; },
+                QString(),
+                [&]() { return sameTopology(model, fresh); } });
+        }
+
+        // icosphere_disk: холодная загрузка файла топологии (mmap + проверка сумм)
+        {
+            const QString path = QDir(parser.value(topologyDirOption)).filePath(topologyFileName(level));
+            IcosphereBuilder builder;
+            if (!writeTopologyFile(path, *SphereTopology::fromIcosphere(builder.build(level), level))) {
+                qWarning() << "cannot write" << path;
+            }
+            HexSphereModel model;
+            record({ "icosphere_disk", level, nullptr,
+                [&]() {
+                    model = HexSphereModel{};
+                    model.rebuildFromTopology(loadTopologyFile(path));
+                },
+                [&]() { return QJsonObject{ { "cells", model.cellCount() },
+                    { "file_bytes", static_cast<double>(QFileInfo(path).size()) } }; },
+                QString(),
+                [&]() { return sameTopology(model, fresh); } });
+        }
+
+        // climate_biome: генератор 3 (ClimateBiome) на свежей сфере
+        {
+            const HexSphereModel blank = makeModel(level, false);
+            HexSphereModel model;
+            record({ "climate_biome", level,
+                [&]() { model = blank; },
+                [&]() { createTerrainGeneratorByIndex(3)->generate(model, TerrainParams{ kSeed, 3, 3.0f }); },
+                [&]() { return QJsonObject{ { "cells", model.cellCount() } }; } });
+
+            // climate_threads: Mode::Parallel по числу потоков, планета обязана совпасть
+            // с однопоточной бит в бит; последовательный проход на std::rand - базовая линия
+            ClimateBiomeGenerator generator;
+            ClimateBiomeGenerator::ClimateParams params;
+            params.mode = ClimateBiomeGenerator::ClimateParams::Mode::Parallel;
+            params.threadCount = 1;
+            HexSphereModel reference = blank;
+            generator.generate(reference, params);
+
+            ClimateBiomeGenerator::ClimateParams legacy;
+            legacy.mode = ClimateBiomeGenerator::ClimateParams::Mode::Legacy;
+            record({ "climate_threads", level,
+                [&]() { model = blank; },
+                [&]() { generator.generate(model, legacy); },
+                [&]() { return QJsonObject{ { "cells", model.cellCount() }, { "mode", "legacy" }, { "threads", 1 } }; },
+                "Legacy serial" });
+
+            for (int threads : scalingThreadCounts()) {
+                ClimateBiomeGenerator::ClimateParams parallel = params;
+                parallel.threadCount = threads;
+                record({ "climate_threads", level,
+                    [&]() { model = blank; },
+                    [&]() { generator.generate(model, parallel); },
+                    [&]() { return QJsonObject{ { "cells", model.cellCount() }, { "mode", "parallel" }, { "threads", threads } }; },
+                    QString("%1 threads").arg(threads),
+                    [&]() { return climateIdentical(model, reference); } });
+            }
+        }
+
+        const HexSphereModel model = makeModel(level, true);
+        TerrainMeshOptions meshOptions;
+        const TerrainMesh terrain = TerrainMeshGenerator::buildTerrainMesh(model, meshOptions);
+        const int triangles = static_cast<int>(terrain.idx.size() / 3);
+        const QJsonObject meshItems{ { "cells", model.cellCount() }, { "triangles", triangles } };
+
+        {
+            TerrainMesh mesh;
+            record({ "tessellation", level, nullptr,
+                [&]() { mesh = TerrainMeshGenerator::buildTerrainMesh(model, meshOptions); },
+                [&]() { return QJsonObject{ { "triangles", static_cast<int>(mesh.idx.size() / 3) },
+                    { "threads", static_cast<int>(std::thread::hardware_concurrency()) } }; } });
+        }
+
+        // tessellation_threads: масштабирование по потокам, меш обязан совпасть с однопоточным
+        {
+            TerrainMeshOptions serial = meshOptions;
+            serial.threadCount = 1;
+            const TerrainMesh reference = TerrainMeshGenerator::buildTerrainMesh(model, serial);
+            for (int threads : scalingThreadCounts()) {
+                TerrainMeshOptions options = meshOptions;
+                options.threadCount = threads;
+                TerrainMesh mesh;
+                record({ "tessellation_threads", level, nullptr,
+                    [&]() { mesh = TerrainMeshGenerator::buildTerrainMesh(model, options); },
+                    [&]() { return QJsonObject{ { "cells", model.cellCount() }, { "threads", threads },
+                        { "triangles", static_cast<int>(mesh.idx.size() / 3) } }; },
+                    QString("%1 threads").arg(threads),
+                    [&]() { return meshesIdentical(mesh, reference); } });
+            }
+        }
+
+        // terrain_format: плоский (три вершины на треугольник) и индексный вывод, каждый
+        // с float-потоками pos/col/norm или упакованными 20-байтными вершинами; упаковка
+        // входит в замер. Индексный меш обязан дать те же треугольники, что плоский
+        {
+            TerrainMeshOptions flatOptions;
+            flatOptions.threadCount = 1;
+            flatOptions.indexedOutput = false;
+            const TerrainMesh flat = TerrainMeshGenerator::buildTerrainMesh(model, flatOptions);
+            for (const bool indexed : { false, true }) {
+                for (const bool packed : { false, true }) {
+                    TerrainMeshOptions options;
+                    options.threadCount = 1;
+                    options.indexedOutput = indexed;
+                    TerrainMesh mesh;
+                    size_t packedVertices = 0;
+                    record({ "terrain_format", level, nullptr,
+                        [&]() {
+                            mesh = TerrainMeshGenerator::buildTerrainMesh(model, options);
+                            if (packed) packedVertices = packTerrainVertices(mesh).size();
+                        },
+                        [&]() {
+                            const size_t vertexCount = mesh.pos.size() / 3;
+                            const size_t gpuBytes = vertexCount * (packed ? sizeof(TerrainPackedVertex) : 9 * sizeof(float)) +
+                                mesh.idx.size() * sizeof(uint32_t);
+                            return QJsonObject{ { "cells", model.cellCount() }, { "indexed", indexed }, { "packed", packed },
+                                { "vertices", static_cast<double>(vertexCount) },
+                                { "triangles", static_cast<int>(mesh.idx.size() / 3) },
+                                { "gpu_bytes", static_cast<double>(gpuBytes) } }; },
+                        QString(indexed ? "Indexed " : "Flat ") + (packed ? "packed" : "float"),
+                        [&]() {
+                            return (!indexed || sameTriangles(mesh, flat)) &&
+                                (!packed || packedVertices == mesh.pos.size() / 3);
+                        } });
+                }
+            }
+        }
+
+        // cell_layout: те же проходы по AoS и SoA, суммы обязаны совпасть
+        {
+            model.columns();
+            for (const CellScan& scan : cellScans()) {
+                const int64_t expected = scan.aos(model);
+                for (const bool soa : { false, true }) {
+                    const QString layout = soa ? "SoA columns" : "AoS cells";
+                    int64_t result = 0;
+                    record({ "cell_layout", level, nullptr,
+                        [&]() { result = soa ? scan.soa(model) : scan.aos(model); },
+                        [&]() { return QJsonObject{ { "cells", model.cellCount() }, { "scan", scan.name },
+                            { "layout", layout } }; },
+                        scan.name + " / " + layout,
+                        [&]() { return result == expected; } });
+                }
+            }
+        }
+
+        // culling: загрузка меша и отсечение с камер на орбите
+        {
+            size_t visible = 0;
+            record({ "culling", level, nullptr,
+                [&]() {
+                    TerrainCulling culling;
+                    culling.setFullMesh(terrain);
+                    std::mt19937 rng(kSeed);
+                    visible = 0;
+                    for (int c = 0; c < kCameraPositionsPerRun; ++c) {
+                        culling.getCulledMesh(randomUnit(rng) * 3.0f, QVector3D(0.0f, 0.0f, 0.0f));
+                        visible += culling.getVisibleTriangleCount();
+                    }
+                },
+                [&]() { QJsonObject items = meshItems;
+                    items["cameras"] = kCameraPositionsPerRun;
+                    items["visible_triangles_avg"] = static_cast<double>(visible) / kCameraPositionsPerRun;
+                    return items; } });
+        }
+
+        // culling_triangles / culling_clusters: развёртка камер - прежний тест полушария на
+        // каждый треугольник против кластеров по 64 и 256 треугольников. Кластеры обязаны
+        // оставить хотя бы все треугольники, хоть одной вершиной повёрнутые к камере
+        {
+            const std::vector<QVector3D> views = sweepViews(kSweepViews);
+            const size_t triangleCount = terrain.idx.size() / 3;
+            auto vertex = [&](uint32_t i) {
+                return QVector3D(terrain.pos[size_t(i) * 3], terrain.pos[size_t(i) * 3 + 1], terrain.pos[size_t(i) * 3 + 2]);
+            };
+            std::vector<QVector3D> centers(triangleCount);
+            std::vector<size_t> frontFacing(views.size());
+            for (size_t t = 0; t < triangleCount; ++t) {
+                const QVector3D v0 = vertex(terrain.idx[t * 3]);
+                const QVector3D v1 = vertex(terrain.idx[t * 3 + 1]);
+                const QVector3D v2 = vertex(terrain.idx[t * 3 + 2]);
+                centers[t] = (v0 + v1 + v2) * (1.0f / 3.0f);
+                const QVector3D n = QVector3D::crossProduct(v1 - v0, v2 - v0);
+                for (size_t v = 0; v < views.size(); ++v) {
+                    if (n.lengthSquared() > 0.0f && (QVector3D::dotProduct(n, v0 - views[v]) < 0.0f ||
+                        QVector3D::dotProduct(n, v1 - views[v]) < 0.0f || QVector3D::dotProduct(n, v2 - views[v]) < 0.0f)) {
+                        ++frontFacing[v];
+                    }
+                }
+            }
+
+            size_t kept = 0;
+            auto sweepItems = [&]() { QJsonObject items = meshItems;
+                items["views"] = kSweepViews;
+                items["kept_triangles_avg"] = static_cast<double>(kept) / kSweepViews;
+                return items; };
+
+            std::vector<uint32_t> visible;
+            record({ "culling_triangles", level, nullptr,
+                [&]() {
+                    kept = 0;
+                    for (const QVector3D& eye : views) {
+                        const QVector3D toCam = eye.normalized();
+                        visible.clear();
+                        for (size_t t = 0; t < triangleCount; ++t) {
+                            if (QVector3D::dotProduct(centers[t].normalized(), toCam) > 0.0f) {
+                                visible.insert(visible.end(), terrain.idx.begin() + t * 3, terrain.idx.begin() + t * 3 + 3);
+                            }
+                        }
+                        kept += visible.size() / 3;
+                    }
+                },
+                sweepItems, "Per-triangle" });
+
+            for (const uint32_t clusterTriangles : { 64u, 256u }) {
+                const QString name = QString("Clusters %1").arg(clusterTriangles);
+                TerrainClusters clusters;
+                record({ "culling_clusters_build", level, nullptr,
+                    [&]() { clusters.build(terrain, clusterTriangles); },
+                    [&]() { QJsonObject items = meshItems;
+                        items["clusters"] = static_cast<double>(clusters.clusterCount());
+                        return items; },
+                    name });
+
+                std::vector<size_t> counts(views.size());
+                record({ "culling_clusters", level, nullptr,
+                    [&]() {
+                        kept = 0;
+                        for (size_t v = 0; v < views.size(); ++v) {
+                            visible.clear();
+                            counts[v] = clusters.gatherVisible(views[v], 0.0f, visible);
+                            kept += counts[v];
+                        }
+                    },
+                    [&]() { QJsonObject items = sweepItems();
+                        items["clusters"] = static_cast<double>(clusters.clusterCount());
+                        return items; },
+                    name,
+                    [&]() {
+                        for (size_t v = 0; v < views.size(); ++v) {
+                            if (counts[v] < frontFacing[v]) return false;
+                        }
+                        return true;
+                    } });
+            }
+
+            // visibility_upload: что стоит отдать в GL смену видимости - список индексов под
+            // Reallocate/SubData в IBO или диапазоны glMultiDrawElements по IBO, упорядоченному
+            // по кластерам и загруженному один раз. bytes_per_view - данные за вид (индексы или
+            // GLsizei-счётчики со смещениями). Простые диапазоны рисуют ровно треугольники списка
+            TerrainClusters clusters;
+            clusters.build(terrain);
+            constexpr uint32_t kMergeGap = TerrainClusters::kDefaultClusterTriangles * 3;
+            std::vector<size_t> listTriangles(views.size());
+            size_t bytes = 0;
+            size_t draws = 0;
+            size_t drawn = 0;
+            auto uploadItems = [&]() { QJsonObject items = meshItems;
+                items["views"] = kSweepViews;
+                items["bytes_per_view"] = static_cast<double>(bytes) / kSweepViews;
+                items["draws_per_view"] = static_cast<double>(draws) / kSweepViews;
+                items["triangles_per_view"] = static_cast<double>(drawn) / kSweepViews;
+                return items; };
+
+            record({ "visibility_upload", level, nullptr,
+                [&]() {
+                    bytes = 0;
+                    drawn = 0;
+                    for (size_t v = 0; v < views.size(); ++v) {
+                        visible.clear();
+                        listTriangles[v] = clusters.gatherVisible(views[v], 0.0f, visible);
+                        bytes += visible.size() * sizeof(uint32_t);
+                        drawn += listTriangles[v];
+                    }
+                    draws = views.size();
+                },
+                uploadItems, "Index list" });
+
+            std::vector<TerrainDrawRange> ranges;
+            for (const uint32_t gap : { 0u, kMergeGap }) {
+                std::vector<size_t> counts(views.size());
+                record({ "visibility_upload", level, nullptr,
+                    [&]() {
+                        draws = 0;
+                        drawn = 0;
+                        for (size_t v = 0; v < views.size(); ++v) {
+                            ranges.clear();
+                            counts[v] = clusters.gatherVisibleRanges(views[v], 0.0f, ranges, gap);
+                            draws += ranges.size();
+                            drawn += counts[v];
+                        }
+                        bytes = draws * (sizeof(int32_t) + sizeof(const void*));
+                    },
+                    uploadItems, gap == 0 ? "Draw ranges" : "Draw ranges (merged)",
+                    [&]() {
+                        for (size_t v = 0; v < views.size(); ++v) {
+                            if (gap == 0 ? counts[v] != listTriangles[v] : counts[v] < listTriangles[v]) return false;
+                        }
+                        return true;
+                    } });
+            }
+        }
+
+        // water_mesh: прежний рекурсивный генератор без индексов против индексированного с
+        // общими вершинами рёбер - с равномерным качеством и с LOD по камере над планетой.
+        // Та же поверхность без LOD обязана дать столько же треугольников
+        {
+            WaterMeshOptions legacy;
+            legacy.mode = WaterMeshOptions::Mode::Legacy;
+            WaterMeshOptions lod;
+            lod.cameraLod = true;
+            lod.eye = QVector3D(0.0f, 0.0f, 1.3f);
+            const std::pair<QString, WaterMeshOptions> waterVariants[] = {
+                { "Recursive unindexed", legacy },
+                { "Indexed", WaterMeshOptions{} },
+                { "Indexed + camera LOD", lod },
+            };
+
+            size_t legacyTriangles = 0;
+            for (const auto& [variant, options] : waterVariants) {
+                WaterGeometryData data;
+                const bool mustMatch = options.mode != WaterMeshOptions::Mode::Legacy && !options.cameraLod;
+                std::function<bool()> check;
+                if (mustMatch) {
+                    check = [&]() { return data.indices.size() / 3 == legacyTriangles; };
+                }
+                record({ "water_mesh", level, nullptr,
+                    [&]() { data = WaterMeshGenerator::buildWaterGeometry(model, options); },
+                    [&]() { return QJsonObject{ { "cells", model.cellCount() },
+                        { "vertices", static_cast<int>(data.edgeFlags.size()) },
+                        { "triangles", static_cast<int>(data.indices.size() / 3) },
+                        { "bytes", static_cast<double>((data.positions.size() + data.edgeFlags.size()) * sizeof(float)
+                            + data.indices.size() * sizeof(uint32_t)) } }; },
+                    variant, check });
+                if (options.mode == WaterMeshOptions::Mode::Legacy) {
+                    legacyTriangles = data.indices.size() / 3;
+                }
+            }
+        }
+
+        // picking: построение BVH и лучи с орбиты по рельефу и по треугольникам пикинга.
+        // Перебор всех треугольников - эталон для первого и для любого попадания
+        const std::pair<QString, std::vector<BVHTriangle>> pickTargets[] = {
+            { QString(), TriangleBVH::trianglesOf(terrain) },
+            { "pick tris", TriangleBVH::trianglesOf(model.pickTris()) },
+        };
+        for (const auto& [target, tris] : pickTargets) {
+            const QJsonObject pickItems{ { "cells", model.cellCount() }, { "triangles", static_cast<int>(tris.size()) } };
+            TriangleBVH bvh;
+            record({ "picking_bvh_build", level, nullptr,
+                [&]() { bvh.build(tris); },
+                [&]() { QJsonObject items = pickItems;
+                    items["nodes"] = static_cast<double>(bvh.nodeCount());
+                    return items; },
+                target });
+
+            std::vector<std::optional<BVHRayHit>> firstHits(kRaysPerRun);
+            std::vector<char> anyHits(kRaysPerRun);
+            int hits = 0;
+            auto rayItems = [&]() { QJsonObject items = pickItems;
+                items["rays"] = kRaysPerRun;
+                items["hits"] = hits;
+                return items; };
+
+            record({ "picking", level, nullptr,
+                [&]() {
+                    hits = 0;
+                    castOrbitRays([&](int r, const QVector3D& origin, const QVector3D& dir) {
+                        firstHits[static_cast<size_t>(r)] = bvh.intersectFirst(origin, dir);
+                        if (firstHits[static_cast<size_t>(r)]) ++hits;
+                        });
+                },
+                rayItems, target });
+
+            std::vector<BVHRayHit> bruteHits(kRaysPerRun);
+            record({ "picking_brute", level, nullptr,
+                [&]() {
+                    hits = 0;
+                    castOrbitRays([&](int r, const QVector3D& origin, const QVector3D& dir) {
+                        bruteHits[static_cast<size_t>(r)] = bruteFirstHit(tris, origin, dir);
+                        if (bruteHits[static_cast<size_t>(r)].triangle >= 0) ++hits;
+                        });
+                },
+                rayItems, target,
+                [&]() {
+                    for (size_t r = 0; r < bruteHits.size(); ++r) {
+                        const bool found = bruteHits[r].triangle >= 0;
+                        if (found != firstHits[r].has_value() ||
+                            (found && std::abs(firstHits[r]->t - bruteHits[r].t) > 1e-5f * bruteHits[r].t)) {
+                            return false;
+                        }
+                    }
+                    return true;
+                } });
+
+            record({ "picking_any", level, nullptr,
+                [&]() {
+                    hits = 0;
+                    castOrbitRays([&](int r, const QVector3D& origin, const QVector3D& dir) {
+                        anyHits[static_cast<size_t>(r)] = bvh.intersectAny(origin, dir);
+                        hits += anyHits[static_cast<size_t>(r)];
+                        });
+                },
+                rayItems, target });
+
+            std::vector<char> bruteAnyHits(kRaysPerRun);
+            record({ "picking_any_brute", level, nullptr,
+                [&]() {
+                    hits = 0;
+                    castOrbitRays([&](int r, const QVector3D& origin, const QVector3D& dir) {
+                        bruteAnyHits[static_cast<size_t>(r)] = bruteAnyHit(tris, origin, dir);
+                        hits += bruteAnyHits[static_cast<size_t>(r)];
+                        });
+                },
+                rayItems, target,
+                [&]() { return bruteAnyHits == anyHits; } });
+        }
+
+        // astar: граф проходимости + пачка случайных запросов
+        {
+            PathBuilder pathBuilder(model, PathBuilder::kMaxClimbDelta);
+            record({ "astar_graph_build", level, nullptr,
+                [&]() { pathBuilder.build(); },
+                [&]() { return QJsonObject{ { "cells", model.cellCount() } }; } });
+
+            int found = 0;
+            uint64_t expanded = 0;
+            record({ "astar", level, nullptr,
+                [&]() {
+                    std::mt19937 rng(kSeed);
+                    std::uniform_int_distribution<int> pickCell(0, model.cellCount() - 1);
+                    const uint64_t before = pathBuilder.totalSearchStats().expandedNodes;
+                    found = 0;
+                    for (int q = 0; q < kPathQueriesPerRun; ++q) {
+                        if (!pathBuilder.astar(pickCell(rng), pickCell(rng)).empty()) ++found;
+                    }
+                    expanded = pathBuilder.totalSearchStats().expandedNodes - before;
+                },
+                [&]() { return QJsonObject{ { "cells", model.cellCount() }, { "queries", kPathQueriesPerRun },
+                    { "found", found }, { "expanded_nodes", static_cast<double>(expanded) } }; } });
+
+            // astar_alt: те же запросы с ALT-эвристикой, стоимость путей обязана совпасть с astar
+            PathBuilder landmarks(model, PathBuilder::kMaxClimbDelta);
+            landmarks.build();
+            record({ "astar_landmarks", level, nullptr,
+                [&]() { landmarks.buildLandmarks(); },
+                [&]() { return QJsonObject{ { "cells", model.cellCount() }, { "landmarks", landmarks.landmarkCount() } }; } });
+
+            std::vector<std::vector<int>> altPaths(kPathQueriesPerRun);
+            uint64_t altExpanded = 0;
+            auto pathCost = [&](const std::vector<int>& path) {
+                float cost = 0.0f;
+                for (size_t i = 0; i + 1 < path.size(); ++i) {
+                    cost += pathBuilder.traversalCost(model.cells()[static_cast<size_t>(path[i])],
+                        model.cells()[static_cast<size_t>(path[i + 1])]);
+                }
+                return cost;
+            };
+            record({ "astar_alt", level, nullptr,
+                [&]() {
+                    std::mt19937 rng(kSeed);
+                    std::uniform_int_distribution<int> pickCell(0, model.cellCount() - 1);
+                    const uint64_t before = landmarks.totalSearchStats().expandedNodes;
+                    for (int q = 0; q < kPathQueriesPerRun; ++q) {
+                        altPaths[static_cast<size_t>(q)] = landmarks.astar(pickCell(rng), pickCell(rng));
+                    }
+                    altExpanded = landmarks.totalSearchStats().expandedNodes - before;
+                },
+                [&]() { return QJsonObject{ { "cells", model.cellCount() }, { "queries", kPathQueriesPerRun },
+                    { "landmarks", landmarks.landmarkCount() }, { "expanded_nodes", static_cast<double>(altExpanded) } }; },
+                QString(),
+                [&]() {
+                    std::mt19937 rng(kSeed);
+                    std::uniform_int_distribution<int> pickCell(0, model.cellCount() - 1);
+                    for (int q = 0; q < kPathQueriesPerRun; ++q) {
+                        const std::vector<int> reference = pathBuilder.astar(pickCell(rng), pickCell(rng));
+                        const std::vector<int>& path = altPaths[static_cast<size_t>(q)];
+                        const float expected = pathCost(reference);
+                        if (path.empty() != reference.empty() ||
+                            std::abs(pathCost(path) - expected) > 1e-4f * std::max(expected, 1.0f)) {
+                            return false;
+                        }
+                    }
+                    return true;
+                } });
+        }
+    }
+
+    // ecs_*: обход и удаление компонентов в sparse-set ComponentStorage и в прежних
+    // hash map; суммы обходов и число выживших сущностей обязаны совпасть
+    for (int entityCount : { 10000, 100000 }) {
+        ecs::ComponentStorage sparse;
+        HashMapStorage hashed;
+        fillEcsStorages(entityCount, sparse, hashed);
+        const QString suffix = QString(" %1k").arg(entityCount / 1000);
+        auto ecsItems = [&](const QString& storage) {
+            return [&, storage]() { return QJsonObject{ { "entities", entityCount }, { "storage", storage } }; };
+        };
+
+        double hashSum = 0.0;
+        double sparseSum = 0.0;
+        record({ "ecs_each_mesh", -1, nullptr,
+            [&]() {
+                hashSum = 0.0;
+                for (ecs::EntityId id : hashed.order) {
+                    if (HashMapStorage::has(hashed.meshes, id) && HashMapStorage::has(hashed.transforms, id)) {
+                        hashSum += hashed.transforms.at(id).position.x() + hashed.entities.at(id).currentCell;
+                    }
+                }
+            },
+            ecsItems("Hash maps"), "Hash maps" + suffix });
+        record({ "ecs_each_mesh", -1, nullptr,
+            [&]() {
+                sparseSum = 0.0;
+                sparse.each<ecs::Mesh, ecs::Transform>([&](const ecs::Entity& entity, const ecs::Mesh&, const ecs::Transform& transform) {
+                    sparseSum += transform.position.x() + entity.currentCell;
+                    });
+            },
+            ecsItems("Sparse sets"), "Sparse sets" + suffix,
+            [&]() { return sparseSum == hashSum; } });
+
+        // Малый набор Collider ведёт обход
+        record({ "ecs_each_collider", -1, nullptr,
+            [&]() {
+                hashSum = 0.0;
+                for (ecs::EntityId id : hashed.order) {
+                    if (HashMapStorage::has(hashed.colliders, id) && HashMapStorage::has(hashed.transforms, id)) {
+                        hashSum += hashed.colliders.at(id).radius * hashed.transforms.at(id).position.y();
+                    }
+                }
+            },
+            ecsItems("Hash maps"), "Hash maps" + suffix });
+        record({ "ecs_each_collider", -1, nullptr,
+            [&]() {
+                sparseSum = 0.0;
+                sparse.each<ecs::Collider, ecs::Transform>([&](const ecs::Entity&, const ecs::Collider& collider, const ecs::Transform& transform) {
+                    sparseSum += collider.radius * transform.position.y();
+                    });
+            },
+            ecsItems("Sparse sets"), "Sparse sets" + suffix,
+            [&]() { return sparseSum == hashSum; } });
+
+        // Уничтожение каждой десятой сущности; prepare заново заполняет хранилища
+        const size_t survivors = static_cast<size_t>(entityCount - (entityCount + 9) / 10);
+        record({ "ecs_destroy", -1,
+            [&]() { fillEcsStorages(entityCount, sparse, hashed); },
+            [&]() {
+                for (int e = 0; e < entityCount; e += 10) hashed.destroy(e);
+            },
+            ecsItems("Hash maps"), "Hash maps" + suffix,
+            [&]() { return hashed.order.size() == survivors; } });
+        record({ "ecs_destroy", -1,
+            [&]() { fillEcsStorages(entityCount, sparse, hashed); },
+            [&]() {
+                for (int e = 0; e < entityCount; e += 10) sparse.destroyEntity(e);
+            },
+            ecsItems("Sparse sets"), "Sparse sets" + suffix,
+            [&]() { return sparse.entityCount() == survivors && !sparse.getEntity(0) && sparse.getEntity(1); } });
+    }
+
+    // perlin_fractal: 4 октавы на точках единичной сферы (как центры клеток в
+    // ClimateBiomeGenerator). Эталон - прежний поштучный double-шум с тем же
+    // накоплением октав; пакетный float обязан совпасть с ним до 1e-4
+    {
+        const Perlin3D noise(kSeed);
+        PerlinFractal fractal;
+        fractal.frequency = 3.0f;
+        fractal.octaves = 4;
+
+        for (int pointCount : { 10000, 100000 }) {
+            std::mt19937 rng(static_cast<uint32_t>(pointCount));
+            std::vector<float> xs(pointCount), ys(pointCount), zs(pointCount);
+            for (int p = 0; p < pointCount; ++p) {
+                const QVector3D v = randomUnit(rng);
+                xs[p] = v.x();
+                ys[p] = v.y();
+                zs[p] = v.z();
+            }
+            const QString suffix = QString(" %1k").arg(pointCount / 1000);
+            auto perlinItems = [&](const QString& backend) {
+                return [&, backend]() { return QJsonObject{ { "points", pointCount }, { "octaves", fractal.octaves },
+                    { "backend", backend } }; };
+            };
+
+            std::vector<double> reference(pointCount);
+            record({ "perlin_fractal", -1, nullptr,
+                [&]() {
+                    for (int p = 0; p < pointCount; ++p) {
+                        double sum = 0.0;
+                        double total = 0.0;
+                        float frequency = fractal.frequency;
+                        double amplitude = 1.0;
+                        for (int o = 0; o < fractal.octaves; ++o) {
+                            sum += amplitude * noise.noise(xs[p] * frequency, ys[p] * frequency, zs[p] * frequency);
+                            total += amplitude;
+                            frequency *= fractal.lacunarity;
+                            amplitude *= fractal.gain;
+                        }
+                        reference[p] = sum / total;
+                    }
+                },
+                perlinItems("double per point"), "double per point" + suffix });
+
+            for (PerlinBackend backend : { PerlinBackend::Scalar, PerlinBackend::SSE2, PerlinBackend::AVX2 }) {
+                // Недоступный на этом CPU/платформе уровень не подменяем нижним
+                if (Perlin3D::resolveBackend(backend) != backend) {
+                    continue;
+                }
+                const QString name = QString("float %1").arg(QString::fromLatin1(Perlin3D::backendName(backend)));
+                std::vector<float> out(pointCount);
+                record({ "perlin_fractal", -1, nullptr,
+                    [&]() { noise.fractalBatch(xs.data(), ys.data(), zs.data(), out.data(), out.size(), fractal, backend); },
+                    perlinItems(name), name + suffix,
+                    [&]() {
+                        double maxError = 0.0;
+                        for (int p = 0; p < pointCount; ++p) {
+                            maxError = std::max(maxError, std::abs(static_cast<double>(out[p]) - reference[p]));
+                        }
+                        return maxError < 1e-4;
+                    } });
+            }
+        }
+    }
+
+    // trees_*: кадр деревьев на L5 - прежний цикл строил точку поверхности и MVP каждого
+    // дерева и рисовал их по одному, TreeInstanceBuilder только отсекает и сортирует
+    // матрицы, запечённые в setPlacements. Деревья, отправленные в GL, и отсечённые
+    // обязаны в сумме дать все деревья в каждом виде
+    {
+        constexpr int kTreeViews = 16;
+        constexpr size_t kTrees = 100000;
+        constexpr float kHeightStep = 0.02f;
+        const HexSphereModel model = makeModel(5, true);
+
+        std::mt19937 rng(kSeed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::uniform_int_distribution<int> cellPick(0, static_cast<int>(model.cells().size()) - 1);
+        std::vector<TreePlacement> placements(kTrees);
+        for (size_t t = 0; t < kTrees; ++t) {
+            TreePlacement& placement = placements[t];
+            placement.cellId = cellPick(rng);
+            const int corners = static_cast<int>(model.cells()[static_cast<size_t>(placement.cellId)].poly.size());
+            placement.triangleIdx = std::min(static_cast<int>(unit(rng) * corners), corners - 1);
+            placement.baryU = unit(rng) * 0.5f;
+            placement.baryV = unit(rng) * 0.5f;
+            placement.baryW = 1.0f - placement.baryU - placement.baryV;
+            placement.scale = 0.8f + 0.4f * unit(rng);
+            placement.rotation = unit(rng) * 6.2831853f;
+            placement.treeType = t % 3 == 0 ? TreeType::Fir : TreeType::Oak;
+        }
+
+        std::vector<std::pair<QVector3D, QMatrix4x4>> views;
+        QMatrix4x4 projection;
+        projection.perspective(50.0f, 16.0f / 9.0f, 0.01f, 100.0f);
+        for (int v = 0; v < kTreeViews; ++v) {
+            const float y = 1.0f - 2.0f * (static_cast<float>(v) + 0.5f) / kTreeViews;
+            const float r = std::sqrt(std::max(0.0f, 1.0f - y * y));
+            const float phi = 2.39996323f * static_cast<float>(v);
+            const float distance = v % 2 == 0 ? 2.5f : 1.3f;
+            const QVector3D eye = QVector3D(r * std::cos(phi), y, r * std::sin(phi)) * distance;
+            QMatrix4x4 view;
+            view.lookAt(eye, QVector3D(), std::abs(y) > 0.9f ? QVector3D(1, 0, 0) : QVector3D(0, 1, 0));
+            views.push_back({ eye, projection * view });
+        }
+
+        size_t bytes = 0;
+        size_t draws = 0;
+        size_t drawn = 0;
+        auto treeItems = [&]() {
+            return QJsonObject{ { "cells", model.cellCount() }, { "trees", static_cast<int>(kTrees) }, { "views", kTreeViews },
+                { "bytes_per_view", static_cast<double>(bytes) / kTreeViews },
+                { "draws_per_view", static_cast<double>(draws) / kTreeViews },
+                { "trees_per_view", static_cast<double>(drawn) / kTreeViews } };
+        };
+
+        TreeInstanceBuilder instances;
+        record({ "trees_bake", -1, nullptr,
+            [&]() { instances.setPlacements(model, placements, kHeightStep); },
+            [&]() { return QJsonObject{ { "cells", model.cellCount() }, { "trees", static_cast<int>(kTrees) } }; } });
+
+        float checksum = 0.0f;
+        record({ "trees_frame", -1, nullptr,
+            [&]() {
+                checksum = 0.0f;
+                for (const auto& [eye, viewProjection] : views) {
+                    for (const TreePlacement& placement : placements) {
+                        const QMatrix4x4 mvp = viewProjection * treeModelMatrix(model, placement, kHeightStep);
+                        checksum += mvp.constData()[15];
+                    }
+                }
+                drawn = draws = kTrees * views.size();
+                bytes = drawn * sizeof(float) * 16;
+            },
+            treeItems, "Per-tree matrices",
+            [&]() { return std::isfinite(checksum); } });
+
+        bool consistent = true;
+        record({ "trees_frame", -1, nullptr,
+            [&]() {
+                consistent = true;
+                draws = 0;
+                drawn = 0;
+                for (const auto& [eye, viewProjection] : views) {
+                    const size_t count = instances.build(viewProjection, eye);
+                    consistent = consistent && count + instances.culledByFrustum() + instances.culledByHorizon() == kTrees;
+                    drawn += count;
+                    for (const TreeType type : { TreeType::Oak, TreeType::Fir })
+                        draws += instances.instances(type).empty() ? 0 : 1;
+                }
+                bytes = drawn * sizeof(TreeInstance);
+            },
+            treeItems, "Instance builder",
+            [&]() { return consistent; } });
+    }
+
+    // particles_step: шаг ветра/пружин частиц деревьев - прежний цикл по массиву
+    // ContributorParticle на месте (как ParticleRenderer::update по отображённому VBO)
+    // против SoA-столбцов ParticleSimulator, в один поток и на всех аппаратных.
+    // prepare возвращает частицы в исходное состояние; итоговые позиции SoA обязаны
+    // совпасть с циклом AoS до 1e-4
+    {
+        constexpr size_t kParticles = 300000;
+        constexpr int kSteps = 30;
+        constexpr float kDeltaTime = 0.016f;
+
+        std::mt19937 rng(kSeed);
+        std::vector<ContributorParticle> source;
+        source.reserve(kParticles);
+        while (source.size() < kParticles) {
+            ContributorParticleBlob blob;
+            blob.center = QVector3D(0.0f, 1.5f, 0.0f);
+            blob.radius = 1.2f;
+            blob.particleCount = static_cast<int>(std::min<size_t>(1000, kParticles - source.size()));
+            const std::vector<ContributorParticle> part = generateParticleBlob(blob, rng);
+            source.insert(source.end(), part.begin(), part.end());
+        }
+
+        ContributorWindField wind;
+        wind.direction = QVector3D(0.8f, 0.2f, 0.4f).normalized();
+        wind.strength = 0.35f;
+        wind.gustStrength = 0.4f;
+        wind.gustSpeed = 1.8f;
+        wind.turbulence = 0.2f;
+        const QVector3D center(0.0f, 1.0f, 0.0f);
+
+        auto particleItems = [&](int threads, size_t bytesPerStep) {
+            return [=]() { return QJsonObject{ { "particles", static_cast<int>(kParticles) }, { "steps", kSteps },
+                { "threads", threads }, { "bytes_per_step", static_cast<double>(bytesPerStep) } }; };
+        };
+
+        std::vector<ContributorParticle> aos;
+        record({ "particles_step", -1,
+            [&]() { aos = source; },
+            [&]() {
+                float time = 0.0f;
+                for (int step = 0; step < kSteps; ++step) {
+                    time += kDeltaTime;
+                    for (ContributorParticle& p : aos) {
+                        const float heightFactor = std::clamp((p.restPosition.y() - center.y()) / 5.0f, 0.3f, 1.2f);
+                        const float gust = std::sin(time * wind.gustSpeed + p.phase) * wind.gustStrength;
+                        const float turbulenceX = std::sin(time * 2.3f + p.restPosition.y() * 1.5f) * wind.turbulence;
+                        const float turbulenceZ = std::cos(time * 1.7f + p.restPosition.x() * 1.2f) * wind.turbulence;
+                        QVector3D windForce = wind.direction * (wind.strength + gust) * heightFactor;
+                        windForce.setX(windForce.x() + turbulenceX);
+                        windForce.setZ(windForce.z() + turbulenceZ);
+                        windForce *= p.windWeight;
+                        const QVector3D acceleration = windForce + (p.restPosition - p.position) * 8.0f - p.velocity * 3.0f;
+                        p.velocity += acceleration * kDeltaTime;
+                        p.position += p.velocity * kDeltaTime;
+                        p.velocity *= 0.99f;
+                    }
+                }
+            },
+            particleItems(1, kParticles * sizeof(ContributorParticle)), "AoS in place" });
+
+        std::vector<int> threadCounts = { 1 };
+        const int hardwareThreads = static_cast<int>(std::thread::hardware_concurrency());
+        if (hardwareThreads > 1) threadCounts.push_back(hardwareThreads);
+
+        std::vector<ParticleVertex> vertices(kParticles);
+        for (const int threads : threadCounts) {
+            ParticleSimulator simulator;
+            simulator.setThreadCount(threads);
+            record({ "particles_step", -1,
+                [&]() { simulator.assign(source); },
+                [&]() {
+                    float time = 0.0f;
+                    for (int step = 0; step < kSteps; ++step) {
+                        time += kDeltaTime;
+                        simulator.step(kDeltaTime, time, wind, center, vertices.data());
+                    }
+                },
+                particleItems(threads, kParticles * sizeof(ParticleVertex)),
+                threads == 1 ? QString("SoA serial") : QString("SoA %1 threads").arg(threads),
+                [&]() {
+                    float maxError = 0.0f;
+                    for (size_t p = 0; p < kParticles; ++p) {
+                        const QVector3D position(vertices[p].position[0], vertices[p].position[1], vertices[p].position[2]);
+                        maxError = std::max(maxError, (position - aos[p].position).length());
+                    }
+                    return maxError < 1e-4f;
+                } });
+        }
+    }
+
+    // obj_load: разбор OBJ без GL-загрузки (ModelHandler требует контекст)
+    for (const QString& path : objFiles) {
+        simple3d::Mesh mesh;
+        bool ok = true;
+        BenchCase bench{ "obj_load", -1, nullptr,
+            [&]() {
+                mesh.clear();
+                ok = simple3d::load_obj_file(QFile::encodeName(path).toStdString(), mesh);
+            },
+            [&]() { return QJsonObject{ { "file", QFileInfo(path).fileName() }, { "loaded", ok },
+                { "vertices", static_cast<double>(mesh.vertexCount()) },
+                { "triangles", static_cast<double>(mesh.triangleCount()) } }; } };
+        record(bench);
+    }
+
+    QJsonObject report;
+    report["schema"] = "planet-pipeline-benchmark/1";
+    report["generated_at"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["label"] = parser.value(labelOption);
+    report["platform"] = QSysInfo::prettyProductName();
+    report["cpu_arch"] = QSysInfo::currentCpuArchitecture();
+    report["compiler"] = compilerName();
+#ifdef NDEBUG
+    report["build"] = "release";
+#else
+    report["build"] = "debug";
+#endif
+    report["hardware_threads"] = static_cast<int>(std::thread::hardware_concurrency());
+    report["repeat"] = repeat;
+    report["ok"] = allOk;
+    report["cases"] = cases;
+
+    const QString outPath = parser.value(outOption);
+    QFile file(outPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Cannot write" << outPath;
+        return 1;
+    }
+    file.write(QJsonDocument(report).toJson(QJsonDocument::Indented));
+    qInfo().noquote() << "Benchmark report written to" << QFileInfo(file).absoluteFilePath();
+    return allOk ? 0 : 2;
+}